@@ -627,6 +627,11 @@ public:
   size_t getASTAllocatedMemory() const {
     return BumpAlloc.getTotalMemory();
   }
+  /// Return the number of bytes requested for AST nodes and type information,
+  /// not counting the unused space at the end of the allocator's slabs.
+  size_t getASTAllocatedBytes() const {
+    return BumpAlloc.getBytesAllocated();
+  }
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
   
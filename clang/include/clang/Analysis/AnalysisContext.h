@@ -36,6 +36,7 @@ class LocationContextManager;
 class StackFrameContext;
 class BlockInvocationContext;
 class AnalysisDeclContextManager;
+class BodyFarm;
 class LocationContext;
 
 namespace idx { class TranslationUnit; }
@@ -421,6 +422,10 @@ class AnalysisDeclContextManager {
   /// for well-known functions.
   bool SynthesizeBodies;
 
+  /// The bodies synthesized for well-known functions. Created lazily, and
+  /// owned by the manager so that each AST gets its own.
+  std::unique_ptr<BodyFarm> FunctionBodyFarm;
+
 public:
   AnalysisDeclContextManager(bool useUnoptimizedCFG = false,
                              bool addImplicitDtors = false,
@@ -479,6 +484,8 @@ private:
   LocationContextManager &getLocationContextManager() {
     return LocContexts;
   }
+
+  BodyFarm &getBodyFarm(ASTContext &C);
 };
 
 } // end clang namespace
@@ -28,6 +28,7 @@
 #include <ctime>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <string>
 
 namespace llvm {
@@ -39,6 +40,7 @@ class MemoryBuffer;
 namespace clang {
 
 class FileSystemStatCache;
+class SharedStatCache;
 
 /// \brief Cached information about one directory (either on disk or in
 /// the virtual file system).
@@ -106,6 +108,38 @@ public:
 
 struct FileData;
 
+/// \brief The contents of files read by several FileManagers, which may be
+/// used on different threads.
+///
+/// Files are identified by their unique ID, size and modification time, so
+/// a file which changed on disk is read again. This lets compilations which
+/// run in the same process read each header, precompiled header and module
+/// file only once.
+class FileContentCache
+    : public llvm::ThreadSafeRefCountedBase<FileContentCache> {
+  struct Entry {
+    off_t Size;
+    time_t ModTime;
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+  };
+
+  std::mutex Mutex;
+  std::map<llvm::sys::fs::UniqueID, Entry> Entries;
+
+public:
+  /// \brief Return the cached contents of \p File, or null if they are not
+  /// in the cache.
+  std::unique_ptr<llvm::MemoryBuffer> lookup(const FileEntry *File);
+
+  /// \brief Add the contents of \p File to the cache, and return a buffer
+  /// referring to the cached contents.
+  std::unique_ptr<llvm::MemoryBuffer>
+  insert(const FileEntry *File, std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief Drop all cached contents. Buffers returned earlier stay valid.
+  void invalidate();
+};
+
 /// \brief Implements support for file system lookup, file system caching,
 /// and directory search management.
 ///
@@ -164,9 +198,25 @@ class FileManager : public RefCountedBase<FileManager> {
   // Caching.
   std::unique_ptr<FileSystemStatCache> StatCache;
 
+  /// \brief The stat cache shared with other FileManagers, if any, and the
+  /// client through which it is used when no other stat cache is installed.
+  /// It is not removed by clearStatCaches().
+  IntrusiveRefCntPtr<SharedStatCache> SharedStats;
+  std::unique_ptr<FileSystemStatCache> SharedStatsClient;
+
+  /// \brief The file contents shared with other FileManagers, if any.
+  IntrusiveRefCntPtr<FileContentCache> SharedContents;
+
   bool getStatValue(StringRef Path, FileData &Data, bool isFile,
                     std::unique_ptr<vfs::File> *F);
 
+  /// \brief Forget the shared 'stat' result for \p Path, if any.
+  void invalidateSharedStat(StringRef Path);
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  readBufferForFile(const FileEntry *Entry, bool isVolatile,
+                    bool ShouldCloseOpenFile);
+
   /// Add all ancestors of the given path (pointing to either a file
   /// or a directory) as virtual directories.
   void addAncestorsAsVirtualDirs(StringRef Path);
@@ -196,6 +246,16 @@ public:
   /// \brief Removes all FileSystemStatCache objects from the manager.
   void clearStatCaches();
 
+  /// \brief Share the results of 'stat' calls with the other FileManagers
+  /// using \p Cache. Passing null stops sharing.
+  void setSharedStatCache(IntrusiveRefCntPtr<SharedStatCache> Cache);
+
+  /// \brief Share the contents of the files read by getBufferForFile() with
+  /// the other FileManagers using \p Cache. Passing null stops sharing.
+  void setFileContentCache(IntrusiveRefCntPtr<FileContentCache> Cache) {
+    SharedContents = std::move(Cache);
+  }
+
   /// \brief Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
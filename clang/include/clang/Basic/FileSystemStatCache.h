@@ -16,9 +16,11 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 #include <memory>
+#include <mutex>
 
 namespace clang {
 
@@ -126,6 +128,42 @@ public:
                        vfs::FileSystem &FS) override;
 };
 
+/// \brief The results of 'stat' calls shared by several FileManagers, which
+/// may be used on different threads.
+///
+/// Like MemorizeStatCalls, only successful lookups are cached: a file which
+/// is missing may be created by one of the compilations sharing the cache.
+/// Only absolute paths are cached, so the FileManagers sharing a cache must
+/// see the same file system, but may have different working directories.
+/// FileManager::getFile() with CacheFailure=false and
+/// FileManager::invalidateCache() drop the entry of the path. Other clients
+/// which modify the file system while the cache is in use have to call
+/// invalidate().
+class SharedStatCache : public llvm::ThreadSafeRefCountedBase<SharedStatCache> {
+  std::mutex Mutex;
+  llvm::StringMap<FileData> Entries;
+
+public:
+  /// \brief Look up the result of a previous successful 'stat' call on
+  /// \p Path.
+  ///
+  /// \returns false if the path has not been found.
+  bool lookup(StringRef Path, FileData &Data);
+
+  /// \brief Record the result of a successful 'stat' call on \p Path.
+  void insert(StringRef Path, const FileData &Data);
+
+  /// \brief Forget the result for \p Path.
+  void invalidate(StringRef Path);
+
+  /// \brief Forget all results.
+  void invalidate();
+
+  /// \brief Create a stat cache which can be installed in a FileManager to
+  /// use and fill this cache.
+  std::unique_ptr<FileSystemStatCache> createClient();
+};
+
 } // end namespace clang
 
 #endif
@@ -259,7 +259,10 @@ public:
   /// \return The result code of the subprocess.
   int ExecuteCommand(const Command &C, const Command *&FailingCommand) const;
 
-  /// ExecuteJob - Execute a single job.
+  /// ExecuteJobs - Execute a list of jobs. If -j was given, independent jobs
+  /// are run concurrently, but their output is still printed in the order of
+  /// the list and execution stops at the first failure as if the jobs were
+  /// run one after another.
   ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
   /// failing commands and their associated result code.
@@ -267,6 +270,22 @@ public:
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
 
+  /// PrintCommand - Print the command line of a job if -v or CC_PRINT_OPTIONS
+  /// is in effect.
+  ///
+  /// \return False if the CC_PRINT_OPTIONS file could not be opened.
+  bool PrintCommand(const Command &C) const;
+
+  /// getNumParallelJobs - Return the number of jobs to run concurrently, as
+  /// given by -j. Returns 1 if the jobs have to be run one after another.
+  unsigned getNumParallelJobs() const;
+
+  /// ExecuteJobsInParallel - Run the jobs as a dependency graph on a pool of
+  /// \p NumJobs workers. See ExecuteJobs.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs, unsigned NumJobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
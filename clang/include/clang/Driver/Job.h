@@ -115,6 +115,12 @@ public:
 
   const llvm::opt::ArgStringList &getArguments() const { return Arguments; }
 
+  /// getInputFilenames - Return the arguments of this command which are
+  /// input files.
+  const llvm::opt::ArgStringList &getInputFilenames() const {
+    return InputFilenames;
+  }
+
   /// Print a command argument, and optionally quote it.
   static void printArg(llvm::raw_ostream &OS, StringRef Arg, bool Quote);
 };
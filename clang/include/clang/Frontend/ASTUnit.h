@@ -54,6 +54,9 @@ class HeaderSearch;
 class Preprocessor;
 class PCHContainerOperations;
 class PCHContainerReader;
+class PrecompiledPreambleStore;
+class PreprocessorOptions;
+struct StoredPreamble;
 class TargetInfo;
 class FrontendAction;
 class ASTDeserializationListener;
@@ -287,6 +290,14 @@ private:
   /// \brief A list of the serialization ID numbers for each of the top-level
   /// declarations parsed within the precompiled preamble.
   std::vector<serialization::DeclID> TopLevelDeclsInPreamble;
+
+  /// \brief The store in which precompiled preambles are kept in memory, or
+  /// null if they are written to temporary files.
+  IntrusiveRefCntPtr<PrecompiledPreambleStore> PreambleStore;
+
+  /// \brief The precompiled preamble, when it is kept in memory rather than
+  /// in a temporary file.
+  std::shared_ptr<const StoredPreamble> InMemoryPreamble;
   
   /// \brief Whether we should be caching code-completion results.
   bool ShouldCacheCodeCompletionResults : 1;
@@ -441,6 +452,16 @@ private:
       unsigned MaxLines = 0);
   void RealizeTopLevelDeclsFromPreamble();
 
+  /// \brief Whether there is a precompiled preamble, either in memory or in
+  /// a temporary file.
+  bool hasPrecompiledPreamble() const;
+
+  /// \brief Forget the precompiled preamble, removing its temporary file.
+  void erasePrecompiledPreamble();
+
+  /// \brief Make \p PPOpts include the precompiled preamble.
+  void addPrecompiledPreamble(PreprocessorOptions &PPOpts) const;
+
   /// \brief Transfers ownership of the objects (like SourceManager) from
   /// \param CI to this ASTUnit.
   void transferASTDataFromCompilerInstance(CompilerInstance &CI);
@@ -587,6 +608,12 @@ public:
     TopLevelDeclsInPreamble.push_back(D);
   }
 
+  /// \brief Set the store in which precompiled preambles are kept in memory
+  /// and shared with other units, or null to write them to temporary files.
+  ///
+  /// By default, the store shared by the whole process is used.
+  void setPreambleStore(IntrusiveRefCntPtr<PrecompiledPreambleStore> Store);
+
   /// \brief Retrieve a reference to the current top-level name hash value.
   ///
   /// Note: This is used internally by the top-level tracking action
@@ -153,6 +153,11 @@ public:
   /// in the backend for setting the name in the skeleton cu.
   std::string SplitDwarfFile;
 
+  /// The files to write the second and later partitions of the module to when
+  /// generating code in parallel. The first partition is written to the main
+  /// output file.
+  std::vector<std::string> ParallelCodeGenOutputs;
+
   /// The name of the relocation model to use.
   std::string RelocationModel;
 
@@ -131,6 +131,10 @@ class CompilerInvocation : public CompilerInvocationBase {
 public:
   CompilerInvocation() : AnalyzerOpts(new AnalyzerOptions()) {}
 
+  /// \brief Copy an invocation. The analyzer options are copied rather than
+  /// shared, as they are for the options in CompilerInvocationBase.
+  CompilerInvocation(const CompilerInvocation &X);
+
   /// @name Utility Methods
   /// @{
 
@@ -0,0 +1,73 @@
+//===--- MinimizedSourceFileSystem.h - Minimizing file system ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a virtual file system that presents source files reduced
+// to their preprocessor directives, for fast dependency scanning.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_MINIMIZEDSOURCEFILESYSTEM_H
+#define LLVM_CLANG_FRONTEND_MINIMIZEDSOURCEFILESYSTEM_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+/// \brief Caches the minimized contents of source files.
+///
+/// The cache is thread-safe, and is meant to be shared by all the dependency
+/// scans that run in a process so that each header is read and minimized only
+/// once. Files are identified by their unique ID, size and modification time,
+/// so a file which changed on disk is minimized again.
+class MinimizedSourceCache
+    : public llvm::ThreadSafeRefCountedBase<MinimizedSourceCache> {
+  struct Entry {
+    uint64_t Size;
+    llvm::sys::TimePoint<> ModTime;
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+  };
+
+  std::mutex Mutex;
+  std::map<llvm::sys::fs::UniqueID, Entry> Entries;
+
+public:
+  /// \brief Return the minimized contents of the file with status \p Stat,
+  /// or null if they are not in the cache.
+  std::shared_ptr<llvm::MemoryBuffer> lookup(const vfs::Status &Stat);
+
+  /// \brief Add the minimized contents of the file with status \p Stat to the
+  /// cache, and return the cached contents.
+  std::shared_ptr<llvm::MemoryBuffer>
+  insert(const vfs::Status &Stat, std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief Drop all cached contents.
+  void invalidate();
+
+  /// \brief Return the cache shared by all compilations in this process.
+  static IntrusiveRefCntPtr<MinimizedSourceCache> getProcessCache();
+};
+
+/// \brief Create a file system that presents the regular files in \p FS
+/// minimized by minimizeSourceToDependencyDirectives.
+///
+/// Files which are not sources, such as module maps, header maps and
+/// precompiled files, are passed through unchanged.
+IntrusiveRefCntPtr<vfs::FileSystem>
+createMinimizedSourceFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS,
+                                IntrusiveRefCntPtr<MinimizedSourceCache> Cache);
+
+} // end namespace clang
+
+#endif
@@ -0,0 +1,118 @@
+//===--- PrecompiledPreambleStore.h - Shared preambles ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a store that keeps precompiled preambles in memory, so
+// that translation units with the same preamble can share them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_PRECOMPILEDPREAMBLESTORE_H
+#define LLVM_CLANG_FRONTEND_PRECOMPILEDPREAMBLESTORE_H
+
+#include "clang/Frontend/ASTUnit.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace clang {
+
+/// \brief A precompiled preamble, along with what an ASTUnit needs to know
+/// about it to use it in place of one it built itself.
+///
+/// A stored preamble is immutable, so it can be used by any number of units
+/// on any number of threads.
+struct StoredPreamble {
+  /// \brief The name under which the PCH is read. No file by this name is
+  /// ever written.
+  std::string FileName;
+
+  /// \brief The serialized PCH.
+  std::unique_ptr<llvm::MemoryBuffer> PCH;
+
+  /// \brief The IDs of the top-level declarations in the PCH.
+  std::vector<serialization::DeclID> TopLevelDecls;
+
+  /// \brief The diagnostics reported while building the preamble.
+  SmallVector<ASTUnit::StandaloneDiagnostic, 4> Diagnostics;
+
+  /// \brief The files included by the preamble, which have to be unchanged
+  /// for it to be used.
+  llvm::StringMap<ASTUnit::PreambleFileHash> FilesInPreamble;
+
+  /// \brief The number of warnings reported while building the preamble.
+  unsigned NumWarnings = 0;
+
+  /// \brief The hash of the top-level declarations and macros in the
+  /// preamble.
+  unsigned TopLevelHashValue = 0;
+};
+
+/// \brief Keeps precompiled preambles in memory, keyed by the text of the
+/// preamble and the options it was built with.
+///
+/// The store is thread-safe. Once the preambles it holds take more memory than
+/// its budget, the least recently used ones are dropped. A unit which uses a
+/// preamble that was dropped keeps it alive until it no longer needs it.
+class PrecompiledPreambleStore
+    : public llvm::ThreadSafeRefCountedBase<PrecompiledPreambleStore> {
+  struct Entry {
+    std::shared_ptr<const StoredPreamble> Preamble;
+    size_t Size;
+    std::list<StringRef>::iterator LRUPosition;
+  };
+
+  mutable std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+  /// The keys of the entries, most recently used first.
+  std::list<StringRef> LRU;
+  size_t MemoryBudget;
+  size_t MemoryUsage;
+
+  void evict();
+
+public:
+  /// \brief The memory budget of the store returned by getProcessStore.
+  static const size_t DefaultMemoryBudget = 256 << 20;
+
+  explicit PrecompiledPreambleStore(size_t MemoryBudget = DefaultMemoryBudget)
+      : MemoryBudget(MemoryBudget), MemoryUsage(0) {}
+
+  /// \brief Return the preamble stored under \p Key, or null if there is none.
+  std::shared_ptr<const StoredPreamble> lookup(StringRef Key);
+
+  /// \brief Store \p Preamble under \p Key and return it. If another preamble
+  /// was stored under the same key in the meantime, that one is kept and
+  /// returned instead, unless it is \p Stale, a preamble that the caller
+  /// found out of date because the files it includes changed.
+  std::shared_ptr<const StoredPreamble>
+  insert(StringRef Key, std::unique_ptr<StoredPreamble> Preamble,
+         const StoredPreamble *Stale = nullptr);
+
+  /// \brief Set the number of bytes the stored preambles may take, dropping
+  /// preambles as needed to fit.
+  void setMemoryBudget(size_t Budget);
+  size_t getMemoryBudget() const;
+
+  /// \brief Return the number of bytes taken by the stored preambles.
+  size_t getMemoryUsage() const;
+
+  /// \brief Drop all stored preambles.
+  void invalidate();
+
+  /// \brief Return the store shared by all ASTUnits in this process.
+  static IntrusiveRefCntPtr<PrecompiledPreambleStore> getProcessStore();
+};
+
+} // end namespace clang
+
+#endif
@@ -0,0 +1,49 @@
+//===- DependencyDirectivesSourceMinimizer.h - Minimize source --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares minimizeSourceToDependencyDirectives, which reduces a
+// source file to the preprocessor directives that can affect the set of files
+// it includes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+#define LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace clang {
+
+/// \brief Minimize the source in \p Input to the directives that can affect
+/// the files it includes, and write the result to \p Output.
+///
+/// Every directive that starts a line is kept verbatim, one per line, with
+/// the exception of \#line, \#ident, \#sccs, line markers, the null directive
+/// and pragmas that do not affect inclusion or the macro state. Objective-C
+/// \@import declarations are kept as well. Everything outside of the kept
+/// directives is dropped.
+///
+/// Preprocessing the minimized source yields the same set of included files
+/// as preprocessing \p Input, which makes it suitable for dependency scanning
+/// but not for anything that looks at the tokens of the file.
+///
+/// The source is lexed with a raw lexer that accepts the union of the C, C++
+/// and Objective-C lexical grammars, so the result does not depend on the
+/// language options of the translation unit it is used in.
+///
+/// \param Input The source to minimize. It must be null-terminated, as a
+/// MemoryBuffer is.
+void minimizeSourceToDependencyDirectives(StringRef Input,
+                                          SmallVectorImpl<char> &Output);
+
+} // end namespace clang
+
+#endif
@@ -15,6 +15,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include <cassert>
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
@@ -57,6 +58,11 @@ public:
   /// The implicit PCH included at the start of the translation unit, or empty.
   std::string ImplicitPCHInclude;
 
+  /// \brief If non-null, the contents of the implicit PCH, which is then
+  /// not read from \c ImplicitPCHInclude. The buffer may be shared with
+  /// other compilations.
+  std::shared_ptr<const llvm::MemoryBuffer> ImplicitPCHBuffer;
+
   /// \brief Headers that will be converted to chained PCHs in memory.
   std::vector<std::string> ChainedIncludes;
 
@@ -171,6 +177,7 @@ public:
     ChainedIncludes.clear();
     DumpDeserializedPCHDecls = false;
     ImplicitPCHInclude.clear();
+    ImplicitPCHBuffer.reset();
     ImplicitPTHInclude.clear();
     TokenCache.clear();
     RetainRemappedFileBuffers = true;
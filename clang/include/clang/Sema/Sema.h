@@ -194,6 +194,7 @@ namespace clang {
   class IndirectFieldDecl;
   struct DeductionFailureInfo;
   class TemplateSpecCandidateSet;
+  class TemplateInstantiationProfiler;
 
 namespace sema {
   class AccessedEntity;
@@ -7235,6 +7236,10 @@ public:
   /// variables.
   LocalInstantiationScope *CurrentInstantiationScope;
 
+  /// \brief Records the time and memory taken by each class and function
+  /// template instantiation, if instantiations are being profiled.
+  std::unique_ptr<TemplateInstantiationProfiler> InstantiationProfiler;
+
   /// \brief Tracks whether we are in a context where typo correction is
   /// disabled.
   bool DisableTypoCorrection;
@@ -0,0 +1,133 @@
+//===- TemplateInstantiationProfiler.h - Profile instantiations -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines TemplateInstantiationProfiler, which records how long the
+// instantiation of each template specialization takes and how much AST memory
+// it allocates.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SEMA_TEMPLATEINSTANTIATIONPROFILER_H
+#define LLVM_CLANG_SEMA_TEMPLATEINSTANTIATIONPROFILER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+class Decl;
+class NamedDecl;
+
+/// \brief Records the wall time, nesting depth and AST memory of each class
+/// and function template instantiation performed by Sema.
+///
+/// The times and memory of an instantiation include those of the
+/// instantiations it triggers; its "self" time and memory do not. The results
+/// can be written as a Chrome trace (viewable in chrome://tracing) or as a flat
+/// report aggregated per primary template.
+class TemplateInstantiationProfiler {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  enum InstantiationKind { IK_Class, IK_Function };
+
+  /// \brief A completed instantiation.
+  struct Instantiation {
+    /// \brief The fully qualified name of the specialization, with its
+    /// template arguments.
+    std::string Name;
+    InstantiationKind Kind;
+    /// \brief The index of the primary template in getTemplates().
+    unsigned Template;
+    /// \brief The number of enclosing instantiations.
+    unsigned Depth;
+    Clock::duration Start;
+    Clock::duration Time;
+    Clock::duration SelfTime;
+    size_t Memory;
+    size_t SelfMemory;
+  };
+
+  /// \brief The instantiations of one primary template.
+  struct TemplateSummary {
+    std::string Name;
+    unsigned Count = 0;
+    /// \brief The time spent instantiating the template, not counting
+    /// instantiations of it nested within others twice.
+    Clock::duration Time = Clock::duration::zero();
+    Clock::duration SelfTime = Clock::duration::zero();
+    size_t SelfMemory = 0;
+  };
+
+private:
+  struct ActiveInstantiation {
+    const NamedDecl *Specialization;
+    const Decl *Template;
+    InstantiationKind Kind;
+    Clock::time_point Start;
+    size_t StartMemory;
+    Clock::duration ChildTime;
+    size_t ChildMemory;
+  };
+
+  ASTContext &Context;
+  Clock::time_point Epoch;
+  std::vector<ActiveInstantiation> Stack;
+  std::vector<Instantiation> Instantiations;
+  std::vector<TemplateSummary> Templates;
+  llvm::DenseMap<const Decl *, unsigned> TemplateIndices;
+
+  void begin(const NamedDecl *Specialization, InstantiationKind Kind);
+  void end();
+
+public:
+  explicit TemplateInstantiationProfiler(ASTContext &Context);
+
+  /// \brief Profiles the instantiation of a definition while in scope.
+  class Scope {
+    TemplateInstantiationProfiler *Profiler;
+
+  public:
+    /// \brief Start profiling the instantiation of \p Specialization, unless
+    /// \p Profiler is null.
+    Scope(TemplateInstantiationProfiler *Profiler,
+          const NamedDecl *Specialization, InstantiationKind Kind)
+        : Profiler(Profiler) {
+      if (Profiler)
+        Profiler->begin(Specialization, Kind);
+    }
+    ~Scope() {
+      if (Profiler)
+        Profiler->end();
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+  /// \brief Return the completed instantiations, in the order they finished.
+  ArrayRef<Instantiation> getInstantiations() const { return Instantiations; }
+
+  /// \brief Return the primary templates which were instantiated.
+  ArrayRef<TemplateSummary> getTemplates() const { return Templates; }
+
+  /// \brief Write the instantiations in the Chrome trace event format.
+  void writeChromeTrace(raw_ostream &OS) const;
+
+  /// \brief Print the primary templates, those which took the most time
+  /// outside of nested instantiations first.
+  void printReport(raw_ostream &OS) const;
+};
+
+} // end namespace clang
+
+#endif
@@ -184,6 +184,10 @@ public:
   /// \brief The mode of function selection used during inlining.
   AnalysisInliningMode InliningMode;
 
+  /// \brief The number of threads analyzing the functions of a translation
+  /// unit, or 0 to use one per hardware thread.
+  unsigned AnalyzerThreads;
+
 private:
   /// \brief Describes the kinds for high-level analyzer mode.
   enum UserModeKind {
@@ -570,6 +574,7 @@ public:
     // Cap the stack depth at 4 calls (5 stack frames, base + 4 calls).
     InlineMaxStackDepth(5),
     InliningMode(NoRedundancy),
+    AnalyzerThreads(1),
     UserMode(UMK_NotSet),
     IPAMode(IPAK_NotSet),
     CXXMemberInliningMode() {}
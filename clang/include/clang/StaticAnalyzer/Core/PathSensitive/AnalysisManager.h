@@ -24,6 +24,8 @@
 namespace clang {
 
 class CodeInjector;
+class ObjCInterfaceDecl;
+class ObjCMethodDecl;
 
 namespace ento {
   class CheckerManager;
@@ -45,6 +47,13 @@ class AnalysisManager : public BugReporterData {
 
 public:
   AnalyzerOptions &options;
+
+  /// \brief The results of looking up the private instance methods of
+  /// Objective-C classes. ObjCMethodCall caches them because the same lookup,
+  /// which usually fails, is issued many times.
+  typedef std::pair<const ObjCInterfaceDecl *, Selector> PrivateMethodKey;
+  llvm::DenseMap<PrivateMethodKey, Optional<const ObjCMethodDecl *>>
+      PrivateMethodCache;
   
   AnalysisManager(ASTContext &ctx,DiagnosticsEngine &diags,
                   const LangOptions &lang,
@@ -22,7 +22,9 @@
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Tooling.h"
 #include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace clang {
 
@@ -45,14 +47,32 @@ public:
 
   /// \brief Returns the file path to replacements map to which replacements
   /// should be added during the run of the tool.
+  ///
+  /// Replacements added with addReplacement() are merged into the map first.
   std::map<std::string, Replacements> &getReplacements();
 
+  /// \brief Add a replacement found during the run of the tool.
+  ///
+  /// Unlike getReplacements(), this may be called by actions run by
+  /// runInParallel(). The replacements are merged into getReplacements()
+  /// sorted and without duplicates, so that the result, including which of
+  /// two conflicting replacements is dropped, does not depend on the order in
+  /// which files are processed.
+  void addReplacement(const Replacement &R);
+
   /// \brief Call run(), apply all generated replacements, and immediately save
   /// the results to disk.
   ///
   /// \returns 0 upon success. Non-zero upon failure.
   int runAndSave(FrontendActionFactory *ActionFactory);
 
+  /// \brief Like runAndSave(), but calls runInParallel(). Actions have to
+  /// report replacements with addReplacement().
+  ///
+  /// \returns 0 upon success. Non-zero upon failure.
+  int runAndSaveInParallel(FrontendActionFactory *ActionFactory,
+                           unsigned ThreadCount = 0);
+
   /// \brief Apply all stored replacements to the given Rewriter.
   ///
   /// FileToReplaces will be deduplicated with `groupReplacementsByFile` before
@@ -68,8 +88,18 @@ private:
   /// \brief Write all refactored files to disk.
   int saveRewrittenFiles(Rewriter &Rewrite);
 
+  /// \brief Apply all generated replacements and save the results to disk.
+  int applyAndSave();
+
+  /// \brief Move the replacements added with addReplacement() to
+  /// FileToReplaces.
+  void mergeAddedReplacements();
+
 private:
   std::map<std::string, Replacements> FileToReplaces;
+
+  std::mutex AddedReplacementsMutex;
+  std::vector<Replacement> AddedReplacements;
 };
 
 /// \brief Groups \p Replaces by the file path and applies each group of
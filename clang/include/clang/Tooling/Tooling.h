@@ -34,6 +34,7 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Driver/Util.h"
 #include "clang/Frontend/FrontendAction.h"
@@ -246,6 +247,10 @@ public:
     this->DiagConsumer = DiagConsumer;
   }
 
+  /// \brief Set the stream diagnostics are printed to if no
+  /// \c DiagnosticConsumer is set. Defaults to llvm::errs().
+  void setDiagnosticOutput(llvm::raw_ostream &OS) { DiagOS = &OS; }
+
   /// \brief Map a virtual file to be used while running the tool.
   ///
   /// \param FilePath The path at which the content will be mapped.
@@ -274,6 +279,7 @@ public:
   // Maps <file name> -> <file content>.
   llvm::StringMap<StringRef> MappedFileContents;
   DiagnosticConsumer *DiagConsumer;
+  llvm::raw_ostream *DiagOS;
 };
 
 /// \brief Utility to run a FrontendAction over a set of files.
@@ -320,11 +326,42 @@ class ClangTool {
   /// \brief Clear the command line arguments adjuster chain.
   void clearArgumentsAdjusters();
 
+  /// \brief Share 'stat' results and file contents between the translation
+  /// units processed by this tool, and with other tools using the same
+  /// caches.
+  ///
+  /// Headers, precompiled headers and module files are then read once
+  /// instead of once per translation unit. The caches must only be shared by
+  /// tools which see the same file system, and have to be invalidated if
+  /// files are modified while they are in use.
+  void setSharedFileCaches(IntrusiveRefCntPtr<SharedStatCache> Stats,
+                           IntrusiveRefCntPtr<FileContentCache> Contents);
+
   /// Runs an action over all files specified in the command line.
   ///
   /// \param Action Tool action.
   int run(ToolAction *Action);
 
+  /// Runs an action over all files specified in the command line, processing
+  /// several files at the same time.
+  ///
+  /// Each file is processed on a thread of an llvm::ThreadPool with its own
+  /// FileManager, which uses the caches set with setSharedFileCaches(). The
+  /// working directory of each compile command is passed with
+  /// -working-directory instead of changing the current directory, and all
+  /// compile commands are queried before the first file is processed.
+  ///
+  /// \p Action must be safe to call from several threads. The diagnostics of
+  /// each file are buffered and printed, or replayed to the DiagnosticConsumer
+  /// which is set, in the order of the source paths. Replayed diagnostics keep
+  /// their source locations, but the consumer's BeginSourceFile() is passed no
+  /// Preprocessor.
+  ///
+  /// \param Action Tool action.
+  /// \param ThreadCount The number of files to process at the same time, or
+  /// 0 to use the number of hardware threads.
+  int runInParallel(ToolAction *Action, unsigned ThreadCount = 0);
+
   /// \brief Create an AST for each file specified in the command line and
   /// append them to ASTs.
   int buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs);
@@ -342,6 +379,8 @@ class ClangTool {
   llvm::IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFileSystem;
   llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem;
   llvm::IntrusiveRefCntPtr<FileManager> Files;
+  llvm::IntrusiveRefCntPtr<SharedStatCache> SharedStats;
+  llvm::IntrusiveRefCntPtr<FileContentCache> SharedContents;
   // Contains a list of pairs (<file name>, <file content>).
   std::vector< std::pair<StringRef, StringRef> > MappedFileContents;
   llvm::StringSet<> SeenWorkingDirectories;
@@ -102,6 +102,23 @@ void FileManager::clearStatCaches() {
   StatCache.reset();
 }
 
+void FileManager::setSharedStatCache(
+    IntrusiveRefCntPtr<SharedStatCache> Cache) {
+  SharedStats = std::move(Cache);
+  if (SharedStats)
+    SharedStatsClient = SharedStats->createClient();
+  else
+    SharedStatsClient.reset();
+}
+
+void FileManager::invalidateSharedStat(StringRef Path) {
+  if (!SharedStats)
+    return;
+  SmallString<128> FilePath(Path);
+  FixupRelativePath(FilePath);
+  SharedStats->invalidate(FilePath);
+}
+
 /// \brief Retrieve the directory that the given file name resides in.
 /// Filename can point to either a real file or a virtual file.
 static const DirectoryEntry *getDirectoryFromFile(FileManager &FileMgr,
@@ -187,6 +204,11 @@ const DirectoryEntry *FileManager::getDirectory(StringRef DirName,
   // SeenDirEntries map.
   StringRef InterndDirName = NamedDirEnt.first();
 
+  // A caller which does not cache failures expects the directory to appear,
+  // so do not trust what other FileManagers found either.
+  if (!CacheFailure)
+    invalidateSharedStat(InterndDirName);
+
   // Check to see if the directory exists.
   FileData Data;
   if (getStatValue(InterndDirName, Data, false, nullptr /*directory lookup*/)) {
@@ -251,6 +273,11 @@ const FileEntry *FileManager::getFile(StringRef Filename, bool openFile,
   // FIXME: Use the directory info to prune this, before doing the stat syscall.
   // FIXME: This will reduce the # syscalls.
 
+  // A caller which does not cache failures expects the file to appear or
+  // change, so do not trust what other FileManagers found either.
+  if (!CacheFailure)
+    invalidateSharedStat(InterndFileName);
+
   // Nope, there isn't.  Check to see if the file exists.
   std::unique_ptr<vfs::File> F;
   FileData Data;
@@ -417,6 +444,28 @@ bool FileManager::makeAbsolutePath(SmallVectorImpl<char> &Path) const {
 llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
 FileManager::getBufferForFile(const FileEntry *Entry, bool isVolatile,
                               bool ShouldCloseOpenFile) {
+  // Volatile files may change while we are using them, and virtual files
+  // may not be backed by a file on disk, so they are never shared.
+  if (!SharedContents || isVolatile ||
+      Entry->getUniqueID() == llvm::sys::fs::UniqueID(0, 0))
+    return readBufferForFile(Entry, isVolatile, ShouldCloseOpenFile);
+
+  if (std::unique_ptr<llvm::MemoryBuffer> Buffer =
+          SharedContents->lookup(Entry)) {
+    if (ShouldCloseOpenFile)
+      Entry->closeFile();
+    return std::move(Buffer);
+  }
+
+  auto Result = readBufferForFile(Entry, isVolatile, ShouldCloseOpenFile);
+  if (!Result)
+    return Result;
+  return SharedContents->insert(Entry, std::move(*Result));
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+FileManager::readBufferForFile(const FileEntry *Entry, bool isVolatile,
+                               bool ShouldCloseOpenFile) {
   uint64_t FileSize = Entry->getSize();
   // If there's a high enough chance that the file have changed since we
   // got its size, force a stat before opening it.
@@ -467,14 +516,16 @@ bool FileManager::getStatValue(StringRef Path, FileData &Data, bool isFile,
                                std::unique_ptr<vfs::File> *F) {
   // FIXME: FileSystemOpts shouldn't be passed in here, all paths should be
   // absolute!
+  FileSystemStatCache *Cache =
+      StatCache ? StatCache.get() : SharedStatsClient.get();
   if (FileSystemOpts.WorkingDir.empty())
-    return FileSystemStatCache::get(Path, Data, isFile, F,StatCache.get(), *FS);
+    return FileSystemStatCache::get(Path, Data, isFile, F, Cache, *FS);
 
   SmallString<128> FilePath(Path);
   FixupRelativePath(FilePath);
 
-  return FileSystemStatCache::get(FilePath.c_str(), Data, isFile, F,
-                                  StatCache.get(), *FS);
+  return FileSystemStatCache::get(FilePath.c_str(), Data, isFile, F, Cache,
+                                  *FS);
 }
 
 bool FileManager::getNoncachedStatValue(StringRef Path,
@@ -493,6 +544,7 @@ void FileManager::invalidateCache(const FileEntry *Entry) {
   assert(Entry && "Cannot invalidate a NULL FileEntry");
 
   SeenFileEntries.erase(Entry->getName());
+  invalidateSharedStat(Entry->getName());
 
   // FileEntry invalidation should not block future optimizations in the file
   // caches. Possible alternatives are cache truncation (invalidate last N) or
@@ -555,6 +607,58 @@ StringRef FileManager::getCanonicalName(const DirectoryEntry *Dir) {
   return CanonicalName;
 }
 
+namespace {
+/// A buffer which refers to the contents of a file in a FileContentCache.
+/// It keeps the contents alive if the cache is invalidated.
+class SharedMemoryBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+
+public:
+  explicit SharedMemoryBuffer(std::shared_ptr<llvm::MemoryBuffer> Contents)
+      : Contents(std::move(Contents)) {
+    init(this->Contents->getBufferStart(), this->Contents->getBufferEnd(),
+         /*RequiresNullTerminator=*/true);
+  }
+
+  StringRef getBufferIdentifier() const override {
+    return Contents->getBufferIdentifier();
+  }
+
+  BufferKind getBufferKind() const override {
+    return Contents->getBufferKind();
+  }
+};
+} // end anonymous namespace
+
+std::unique_ptr<llvm::MemoryBuffer>
+FileContentCache::lookup(const FileEntry *File) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = Entries.find(File->getUniqueID());
+  if (I == Entries.end() || I->second.Size != File->getSize() ||
+      I->second.ModTime != File->getModificationTime())
+    return nullptr;
+  return llvm::make_unique<SharedMemoryBuffer>(I->second.Buffer);
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+FileContentCache::insert(const FileEntry *File,
+                         std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entry &E = Entries[File->getUniqueID()];
+  if (!E.Buffer || E.Size != File->getSize() ||
+      E.ModTime != File->getModificationTime()) {
+    E.Size = File->getSize();
+    E.ModTime = File->getModificationTime();
+    E.Buffer = std::move(Buffer);
+  }
+  return llvm::make_unique<SharedMemoryBuffer>(E.Buffer);
+}
+
+void FileContentCache::invalidate() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries.clear();
+}
+
 void FileManager::PrintStats() const {
   llvm::errs() << "\n*** File Manager Stats:\n";
   llvm::errs() << UniqueRealFiles.size() << " real files found, "
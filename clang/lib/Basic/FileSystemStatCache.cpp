@@ -124,3 +124,59 @@ MemorizeStatCalls::getStat(StringRef Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+namespace {
+/// The FileSystemStatCache installed in each FileManager which shares a
+/// SharedStatCache.
+class SharedStatCacheClient : public FileSystemStatCache {
+  IntrusiveRefCntPtr<SharedStatCache> Shared;
+
+public:
+  explicit SharedStatCacheClient(IntrusiveRefCntPtr<SharedStatCache> Shared)
+      : Shared(std::move(Shared)) {}
+
+  LookupResult getStat(StringRef Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override {
+    // Relative paths depend on the working directory of the file system.
+    bool IsAbsolute = llvm::sys::path::is_absolute(Path);
+    if (IsAbsolute && Shared->lookup(Path, Data))
+      return CacheExists;
+
+    LookupResult Result = statChained(Path, Data, isFile, F, FS);
+    // Do not cache failed stats, as MemorizeStatCalls does not: another
+    // compilation may create the file.
+    if (IsAbsolute && Result == CacheExists)
+      Shared->insert(Path, Data);
+    return Result;
+  }
+};
+} // end anonymous namespace
+
+bool SharedStatCache::lookup(StringRef Path, FileData &Data) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = Entries.find(Path);
+  if (I == Entries.end())
+    return false;
+  Data = I->second;
+  return true;
+}
+
+void SharedStatCache::insert(StringRef Path, const FileData &Data) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries[Path] = Data;
+}
+
+void SharedStatCache::invalidate(StringRef Path) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries.erase(Path);
+}
+
+void SharedStatCache::invalidate() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries.clear();
+}
+
+std::unique_ptr<FileSystemStatCache> SharedStatCache::createClient() {
+  return llvm::make_unique<SharedStatCacheClient>(this);
+}
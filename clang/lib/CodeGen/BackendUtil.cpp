@@ -24,6 +24,7 @@
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/SchedulerRegistry.h"
 #include "llvm/IR/DataLayout.h"
@@ -36,6 +37,7 @@
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
+#include "llvm/Object/ModuleSummaryIndexTable.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -54,6 +56,7 @@
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
 #include <memory>
 using namespace clang;
@@ -102,6 +105,17 @@ private:
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS);
 
+  /// Whether code should be generated for several partitions of the module in
+  /// parallel, see CodeGenOptions::ParallelCodeGenOutputs.
+  bool shouldSplitCodeGen(BackendAction Action) const {
+    return Action == Backend_EmitObj &&
+           !CodeGenOpts.ParallelCodeGenOutputs.empty();
+  }
+
+  /// Split the module and generate an object file for each partition in
+  /// parallel, writing the first to OS.
+  void EmitObjectsInParallel(raw_pwrite_stream &OS);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags,
                      const HeaderSearchOptions &HeaderSearchOpts,
@@ -119,6 +133,9 @@ public:
 
   std::unique_ptr<TargetMachine> TM;
 
+  /// Creates a TargetMachine like TM, for code generation on other threads.
+  std::function<std::unique_ptr<TargetMachine>()> TMFactory;
+
   void EmitAssembly(BackendAction Action,
                     std::unique_ptr<raw_pwrite_stream> OS);
 
@@ -611,8 +628,12 @@ void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
       Options.MCOptions.IASSearchPaths.push_back(
           Entry.IgnoreSysRoot ? Entry.Path : HSOpts.Sysroot + Entry.Path);
 
-  TM.reset(TheTarget->createTargetMachine(Triple, TargetOpts.CPU, FeaturesStr,
-                                          Options, RM, CM, OptLevel));
+  std::string CPU = TargetOpts.CPU;
+  TMFactory = [=]() {
+    return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+        Triple, CPU, FeaturesStr, Options, RM, CM, OptLevel));
+  };
+  TM = TMFactory();
 }
 
 bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
@@ -649,6 +670,93 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   return true;
 }
 
+void EmitAssemblyHelper::EmitObjectsInParallel(raw_pwrite_stream &OS) {
+  // splitCodeGen only adds the code generator's passes, so run the ObjC ARC
+  // final-cleanup that AddEmitPasses would add on the whole module first.
+  if (CodeGenOpts.OptimizationLevel > 0) {
+    legacy::PassManager ContractPasses;
+    ContractPasses.add(createObjCARCContractPass());
+    ContractPasses.run(*TheModule);
+  }
+
+  std::vector<std::unique_ptr<raw_fd_ostream>> Outputs;
+  SmallVector<raw_pwrite_stream *, 8> OSs;
+  OSs.push_back(&OS);
+  for (const std::string &Path : CodeGenOpts.ParallelCodeGenOutputs) {
+    std::error_code EC;
+    Outputs.push_back(
+        llvm::make_unique<raw_fd_ostream>(Path, EC, llvm::sys::fs::F_None));
+    if (EC) {
+      Diags.Report(diag::err_fe_unable_to_open_output) << Path << EC.message();
+      return;
+    }
+    OSs.push_back(Outputs.back().get());
+  }
+
+  // With -fembed-bitcode, the bitcode and command line sections would end up
+  // in whichever partition SplitModule picks for them. Take them out of the
+  // module and add them back to the first partition, which is also the only
+  // one to keep the module-level inline asm.
+  struct EmbeddedData {
+    std::string Name;
+    std::string Section;
+    std::string Data;
+  };
+  std::vector<EmbeddedData> Embedded;
+  for (StringRef Name : {"llvm.embedded.module", "llvm.cmdline"}) {
+    GlobalVariable *GV = TheModule->getGlobalVariable(Name, true);
+    if (!GV)
+      continue;
+    // The marker embedded with -fembed-bitcode=marker is an empty array.
+    StringRef Data;
+    if (auto *Init = dyn_cast<ConstantDataSequential>(GV->getInitializer()))
+      Data = Init->getRawDataValues();
+    Embedded.push_back({Name, GV->getSection(), Data});
+  }
+  if (!Embedded.empty()) {
+    GlobalVariable *Used = TheModule->getGlobalVariable("llvm.compiler.used");
+    SmallVector<GlobalValue *, 4> UsedGlobals;
+    for (Value *Op : cast<ConstantArray>(Used->getInitializer())->operands()) {
+      auto *GV = cast<GlobalValue>(Op->stripPointerCasts());
+      if (GV->getName() != "llvm.embedded.module" &&
+          GV->getName() != "llvm.cmdline")
+        UsedGlobals.push_back(GV);
+    }
+    Used->eraseFromParent();
+    for (const EmbeddedData &E : Embedded)
+      TheModule->getGlobalVariable(E.Name, true)->eraseFromParent();
+    if (!UsedGlobals.empty())
+      appendToCompilerUsed(*TheModule, UsedGlobals);
+  }
+
+  // splitCodeGen forwards the diagnostics of the partitions to the handlers
+  // of the module's context, which report to Diags.
+  auto PreparePartition = [&](unsigned Index, Module &MPart) {
+    if (Index != 0 || Embedded.empty())
+      return;
+    SmallVector<GlobalValue *, 2> EmbeddedGlobals;
+    for (const EmbeddedData &E : Embedded) {
+      Constant *Data = ConstantDataArray::get(
+          MPart.getContext(),
+          makeArrayRef((const uint8_t *)E.Data.data(), E.Data.size()));
+      auto *GV = new GlobalVariable(MPart, Data->getType(), true,
+                                    GlobalValue::PrivateLinkage, Data, E.Name);
+      GV->setSection(E.Section);
+      EmbeddedGlobals.push_back(GV);
+    }
+    appendToCompilerUsed(MPart, EmbeddedGlobals);
+  };
+
+  // Keep local symbols local. Splitting would otherwise turn them into hidden
+  // globals, which could clash with those of other object files once the
+  // partitions are linked together; SplitModule keeps each local symbol in
+  // the same partition as its users.
+  PrettyStackTraceString CrashInfo("Code generation");
+  splitCodeGen(*TheModule, OSs, {}, TMFactory, TargetMachine::CGFT_ObjectFile,
+               /*PreserveLocals=*/true, /*OptimizePartition=*/nullptr,
+               PreparePartition);
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       std::unique_ptr<raw_pwrite_stream> OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -697,6 +805,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
+    if (shouldSplitCodeGen(Action))
+      break;
     if (!AddEmitPasses(CodeGenPasses, Action, *OS))
       return;
   }
@@ -722,6 +832,11 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     PerModulePasses.run(*TheModule);
   }
 
+  if (shouldSplitCodeGen(Action)) {
+    EmitObjectsInParallel(*OS);
+    return;
+  }
+
   {
     PrettyStackTraceString CrashInfo("Code generation");
     CodeGenPasses.run(*TheModule);
@@ -834,6 +949,8 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
   case Backend_EmitAssembly:
   case Backend_EmitMCNull:
   case Backend_EmitObj:
+    if (shouldSplitCodeGen(Action))
+      break;
     NeedCodeGen = true;
     CodeGenPasses.add(
         createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
@@ -852,6 +969,9 @@ void EmitAssemblyHelper::EmitAssemblyWithNewPassManager(
     MPM.run(*TheModule, MAM);
   }
 
+  if (shouldSplitCodeGen(Action))
+    EmitObjectsInParallel(*OS);
+
   // Now if needed, run the legacy PM for codegen.
   if (NeedCodeGen) {
     PrettyStackTraceString CrashInfo("Code generation");
@@ -952,7 +1072,8 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
     // into memory and pass it into runThinLTOBackend, which will run the
     // function importer and invoke LTO passes.
     Expected<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
-        llvm::getModuleSummaryIndexForFile(CGOpts.ThinLTOIndexFile);
+        llvm::getModuleSummaryIndexForModule(CGOpts.ThinLTOIndexFile,
+                                             M->getModuleIdentifier());
     if (!IndexOrErr) {
       logAllUnhandledErrors(IndexOrErr.takeError(), errs(),
                             "Error loading index file '" +
@@ -14,9 +14,16 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
 
 using namespace clang::driver;
 using namespace clang;
@@ -121,35 +128,43 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
-      std::error_code EC;
-      OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
-                                    llvm::sys::fs::F_Append |
-                                        llvm::sys::fs::F_Text);
-      if (EC) {
-        getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        delete OS;
-        return 1;
-      }
+bool Compilation::PrintCommand(const Command &C) const {
+  if ((!getDriver().CCPrintOptions && !getArgs().hasArg(options::OPT_v)) ||
+      getDriver().CCGenDiagnostics)
+    return true;
+
+  raw_ostream *OS = &llvm::errs();
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
+    std::error_code EC;
+    OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
+                                  llvm::sys::fs::F_Append |
+                                      llvm::sys::fs::F_Text);
+    if (EC) {
+      getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
+          << EC.message();
+      delete OS;
+      return false;
     }
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]";
+  if (getDriver().CCPrintOptions)
+    *OS << "[Logging clang options]";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
 
-    if (OS != &llvm::errs())
-      delete OS;
+  if (OS != &llvm::errs())
+    delete OS;
+  return true;
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommand(C)) {
+    FailingCommand = &C;
+    return 1;
   }
 
   std::string Error;
@@ -166,9 +181,36 @@ int Compilation::ExecuteCommand(const Command &C,
   return ExecutionFailed ? 1 : Res;
 }
 
+unsigned Compilation::getNumParallelJobs() const {
+  const Arg *A = getArgs().getLastArg(options::OPT_j);
+  if (!A)
+    return 1;
+
+  // The value has been checked by the driver.
+  unsigned NumJobs;
+  if (StringRef(A->getValue()).getAsInteger(10, NumJobs) || NumJobs == 0)
+    return 1;
+
+#if LLVM_ENABLE_THREADS
+  // Jobs that redirect their output or that may fall back to another
+  // compiler report through shared state, so run them one at a time.
+  if (Redirects || getArgs().hasArg(options::OPT__SLASH_fallback))
+    return 1;
+  return NumJobs;
+#else
+  return 1;
+#endif
+}
+
 void Compilation::ExecuteJobs(
     const JobList &Jobs,
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  unsigned NumJobs = getNumParallelJobs();
+  if (NumJobs > 1 && Jobs.size() > 1) {
+    ExecuteJobsInParallel(Jobs, NumJobs, FailingCommands);
+    return;
+  }
+
   for (const auto &Job : Jobs) {
     const Command *FailingCommand = nullptr;
     if (int Res = ExecuteCommand(Job, FailingCommand)) {
@@ -180,6 +222,204 @@ void Compilation::ExecuteJobs(
   }
 }
 
+namespace {
+/// The state of a job run by ExecuteJobsInParallel.
+struct ParallelJob {
+  const Command *Cmd = nullptr;
+
+  /// Jobs which read a file written by this job.
+  SmallVector<size_t, 4> Users;
+
+  /// The number of jobs which have to finish before this one can start.
+  unsigned NumPendingDeps = 0;
+
+  bool Started = false;
+  bool Finished = false;
+
+  /// The results of Command::Execute.
+  int Res = 0;
+  bool ExecutionFailed = false;
+  std::string Error;
+
+  /// Temporary files which hold the stdout and stderr of the job until it
+  /// is its turn to print them.
+  SmallString<128> StdoutPath;
+  SmallString<128> StderrPath;
+  StringRef StdoutRef;
+  StringRef StderrRef;
+  const StringRef *Redirects[3] = {nullptr, nullptr, nullptr};
+};
+} // end anonymous namespace
+
+/// Returns true if \p Producer writes \p File. Commands do not record their
+/// outputs, so any argument which names the file and which is not an input
+/// counts as one. Arguments are matched by suffix to catch joined forms such
+/// as "/Fofoo.obj".
+static bool writesFile(const Command &Producer, StringRef File) {
+  const ArgStringList &Inputs = Producer.getInputFilenames();
+  for (const char *Arg : Producer.getArguments()) {
+    if (!StringRef(Arg).endswith(File))
+      continue;
+    if (std::find_if(Inputs.begin(), Inputs.end(), [&](const char *In) {
+          return File == In;
+        }) == Inputs.end())
+      return true;
+  }
+  return false;
+}
+
+/// Copies the contents of \p Path to \p OS and removes the file.
+static void replayOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (auto MBOrErr = llvm::MemoryBuffer::getFile(Path))
+    OS << (*MBOrErr)->getBuffer();
+  OS.flush();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, unsigned NumJobs,
+    SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  // Build the dependency graph. A job depends on every earlier job which
+  // writes one of its input files.
+  std::vector<ParallelJob> State(Jobs.size());
+  size_t I = 0;
+  for (const Command &Job : Jobs)
+    State[I++].Cmd = &Job;
+
+  for (size_t User = 0, E = State.size(); User != E; ++User) {
+    for (const char *In : State[User].Cmd->getInputFilenames()) {
+      for (size_t Dep = 0; Dep != User; ++Dep) {
+        if (!writesFile(*State[Dep].Cmd, In))
+          continue;
+        if (!llvm::is_contained(State[Dep].Users, User)) {
+          State[Dep].Users.push_back(User);
+          ++State[User].NumPendingDeps;
+        }
+      }
+    }
+  }
+
+  // Ready jobs are started lowest index first, so that the job whose output
+  // is printed next is never waiting behind a later one.
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> Ready;
+  for (size_t I = 0, E = State.size(); I != E; ++I)
+    if (State[I].NumPendingDeps == 0)
+      Ready.push(I);
+
+  std::mutex Mu;
+  std::condition_variable Cond;
+  std::vector<size_t> Done;
+  llvm::ThreadPool Pool(NumJobs);
+
+  // The index of the first failing job. A serial run would not have started
+  // any job after it, so those are not started, and the output of the ones
+  // already running is discarded.
+  size_t FirstFailure = State.size();
+  size_t NextToPrint = 0;
+  unsigned NumRunning = 0;
+
+  auto Start = [&](size_t I) {
+    ParallelJob &J = State[I];
+    J.Started = true;
+
+    // Capture stdout and stderr so that they can be printed in job order.
+    // If a temporary file cannot be created, the stream is inherited.
+    if (!llvm::sys::fs::createTemporaryFile("clang-job", "out", J.StdoutPath)) {
+      J.StdoutRef = J.StdoutPath;
+      J.Redirects[1] = &J.StdoutRef;
+    } else {
+      J.StdoutPath.clear();
+    }
+    if (!llvm::sys::fs::createTemporaryFile("clang-job", "err", J.StderrPath)) {
+      J.StderrRef = J.StderrPath;
+      J.Redirects[2] = &J.StderrRef;
+    } else {
+      J.StderrPath.clear();
+    }
+
+    ++NumRunning;
+    Pool.async([&, I] {
+      ParallelJob &J = State[I];
+      J.Res = J.Cmd->Execute(J.Redirects, &J.Error, &J.ExecutionFailed);
+      std::lock_guard<std::mutex> Lock(Mu);
+      Done.push_back(I);
+      Cond.notify_one();
+    });
+  };
+
+  auto Print = [&](size_t I) {
+    ParallelJob &J = State[I];
+    if (!PrintCommand(*J.Cmd)) {
+      J.Res = 1;
+      J.ExecutionFailed = true;
+    }
+    replayOutput(J.StdoutPath, llvm::outs());
+    replayOutput(J.StderrPath, llvm::errs());
+    if (!J.Error.empty()) {
+      assert(J.Res && "Error string set with 0 result code!");
+      getDriver().Diag(clang::diag::err_drv_command_failure) << J.Error;
+    }
+  };
+
+  for (;;) {
+    while (NumRunning < NumJobs && !Ready.empty() &&
+           Ready.top() < FirstFailure) {
+      Start(Ready.top());
+      Ready.pop();
+    }
+    if (NumRunning == 0)
+      break;
+
+    std::vector<size_t> Finished;
+    {
+      std::unique_lock<std::mutex> Lock(Mu);
+      Cond.wait(Lock, [&] { return !Done.empty(); });
+      Finished.swap(Done);
+    }
+
+    for (size_t I : Finished) {
+      ParallelJob &J = State[I];
+      J.Finished = true;
+      --NumRunning;
+      if (J.Res) {
+        FirstFailure = std::min(FirstFailure, I);
+        continue;
+      }
+      for (size_t User : J.Users)
+        if (--State[User].NumPendingDeps == 0)
+          Ready.push(User);
+    }
+
+    // Print the output of the finished prefix of the job list.
+    while (NextToPrint < State.size() && NextToPrint <= FirstFailure &&
+           State[NextToPrint].Finished) {
+      Print(NextToPrint);
+      if (State[NextToPrint].Res)
+        FirstFailure = std::min(FirstFailure, NextToPrint);
+      ++NextToPrint;
+    }
+  }
+  Pool.wait();
+
+  // Discard the output of jobs which ran past the first failure.
+  for (size_t I = NextToPrint, E = State.size(); I != E; ++I) {
+    if (!State[I].Started)
+      continue;
+    if (!State[I].StdoutPath.empty())
+      llvm::sys::fs::remove(State[I].StdoutPath);
+    if (!State[I].StderrPath.empty())
+      llvm::sys::fs::remove(State[I].StderrPath);
+  }
+
+  if (FirstFailure != State.size()) {
+    const ParallelJob &J = State[FirstFailure];
+    FailingCommands.push_back(
+        std::make_pair(J.ExecutionFailed ? 1 : J.Res, J.Cmd));
+  }
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
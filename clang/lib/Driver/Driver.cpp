@@ -578,6 +578,15 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // Ignore -pipe.
   Args.ClaimAllArgs(options::OPT_pipe);
 
+  // -j is used when the jobs are executed.
+  if (Arg *A = Args.getLastArg(options::OPT_j)) {
+    unsigned NumJobs;
+    if (StringRef(A->getValue()).getAsInteger(10, NumJobs) || NumJobs == 0)
+      Diag(clang::diag::err_drv_invalid_int_value)
+          << A->getAsString(Args) << A->getValue();
+  }
+  Args.ClaimAllArgs(options::OPT_j);
+
   // Extract -ccc args.
   //
   // FIXME: We need to figure out where this behavior should live. Most of it
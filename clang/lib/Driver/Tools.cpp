@@ -513,6 +513,13 @@ void Clang::AddPreprocessingOptions(Compilation &C, const JobAction &JA,
          !Args.hasArg(options::OPT_fno_module_file_deps)) ||
         Args.hasArg(options::OPT_fmodule_file_deps))
       CmdArgs.push_back("-module-file-deps");
+
+    // Only a pure dependency scan can be run on minimized sources; -MD and
+    // -MMD need the real sources for the compilation they are part of.
+    if (Output.getType() == types::TY_Dependencies &&
+        Args.hasFlag(options::OPT_fminimize_dependency_scan,
+                     options::OPT_fno_minimize_dependency_scan, false))
+      CmdArgs.push_back("-minimize-dependency-sources");
   }
 
   if (Args.hasArg(options::OPT_MG)) {
@@ -3594,6 +3601,78 @@ static void SplitDebugInfo(const ToolChain &TC, Compilation &C, const Tool &T,
   C.addCommand(llvm::make_unique<Command>(JA, T, Exec, StripArgs, II));
 }
 
+static const char *getLDMOption(const llvm::Triple &T, const ArgList &Args);
+
+/// \brief Return the temporary object files the backend should generate code
+/// for the partitions of the module into for -fparallel-codegen=N, or none if
+/// code should be generated into the output as usual.
+static SmallVector<const char *, 8>
+getCodeGenPartitions(Compilation &C, const ToolChain &TC, const JobAction &JA,
+                     const ArgList &Args, const InputInfo &Output,
+                     bool SplitDwarf) {
+  SmallVector<const char *, 8> Partitions;
+  Arg *A = Args.getLastArg(options::OPT_fparallel_codegen_EQ);
+  if (!A)
+    return Partitions;
+
+  const Driver &D = TC.getDriver();
+  unsigned N;
+  if (StringRef(A->getValue()).getAsInteger(10, N) || N == 0) {
+    D.Diag(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                            << A->getValue();
+    return Partitions;
+  }
+
+  // The partitions are linked back together with ld -r, so only objects
+  // written to a file by the integrated assembler can be split. Split DWARF
+  // extracts the .dwo from the output, and LTO defers code generation to link
+  // time, so neither is combined with it.
+  const llvm::Triple &Triple = TC.getTriple();
+  if (N == 1 || Output.getType() != types::TY_Object || !Output.isFilename() ||
+      StringRef(Output.getFilename()) == "-" ||
+      !(isa<CompileJobAction>(JA) || isa<BackendJobAction>(JA)) ||
+      SplitDwarf || D.isUsingLTO() ||
+      !(Triple.isOSBinFormatELF() || Triple.isOSBinFormatMachO()) ||
+      (Triple.isOSBinFormatELF() && !getLDMOption(Triple, Args)))
+    return Partitions;
+
+  StringRef Stem = llvm::sys::path::stem(Output.getFilename());
+  for (unsigned I = 0; I != N; ++I)
+    Partitions.push_back(C.addTempFile(Args.MakeArgString(D.GetTemporaryPath(
+        Stem, types::getTypeTempSuffix(types::TY_Object)))));
+  return Partitions;
+}
+
+/// \brief Link the objects generated for the partitions of the module into
+/// the output with a relocatable link.
+static void LinkCodeGenPartitions(const ToolChain &TC, Compilation &C,
+                                  const Tool &T, const JobAction &JA,
+                                  const ArgList &Args, const InputInfo &Output,
+                                  ArrayRef<const char *> Partitions) {
+  ArgStringList LinkArgs;
+  const llvm::Triple &Triple = TC.getTriple();
+  if (Triple.isOSBinFormatMachO()) {
+    LinkArgs.push_back("-arch");
+    LinkArgs.push_back(Args.MakeArgString(
+        static_cast<const toolchains::MachO &>(TC).getMachOArchName(Args)));
+  } else {
+    LinkArgs.push_back("-m");
+    LinkArgs.push_back(getLDMOption(Triple, Args));
+  }
+  LinkArgs.push_back("-r");
+  LinkArgs.push_back("-o");
+  LinkArgs.push_back(Output.getFilename());
+
+  InputInfoList LinkInputs;
+  for (const char *Partition : Partitions) {
+    LinkArgs.push_back(Partition);
+    LinkInputs.push_back(InputInfo(types::TY_Object, Partition, Partition));
+  }
+
+  const char *Exec = Args.MakeArgString(TC.GetLinkerPath());
+  C.addCommand(llvm::make_unique<Command>(JA, T, Exec, LinkArgs, LinkInputs));
+}
+
 /// \brief Vectorize at all optimization levels greater than 1 except for -Oz.
 /// For -Oz the loop vectorizer is disable, while the slp vectorizer is enabled.
 static bool shouldEnableVectorizerAtOLevel(const ArgList &Args, bool isSlpVec) {
@@ -5496,6 +5575,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftemplate_profile_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftemplate_profile_report);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -6523,8 +6604,21 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       isa<CompileJobAction>(JA))
     CmdArgs.push_back("-disable-llvm-passes");
 
+  // With -fparallel-codegen=N, the first partition of the module is written
+  // to -o and the others to -parallel-codegen-output, and all of them are
+  // linked into the output afterwards.
+  SmallVector<const char *, 8> CodeGenPartitions =
+      getCodeGenPartitions(C, getToolChain(), JA, Args, Output, SplitDwarfArg);
+
   if (Output.getType() == types::TY_Dependencies) {
     // Handled with other dependency code.
+  } else if (!CodeGenPartitions.empty()) {
+    CmdArgs.push_back("-o");
+    CmdArgs.push_back(CodeGenPartitions[0]);
+    for (const char *Partition : makeArrayRef(CodeGenPartitions).slice(1)) {
+      CmdArgs.push_back("-parallel-codegen-output");
+      CmdArgs.push_back(Partition);
+    }
   } else if (Output.isFilename()) {
     CmdArgs.push_back("-o");
     CmdArgs.push_back(Output.getFilename());
@@ -6641,6 +6735,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
 
+  if (!CodeGenPartitions.empty())
+    LinkCodeGenPartitions(getToolChain(), C, *this, JA, Args, Output,
+                          CodeGenPartitions);
+
   // Handle the debug info splitting at object creation time if we're
   // creating an object.
   // TODO: Currently only works on linux with newer objcopy.
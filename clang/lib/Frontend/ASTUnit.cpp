@@ -26,6 +26,7 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendOptions.h"
 #include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/Frontend/PrecompiledPreambleStore.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
@@ -41,6 +42,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <atomic>
@@ -220,6 +222,7 @@ ASTUnit::ASTUnit(bool _MainFileIsAST)
     NumStoredDiagnosticsFromDriver(0),
     PreambleRebuildCounter(0),
     NumWarningsInPreamble(0),
+    PreambleStore(PrecompiledPreambleStore::getProcessStore()),
     ShouldCacheCodeCompletionResults(false),
     IncludeBriefCommentsInCodeCompletion(false), UserFilesAreVolatile(false),
     CompletionCacheTopLevelHashValue(0),
@@ -900,15 +903,27 @@ public:
 class PrecompilePreambleAction : public ASTFrontendAction {
   ASTUnit &Unit;
   bool HasEmittedPreamblePCH;
+  bool EmitInMemory;
+  std::unique_ptr<llvm::MemoryBuffer> PreamblePCH;
 
 public:
-  explicit PrecompilePreambleAction(ASTUnit &Unit)
-      : Unit(Unit), HasEmittedPreamblePCH(false) {}
+  PrecompilePreambleAction(ASTUnit &Unit, bool EmitInMemory)
+      : Unit(Unit), HasEmittedPreamblePCH(false), EmitInMemory(EmitInMemory) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override;
   bool hasEmittedPreamblePCH() const { return HasEmittedPreamblePCH; }
   void setHasEmittedPreamblePCH() { HasEmittedPreamblePCH = true; }
+
+  /// \brief Retrieve the PCH, when it is emitted into memory rather than
+  /// into the output file.
+  std::unique_ptr<llvm::MemoryBuffer> takePreamblePCH() {
+    return std::move(PreamblePCH);
+  }
+  void setPreamblePCH(std::unique_ptr<llvm::MemoryBuffer> PCH) {
+    PreamblePCH = std::move(PCH);
+  }
+
   bool shouldEraseOutputFiles() override { return !hasEmittedPreamblePCH(); }
 
   bool hasCodeCompletionSupport() const override { return false; }
@@ -952,10 +967,15 @@ public:
   void HandleTranslationUnit(ASTContext &Ctx) override {
     PCHGenerator::HandleTranslationUnit(Ctx);
     if (hasEmittedPCH()) {
-      // Write the generated bitstream to "Out".
-      *Out << getPCH();
-      // Make sure it hits disk now.
-      Out->flush();
+      if (Out) {
+        // Write the generated bitstream to "Out".
+        *Out << getPCH();
+        // Make sure it hits disk now.
+        Out->flush();
+      } else {
+        Action->setPreamblePCH(llvm::MemoryBuffer::getMemBufferCopy(
+            StringRef(getPCH().data(), getPCH().size()), "<preamble>"));
+      }
       // Free the buffer.
       llvm::SmallVector<char, 0> Empty;
       getPCH() = std::move(Empty);
@@ -982,12 +1002,16 @@ std::unique_ptr<ASTConsumer>
 PrecompilePreambleAction::CreateASTConsumer(CompilerInstance &CI,
                                             StringRef InFile) {
   std::string Sysroot;
-  std::string OutputFile;
-  std::unique_ptr<raw_ostream> OS =
-      GeneratePCHAction::ComputeASTConsumerArguments(CI, InFile, Sysroot,
-                                                     OutputFile);
-  if (!OS)
-    return nullptr;
+  std::unique_ptr<raw_ostream> OS;
+  if (EmitInMemory) {
+    Sysroot = CI.getHeaderSearchOpts().Sysroot;
+  } else {
+    std::string OutputFile;
+    OS = GeneratePCHAction::ComputeASTConsumerArguments(CI, InFile, Sysroot,
+                                                        OutputFile);
+    if (!OS)
+      return nullptr;
+  }
 
   if (!CI.getFrontendOpts().RelocatablePCH)
     Sysroot.clear();
@@ -1110,11 +1134,7 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   if (OverrideMainBuffer) {
     PreprocessorOpts.addRemappedFile(OriginalSourceFile,
                                      OverrideMainBuffer.get());
-    PreprocessorOpts.PrecompiledPreambleBytes.first = Preamble.size();
-    PreprocessorOpts.PrecompiledPreambleBytes.second
-                                                    = PreambleEndsAtStartOfLine;
-    PreprocessorOpts.ImplicitPCHInclude = getPreambleFile(this);
-    PreprocessorOpts.DisablePCHValidation = true;
+    addPrecompiledPreamble(PreprocessorOpts);
     
     // The stored diagnostic has the old source manager in it; update
     // the locations to refer into the new source manager. Since we've
@@ -1315,6 +1335,143 @@ makeStandaloneDiagnostic(const LangOptions &LangOpts,
   return OutDiag;
 }
 
+/// \brief Return true if any of the files used by a precompiled preamble
+/// has changed since the preamble was built, taking into account the files
+/// remapped by \p PPOpts.
+static bool haveFilesInPreambleChanged(
+    const llvm::StringMap<ASTUnit::PreambleFileHash> &FilesInPreamble,
+    const PreprocessorOptions &PPOpts, FileManager &FileMgr) {
+  typedef ASTUnit::PreambleFileHash PreambleFileHash;
+
+  // First, make a record of those files that have been overridden via
+  // remapping or unsaved_files.
+  std::map<llvm::sys::fs::UniqueID, PreambleFileHash> OverriddenFiles;
+  for (const auto &R : PPOpts.RemappedFiles) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(R.second, Status)) {
+      // If we can't stat the file we're remapping to, assume that something
+      // horrible happened.
+      return true;
+    }
+
+    OverriddenFiles[Status.getUniqueID()] = PreambleFileHash::createForFile(
+        Status.getSize(),
+        llvm::sys::toTimeT(Status.getLastModificationTime()));
+  }
+
+  for (const auto &RB : PPOpts.RemappedFileBuffers) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(RB.first, Status))
+      return true;
+
+    OverriddenFiles[Status.getUniqueID()] =
+        PreambleFileHash::createForMemoryBuffer(RB.second);
+  }
+
+  // Check whether anything has changed.
+  for (const auto &F : FilesInPreamble) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(F.first(), Status)) {
+      // If we can't stat the file, assume that something horrible happened.
+      return true;
+    }
+
+    auto Overridden = OverriddenFiles.find(Status.getUniqueID());
+    if (Overridden != OverriddenFiles.end()) {
+      // This file was remapped; check whether the newly-mapped file
+      // matches up with the previous mapping.
+      if (Overridden->second != F.second)
+        return true;
+      continue;
+    }
+
+    // The file was not remapped; check whether it has changed on disk.
+    if (Status.getSize() != uint64_t(F.second.Size) ||
+        llvm::sys::toTimeT(Status.getLastModificationTime()) !=
+            F.second.ModTime)
+      return true;
+  }
+
+  return false;
+}
+
+/// \brief Compute the key under which a precompiled preamble is kept in a
+/// PrecompiledPreambleStore.
+///
+/// The key holds the text of the preamble and everything in the invocation
+/// that can change how it is parsed. The contents of the files it includes are
+/// not part of the key; they are checked by haveFilesInPreambleChanged.
+static std::string getPreambleStoreKey(const CompilerInvocation &Invocation,
+                                       StringRef MainFilename,
+                                       StringRef PreambleText,
+                                       bool PreambleEndsAtStartOfLine) {
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  // Strings are prefixed with their length so that the key is unambiguous.
+  auto AddString = [&OS](StringRef Str) { OS << Str.size() << ':' << Str; };
+
+  AddString(Invocation.getModuleHash());
+
+  // The module hash leaves out the options which do not affect the contents
+  // of modules.
+  const LangOptions &LangOpts = *Invocation.getLangOpts();
+#define LANGOPT(Name, Bits, Default, Description) OS << LangOpts.Name << ',';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description)                   \
+  OS << static_cast<unsigned>(LangOpts.get##Name()) << ',';
+#include "clang/Basic/LangOptions.def"
+
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+#define DIAGOPT(Name, Bits, Default) OS << DiagOpts.Name << ',';
+#define ENUM_DIAGOPT(Name, Type, Bits, Default)                                \
+  OS << static_cast<unsigned>(DiagOpts.get##Name()) << ',';
+#include "clang/Basic/DiagnosticOptions.def"
+  for (const std::string &Warning : DiagOpts.Warnings)
+    AddString(Warning);
+  for (const std::string &Remark : DiagOpts.Remarks)
+    AddString(Remark);
+
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const auto &Macro : PPOpts.Macros) {
+    AddString(Macro.first);
+    OS << Macro.second;
+  }
+  for (const std::string &Include : PPOpts.Includes)
+    AddString(Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    AddString(Include);
+  AddString(PPOpts.ImplicitPCHInclude);
+  AddString(PPOpts.ImplicitPTHInclude);
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  for (const auto &Entry : HSOpts.UserEntries) {
+    AddString(Entry.Path);
+    OS << Entry.Group << Entry.IsFramework << Entry.IgnoreSysRoot;
+  }
+  for (const auto &Prefix : HSOpts.SystemHeaderPrefixes) {
+    AddString(Prefix.Prefix);
+    OS << Prefix.IsSystemHeader;
+  }
+  for (const std::string &Overlay : HSOpts.VFSOverlayFiles)
+    AddString(Overlay);
+  AddString(Invocation.getFileSystemOpts().WorkingDir);
+
+  AddString(MainFilename);
+  OS << PreambleEndsAtStartOfLine;
+  AddString(PreambleText);
+  return OS.str();
+}
+
+/// \brief Return a name under which a precompiled preamble which is kept in
+/// memory can be read. No file by this name is created.
+static std::string getInMemoryPreamblePCHName() {
+  static std::atomic<unsigned> NextID(0);
+  SmallString<128> Path;
+  llvm::sys::path::system_temp_directory(/*ErasedOnReboot=*/true, Path);
+  llvm::sys::path::append(Path, "preamble-in-memory-" + Twine(NextID++) +
+                                    ".pch");
+  return Path.str();
+}
+
 /// \brief Attempt to build or re-use a precompiled preamble when (re-)parsing
 /// the source file.
 ///
@@ -1353,7 +1510,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     // We couldn't find a preamble in the main source. Clear out the current
     // preamble, if we have one. It's obviously no good any more.
     Preamble.clear();
-    erasePreambleFile(this);
+    erasePrecompiledPreamble();
 
     // The next time we actually see a preamble, precompile it.
     PreambleRebuildCounter = 1;
@@ -1373,71 +1530,9 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
       // preamble.
 
       // Check that none of the files used by the preamble have changed.
-      bool AnyFileChanged = false;
-          
-      // First, make a record of those files that have been overridden via
-      // remapping or unsaved_files.
-      std::map<llvm::sys::fs::UniqueID, PreambleFileHash> OverriddenFiles;
-      for (const auto &R : PreprocessorOpts.RemappedFiles) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(R.second, Status)) {
-          // If we can't stat the file we're remapping to, assume that something
-          // horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[Status.getUniqueID()] = PreambleFileHash::createForFile(
-            Status.getSize(),
-            llvm::sys::toTimeT(Status.getLastModificationTime()));
-      }
+      bool AnyFileChanged = haveFilesInPreambleChanged(
+          FilesInPreamble, PreprocessorOpts, *FileMgr);
 
-      for (const auto &RB : PreprocessorOpts.RemappedFileBuffers) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(RB.first, Status)) {
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[Status.getUniqueID()] =
-            PreambleFileHash::createForMemoryBuffer(RB.second);
-      }
-       
-      // Check whether anything has changed.
-      for (llvm::StringMap<PreambleFileHash>::iterator
-             F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
-           !AnyFileChanged && F != FEnd; 
-           ++F) {
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(F->first(), Status)) {
-          // If we can't stat the file, assume that something horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        std::map<llvm::sys::fs::UniqueID, PreambleFileHash>::iterator Overridden
-          = OverriddenFiles.find(Status.getUniqueID());
-        if (Overridden != OverriddenFiles.end()) {
-          // This file was remapped; check whether the newly-mapped file 
-          // matches up with the previous mapping.
-          if (Overridden->second != F->second)
-            AnyFileChanged = true;
-          continue;
-        }
-        
-        // The file was not remapped; check whether it has changed on disk.
-        if (Status.getSize() != uint64_t(F->second.Size) ||
-            llvm::sys::toTimeT(Status.getLastModificationTime()) !=
-                F->second.ModTime)
-          AnyFileChanged = true;
-      }
-          
       if (!AnyFileChanged) {
         // Okay! We can re-use the precompiled preamble.
 
@@ -1461,7 +1556,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     // We can't reuse the previously-computed preamble. Build a new one.
     Preamble.clear();
     PreambleDiagnostics.clear();
-    erasePreambleFile(this);
+    erasePrecompiledPreamble();
     PreambleRebuildCounter = 1;
   } else if (!AllowRebuild) {
     // We aren't allowed to rebuild the precompiled preamble; just
@@ -1477,13 +1572,69 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
 
+  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
+  StringRef PreambleText =
+      NewPreamble.Buffer->getBuffer().slice(0, NewPreamble.Size);
+
+  // Keep the precompiled preamble in memory, where other units can share it,
+  // unless the AST is going to be serialized (as the serialized AST refers to
+  // the preamble by name) or a test asked for the preamble file.
+  std::string PreambleKey;
+  std::shared_ptr<const StoredPreamble> StalePreamble;
+  if (PreambleStore && !WriterData && !::getenv("CINDEXTEST_PREAMBLE_FILE")) {
+    PreambleKey = getPreambleStoreKey(*PreambleInvocation, MainFilename,
+                                      PreambleText,
+                                      NewPreamble.PreambleEndsAtStartOfLine);
+    std::shared_ptr<const StoredPreamble> Stored =
+        PreambleStore->lookup(PreambleKey);
+    if (Stored && !haveFilesInPreambleChanged(Stored->FilesInPreamble,
+                                              PreprocessorOpts, *FileMgr)) {
+      // The same preamble has already been precompiled, possibly by another
+      // unit. Use it as if we had just built it.
+      Preamble.assign(FileMgr->getFile(MainFilename), PreambleText.begin(),
+                      PreambleText.end());
+      PreambleEndsAtStartOfLine = NewPreamble.PreambleEndsAtStartOfLine;
+      InMemoryPreamble = std::move(Stored);
+      TopLevelDecls.clear();
+      TopLevelDeclsInPreamble = InMemoryPreamble->TopLevelDecls;
+      PreambleDiagnostics = InMemoryPreamble->Diagnostics;
+      FilesInPreamble = InMemoryPreamble->FilesInPreamble;
+      NumWarningsInPreamble = InMemoryPreamble->NumWarnings;
+      PreambleRebuildCounter = 1;
+
+      // Set the state of the diagnostic object to mimic its state
+      // after parsing the preamble.
+      getDiagnostics().Reset();
+      ProcessWarningOptions(getDiagnostics(),
+                            PreambleInvocation->getDiagnosticOpts());
+      getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+      checkAndRemoveNonDriverDiags(StoredDiagnostics);
+
+      CurrentTopLevelHashValue = InMemoryPreamble->TopLevelHashValue;
+      if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+        CompletionCacheTopLevelHashValue = 0;
+        PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+      }
+
+      return llvm::MemoryBuffer::getMemBufferCopy(
+          NewPreamble.Buffer->getBuffer(), MainFilename);
+    }
+
+    // The stored preamble, if any, is out of date. The one built below
+    // replaces it.
+    StalePreamble = std::move(Stored);
+  }
+
   // Create a temporary file for the precompiled preamble. In rare 
   // circumstances, this can fail.
-  std::string PreamblePCHPath = GetPreamblePCHPath();
-  if (PreamblePCHPath.empty()) {
-    // Try again next time.
-    PreambleRebuildCounter = 1;
-    return nullptr;
+  std::string PreamblePCHPath;
+  if (PreambleKey.empty()) {
+    PreamblePCHPath = GetPreamblePCHPath();
+    if (PreamblePCHPath.empty()) {
+      // Try again next time.
+      PreambleRebuildCounter = 1;
+      return nullptr;
+    }
   }
   
   // We did not previously compute a preamble, or it can't be reused anyway.
@@ -1492,10 +1643,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
 
   // Save the preamble text for later; we'll need to compare against it for
   // subsequent reparses.
-  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
-  Preamble.assign(FileMgr->getFile(MainFilename),
-                  NewPreamble.Buffer->getBufferStart(),
-                  NewPreamble.Buffer->getBufferStart() + NewPreamble.Size);
+  Preamble.assign(FileMgr->getFile(MainFilename), PreambleText.begin(),
+                  PreambleText.end());
   PreambleEndsAtStartOfLine = NewPreamble.PreambleEndsAtStartOfLine;
 
   PreambleBuffer = llvm::MemoryBuffer::getMemBufferCopy(
@@ -1574,7 +1723,7 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   Clang->addDependencyCollector(PreambleDepCollector);
 
   std::unique_ptr<PrecompilePreambleAction> Act;
-  Act.reset(new PrecompilePreambleAction(*this));
+  Act.reset(new PrecompilePreambleAction(*this, !PreambleKey.empty()));
   if (!Act->BeginSourceFile(*Clang.get(), Clang->getFrontendOpts().Inputs[0])) {
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
     Preamble.clear();
@@ -1610,7 +1759,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   }
   
   // Keep track of the preamble we precompiled.
-  setPreambleFile(this, FrontendOpts.OutputFile);
+  if (PreambleKey.empty())
+    setPreambleFile(this, FrontendOpts.OutputFile);
   NumWarningsInPreamble = getDiagnostics().getNumWarnings();
   
   // Keep track of all of the files that the source manager knows about,
@@ -1634,6 +1784,32 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   PreambleRebuildCounter = 1;
   PreprocessorOpts.RemappedFileBuffers.pop_back();
 
+  if (!PreambleKey.empty()) {
+    auto Stored = llvm::make_unique<StoredPreamble>();
+    const StoredPreamble *Built = Stored.get();
+    Stored->FileName = getInMemoryPreamblePCHName();
+    Stored->PCH = Act->takePreamblePCH();
+    Stored->TopLevelDecls = TopLevelDeclsInPreamble;
+    Stored->Diagnostics = PreambleDiagnostics;
+    Stored->FilesInPreamble = FilesInPreamble;
+    Stored->NumWarnings = NumWarningsInPreamble;
+    Stored->TopLevelHashValue = CurrentTopLevelHashValue;
+    InMemoryPreamble = PreambleStore->insert(PreambleKey, std::move(Stored),
+                                             StalePreamble.get());
+
+    // Another unit may have stored the same preamble in the meantime, in
+    // which case its PCH is the one that will be read. Use what was recorded
+    // while building it, as if the lookup above had found it.
+    if (InMemoryPreamble.get() != Built) {
+      TopLevelDeclsInPreamble = InMemoryPreamble->TopLevelDecls;
+      PreambleDiagnostics = InMemoryPreamble->Diagnostics;
+      FilesInPreamble = InMemoryPreamble->FilesInPreamble;
+      NumWarningsInPreamble = InMemoryPreamble->NumWarnings;
+      getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+      CurrentTopLevelHashValue = InMemoryPreamble->TopLevelHashValue;
+    }
+  }
+
   // If the hash of top-level entities differs from the hash of the top-level
   // entities the last time we rebuilt the preamble, clear out the completion
   // cache.
@@ -1646,6 +1822,34 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
                                               MainFilename);
 }
 
+bool ASTUnit::hasPrecompiledPreamble() const {
+  return InMemoryPreamble || !getPreambleFile(this).empty();
+}
+
+void ASTUnit::erasePrecompiledPreamble() {
+  InMemoryPreamble.reset();
+  erasePreambleFile(this);
+}
+
+void ASTUnit::addPrecompiledPreamble(PreprocessorOptions &PPOpts) const {
+  PPOpts.PrecompiledPreambleBytes.first = Preamble.size();
+  PPOpts.PrecompiledPreambleBytes.second = PreambleEndsAtStartOfLine;
+  PPOpts.DisablePCHValidation = true;
+  if (InMemoryPreamble) {
+    PPOpts.ImplicitPCHInclude = InMemoryPreamble->FileName;
+    // The buffer shares ownership of the whole stored preamble.
+    PPOpts.ImplicitPCHBuffer = std::shared_ptr<const llvm::MemoryBuffer>(
+        InMemoryPreamble, InMemoryPreamble->PCH.get());
+  } else {
+    PPOpts.ImplicitPCHInclude = getPreambleFile(this);
+  }
+}
+
+void ASTUnit::setPreambleStore(
+    IntrusiveRefCntPtr<PrecompiledPreambleStore> Store) {
+  PreambleStore = std::move(Store);
+}
+
 void ASTUnit::RealizeTopLevelDeclsFromPreamble() {
   std::vector<Decl *> Resolved;
   Resolved.reserve(TopLevelDeclsInPreamble.size());
@@ -2049,7 +2253,7 @@ bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   // If we have a preamble file lying around, or if we might try to
   // build a precompiled preamble, do so now.
   std::unique_ptr<llvm::MemoryBuffer> OverrideMainBuffer;
-  if (!getPreambleFile(this).empty() || PreambleRebuildCounter > 0)
+  if (hasPrecompiledPreamble() || PreambleRebuildCounter > 0)
     OverrideMainBuffer =
         getMainBufferWithPrecompiledPreamble(PCHContainerOps, *Invocation);
 
@@ -2417,7 +2621,7 @@ void ASTUnit::CodeComplete(
   // point is within the main file, after the end of the precompiled
   // preamble.
   std::unique_ptr<llvm::MemoryBuffer> OverrideMainBuffer;
-  if (!getPreambleFile(this).empty()) {
+  if (hasPrecompiledPreamble()) {
     std::string CompleteFilePath(File);
     llvm::sys::fs::UniqueID CompleteFileID;
 
@@ -2437,11 +2641,7 @@ void ASTUnit::CodeComplete(
   if (OverrideMainBuffer) {
     PreprocessorOpts.addRemappedFile(OriginalSourceFile,
                                      OverrideMainBuffer.get());
-    PreprocessorOpts.PrecompiledPreambleBytes.first = Preamble.size();
-    PreprocessorOpts.PrecompiledPreambleBytes.second
-                                                    = PreambleEndsAtStartOfLine;
-    PreprocessorOpts.ImplicitPCHInclude = getPreambleFile(this);
-    PreprocessorOpts.DisablePCHValidation = true;
+    addPrecompiledPreamble(PreprocessorOpts);
 
     OwnedBuffers.push_back(OverrideMainBuffer.release());
   } else {
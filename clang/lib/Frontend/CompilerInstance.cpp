@@ -22,6 +22,7 @@
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/LogDiagnosticPrinter.h"
+#include "clang/Frontend/MinimizedSourceFileSystem.h"
 #include "clang/Frontend/SerializedDiagnosticPrinter.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
@@ -32,6 +33,7 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstantiationProfiler.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "llvm/ADT/Statistic.h"
@@ -298,7 +300,13 @@ void CompilerInstance::createFileManager() {
     // TODO: choose the virtual file system based on the CompilerInvocation.
     setVirtualFileSystem(vfs::getRealFileSystem());
   }
-  FileMgr = new FileManager(getFileSystemOpts(), VirtualFileSystem);
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = VirtualFileSystem;
+  // A dependency scan only needs the directives of each file. Modules are
+  // built from the same files and need all of their contents.
+  if (getDependencyOutputOpts().MinimizeSources && !getLangOpts().Modules)
+    FS = createMinimizedSourceFileSystem(
+        FS, MinimizedSourceCache::getProcessCache());
+  FileMgr = new FileManager(getFileSystemOpts(), FS);
 }
 
 // Source Manager
@@ -496,6 +504,25 @@ void CompilerInstance::createPCHExternalASTSource(
       getFrontendOpts().UseGlobalModuleIndex);
 }
 
+namespace {
+/// A buffer whose contents are owned by a buffer shared with other readers.
+class SharedMemoryBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<const llvm::MemoryBuffer> Buffer;
+
+public:
+  explicit SharedMemoryBuffer(std::shared_ptr<const llvm::MemoryBuffer> Buffer)
+      : Buffer(std::move(Buffer)) {
+    init(this->Buffer->getBufferStart(), this->Buffer->getBufferEnd(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  StringRef getBufferIdentifier() const override {
+    return Buffer->getBufferIdentifier();
+  }
+  BufferKind getBufferKind() const override { return Buffer->getBufferKind(); }
+};
+} // end anonymous namespace
+
 IntrusiveRefCntPtr<ASTReader> CompilerInstance::createPCHExternalASTSource(
     StringRef Path, StringRef Sysroot, bool DisablePCHValidation,
     bool AllowPCHWithCompilerErrors, Preprocessor &PP, ASTContext &Context,
@@ -518,6 +545,14 @@ IntrusiveRefCntPtr<ASTReader> CompilerInstance::createPCHExternalASTSource(
   Reader->setDeserializationListener(
       static_cast<ASTDeserializationListener *>(DeserializationListener),
       /*TakeOwnership=*/OwnDeserializationListener);
+
+  // A PCH which is kept in memory is handed to the reader, rather than read
+  // from disk.
+  const PreprocessorOptions &PPOpts = PP.getPreprocessorOpts();
+  if (PPOpts.ImplicitPCHBuffer && Path == PPOpts.ImplicitPCHInclude)
+    Reader->addInMemoryBuffer(
+        Path, llvm::make_unique<SharedMemoryBuffer>(PPOpts.ImplicitPCHBuffer));
+
   switch (Reader->ReadAST(Path,
                           Preamble ? serialization::MK_Preamble
                                    : serialization::MK_PCH,
@@ -615,6 +650,10 @@ void CompilerInstance::createSema(TranslationUnitKind TUKind,
                                   CodeCompleteConsumer *CompletionConsumer) {
   TheSema.reset(new Sema(getPreprocessor(), getASTContext(), getASTConsumer(),
                          TUKind, CompletionConsumer));
+  if (getFrontendOpts().ShowTemplateProfile ||
+      !getFrontendOpts().TemplateProfileFile.empty())
+    TheSema->InstantiationProfiler =
+        llvm::make_unique<TemplateInstantiationProfiler>(getASTContext());
   // Attach the external sema source if there is any.
   if (ExternalSemaSrc) {
     TheSema->addExternalSource(ExternalSemaSrc.get());
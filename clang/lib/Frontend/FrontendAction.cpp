@@ -22,6 +22,8 @@
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Parse/ParseAST.h"
+#include "clang/Sema/Sema.h"
+#include "clang/Sema/TemplateInstantiationProfiler.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
@@ -472,6 +474,27 @@ bool FrontendAction::Execute() {
   return true;
 }
 
+/// \brief Write the Chrome trace and print the report requested by
+/// -ftemplate-profile= and -ftemplate-profile-report.
+static void
+reportTemplateInstantiations(CompilerInstance &CI,
+                             const TemplateInstantiationProfiler &Profiler) {
+  const FrontendOptions &Opts = CI.getFrontendOpts();
+  if (!Opts.TemplateProfileFile.empty()) {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Opts.TemplateProfileFile, EC,
+                            llvm::sys::fs::F_Text);
+    if (EC)
+      CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << Opts.TemplateProfileFile << EC.message();
+    else
+      Profiler.writeChromeTrace(OS);
+  }
+
+  if (Opts.ShowTemplateProfile)
+    Profiler.printReport(llvm::errs());
+}
+
 void FrontendAction::EndSourceFile() {
   CompilerInstance &CI = getCompilerInstance();
 
@@ -485,6 +508,10 @@ void FrontendAction::EndSourceFile() {
   // Finalize the action.
   EndSourceFileAction();
 
+  // Report the template instantiations while their declarations still exist.
+  if (CI.hasSema() && CI.getSema().InstantiationProfiler)
+    reportTemplateInstantiations(CI, *CI.getSema().InstantiationProfiler);
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
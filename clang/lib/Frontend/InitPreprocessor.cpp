@@ -1080,8 +1080,9 @@ void clang::InitializePreprocessor(
   for (unsigned i = 0, e = InitOpts.MacroIncludes.size(); i != e; ++i)
     AddImplicitIncludeMacros(Builder, InitOpts.MacroIncludes[i]);
 
-  // Process -include-pch/-include-pth directives.
-  if (!InitOpts.ImplicitPCHInclude.empty())
+  // Process -include-pch/-include-pth directives. A PCH which is kept in
+  // memory is only read by the ASTReader, which replaces these predefines.
+  if (!InitOpts.ImplicitPCHInclude.empty() && !InitOpts.ImplicitPCHBuffer)
     AddImplicitIncludePCH(Builder, PP, PCHContainerRdr,
                           InitOpts.ImplicitPCHInclude);
   if (!InitOpts.ImplicitPTHInclude.empty())
@@ -0,0 +1,187 @@
+//===--- MinimizedSourceFileSystem.cpp - Minimizing file system -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/MinimizedSourceFileSystem.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Path.h"
+
+using namespace clang;
+using namespace clang::vfs;
+
+std::shared_ptr<llvm::MemoryBuffer>
+MinimizedSourceCache::lookup(const Status &Stat) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = Entries.find(Stat.getUniqueID());
+  if (I == Entries.end() || I->second.Size != Stat.getSize() ||
+      I->second.ModTime != Stat.getLastModificationTime())
+    return nullptr;
+  return I->second.Buffer;
+}
+
+std::shared_ptr<llvm::MemoryBuffer>
+MinimizedSourceCache::insert(const Status &Stat,
+                             std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entry &E = Entries[Stat.getUniqueID()];
+  if (!E.Buffer || E.Size != Stat.getSize() ||
+      E.ModTime != Stat.getLastModificationTime()) {
+    E.Size = Stat.getSize();
+    E.ModTime = Stat.getLastModificationTime();
+    E.Buffer = std::move(Buffer);
+  }
+  return E.Buffer;
+}
+
+void MinimizedSourceCache::invalidate() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries.clear();
+}
+
+IntrusiveRefCntPtr<MinimizedSourceCache>
+MinimizedSourceCache::getProcessCache() {
+  static IntrusiveRefCntPtr<MinimizedSourceCache> Cache =
+      new MinimizedSourceCache();
+  return Cache;
+}
+
+/// Returns true if the file at \p Path is a source file that the
+/// preprocessor lexes, as opposed to one which is parsed in some other way.
+static bool shouldMinimize(StringRef Path, const Status &Stat) {
+  if (!Stat.isRegularFile())
+    return false;
+  StringRef FileName = llvm::sys::path::filename(Path);
+  if (FileName == "module.map" || FileName == "module.private.map")
+    return false;
+  return llvm::StringSwitch<bool>(llvm::sys::path::extension(FileName))
+      .Cases(".modulemap", ".hmap", ".pcm", ".pch", ".gch", ".pth", false)
+      .Default(true);
+}
+
+namespace {
+/// A file whose contents are the minimized contents of an underlying file.
+class MinimizedFile : public File {
+  Status Stat;
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+
+public:
+  MinimizedFile(Status Stat, std::shared_ptr<llvm::MemoryBuffer> Contents)
+      : Stat(std::move(Stat)), Contents(std::move(Contents)) {}
+
+  llvm::ErrorOr<Status> status() override { return Stat; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return llvm::MemoryBuffer::getMemBufferCopy(Contents->getBuffer(),
+                                                Name.str());
+  }
+
+  std::error_code close() override { return std::error_code(); }
+};
+
+/// A file system which minimizes the source files of an underlying file
+/// system.
+class MinimizedSourceFileSystem : public FileSystem {
+  IntrusiveRefCntPtr<FileSystem> FS;
+  IntrusiveRefCntPtr<MinimizedSourceCache> Cache;
+
+  /// Returns the minimized contents of the file with status \p Stat, reading
+  /// them from \p F if they are not in the cache.
+  llvm::ErrorOr<std::shared_ptr<llvm::MemoryBuffer>>
+  getMinimizedContents(const Twine &Path, const Status &Stat, File &F) {
+    if (auto Contents = Cache->lookup(Stat))
+      return Contents;
+
+    auto Buffer = F.getBuffer(Path);
+    if (!Buffer)
+      return Buffer.getError();
+
+    SmallString<1024> Minimized;
+    minimizeSourceToDependencyDirectives((*Buffer)->getBuffer(), Minimized);
+    return Cache->insert(
+        Stat, llvm::MemoryBuffer::getMemBufferCopy(
+                  Minimized, (*Buffer)->getBufferIdentifier()));
+  }
+
+  /// Returns \p Stat with the size of the minimized contents.
+  static Status getMinimizedStatus(const Status &Stat,
+                                   const llvm::MemoryBuffer &Contents) {
+    Status Result(Stat.getName(), Stat.getUniqueID(),
+                  Stat.getLastModificationTime(), Stat.getUser(),
+                  Stat.getGroup(), Contents.getBufferSize(), Stat.getType(),
+                  Stat.getPermissions());
+    Result.IsVFSMapped = Stat.IsVFSMapped;
+    return Result;
+  }
+
+public:
+  MinimizedSourceFileSystem(IntrusiveRefCntPtr<FileSystem> FS,
+                            IntrusiveRefCntPtr<MinimizedSourceCache> Cache)
+      : FS(std::move(FS)), Cache(std::move(Cache)) {}
+
+  llvm::ErrorOr<Status> status(const Twine &Path) override {
+    SmallString<256> PathStorage;
+    StringRef P = Path.toStringRef(PathStorage);
+    llvm::ErrorOr<Status> Stat = FS->status(P);
+    if (!Stat || !shouldMinimize(P, *Stat))
+      return Stat;
+
+    // The size of the file has to match the size of its contents, so the
+    // file is minimized as soon as it is found.
+    if (auto Contents = Cache->lookup(*Stat))
+      return getMinimizedStatus(*Stat, *Contents);
+    auto F = FS->openFileForRead(P);
+    if (!F)
+      return F.getError();
+    auto Contents = getMinimizedContents(P, *Stat, **F);
+    if (!Contents)
+      return Contents.getError();
+    return getMinimizedStatus(*Stat, **Contents);
+  }
+
+  llvm::ErrorOr<std::unique_ptr<File>>
+  openFileForRead(const Twine &Path) override {
+    SmallString<256> PathStorage;
+    StringRef P = Path.toStringRef(PathStorage);
+    auto F = FS->openFileForRead(P);
+    if (!F)
+      return F;
+    llvm::ErrorOr<Status> Stat = (*F)->status();
+    if (!Stat || !shouldMinimize(P, *Stat))
+      return F;
+
+    auto Contents = getMinimizedContents(P, *Stat, **F);
+    if (!Contents)
+      return Contents.getError();
+    return std::unique_ptr<File>(llvm::make_unique<MinimizedFile>(
+        getMinimizedStatus(*Stat, **Contents), std::move(*Contents)));
+  }
+
+  directory_iterator dir_begin(const Twine &Dir,
+                               std::error_code &EC) override {
+    return FS->dir_begin(Dir, EC);
+  }
+
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    return FS->setCurrentWorkingDirectory(Path);
+  }
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return FS->getCurrentWorkingDirectory();
+  }
+};
+} // end anonymous namespace
+
+IntrusiveRefCntPtr<FileSystem> clang::createMinimizedSourceFileSystem(
+    IntrusiveRefCntPtr<FileSystem> FS,
+    IntrusiveRefCntPtr<MinimizedSourceCache> Cache) {
+  return new MinimizedSourceFileSystem(std::move(FS), std::move(Cache));
+}
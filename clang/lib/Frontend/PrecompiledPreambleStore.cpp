@@ -0,0 +1,89 @@
+//===--- PrecompiledPreambleStore.cpp - Shared preambles --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/PrecompiledPreambleStore.h"
+
+using namespace clang;
+
+std::shared_ptr<const StoredPreamble>
+PrecompiledPreambleStore::lookup(StringRef Key) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = Entries.find(Key);
+  if (I == Entries.end())
+    return nullptr;
+  LRU.splice(LRU.begin(), LRU, I->second.LRUPosition);
+  return I->second.Preamble;
+}
+
+std::shared_ptr<const StoredPreamble>
+PrecompiledPreambleStore::insert(StringRef Key,
+                                 std::unique_ptr<StoredPreamble> Preamble,
+                                 const StoredPreamble *Stale) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto Inserted = Entries.insert(std::make_pair(Key, Entry()));
+  Entry &E = Inserted.first->second;
+  if (Inserted.second) {
+    E.LRUPosition = LRU.insert(LRU.begin(), Inserted.first->first());
+  } else {
+    LRU.splice(LRU.begin(), LRU, E.LRUPosition);
+    if (E.Preamble.get() != Stale)
+      return E.Preamble;
+    // Units still using the stale preamble keep it alive.
+    MemoryUsage -= E.Size;
+  }
+
+  // The key is usually dominated by the text of the preamble, but it is kept
+  // for as long as the PCH, so count it as well.
+  E.Size = Preamble->PCH->getBufferSize() + Key.size();
+  E.Preamble = std::move(Preamble);
+  MemoryUsage += E.Size;
+
+  std::shared_ptr<const StoredPreamble> Result = E.Preamble;
+  evict();
+  return Result;
+}
+
+void PrecompiledPreambleStore::evict() {
+  while (MemoryUsage > MemoryBudget) {
+    auto I = Entries.find(LRU.back());
+    MemoryUsage -= I->second.Size;
+    LRU.pop_back();
+    Entries.erase(I);
+  }
+}
+
+void PrecompiledPreambleStore::setMemoryBudget(size_t Budget) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  MemoryBudget = Budget;
+  evict();
+}
+
+size_t PrecompiledPreambleStore::getMemoryBudget() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return MemoryBudget;
+}
+
+size_t PrecompiledPreambleStore::getMemoryUsage() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return MemoryUsage;
+}
+
+void PrecompiledPreambleStore::invalidate() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  LRU.clear();
+  Entries.clear();
+  MemoryUsage = 0;
+}
+
+IntrusiveRefCntPtr<PrecompiledPreambleStore>
+PrecompiledPreambleStore::getProcessStore() {
+  static IntrusiveRefCntPtr<PrecompiledPreambleStore> Store =
+      new PrecompiledPreambleStore();
+  return Store;
+}
@@ -0,0 +1,138 @@
+//===--- DependencyDirectivesSourceMinimizer.cpp - Minimize source --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements minimizeSourceToDependencyDirectives. The minimized
+// source is used by dependency scanning (-M, -MM), which only needs to know
+// which files a translation unit enters and therefore has no use for anything
+// but the preprocessor directives.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/ADT/ArrayRef.h"
+#include <algorithm>
+using namespace clang;
+
+namespace {
+/// The tokens at the start of a directive, along with their position in the
+/// source buffer.
+struct DirectiveToken {
+  Token Tok;
+  const char *Start;
+};
+} // end anonymous namespace
+
+static bool isRawIdentifier(const DirectiveToken &DT, StringRef Name) {
+  return DT.Tok.is(tok::raw_identifier) && DT.Tok.getRawIdentifier() == Name;
+}
+
+/// Returns true if the directive whose tokens (following the '#') are
+/// \p Toks can affect the set of included files.
+static bool shouldKeepDirective(ArrayRef<DirectiveToken> Toks) {
+  // Line markers ("# 42 "foo.h"") only change presumed locations.
+  if (Toks[0].Tok.isNot(tok::raw_identifier))
+    return false;
+
+  StringRef Name = Toks[0].Tok.getRawIdentifier();
+  if (Name == "line" || Name == "ident" || Name == "sccs")
+    return false;
+  if (Name != "pragma")
+    return true;
+
+  // Only keep the pragmas that change how headers are entered or looked up,
+  // whether they are system headers, or the macro state.
+  if (Toks.size() < 2)
+    return false;
+  if (isRawIdentifier(Toks[1], "once") ||
+      isRawIdentifier(Toks[1], "push_macro") ||
+      isRawIdentifier(Toks[1], "pop_macro") ||
+      isRawIdentifier(Toks[1], "include_alias"))
+    return true;
+  if (Toks.size() < 3)
+    return false;
+  if (isRawIdentifier(Toks[1], "GCC") || isRawIdentifier(Toks[1], "clang"))
+    if (isRawIdentifier(Toks[2], "system_header"))
+      return true;
+  return isRawIdentifier(Toks[1], "clang") &&
+         isRawIdentifier(Toks[2], "module");
+}
+
+/// Returns the end of the header name of an angled include directive that
+/// starts at \p Less, or null if there is no '>' on the same line.
+///
+/// The raw lexer does not know that "<a//b.h>" is a header name, so the end
+/// of the last token it produces on the line may be in the middle of it. A
+/// "/*" in a header name is undefined behavior and is not handled.
+static const char *getAngledHeaderNameEnd(const char *Less) {
+  for (const char *P = Less + 1; *P && *P != '\n' && *P != '\r'; ++P)
+    if (*P == '>')
+      return P + 1;
+  return nullptr;
+}
+
+void clang::minimizeSourceToDependencyDirectives(
+    StringRef Input, SmallVectorImpl<char> &Output) {
+  assert(Input.end()[0] == '\0' && "Input must be null-terminated");
+
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = LangOpts.CPlusPlus14 = true;
+  LangOpts.LineComment = true;
+  LangOpts.Digraphs = true;
+  LangOpts.ObjC1 = true;
+
+  Lexer L(SourceLocation(), LangOpts, Input.begin(), Input.begin(),
+          Input.end());
+
+  Token Tok;
+  L.LexFromRawLexer(Tok);
+  while (Tok.isNot(tok::eof)) {
+    if (!Tok.isAtStartOfLine() || !Tok.isOneOf(tok::hash, tok::at)) {
+      L.LexFromRawLexer(Tok);
+      continue;
+    }
+
+    const char *Start = L.getBufferLocation() - Tok.getLength();
+    bool IsAt = Tok.is(tok::at);
+
+    // Lex the rest of the logical line, remembering the first few tokens so
+    // that the directive can be identified.
+    SmallVector<DirectiveToken, 4> Toks;
+    const char *End = L.getBufferLocation();
+    L.LexFromRawLexer(Tok);
+    while (Tok.isNot(tok::eof) && !Tok.isAtStartOfLine()) {
+      if (Toks.size() < 4)
+        Toks.push_back({Tok, L.getBufferLocation() - Tok.getLength()});
+      End = L.getBufferLocation();
+      L.LexFromRawLexer(Tok);
+    }
+
+    // A '#' on its own is the null directive.
+    if (Toks.empty())
+      continue;
+
+    if (IsAt) {
+      if (!isRawIdentifier(Toks[0], "import"))
+        continue;
+    } else {
+      if (!shouldKeepDirective(Toks))
+        continue;
+      if (Toks.size() >= 2 && Toks[1].Tok.is(tok::less) &&
+          (isRawIdentifier(Toks[0], "include") ||
+           isRawIdentifier(Toks[0], "include_next") ||
+           isRawIdentifier(Toks[0], "import")))
+        if (const char *NameEnd = getAngledHeaderNameEnd(Toks[1].Start))
+          End = std::max(End, NameEnd);
+    }
+
+    Output.append(Start, End);
+    Output.push_back('\n');
+  }
+}
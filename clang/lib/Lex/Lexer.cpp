@@ -1369,6 +1369,127 @@ Slash:
   return *Ptr;
 }
 
+//===----------------------------------------------------------------------===//
+// Fast Scanning Helpers.
+//===----------------------------------------------------------------------===//
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
+// The functions below skip a run of characters that need no special handling
+// 16 bytes at a time.  They stop at the first character that does, or when
+// fewer than 16 bytes are left before BufferEnd, and leave the rest of the
+// work to the scalar loop in the caller.  Without SSE2 they do nothing.
+
+#ifdef __SSE2__
+/// Advance \p CurPtr to the first byte for which \p IsStop returns a set
+/// byte in its result.
+template <typename StopFn>
+static inline const char *skipChunks(const char *CurPtr, const char *BufferEnd,
+                                     StopFn IsStop) {
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+    unsigned Mask = _mm_movemask_epi8(IsStop(Chunk));
+    if (Mask != 0)
+      return CurPtr + llvm::countTrailingZeros(Mask);
+    CurPtr += 16;
+  }
+  return CurPtr;
+}
+
+static inline __m128i matchChar(__m128i Chunk, char C) {
+  return _mm_cmpeq_epi8(Chunk, _mm_set1_epi8(C));
+}
+
+/// Matches the bytes in [Lo, Hi].  Bytes with the high bit set never match,
+/// because the comparisons are signed.
+static inline __m128i matchRange(__m128i Chunk, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(Chunk, _mm_set1_epi8(Hi + 1)));
+}
+#endif
+
+/// Skip [_A-Za-z0-9]*.
+static const char *fastSkipIdentifierBody(const char *CurPtr,
+                                          const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipChunks(CurPtr, BufferEnd, [](__m128i Chunk) {
+    __m128i Lower = _mm_or_si128(Chunk, _mm_set1_epi8(0x20));
+    __m128i Body = _mm_or_si128(
+        _mm_or_si128(matchRange(Lower, 'a', 'z'), matchRange(Chunk, '0', '9')),
+        matchChar(Chunk, '_'));
+    return _mm_xor_si128(Body, _mm_set1_epi8(-1));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip [ \t\f\v]*.
+static const char *fastSkipHorizontalWhitespace(const char *CurPtr,
+                                                const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipChunks(CurPtr, BufferEnd, [](__m128i Chunk) {
+    __m128i Space = _mm_or_si128(
+        _mm_or_si128(matchChar(Chunk, ' '), matchChar(Chunk, '\t')),
+        _mm_or_si128(matchChar(Chunk, '\f'), matchChar(Chunk, '\v')));
+    return _mm_xor_si128(Space, _mm_set1_epi8(-1));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip to the next newline or nul character.
+static const char *fastSkipToLineEnd(const char *CurPtr,
+                                     const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipChunks(CurPtr, BufferEnd, [](__m128i Chunk) {
+    return _mm_or_si128(
+        _mm_or_si128(matchChar(Chunk, '\n'), matchChar(Chunk, '\r')),
+        matchChar(Chunk, '\0'));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip the characters of a string literal that getAndAdvanceChar returns
+/// unchanged and that do not end the literal: everything but '"', '\\',
+/// '?', newlines and nul characters.
+static const char *fastSkipStringLiteralBody(const char *CurPtr,
+                                             const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipChunks(CurPtr, BufferEnd, [](__m128i Chunk) {
+    __m128i Special = _mm_or_si128(
+        _mm_or_si128(matchChar(Chunk, '"'), matchChar(Chunk, '\\')),
+        matchChar(Chunk, '?'));
+    __m128i End = _mm_or_si128(
+        _mm_or_si128(matchChar(Chunk, '\n'), matchChar(Chunk, '\r')),
+        matchChar(Chunk, '\0'));
+    return _mm_or_si128(Special, End);
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skip to the next ')' or nul character in the body of a raw string literal.
+static const char *fastSkipRawStringBody(const char *CurPtr,
+                                         const char *BufferEnd) {
+#ifdef __SSE2__
+  return skipChunks(CurPtr, BufferEnd, [](__m128i Chunk) {
+    return _mm_or_si128(matchChar(Chunk, ')'), matchChar(Chunk, '\0'));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
 //===----------------------------------------------------------------------===//
 // Helper methods for lexing.
 //===----------------------------------------------------------------------===//
@@ -1507,6 +1628,7 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = fastSkipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -1767,6 +1889,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
            ? diag::warn_cxx98_compat_unicode_literal
            : diag::warn_c99_compat_unicode_literal);
 
+  CurPtr = fastSkipStringLiteralBody(CurPtr, BufferEnd);
   char C = getAndAdvanceChar(CurPtr, Result);
   while (C != '"') {
     // Skip escaped characters.  Escaped newlines will already be processed by
@@ -1792,6 +1915,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = fastSkipStringLiteralBody(CurPtr, BufferEnd);
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -1862,6 +1986,7 @@ bool Lexer::LexRawStringLiteral(Token &Result, const char *CurPtr,
   CurPtr += PrefixLen + 1; // skip over prefix and '('
 
   while (true) {
+    CurPtr = fastSkipRawStringBody(CurPtr, BufferEnd);
     char C = *CurPtr++;
 
     if (C == ')') {
@@ -2006,6 +2131,8 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    CurPtr = fastSkipHorizontalWhitespace(CurPtr, BufferEnd);
+    Char = *CurPtr;
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2072,6 +2199,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // them.  As such, optimize for this case with the inner loop.
   char C;
   do {
+    CurPtr = fastSkipToLineEnd(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2277,13 +2405,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
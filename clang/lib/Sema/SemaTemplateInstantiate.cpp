@@ -25,6 +25,7 @@
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Template.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "clang/Sema/TemplateInstantiationProfiler.h"
 
 using namespace clang;
 using namespace sema;
@@ -1939,6 +1940,9 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
   assert(!Inst.isAlreadyInstantiating() && "should have been caught by caller");
   PrettyDeclStackTraceEntry CrashInfo(*this, Instantiation, SourceLocation(),
                                       "instantiating class definition");
+  TemplateInstantiationProfiler::Scope ProfileScope(
+      InstantiationProfiler.get(), Instantiation,
+      TemplateInstantiationProfiler::IK_Class);
 
   // Enter the scope of this instantiation. We don't use
   // PushDeclContext because we don't have a scope.
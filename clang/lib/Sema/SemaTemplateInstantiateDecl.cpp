@@ -23,6 +23,7 @@
 #include "clang/Sema/Lookup.h"
 #include "clang/Sema/PrettyDeclStackTrace.h"
 #include "clang/Sema/Template.h"
+#include "clang/Sema/TemplateInstantiationProfiler.h"
 
 using namespace clang;
 
@@ -3797,6 +3798,9 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
     return;
   PrettyDeclStackTraceEntry CrashInfo(*this, Function, SourceLocation(),
                                       "instantiating function definition");
+  TemplateInstantiationProfiler::Scope ProfileScope(
+      InstantiationProfiler.get(), Function,
+      TemplateInstantiationProfiler::IK_Function);
 
   // The instantiation is visible here, even if it was first declared in an
   // unimported module.
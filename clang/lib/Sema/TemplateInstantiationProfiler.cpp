@@ -0,0 +1,198 @@
+//===--- TemplateInstantiationProfiler.cpp - Profile instantiations -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements TemplateInstantiationProfiler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Sema/TemplateInstantiationProfiler.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclTemplate.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+
+typedef TemplateInstantiationProfiler::Clock Clock;
+
+TemplateInstantiationProfiler::TemplateInstantiationProfiler(
+    ASTContext &Context)
+    : Context(Context), Epoch(Clock::now()) {}
+
+/// \brief Return the template that \p Specialization is an instantiation of,
+/// looking through member templates of class template specializations.
+static const NamedDecl *getPrimaryTemplate(const NamedDecl *Specialization) {
+  const RedeclarableTemplateDecl *Template = nullptr;
+  const NamedDecl *Member = nullptr;
+  if (auto *Spec = dyn_cast<ClassTemplateSpecializationDecl>(Specialization))
+    Template = Spec->getSpecializedTemplate();
+  else if (auto *Record = dyn_cast<CXXRecordDecl>(Specialization))
+    Member = Record->getInstantiatedFromMemberClass();
+  else if (auto *Function = dyn_cast<FunctionDecl>(Specialization)) {
+    Template = Function->getPrimaryTemplate();
+    if (!Template)
+      Member = Function->getInstantiatedFromMemberFunction();
+  }
+
+  if (Template) {
+    while (auto *From = Template->getInstantiatedFromMemberTemplate())
+      Template = From;
+    return cast<NamedDecl>(Template->getCanonicalDecl());
+  }
+  if (Member)
+    return cast<NamedDecl>(Member->getCanonicalDecl());
+  return Specialization;
+}
+
+void TemplateInstantiationProfiler::begin(const NamedDecl *Specialization,
+                                          InstantiationKind Kind) {
+  ActiveInstantiation Active;
+  Active.Specialization = Specialization;
+  Active.Template = getPrimaryTemplate(Specialization);
+  Active.Kind = Kind;
+  Active.StartMemory = Context.getASTAllocatedBytes();
+  Active.ChildTime = Clock::duration::zero();
+  Active.ChildMemory = 0;
+  Active.Start = Clock::now();
+  Stack.push_back(Active);
+}
+
+void TemplateInstantiationProfiler::end() {
+  Clock::time_point End = Clock::now();
+  size_t EndMemory = Context.getASTAllocatedBytes();
+  ActiveInstantiation Active = Stack.back();
+  Stack.pop_back();
+
+  Clock::duration Time = End - Active.Start;
+  size_t Memory = EndMemory - Active.StartMemory;
+  if (!Stack.empty()) {
+    Stack.back().ChildTime += Time;
+    Stack.back().ChildMemory += Memory;
+  }
+
+  auto Inserted = TemplateIndices.insert(
+      std::make_pair(Active.Template, unsigned(Templates.size())));
+  if (Inserted.second) {
+    Templates.emplace_back();
+    Templates.back().Name =
+        cast<NamedDecl>(Active.Template)->getQualifiedNameAsString();
+  }
+  TemplateSummary &Summary = Templates[Inserted.first->second];
+
+  Instantiation I;
+  llvm::raw_string_ostream NameOS(I.Name);
+  Active.Specialization->getNameForDiagnostic(
+      NameOS, Context.getPrintingPolicy(), /*Qualified=*/true);
+  NameOS.flush();
+  I.Kind = Active.Kind;
+  I.Template = Inserted.first->second;
+  I.Depth = Stack.size();
+  I.Start = Active.Start - Epoch;
+  I.Time = Time;
+  I.SelfTime = Time - Active.ChildTime;
+  I.Memory = Memory;
+  I.SelfMemory = Memory - Active.ChildMemory;
+  Instantiations.push_back(std::move(I));
+
+  ++Summary.Count;
+  Summary.SelfTime += Time - Active.ChildTime;
+  Summary.SelfMemory += Memory - Active.ChildMemory;
+  // The time of a recursive instantiation is already part of the time of the
+  // outermost instantiation of the same template.
+  if (std::none_of(Stack.begin(), Stack.end(),
+                   [&](const ActiveInstantiation &Outer) {
+                     return Outer.Template == Active.Template;
+                   }))
+    Summary.Time += Time;
+}
+
+static uint64_t toMicroseconds(Clock::duration D) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(D).count();
+}
+
+static double toMilliseconds(Clock::duration D) {
+  return std::chrono::duration<double, std::milli>(D).count();
+}
+
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':
+    case '\\':
+      OS << '\\' << C;
+      break;
+    case '\n':
+      OS << "\\n";
+      break;
+    case '\t':
+      OS << "\\t";
+      break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void TemplateInstantiationProfiler::writeChromeTrace(raw_ostream &OS) const {
+  OS << "{\"traceEvents\": [";
+  bool First = true;
+  for (const Instantiation &I : Instantiations) {
+    OS << (First ? "\n" : ",\n");
+    First = false;
+    OS << "{\"name\": ";
+    writeJSONString(OS, I.Name);
+    OS << ", \"cat\": \""
+       << (I.Kind == IK_Class ? "InstantiateClass" : "InstantiateFunction")
+       << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 0"
+       << ", \"ts\": " << toMicroseconds(I.Start)
+       << ", \"dur\": " << toMicroseconds(I.Time)
+       << ", \"args\": {\"template\": ";
+    writeJSONString(OS, Templates[I.Template].Name);
+    OS << ", \"depth\": " << I.Depth << ", \"self_us\": "
+       << toMicroseconds(I.SelfTime) << ", \"bytes\": " << I.Memory
+       << ", \"self_bytes\": " << I.SelfMemory << "}}";
+  }
+  OS << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+void TemplateInstantiationProfiler::printReport(raw_ostream &OS) const {
+  std::vector<const TemplateSummary *> Sorted;
+  for (const TemplateSummary &Summary : Templates)
+    Sorted.push_back(&Summary);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const TemplateSummary *A, const TemplateSummary *B) {
+                     return A->SelfTime > B->SelfTime;
+                   });
+
+  Clock::duration Total = Clock::duration::zero();
+  for (const Instantiation &I : Instantiations)
+    if (I.Depth == 0)
+      Total += I.Time;
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << std::string(24, ' ') << "Template instantiation report\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "  Total instantiation time: "
+     << llvm::format("%.3f", toMilliseconds(Total)) << " ms, "
+     << Instantiations.size() << " instantiations of " << Templates.size()
+     << " templates\n\n"
+     << "   Self (ms)   Total (ms)   Self (KB)    Count  Template\n";
+  for (const TemplateSummary *Summary : Sorted)
+    OS << llvm::format("%12.3f %12.3f %11.1f %8u  ",
+                       toMilliseconds(Summary->SelfTime),
+                       toMilliseconds(Summary->Time),
+                       Summary->SelfMemory / 1024.0, Summary->Count)
+       << Summary->Name << '\n';
+}
@@ -31,7 +31,7 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/MemRegion.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "llvm/ADT/SmallString.h"
-#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
@@ -68,19 +68,16 @@ enum FoundationClass {
 
 static FoundationClass findKnownClass(const ObjCInterfaceDecl *ID,
                                       bool IncludeSuperclasses = true) {
-  static llvm::StringMap<FoundationClass> Classes;
-  if (Classes.empty()) {
-    Classes["NSArray"] = FC_NSArray;
-    Classes["NSDictionary"] = FC_NSDictionary;
-    Classes["NSEnumerator"] = FC_NSEnumerator;
-    Classes["NSNull"] = FC_NSNull;
-    Classes["NSOrderedSet"] = FC_NSOrderedSet;
-    Classes["NSSet"] = FC_NSSet;
-    Classes["NSString"] = FC_NSString;
-  }
-
-  // FIXME: Should we cache this at all?
-  FoundationClass result = Classes.lookup(ID->getIdentifier()->getName());
+  FoundationClass result =
+      llvm::StringSwitch<FoundationClass>(ID->getIdentifier()->getName())
+          .Case("NSArray", FC_NSArray)
+          .Case("NSDictionary", FC_NSDictionary)
+          .Case("NSEnumerator", FC_NSEnumerator)
+          .Case("NSNull", FC_NSNull)
+          .Case("NSOrderedSet", FC_NSOrderedSet)
+          .Case("NSSet", FC_NSSet)
+          .Case("NSString", FC_NSString)
+          .Default(FC_None);
   if (result == FC_None && IncludeSuperclasses)
     if (const ObjCInterfaceDecl *Super = ID->getSuperClass())
       return findKnownClass(Super);
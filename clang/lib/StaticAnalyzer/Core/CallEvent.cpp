@@ -996,22 +996,14 @@ RuntimeDefinition ObjCMethodCall::getRuntimeDefinition() const {
         // don't incur the same cost.  On some test cases, we can see the
         // same query being issued thousands of times.
         //
-        // NOTE: This cache is essentially a "global" variable, but it
-        // only gets lazily created when we get here.  The value of the
-        // cache probably comes from it being global across ExprEngines,
-        // where the same queries may get issued.  If we are worried about
-        // concurrency, or possibly loading/unloading ASTs, etc., we may
-        // need to revisit this someday.  In terms of memory, this table
-        // stays around until clang quits, which also may be bad if we
-        // need to release memory.
-        typedef std::pair<const ObjCInterfaceDecl*, Selector>
-                PrivateMethodKey;
-        typedef llvm::DenseMap<PrivateMethodKey,
-                               Optional<const ObjCMethodDecl *> >
-                PrivateMethodCache;
-
-        static PrivateMethodCache PMC;
-        Optional<const ObjCMethodDecl *> &Val = PMC[std::make_pair(IDecl, Sel)];
+        // The cache lives in the AnalysisManager, so that it is shared by
+        // all the ExprEngines analyzing this AST but not by other ASTs,
+        // which may be analyzed concurrently.
+        AnalysisManager &AMgr =
+            getState()->getStateManager().getOwningEngine()
+                ->getAnalysisManager();
+        Optional<const ObjCMethodDecl *> &Val =
+            AMgr.PrivateMethodCache[std::make_pair(IDecl, Sel)];
 
         // Query lookupPrivateMethod() if the cache does not hit.
         if (!Val.hasValue()) {
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "AnalysisSummaryCache.h"
 #include "ModelInjector.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
@@ -23,7 +24,10 @@
 #include "clang/Analysis/CodeInjector.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
@@ -33,15 +37,25 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <queue>
+#include <tuple>
 #include <utility>
 
 using namespace clang;
@@ -59,6 +73,9 @@ STATISTIC(NumBlocksInAnalyzedFunctions,
                       "The # of basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(NumFunctionsReused,
+                      "The # of functions whose analysis results were reused "
+                      "from the summary cache.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -101,6 +118,13 @@ public:
     IncludePath = true;
   }
 
+  /// \brief Report the path diagnostics collected so far, and start
+  /// collecting new ones.
+  void flushCollectedDiagnostics() {
+    FlushDiagnostics(nullptr);
+    flushed = false;
+  }
+
   void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
                             FilesMade *filesMade) override {
     unsigned WarnID = Diag.getCustomDiagID(DiagnosticsEngine::Warning, "%0");
@@ -141,10 +165,119 @@ public:
 };
 } // end anonymous namespace
 
+//===----------------------------------------------------------------------===//
+// Stored diagnostics.
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// \brief Stores the diagnostics of the analyzer reported to a
+/// DiagnosticsEngine, so that they can be reported again later on, possibly
+/// by another compiler instance.
+///
+/// The diagnostics of the parser are dropped, as the compiler instance that
+/// reports the stored diagnostics reports them as well.
+class StoringDiagnosticConsumer : public DiagnosticConsumer {
+  std::vector<StoredAnalyzerDiagnostic> &Diagnostics;
+
+  static StoredLocation getStoredLocation(const SourceManager &SM,
+                                          SourceLocation Loc) {
+    StoredLocation Result;
+    if (Loc.isInvalid())
+      return Result;
+    std::pair<FileID, unsigned> Decomposed =
+        SM.getDecomposedLoc(SM.getExpansionLoc(Loc));
+    if (const FileEntry *FE = SM.getFileEntryForID(Decomposed.first)) {
+      Result.File = FE->getName().str();
+      Result.Line = SM.getLineNumber(Decomposed.first, Decomposed.second);
+      Result.Column = SM.getColumnNumber(Decomposed.first, Decomposed.second);
+    }
+    return Result;
+  }
+
+public:
+  StoringDiagnosticConsumer(std::vector<StoredAnalyzerDiagnostic> &Diagnostics)
+      : Diagnostics(Diagnostics) {}
+
+  void HandleDiagnostic(DiagnosticsEngine::Level Level,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(Level, Info);
+
+    // The analyzer reports its diagnostics with custom IDs. Keep errors as
+    // well, in case an analysis worker did not see the same sources.
+    if (Info.getID() < diag::DIAG_UPPER_LIMIT &&
+        Level < DiagnosticsEngine::Error)
+      return;
+
+    StoredAnalyzerDiagnostic D;
+    D.Level = Level;
+    SmallString<128> Message;
+    Info.FormatDiagnostic(Message);
+    D.Message = Message.str();
+    if (Info.hasSourceManager()) {
+      const SourceManager &SM = Info.getSourceManager();
+      D.Location = getStoredLocation(SM, Info.getLocation());
+      for (const CharSourceRange &R : Info.getRanges()) {
+        StoredAnalyzerDiagnostic::Range Stored;
+        Stored.Begin = getStoredLocation(SM, R.getBegin());
+        Stored.End = getStoredLocation(SM, R.getEnd());
+        Stored.IsTokenRange = R.isTokenRange();
+        D.Ranges.push_back(std::move(Stored));
+      }
+    }
+    Diagnostics.push_back(std::move(D));
+  }
+};
+} // end anonymous namespace
+
+static SourceLocation getSourceLocation(SourceManager &SM,
+                                        const StoredLocation &Loc) {
+  if (Loc.File.empty())
+    return SourceLocation();
+  const FileEntry *FE = SM.getFileManager().getFile(Loc.File);
+  if (!FE)
+    return SourceLocation();
+  return SM.translateFileLineCol(FE, Loc.Line, Loc.Column);
+}
+
+/// \brief Report the stored diagnostic \p D to \p Diags, translating its
+/// locations to the source manager of \p Diags.
+static void reportStoredDiagnostic(DiagnosticsEngine &Diags,
+                                   const StoredAnalyzerDiagnostic &D) {
+  SourceManager &SM = Diags.getSourceManager();
+  DiagnosticBuilder DB = Diags.Report(getSourceLocation(SM, D.Location),
+                                      Diags.getCustomDiagID(D.Level, "%0"));
+  DB << D.Message;
+  for (const StoredAnalyzerDiagnostic::Range &R : D.Ranges) {
+    SourceLocation Begin = getSourceLocation(SM, R.Begin);
+    SourceLocation End = getSourceLocation(SM, R.End);
+    if (Begin.isValid() && End.isValid())
+      DB << CharSourceRange(SourceRange(Begin, End), R.IsTokenRange);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer declaration.
 //===----------------------------------------------------------------------===//
 
+/// \brief Returns true if the results of the analysis can be cached in the
+/// summary cache.
+static bool canUseSummaryCache(const AnalyzerOptions &Opts,
+                               const std::string &OutDir,
+                               const Preprocessor &PP) {
+  // The cached diagnostics are reported as clang diagnostics. The other
+  // consumers need the AST nodes along the path, which are not stored.
+  if (Opts.AnalysisDiagOpt == PD_NONE ||
+      (Opts.AnalysisDiagOpt != PD_TEXT && !OutDir.empty()))
+    return false;
+
+  // The key of a summary does not cover the declarations which come from a
+  // PCH or a module, nor the definitions injected from model files.
+  if (PP.getLangOpts().Modules ||
+      !PP.getPreprocessorOpts().ImplicitPCHInclude.empty())
+    return false;
+  return !Opts.Config.count("model-path");
+}
+
 namespace {
 
 class AnalysisConsumer : public AnalysisASTConsumer,
@@ -179,6 +312,35 @@ public:
   // Set of PathDiagnosticConsumers.  Owned by AnalysisManager.
   PathDiagnosticConsumers PathConsumers;
 
+  /// \brief The consumer which reports the path diagnostics as clang
+  /// diagnostics, if any.
+  ClangDiagPathDiagConsumer *ClangDiags;
+
+  /// \brief The cache of the results of the path-sensitive analysis of the
+  /// top-level functions, if the 'summary-cache-dir' config option is set.
+  std::unique_ptr<AnalysisSummaryCache> SummaryCache;
+
+  /// \brief The digest of the options of the analysis, which is part of the
+  /// key of every summary.
+  std::string ConfigurationDigest;
+
+  /// \brief Whether the summary cache is used for the functions of this
+  /// translation unit; see HandleDeclsCallGraph.
+  bool UseSummaryCache;
+
+  /// \brief The digests of the function definitions, and of the other
+  /// declarations the functions refer to, computed on demand.
+  llvm::DenseMap<const Decl *, std::string> FunctionDigests;
+  llvm::DenseMap<const Decl *, std::string> ContextDigests;
+
+  /// \brief When the summary cache is used, the path diagnostics are reported
+  /// to RecordingDiags, which stores them in RecordedDiagnostics, so that they
+  /// can be attributed to the function whose analysis produced them. They
+  /// are reported to the DiagnosticsEngine of the preprocessor at the end of
+  /// the translation unit.
+  std::vector<StoredAnalyzerDiagnostic> RecordedDiagnostics;
+  std::unique_ptr<DiagnosticsEngine> RecordingDiags;
+
   StoreManagerCreator CreateStoreMgr;
   ConstraintManagerCreator CreateConstraintMgr;
 
@@ -192,12 +354,25 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// \brief The partition of the call graph analyzed by this consumer, and
+  /// the number of partitions. The partitions other than the first one are
+  /// analyzed by workers; see AnalysisWorkers.
+  unsigned WorkerIndex;
+  unsigned NumWorkers;
+
+  /// \brief What the workers need to re-parse the translation unit. Only set
+  /// in the consumer analyzing the first partition.
+  std::shared_ptr<CompilerInvocation> WorkerInvocation;
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps;
+  IntrusiveRefCntPtr<vfs::FileSystem> VFS;
+
   AnalysisConsumer(const Preprocessor &pp, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
                    CodeInjector *injector)
       : RecVisitorMode(0), RecVisitorBR(nullptr), Ctx(nullptr), PP(pp),
         OutDir(outdir), Opts(std::move(opts)), Plugins(plugins),
-        Injector(injector) {
+        Injector(injector), ClangDiags(nullptr), UseSummaryCache(false),
+        WorkerIndex(0), NumWorkers(1) {
     DigestAnalyzerOptions();
     if (Opts->PrintStats) {
       llvm::EnableStatistics(false);
@@ -213,14 +388,26 @@ public:
   }
 
   void DigestAnalyzerOptions() {
+    StringRef SummaryCacheDir = Opts->Config.lookup("summary-cache-dir");
+    // With the inlining mode 'all', the inlined functions are not recorded,
+    // so they cannot be stored in a summary.
+    if (!SummaryCacheDir.empty() && canUseSummaryCache(*Opts, OutDir, PP) &&
+        Opts->InliningMode != All) {
+      SummaryCache = llvm::make_unique<AnalysisSummaryCache>(SummaryCacheDir);
+      RecordingDiags = llvm::make_unique<DiagnosticsEngine>(
+          PP.getDiagnostics().getDiagnosticIDs(), new DiagnosticOptions(),
+          new StoringDiagnosticConsumer(RecordedDiagnostics));
+      RecordingDiags->setSourceManager(&PP.getSourceManager());
+    }
+
     if (Opts->AnalysisDiagOpt != PD_NONE) {
       // Create the PathDiagnosticConsumer.
-      ClangDiagPathDiagConsumer *clangDiags =
-          new ClangDiagPathDiagConsumer(PP.getDiagnostics());
-      PathConsumers.push_back(clangDiags);
+      ClangDiags = new ClangDiagPathDiagConsumer(
+          RecordingDiags ? *RecordingDiags : PP.getDiagnostics());
+      PathConsumers.push_back(ClangDiags);
 
       if (Opts->AnalysisDiagOpt == PD_TEXT) {
-        clangDiags->enablePaths();
+        ClangDiags->enablePaths();
 
       } else if (!OutDir.empty()) {
         switch (Opts->AnalysisDiagOpt) {
@@ -324,6 +511,12 @@ public:
   void RunPathSensitiveChecks(Decl *D,
                               ExprEngine::InliningModes IMode,
                               SetOfConstDecls *VisitedCallees);
+
+  /// \brief Run the path-sensitive analysis of the top-level function \p N
+  /// as HandleCode does, unless the summary cache has its results.
+  void HandleCodeWithSummaryCache(const CallGraphNode *N,
+                                  ExprEngine::InliningModes IMode,
+                                  SetOfConstDecls &VisitedCallees);
   void ActionExprEngine(Decl *D, bool ObjCGCEnabled,
                         ExprEngine::InliningModes IMode,
                         SetOfConstDecls *VisitedCallees);
@@ -382,6 +575,18 @@ private:
   void storeTopLevelDecls(DeclGroupRef DG);
   std::string getFunctionName(const Decl *D);
 
+  std::string getFunctionDigest(const Decl *D);
+  std::string getContextDigest(const Decl *D);
+
+  /// \brief Compute the key of the summary of the analysis of \p N, and
+  /// collect the functions reachable from it in the call graph, which the
+  /// summary refers to by index. Returns false if the analysis of the
+  /// function cannot be summarized.
+  bool getSummaryKey(const CallGraphNode *N, ExprEngine::InliningModes IMode,
+                     std::vector<const Decl *> &Reachable, std::string &Key);
+
+  void reportRecordedDiagnostics(DiagnosticsEngine &Diags);
+
   /// \brief Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
 
@@ -389,6 +594,323 @@ private:
 } // end anonymous namespace
 
 
+//===----------------------------------------------------------------------===//
+// Parallel analysis.
+//===----------------------------------------------------------------------===//
+
+static std::unique_ptr<AnalysisConsumer>
+createAnalysisConsumer(CompilerInstance &CI);
+
+namespace {
+/// \brief Parses the main file, and analyzes one partition of its call graph.
+class AnalysisWorkerAction : public ASTFrontendAction {
+  unsigned WorkerIndex;
+  unsigned NumWorkers;
+
+public:
+  AnalysisWorkerAction(unsigned WorkerIndex, unsigned NumWorkers)
+      : WorkerIndex(WorkerIndex), NumWorkers(NumWorkers) {}
+
+protected:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override {
+    std::unique_ptr<AnalysisConsumer> Consumer = createAnalysisConsumer(CI);
+    Consumer->WorkerIndex = WorkerIndex;
+    Consumer->NumWorkers = NumWorkers;
+    return std::move(Consumer);
+  }
+};
+
+/// \brief Analyzes the partitions of the call graph of a translation unit
+/// other than the first one on separate threads.
+///
+/// The AST is not shared with the workers: the analysis builds CFGs and
+/// synthesizes function bodies in the ASTContext, and the checkers and the
+/// path diagnostic consumers are not thread-safe. Instead, each worker
+/// re-parses the translation unit in its own CompilerInstance, and runs an
+/// AnalysisConsumer that only analyzes its partition. The diagnostics of the
+/// workers are reported through the main DiagnosticsEngine after they are
+/// done, in the order of the partitions, so the output does not depend on
+/// how the workers were scheduled.
+class AnalysisWorkers {
+  std::vector<std::vector<StoredAnalyzerDiagnostic>> Diagnostics;
+  llvm::ThreadPool Pool;
+
+  static void runWorker(const CompilerInvocation &Invocation,
+                        std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                        IntrusiveRefCntPtr<vfs::FileSystem> VFS,
+                        unsigned WorkerIndex, unsigned NumWorkers,
+                        std::vector<StoredAnalyzerDiagnostic> &Diagnostics) {
+    CompilerInstance Instance(std::move(PCHContainerOps));
+    Instance.setInvocation(std::make_shared<CompilerInvocation>(Invocation));
+    Instance.createDiagnostics(
+        new StoringDiagnosticConsumer(Diagnostics),
+        /*ShouldOwnClient=*/true);
+    Instance.setVirtualFileSystem(VFS);
+    AnalysisWorkerAction Action(WorkerIndex, NumWorkers);
+    Instance.ExecuteAction(Action);
+  }
+
+public:
+  AnalysisWorkers(std::shared_ptr<const CompilerInvocation> Invocation,
+                  std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                  IntrusiveRefCntPtr<vfs::FileSystem> VFS, unsigned NumWorkers)
+      : Diagnostics(NumWorkers - 1), Pool(NumWorkers - 1) {
+    for (unsigned I = 1; I != NumWorkers; ++I) {
+      std::vector<StoredAnalyzerDiagnostic> &WorkerDiagnostics =
+          Diagnostics[I - 1];
+      Pool.async([=, &WorkerDiagnostics] {
+        runWorker(*Invocation, PCHContainerOps, VFS, I, NumWorkers,
+                  WorkerDiagnostics);
+      });
+    }
+  }
+
+  /// \brief Wait for the workers to finish, and report their diagnostics to
+  /// \p Diags.
+  void reportDiagnostics(DiagnosticsEngine &Diags) {
+    Pool.wait();
+    for (const auto &WorkerDiagnostics : Diagnostics)
+      for (const StoredAnalyzerDiagnostic &D : WorkerDiagnostics)
+        reportStoredDiagnostic(Diags, D);
+  }
+};
+} // end anonymous namespace
+
+namespace {
+/// \brief Finds the calls of a function for which the call graph has no edge.
+///
+/// The callees of the implicit calls of C++ constructors, destructors and
+/// allocation functions are collected. The other calls, whose callee is only
+/// known while analyzing the caller, are calls through function, block and
+/// member pointers, virtual calls and Objective-C messages. Also collects the
+/// functions referenced other than by calling them, which may be called
+/// through a pointer anywhere.
+class HiddenCallFinder : public RecursiveASTVisitor<HiddenCallFinder> {
+  llvm::SmallPtrSet<const Expr *, 16> DirectCallees;
+
+  void addDestructor(QualType T) {
+    if (const CXXRecordDecl *RD =
+            T->getBaseElementTypeUnsafe()->getAsCXXRecordDecl())
+      if (RD->hasDefinition() && !RD->hasTrivialDestructor())
+        addCallee(RD->getDestructor());
+  }
+
+  void addCallee(const FunctionDecl *FD) {
+    if (!FD)
+      return;
+    if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+      if (MD->isVirtual())
+        HasUnknownCallees = true;
+    ImplicitCallees.push_back(FD);
+  }
+
+public:
+  /// Whether the function makes calls whose callee is only known while
+  /// analyzing it.
+  bool HasUnknownCallees;
+  std::vector<const FunctionDecl *> ImplicitCallees;
+  llvm::SmallPtrSet<const Decl *, 16> AddressTaken;
+
+  HiddenCallFinder() : HasUnknownCallees(false) {}
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+  /// Adds the implicit destructions of the members and bases of a class to
+  /// the callees of its destructor.
+  void addMemberDestructors(const CXXDestructorDecl *DD) {
+    const CXXRecordDecl *RD = DD->getParent();
+    for (const CXXBaseSpecifier &Base : RD->bases())
+      addDestructor(Base.getType());
+    for (const CXXBaseSpecifier &Base : RD->vbases())
+      addDestructor(Base.getType());
+    for (const FieldDecl *FD : RD->fields())
+      addDestructor(FD->getType());
+  }
+
+  bool VisitCallExpr(CallExpr *CE) {
+    const Expr *Callee = CE->getCallee()->IgnoreParenImpCasts();
+    if (isa<BlockExpr>(Callee))
+      return true;
+    const FunctionDecl *FD = CE->getDirectCallee();
+    if (!FD) {
+      HasUnknownCallees = true;
+      return true;
+    }
+    if (const auto *MD = dyn_cast<CXXMethodDecl>(FD))
+      if (MD->isVirtual())
+        HasUnknownCallees = true;
+    DirectCallees.insert(Callee);
+    return true;
+  }
+
+  bool VisitDeclRefExpr(DeclRefExpr *DRE) {
+    if (const auto *FD = dyn_cast<FunctionDecl>(DRE->getDecl()))
+      if (!DirectCallees.count(DRE))
+        AddressTaken.insert(FD->getCanonicalDecl());
+    return true;
+  }
+
+  bool VisitVarDecl(VarDecl *VD) {
+    if (!VD->getType()->isReferenceType())
+      addDestructor(VD->getType());
+    return true;
+  }
+
+  bool VisitCXXConstructExpr(CXXConstructExpr *CE) {
+    addCallee(CE->getConstructor());
+    return true;
+  }
+
+  bool VisitCXXInheritedCtorInitExpr(CXXInheritedCtorInitExpr *E) {
+    addCallee(E->getConstructor());
+    return true;
+  }
+
+  bool VisitCXXBindTemporaryExpr(CXXBindTemporaryExpr *E) {
+    addCallee(E->getTemporary()->getDestructor());
+    return true;
+  }
+
+  bool VisitCXXNewExpr(CXXNewExpr *E) {
+    addCallee(E->getOperatorNew());
+    addCallee(E->getOperatorDelete());
+    return true;
+  }
+
+  bool VisitCXXDeleteExpr(CXXDeleteExpr *E) {
+    addCallee(E->getOperatorDelete());
+    if (!E->getDestroyedType().isNull())
+      addDestructor(E->getDestroyedType());
+    return true;
+  }
+
+  bool VisitObjCMessageExpr(ObjCMessageExpr *) { return setUnknown(); }
+  bool VisitObjCPropertyRefExpr(ObjCPropertyRefExpr *) { return setUnknown(); }
+  bool VisitObjCSubscriptRefExpr(ObjCSubscriptRefExpr *) {
+    return setUnknown();
+  }
+  bool VisitObjCBoxedExpr(ObjCBoxedExpr *) { return setUnknown(); }
+  bool VisitObjCArrayLiteral(ObjCArrayLiteral *) { return setUnknown(); }
+  bool VisitObjCDictionaryLiteral(ObjCDictionaryLiteral *) {
+    return setUnknown();
+  }
+  bool VisitObjCForCollectionStmt(ObjCForCollectionStmt *) {
+    return setUnknown();
+  }
+
+private:
+  bool setUnknown() {
+    HasUnknownCallees = true;
+    return true;
+  }
+};
+} // end anonymous namespace
+
+/// \brief Returns true if \p D may be called through an edge whose callee is
+/// only known while analyzing the caller, other than through a pointer to it.
+static bool mayBeCalledIndirectly(const Decl *D) {
+  if (isa<BlockDecl>(D) || isa<ObjCMethodDecl>(D))
+    return true;
+  if (const auto *MD = dyn_cast<CXXMethodDecl>(D))
+    return MD->isVirtual();
+  return false;
+}
+
+/// \brief Split the call graph into its weakly connected components, and
+/// assign them to \p NumWorkers workers so that each gets about the same
+/// number of functions. Returns the functions assigned to \p WorkerIndex.
+///
+/// A function and the functions it calls always end up in the same
+/// partition, so a worker inlines them and skips them afterwards just as the
+/// serial analysis does. The call graph only has edges for direct calls, so
+/// the implicit calls of C++ special members are added, and the other calls
+/// are over-approximated: the functions which make calls through pointers,
+/// virtual calls or Objective-C messages or take the address of a function,
+/// and the functions which may be called that way, are all put in one
+/// component. The assignment only depends on the AST and on the order of
+/// \p Nodes, which are the same in every worker.
+static SetOfConstDecls
+getCallGraphPartition(ASTContext &C, ArrayRef<const CallGraphNode *> Nodes,
+                      unsigned WorkerIndex, unsigned NumWorkers) {
+  HiddenCallFinder TUFinder;
+  TUFinder.TraverseDecl(C.getTranslationUnitDecl());
+
+  // The nodes are keyed by the canonical declarations.
+  llvm::DenseMap<const Decl *, const CallGraphNode *> NodeForDecl;
+  for (const CallGraphNode *N : Nodes)
+    if (N->getDecl())
+      NodeForDecl[N->getDecl()] = N;
+
+  llvm::EquivalenceClasses<const CallGraphNode *> Components;
+  const CallGraphNode *Unknown = nullptr;
+  for (const CallGraphNode *N : Nodes) {
+    // Skip the abstract root node, which calls every function.
+    Decl *D = N->getDecl();
+    if (!D)
+      continue;
+    Components.insert(N);
+    for (const CallGraphNode *Callee : *N)
+      Components.unionSets(N, Callee);
+
+    HiddenCallFinder Finder;
+    if (const auto *DD = dyn_cast<CXXDestructorDecl>(D))
+      Finder.addMemberDestructors(DD);
+    Finder.TraverseDecl(D);
+    for (const FunctionDecl *Callee : Finder.ImplicitCallees) {
+      auto It = NodeForDecl.find(Callee->getCanonicalDecl());
+      if (It != NodeForDecl.end())
+        Components.unionSets(N, It->second);
+    }
+    if (Finder.HasUnknownCallees || !Finder.AddressTaken.empty() ||
+        mayBeCalledIndirectly(D) ||
+        TUFinder.AddressTaken.count(D->getCanonicalDecl())) {
+      if (Unknown)
+        Components.unionSets(Unknown, N);
+      else
+        Unknown = N;
+    }
+  }
+
+  // Number the components in the order of their first function, and count
+  // their functions.
+  llvm::DenseMap<const CallGraphNode *, unsigned> ComponentIndex;
+  std::vector<unsigned> ComponentSize;
+  for (const CallGraphNode *N : Nodes) {
+    if (!N->getDecl())
+      continue;
+    auto Inserted = ComponentIndex.insert(
+        std::make_pair(Components.getLeaderValue(N), ComponentSize.size()));
+    if (Inserted.second)
+      ComponentSize.push_back(0);
+    ++ComponentSize[Inserted.first->second];
+  }
+
+  // Give the largest remaining component to the least loaded worker.
+  std::vector<unsigned> BySize(ComponentSize.size());
+  for (unsigned I = 0, E = BySize.size(); I != E; ++I)
+    BySize[I] = I;
+  std::stable_sort(BySize.begin(), BySize.end(), [&](unsigned A, unsigned B) {
+    return ComponentSize[A] > ComponentSize[B];
+  });
+  std::vector<unsigned> Load(NumWorkers);
+  std::vector<unsigned> ComponentWorker(ComponentSize.size());
+  for (unsigned C : BySize) {
+    auto Worker = std::min_element(Load.begin(), Load.end());
+    ComponentWorker[C] = Worker - Load.begin();
+    *Worker += ComponentSize[C];
+  }
+
+  SetOfConstDecls Partition;
+  for (const CallGraphNode *N : Nodes)
+    if (N->getDecl() &&
+        ComponentWorker[ComponentIndex[Components.getLeaderValue(N)]] ==
+            WorkerIndex)
+      Partition.insert(N->getDecl());
+  return Partition;
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisConsumer implementation.
 //===----------------------------------------------------------------------===//
@@ -457,6 +979,282 @@ AnalysisConsumer::getInliningModeForFunction(const Decl *D,
   return ExprEngine::Inline_Regular;
 }
 
+static std::string getDigest(StringRef Data) {
+  llvm::MD5 Hash;
+  Hash.update(Data);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return Digest.str();
+}
+
+namespace {
+/// \brief Collects the declarations outside of a set of function definitions
+/// that the analysis of the functions may depend on: the types, variables,
+/// enumerators and functions they refer to, and transitively the ones which
+/// those declarations refer to.
+class ContextCollector : public RecursiveASTVisitor<ContextCollector> {
+public:
+  llvm::SetVector<const Decl *> Decls;
+
+  /// \brief Collect the declarations that the definition \p D refers to.
+  void addDefinition(const Decl *D) { TraverseDecl(const_cast<Decl *>(D)); }
+
+  bool VisitDeclRefExpr(DeclRefExpr *E) {
+    addDecl(E->getDecl());
+    return true;
+  }
+
+  bool VisitExpr(Expr *E) {
+    TraverseType(E->getType());
+    return true;
+  }
+
+  bool VisitTagType(TagType *T) {
+    addDecl(T->getDecl());
+    return true;
+  }
+
+  bool VisitTypedefType(TypedefType *T) {
+    addDecl(T->getDecl());
+    return true;
+  }
+
+  bool VisitObjCInterfaceType(ObjCInterfaceType *T) {
+    addDecl(T->getDecl());
+    return true;
+  }
+
+private:
+  void addDecl(const Decl *D) {
+    if (const auto *ECD = dyn_cast<EnumConstantDecl>(D))
+      D = cast<Decl>(ECD->getDeclContext());
+
+    // The local declarations are part of the function definitions.
+    if (!D->getDeclContext()->getRedeclContext()->isFileContext())
+      return;
+
+    if (const auto *TD = dyn_cast<TagDecl>(D))
+      if (const TagDecl *Definition = TD->getDefinition())
+        D = Definition;
+    if (const auto *ID = dyn_cast<ObjCInterfaceDecl>(D))
+      if (const ObjCInterfaceDecl *Definition = ID->getDefinition())
+        D = Definition;
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      D = FD->getMostRecentDecl();
+    if (!Decls.insert(D))
+      return;
+
+    // The body of a function only matters if the function is inlined, and
+    // then it is one of the definitions.
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      TraverseType(FD->getType());
+    else
+      TraverseDecl(const_cast<Decl *>(D));
+  }
+};
+} // end anonymous namespace
+
+/// \brief Returns a digest of the declaration \p D, which is not a function
+/// definition that may be inlined. Function bodies are left out unless they
+/// are members of a class.
+std::string AnalysisConsumer::getContextDigest(const Decl *D) {
+  std::string &Digest = ContextDigests[D];
+  if (!Digest.empty())
+    return Digest;
+
+  std::string Str;
+  llvm::raw_string_ostream OS(Str);
+  PrintingPolicy Policy(Ctx->getLangOpts());
+  Policy.TerseOutput = isa<FunctionDecl>(D);
+  D->print(OS, Policy);
+
+  Digest = getDigest(OS.str());
+  return Digest;
+}
+
+/// \brief Returns a digest of the definition of the function \p D, and of its
+/// location, which the locations of the diagnostics depend on.
+std::string AnalysisConsumer::getFunctionDigest(const Decl *D) {
+  std::string &Digest = FunctionDigests[D];
+  if (!Digest.empty())
+    return Digest;
+
+  if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+    const FunctionDecl *Definition;
+    if (FD->hasBody(Definition))
+      D = Definition;
+  }
+
+  std::string Str;
+  llvm::raw_string_ostream OS(Str);
+  const SourceManager &SM = Ctx->getSourceManager();
+  CharSourceRange Range = CharSourceRange::getTokenRange(D->getSourceRange());
+  PresumedLoc Loc = SM.getPresumedLoc(SM.getExpansionLoc(Range.getBegin()));
+  if (Loc.isValid())
+    OS << Loc.getFilename() << ':' << Loc.getLine() << ':' << Loc.getColumn()
+       << '\n';
+
+  // The source text determines the locations within the function, and the
+  // AST what the macros it uses expand to.
+  OS << Lexer::getSourceText(Range, SM, Ctx->getLangOpts()) << '\n';
+  D->print(OS, PrintingPolicy(Ctx->getLangOpts()));
+
+  Digest = getDigest(OS.str());
+  return Digest;
+}
+
+bool AnalysisConsumer::getSummaryKey(const CallGraphNode *N,
+                                     ExprEngine::InliningModes IMode,
+                                     std::vector<const Decl *> &Reachable,
+                                     std::string &Key) {
+  std::string Str;
+  llvm::raw_string_ostream OS(Str);
+  OS << ConfigurationDigest << '\n' << IMode << '\n';
+
+  // The functions the analysis may inline are the ones reachable from N. The
+  // order in which they are visited only depends on the call graph.
+  SmallVector<const CallGraphNode *, 16> Worklist(1, N);
+  llvm::SmallPtrSet<const CallGraphNode *, 16> Seen;
+  while (!Worklist.empty()) {
+    const CallGraphNode *Node = Worklist.pop_back_val();
+    if (!Seen.insert(Node).second)
+      continue;
+
+    // Blocks cannot be printed on their own.
+    const Decl *D = Node->getDecl();
+    if (!isa<FunctionDecl>(D) && !isa<ObjCMethodDecl>(D))
+      return false;
+
+    Reachable.push_back(D);
+    OS << getFunctionDigest(D) << '\n';
+    Worklist.append(Node->begin(), Node->end());
+  }
+
+  // The analysis also depends on the declarations the functions refer to,
+  // such as the layout of a struct or the initializer of a constant.
+  ContextCollector Collector;
+  for (const Decl *D : Reachable)
+    Collector.addDefinition(D);
+  llvm::SmallPtrSet<const Decl *, 16> Definitions;
+  for (const Decl *D : Reachable) {
+    Definitions.insert(D);
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      Definitions.insert(FD->getMostRecentDecl());
+  }
+  for (const Decl *D : Collector.Decls)
+    if (!Definitions.count(D))
+      OS << getContextDigest(D) << '\n';
+
+  Key = getDigest(OS.str());
+  return true;
+}
+
+void AnalysisConsumer::HandleCodeWithSummaryCache(
+    const CallGraphNode *N, ExprEngine::InliningModes IMode,
+    SetOfConstDecls &VisitedCallees) {
+  Decl *D = N->getDecl();
+  if (!(getModeForDecl(D, AM_Path) & AM_Path))
+    return;
+
+  std::vector<const Decl *> Reachable;
+  std::string Key;
+  if (!getSummaryKey(N, IMode, Reachable, Key)) {
+    HandleCode(D, AM_Path, IMode, &VisitedCallees);
+    return;
+  }
+
+  AnalysisSummary Summary;
+  if (SummaryCache->lookup(Key, Summary) &&
+      std::all_of(Summary.InlinedCallees.begin(), Summary.InlinedCallees.end(),
+                  [&](unsigned I) { return I < Reachable.size(); })) {
+    for (unsigned I : Summary.InlinedCallees)
+      VisitedCallees.insert(Reachable[I]);
+    RecordedDiagnostics.insert(RecordedDiagnostics.end(),
+                               Summary.Diagnostics.begin(),
+                               Summary.Diagnostics.end());
+    NumFunctionsReused++;
+    return;
+  }
+
+  // Record the diagnostics reported so far, so that the ones reported from
+  // now on are those of the analysis of D.
+  ClangDiags->flushCollectedDiagnostics();
+  size_t FirstDiagnostic = RecordedDiagnostics.size();
+  HandleCode(D, AM_Path, IMode, &VisitedCallees);
+  ClangDiags->flushCollectedDiagnostics();
+
+  // A function inlined through a call the call graph does not know about,
+  // such as a call to a constructor, is not part of the key.
+  llvm::DenseMap<const Decl *, unsigned> ReachableIndex;
+  for (unsigned I = 0, E = Reachable.size(); I != E; ++I)
+    ReachableIndex[Reachable[I]] = I;
+  for (const Decl *Callee : VisitedCallees) {
+    auto It = ReachableIndex.find(isa<ObjCMethodDecl>(Callee)
+                                      ? Callee
+                                      : Callee->getCanonicalDecl());
+    if (It == ReachableIndex.end())
+      return;
+    Summary.InlinedCallees.push_back(It->second);
+  }
+  std::sort(Summary.InlinedCallees.begin(), Summary.InlinedCallees.end());
+
+  Summary.Diagnostics.assign(RecordedDiagnostics.begin() + FirstDiagnostic,
+                             RecordedDiagnostics.end());
+  SummaryCache->store(Key, Summary);
+}
+
+/// \brief Report the recorded diagnostics sorted by location. A warning which
+/// was found by the analysis of several functions is only reported once, with
+/// the shortest path, just as the path diagnostic consumer would have if it
+/// had seen all of them at once. If the summary cache was not used after all,
+/// the diagnostics are reported as they were recorded.
+void AnalysisConsumer::reportRecordedDiagnostics(DiagnosticsEngine &Diags) {
+  if (!UseSummaryCache) {
+    for (const StoredAnalyzerDiagnostic &D : RecordedDiagnostics)
+      reportStoredDiagnostic(Diags, D);
+    return;
+  }
+
+  // Split the diagnostics into the warnings and the notes that follow them.
+  std::vector<ArrayRef<StoredAnalyzerDiagnostic>> Warnings;
+  ArrayRef<StoredAnalyzerDiagnostic> Recorded(RecordedDiagnostics);
+  while (!Recorded.empty()) {
+    size_t Size = 1;
+    while (Size != Recorded.size() &&
+           Recorded[Size].Level == DiagnosticsEngine::Note)
+      ++Size;
+    Warnings.push_back(Recorded.take_front(Size));
+    Recorded = Recorded.drop_front(Size);
+  }
+
+  typedef std::tuple<StringRef, unsigned, unsigned, StringRef> WarningKey;
+  auto getKey = [](ArrayRef<StoredAnalyzerDiagnostic> W) {
+    return WarningKey(W[0].Location.File, W[0].Location.Line,
+                      W[0].Location.Column, W[0].Message);
+  };
+
+  std::map<WarningKey, size_t> Index;
+  std::vector<ArrayRef<StoredAnalyzerDiagnostic>> Unique;
+  for (ArrayRef<StoredAnalyzerDiagnostic> W : Warnings) {
+    auto Inserted = Index.insert(std::make_pair(getKey(W), Unique.size()));
+    if (Inserted.second)
+      Unique.push_back(W);
+    else if (W.size() < Unique[Inserted.first->second].size())
+      Unique[Inserted.first->second] = W;
+  }
+
+  std::stable_sort(Unique.begin(), Unique.end(),
+                   [&](ArrayRef<StoredAnalyzerDiagnostic> A,
+                       ArrayRef<StoredAnalyzerDiagnostic> B) {
+                     return getKey(A) < getKey(B);
+                   });
+  for (ArrayRef<StoredAnalyzerDiagnostic> W : Unique)
+    for (const StoredAnalyzerDiagnostic &D : W)
+      reportStoredDiagnostic(Diags, D);
+}
+
 void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // Build the Call Graph by adding all the top level declarations to the graph.
   // Note: CallGraph can trigger deserialization of more items from a pch
@@ -476,6 +1274,20 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+
+  // When the analysis is split between workers, only analyze the functions
+  // in the partition of this one.
+  SetOfConstDecls Partition;
+  if (NumWorkers > 1) {
+    std::vector<const CallGraphNode *> Nodes(RPOT.begin(), RPOT.end());
+    Partition = getCallGraphPartition(*Ctx, Nodes, WorkerIndex, NumWorkers);
+  }
+
+  // The summaries record the functions which were inlined, and the
+  // diagnostics reported by the clang diagnostics consumer. Other consumers
+  // can be added by AddDiagnosticConsumer.
+  UseSummaryCache = SummaryCache && ClangDiags && PathConsumers.size() == 1;
+
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -487,6 +1299,9 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    if (NumWorkers > 1 && !Partition.count(D))
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -494,9 +1309,14 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
 
     // Analyze the function.
     SetOfConstDecls VisitedCallees;
+    ExprEngine::InliningModes IMode = getInliningModeForFunction(D, Visited);
 
-    HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
-               (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
+    if (UseSummaryCache)
+      HandleCodeWithSummaryCache(N, IMode, VisitedCallees);
+    else
+      HandleCode(D, AM_Path, IMode,
+                 (Mgr->options.InliningMode == All ? nullptr
+                                                   : &VisitedCallees));
 
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
@@ -519,48 +1339,70 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
   if (Opts->DisableAllChecks)
     return;
 
+  // Only the path-sensitive analysis of the call graph is split between
+  // workers. Without inlining, it is run while visiting the AST instead.
+  std::unique_ptr<AnalysisWorkers> Workers;
+  if (!Mgr->shouldInlineCall())
+    NumWorkers = 1;
+  else if (WorkerInvocation)
+    Workers = llvm::make_unique<AnalysisWorkers>(WorkerInvocation,
+                                                 PCHContainerOps, VFS,
+                                                 NumWorkers);
+
   {
     if (TUTotalTimer) TUTotalTimer->startTimer();
 
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-
-    // Run the AST-only checks using the order in which functions are defined.
-    // If inlining is not turned on, use the simplest function order for path
-    // sensitive analyzes as well.
-    RecVisitorMode = AM_Syntax;
-    if (!Mgr->shouldInlineCall())
-      RecVisitorMode |= AM_Path;
-    RecVisitorBR = &BR;
-
-    // Process all the top level declarations.
-    //
-    // Note: TraverseDecl may modify LocalTUDecls, but only by appending more
-    // entries.  Thus we don't use an iterator, but rely on LocalTUDecls
-    // random access.  By doing so, we automatically compensate for iterators
-    // possibly being invalidated, although this is a bit slower.
+
+    // The checks which are not path-sensitive are run by the first worker.
     const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-      TraverseDecl(LocalTUDecls[i]);
+    if (WorkerIndex == 0) {
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+
+      // Run the AST-only checks using the order in which functions are
+      // defined. If inlining is not turned on, use the simplest function
+      // order for path sensitive analyzes as well.
+      RecVisitorMode = AM_Syntax;
+      if (!Mgr->shouldInlineCall())
+        RecVisitorMode |= AM_Path;
+      RecVisitorBR = &BR;
+
+      // Process all the top level declarations.
+      //
+      // Note: TraverseDecl may modify LocalTUDecls, but only by appending
+      // more entries.  Thus we don't use an iterator, but rely on
+      // LocalTUDecls random access.  By doing so, we automatically compensate
+      // for iterators possibly being invalidated, although this is a bit
+      // slower.
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+        TraverseDecl(LocalTUDecls[i]);
+      }
     }
 
     if (Mgr->shouldInlineCall())
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (WorkerIndex == 0)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
     RecVisitorBR = nullptr;
   }
 
+  if (Workers)
+    Workers->reportDiagnostics(Diags);
+
   // Explicitly destroy the PathDiagnosticConsumer.  This will flush its output.
   // FIXME: This should be replaced with something that doesn't rely on
   // side-effects in PathDiagnosticConsumer's destructor. This is required when
   // used with option -disable-free.
   Mgr.reset();
 
+  if (RecordingDiags)
+    reportRecordedDiagnostics(Diags);
+
   if (TUTotalTimer) TUTotalTimer->stopTimer();
 
   // Count how many basic blocks we have not covered.
@@ -720,8 +1562,10 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
                       Mgr->options.getMaxNodesPerTopLevelFunction());
 
   // Release the auditor (if any) so that it doesn't monitor the graph
-  // created BugReporter.
-  ExplodedNode::SetAuditor(nullptr);
+  // created BugReporter. The auditor is global, so leave it alone otherwise
+  // in case other threads are analyzing another translation unit.
+  if (Auditor)
+    ExplodedNode::SetAuditor(nullptr);
 
   // Visualize the exploded graph.
   if (Mgr->options.visualizeExplodedGraphWithGraphViz)
@@ -755,18 +1599,126 @@ void AnalysisConsumer::RunPathSensitiveChecks(Decl *D,
 // AnalysisConsumer creation.
 //===----------------------------------------------------------------------===//
 
-std::unique_ptr<AnalysisASTConsumer>
-ento::CreateAnalysisConsumer(CompilerInstance &CI) {
+/// \brief Returns a digest of the options which the results of the analysis
+/// of a function depend on.
+static std::string getConfigurationDigest(CompilerInstance &CI) {
+  const AnalyzerOptions &Opts = *CI.getAnalyzerOpts();
+  std::string Str;
+  llvm::raw_string_ostream OS(Str);
+
+  // The module hash covers the compiler version, and the language, target
+  // and preprocessor options.
+  OS << CI.getInvocation().getModuleHash() << '\n';
+  for (const auto &Checker : Opts.CheckersControlList)
+    OS << Checker.first << ' ' << Checker.second << '\n';
+
+  // The checkers of a plugin change when the plugin is rebuilt.
+  for (const std::string &Plugin : CI.getFrontendOpts().Plugins) {
+    OS << "plugin " << Plugin;
+    llvm::sys::fs::file_status Status;
+    if (!llvm::sys::fs::status(Plugin, Status))
+      OS << ' ' << Status.getSize() << ' '
+         << Status.getLastModificationTime().time_since_epoch().count();
+    OS << '\n';
+  }
+
+  std::vector<std::pair<StringRef, StringRef>> Config;
+  for (const auto &Entry : Opts.Config)
+    if (Entry.getKey() != "summary-cache-dir")
+      Config.push_back(std::make_pair(Entry.getKey(), Entry.getValue()));
+  std::sort(Config.begin(), Config.end());
+  for (const auto &Entry : Config)
+    OS << Entry.first << '=' << Entry.second << '\n';
+
+  OS << Opts.AnalysisStoreOpt << ' ' << Opts.AnalysisConstraintsOpt << ' '
+     << Opts.AnalysisDiagOpt << ' ' << Opts.AnalysisPurgeOpt << ' '
+     << Opts.maxBlockVisitOnPath << ' ' << Opts.AnalyzeAll << ' '
+     << Opts.AnalyzeNestedBlocks << ' ' << Opts.eagerlyAssumeBinOpBifurcation
+     << ' ' << Opts.UnoptimizedCFG << ' ' << Opts.NoRetryExhausted << ' '
+     << Opts.InlineMaxStackDepth << ' ' << Opts.InliningMode;
+  return getDigest(OS.str());
+}
+
+static std::unique_ptr<AnalysisConsumer>
+createAnalysisConsumer(CompilerInstance &CI) {
   // Disable the effects of '-Werror' when using the AnalysisConsumer.
   CI.getPreprocessor().getDiagnostics().setWarningsAsErrors(false);
 
   AnalyzerOptionsRef analyzerOpts = CI.getAnalyzerOpts();
   bool hasModelPath = analyzerOpts->Config.count("model-path") > 0;
 
-  return llvm::make_unique<AnalysisConsumer>(
+  auto Consumer = llvm::make_unique<AnalysisConsumer>(
       CI.getPreprocessor(), CI.getFrontendOpts().OutputFile, analyzerOpts,
       CI.getFrontendOpts().Plugins,
       hasModelPath ? new ModelInjector(CI) : nullptr);
+  if (Consumer->SummaryCache)
+    Consumer->ConfigurationDigest = getConfigurationDigest(CI);
+  return Consumer;
+}
+
+/// \brief Returns true if the analysis of the translation unit \p CI
+/// compiles can be split between workers.
+static bool canAnalyzeInParallel(CompilerInstance &CI) {
+  const AnalyzerOptions &Opts = *CI.getAnalyzerOpts();
+
+  // The plist consumers write a single file for the translation unit.
+  if (Opts.AnalysisDiagOpt != PD_NONE && Opts.AnalysisDiagOpt != PD_TEXT &&
+      Opts.AnalysisDiagOpt != PD_HTML)
+    return false;
+
+  // The statistics, timers and graph visualizations are global.
+  if (Opts.PrintStats || Opts.visualizeExplodedGraphWithGraphViz ||
+      Opts.visualizeExplodedGraphWithUbiGraph)
+    return false;
+
+  // The workers have to be able to read the main file again.
+  const FrontendOptions &FEOpts = CI.getFrontendOpts();
+  if (FEOpts.Inputs.size() != 1 || !FEOpts.Inputs[0].isFile() ||
+      FEOpts.Inputs[0].getFile() == "-")
+    return false;
+  return CI.getPreprocessorOpts().RemappedFileBuffers.empty();
+}
+
+/// \brief Create the invocation the analysis workers run from the one that
+/// \p CI runs.
+static std::shared_ptr<CompilerInvocation>
+createWorkerInvocation(CompilerInstance &CI) {
+  auto Invocation = std::make_shared<CompilerInvocation>(CI.getInvocation());
+
+  // The worker reports its diagnostics to the main instance, which is the
+  // one that verifies, logs or serializes them.
+  DiagnosticOptions &DiagOpts = Invocation->getDiagnosticOpts();
+  DiagOpts.VerifyDiagnostics = false;
+  DiagOpts.ShowCarets = false;
+  DiagOpts.DiagnosticLogFile.clear();
+  DiagOpts.DiagnosticSerializationFile.clear();
+
+  Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
+
+  FrontendOptions &FEOpts = Invocation->getFrontendOpts();
+  FEOpts.DisableFree = false;
+  FEOpts.ShowStats = false;
+  FEOpts.ShowTimers = false;
+  FEOpts.StatsFile.clear();
+
+  Invocation->getAnalyzerOpts()->AnalyzerDisplayProgress = false;
+  return Invocation;
+}
+
+std::unique_ptr<AnalysisASTConsumer>
+ento::CreateAnalysisConsumer(CompilerInstance &CI) {
+  std::unique_ptr<AnalysisConsumer> Consumer = createAnalysisConsumer(CI);
+
+  unsigned NumWorkers = CI.getAnalyzerOpts()->AnalyzerThreads;
+  if (NumWorkers == 0)
+    NumWorkers = llvm::heavyweight_hardware_concurrency();
+  if (NumWorkers > 1 && canAnalyzeInParallel(CI)) {
+    Consumer->NumWorkers = NumWorkers;
+    Consumer->WorkerInvocation = createWorkerInvocation(CI);
+    Consumer->PCHContainerOps = CI.getPCHContainerOperations();
+    Consumer->VFS = &CI.getVirtualFileSystem();
+  }
+  return std::move(Consumer);
 }
 
 //===----------------------------------------------------------------------===//
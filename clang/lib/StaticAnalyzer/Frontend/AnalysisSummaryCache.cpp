@@ -0,0 +1,117 @@
+//===-- AnalysisSummaryCache.cpp --------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AnalysisSummaryCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace ento;
+
+LLVM_YAML_IS_FLOW_SEQUENCE_VECTOR(unsigned)
+LLVM_YAML_IS_SEQUENCE_VECTOR(StoredAnalyzerDiagnostic::Range)
+LLVM_YAML_IS_SEQUENCE_VECTOR(StoredAnalyzerDiagnostic)
+
+namespace llvm {
+namespace yaml {
+template <> struct ScalarEnumerationTraits<DiagnosticsEngine::Level> {
+  static void enumeration(IO &IO, DiagnosticsEngine::Level &Value) {
+    IO.enumCase(Value, "ignored", DiagnosticsEngine::Ignored);
+    IO.enumCase(Value, "note", DiagnosticsEngine::Note);
+    IO.enumCase(Value, "remark", DiagnosticsEngine::Remark);
+    IO.enumCase(Value, "warning", DiagnosticsEngine::Warning);
+    IO.enumCase(Value, "error", DiagnosticsEngine::Error);
+    IO.enumCase(Value, "fatal", DiagnosticsEngine::Fatal);
+  }
+};
+
+template <> struct MappingTraits<StoredLocation> {
+  static void mapping(IO &IO, StoredLocation &Loc) {
+    IO.mapRequired("File", Loc.File);
+    IO.mapRequired("Line", Loc.Line);
+    IO.mapRequired("Column", Loc.Column);
+  }
+};
+
+template <> struct MappingTraits<StoredAnalyzerDiagnostic::Range> {
+  static void mapping(IO &IO, StoredAnalyzerDiagnostic::Range &R) {
+    IO.mapRequired("Begin", R.Begin);
+    IO.mapRequired("End", R.End);
+    IO.mapRequired("IsTokenRange", R.IsTokenRange);
+  }
+};
+
+template <> struct MappingTraits<StoredAnalyzerDiagnostic> {
+  static void mapping(IO &IO, StoredAnalyzerDiagnostic &D) {
+    IO.mapRequired("Level", D.Level);
+    IO.mapRequired("Message", D.Message);
+    IO.mapRequired("Location", D.Location);
+    IO.mapOptional("Ranges", D.Ranges);
+  }
+};
+
+template <> struct MappingTraits<AnalysisSummary> {
+  static void mapping(IO &IO, AnalysisSummary &Summary) {
+    IO.mapOptional("InlinedCallees", Summary.InlinedCallees);
+    IO.mapOptional("Diagnostics", Summary.Diagnostics);
+  }
+};
+} // end namespace yaml
+} // end namespace llvm
+
+std::string AnalysisSummaryCache::getSummaryPath(StringRef Key) const {
+  SmallString<128> Path(Directory);
+  llvm::sys::path::append(Path, Key + ".yaml");
+  return Path.str();
+}
+
+bool AnalysisSummaryCache::lookup(StringRef Key,
+                                  AnalysisSummary &Summary) const {
+  auto Buffer = llvm::MemoryBuffer::getFile(getSummaryPath(Key));
+  if (!Buffer)
+    return false;
+
+  // A summary which is being written is never seen, as it is renamed into
+  // place, but one which was truncated by a full disk might be.
+  llvm::yaml::Input YIn((*Buffer)->getBuffer(), nullptr,
+                        [](const llvm::SMDiagnostic &, void *) {});
+  YIn >> Summary;
+  return !YIn.error();
+}
+
+void AnalysisSummaryCache::store(StringRef Key,
+                                 const AnalysisSummary &Summary) const {
+  if (llvm::sys::fs::create_directories(Directory))
+    return;
+
+  std::string Path = getSummaryPath(Key);
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%.tmp", FD, TempPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    llvm::yaml::Output YOut(OS);
+    YOut << const_cast<AnalysisSummary &>(Summary);
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
@@ -0,0 +1,88 @@
+//===-- AnalysisSummaryCache.h ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::AnalysisSummaryCache class, which
+/// stores the results of the path-sensitive analysis of top-level functions
+/// on disk, so that a later analysis of the same code can reuse them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_ANALYSISSUMMARYCACHE_H
+#define LLVM_CLANG_SA_FRONTEND_ANALYSISSUMMARYCACHE_H
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/LLVM.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace ento {
+
+/// \brief A source location which outlives the SourceManager it came from.
+struct StoredLocation {
+  std::string File;
+  unsigned Line;
+  unsigned Column;
+
+  StoredLocation() : Line(0), Column(0) {}
+};
+
+/// \brief A diagnostic reported by the analyzer, which can be reported again
+/// by another compiler instance.
+struct StoredAnalyzerDiagnostic {
+  struct Range {
+    StoredLocation Begin, End;
+    bool IsTokenRange;
+  };
+
+  DiagnosticsEngine::Level Level;
+  std::string Message;
+  StoredLocation Location;
+  std::vector<Range> Ranges;
+};
+
+/// \brief The results of the path-sensitive analysis of a top-level function.
+struct AnalysisSummary {
+  /// \brief The functions which were inlined, and thus do not need to be
+  /// analyzed as top-level functions. They are stored as indices into the
+  /// list of functions reachable from the analyzed one in the call graph.
+  std::vector<unsigned> InlinedCallees;
+
+  /// \brief The diagnostics reported by the analysis, each warning followed
+  /// by its notes.
+  std::vector<StoredAnalyzerDiagnostic> Diagnostics;
+};
+
+/// \brief A directory of analysis summaries, one file per key.
+///
+/// The key has to identify everything the analysis of the function depends
+/// on. Summaries are written atomically, so the cache can be shared by
+/// concurrent analyses. A summary which cannot be read is treated as missing.
+class AnalysisSummaryCache {
+  std::string Directory;
+
+  std::string getSummaryPath(StringRef Key) const;
+
+public:
+  explicit AnalysisSummaryCache(StringRef Directory) : Directory(Directory) {}
+
+  /// \brief Read the summary stored for \p Key into \p Summary. Returns false
+  /// if there is none.
+  bool lookup(StringRef Key, AnalysisSummary &Summary) const;
+
+  /// \brief Store \p Summary for \p Key. Failures are ignored, as they only
+  /// cost a later analysis the reuse of the summary.
+  void store(StringRef Key, const AnalysisSummary &Summary) const;
+};
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
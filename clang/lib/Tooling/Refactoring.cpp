@@ -21,6 +21,7 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include <algorithm>
 
 namespace clang {
 namespace tooling {
@@ -31,14 +32,46 @@ RefactoringTool::RefactoringTool(
     : ClangTool(Compilations, SourcePaths, PCHContainerOps) {}
 
 std::map<std::string, Replacements> &RefactoringTool::getReplacements() {
+  mergeAddedReplacements();
   return FileToReplaces;
 }
 
+void RefactoringTool::addReplacement(const Replacement &R) {
+  std::lock_guard<std::mutex> Lock(AddedReplacementsMutex);
+  AddedReplacements.push_back(R);
+}
+
+void RefactoringTool::mergeAddedReplacements() {
+  std::vector<Replacement> Added;
+  {
+    std::lock_guard<std::mutex> Lock(AddedReplacementsMutex);
+    Added.swap(AddedReplacements);
+  }
+  std::sort(Added.begin(), Added.end());
+  Added.erase(std::unique(Added.begin(), Added.end()), Added.end());
+  for (const Replacement &R : Added) {
+    if (llvm::Error Err = FileToReplaces[R.getFilePath()].add(R)) {
+      llvm::errs() << llvm::toString(std::move(Err)) << "\n";
+    }
+  }
+}
+
 int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   if (int Result = run(ActionFactory)) {
     return Result;
   }
+  return applyAndSave();
+}
+
+int RefactoringTool::runAndSaveInParallel(FrontendActionFactory *ActionFactory,
+                                          unsigned ThreadCount) {
+  if (int Result = runInParallel(ActionFactory, ThreadCount)) {
+    return Result;
+  }
+  return applyAndSave();
+}
 
+int RefactoringTool::applyAndSave() {
   LangOptions DefaultLangOptions;
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
   TextDiagnosticPrinter DiagnosticPrinter(llvm::errs(), &*DiagOpts);
@@ -56,6 +89,7 @@ int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
 }
 
 bool RefactoringTool::applyAllReplacements(Rewriter &Rewrite) {
+  mergeAddedReplacements();
   bool Result = true;
   for (const auto &Entry : groupReplacementsByFile(
            Rewrite.getSourceMgr().getFileManager(), FileToReplaces))
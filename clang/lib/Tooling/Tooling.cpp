@@ -22,6 +22,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CompilationDatabase.h"
@@ -33,7 +34,10 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <future>
 #include <utility>
 
 #define DEBUG_TYPE "clang-tooling"
@@ -216,7 +220,7 @@ ToolInvocation::ToolInvocation(
     FileManager *Files, std::shared_ptr<PCHContainerOperations> PCHContainerOps)
     : CommandLine(std::move(CommandLine)), Action(Action), OwnsAction(false),
       Files(Files), PCHContainerOps(std::move(PCHContainerOps)),
-      DiagConsumer(nullptr) {}
+      DiagConsumer(nullptr), DiagOS(&llvm::errs()) {}
 
 ToolInvocation::ToolInvocation(
     std::vector<std::string> CommandLine, FrontendAction *FAction,
@@ -224,7 +228,7 @@ ToolInvocation::ToolInvocation(
     : CommandLine(std::move(CommandLine)),
       Action(new SingleFrontendActionFactory(FAction)), OwnsAction(true),
       Files(Files), PCHContainerOps(std::move(PCHContainerOps)),
-      DiagConsumer(nullptr) {}
+      DiagConsumer(nullptr), DiagOS(&llvm::errs()) {}
 
 ToolInvocation::~ToolInvocation() {
   if (OwnsAction)
@@ -248,8 +252,7 @@ bool ToolInvocation::run() {
   llvm::opt::InputArgList ParsedArgs = Opts->ParseArgs(
       ArrayRef<const char *>(Argv).slice(1), MissingArgIndex, MissingArgCount);
   ParseDiagnosticArgs(*DiagOpts, ParsedArgs);
-  TextDiagnosticPrinter DiagnosticPrinter(
-      llvm::errs(), &*DiagOpts);
+  TextDiagnosticPrinter DiagnosticPrinter(*DiagOS, &*DiagOpts);
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<clang::DiagnosticIDs>(new DiagnosticIDs()), &*DiagOpts,
       DiagConsumer ? DiagConsumer : &DiagnosticPrinter, false);
@@ -285,13 +288,23 @@ bool ToolInvocation::runInvocation(
     std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
   // Show the invocation, with -v.
   if (Invocation->getHeaderSearchOpts().Verbose) {
-    llvm::errs() << "clang Invocation:\n";
-    Compilation->getJobs().Print(llvm::errs(), "\n", true);
-    llvm::errs() << "\n";
+    *DiagOS << "clang Invocation:\n";
+    Compilation->getJobs().Print(*DiagOS, "\n", true);
+    *DiagOS << "\n";
+  }
+
+  // The compiler instance prints diagnostics to llvm::errs() unless it is
+  // given a consumer.
+  std::unique_ptr<TextDiagnosticPrinter> DiagnosticPrinter;
+  DiagnosticConsumer *Consumer = DiagConsumer;
+  if (!Consumer && DiagOS != &llvm::errs()) {
+    DiagnosticPrinter = llvm::make_unique<TextDiagnosticPrinter>(
+        *DiagOS, &Invocation->getDiagnosticOpts());
+    Consumer = DiagnosticPrinter.get();
   }
 
   return Action->runInvocation(std::move(Invocation), Files,
-                               std::move(PCHContainerOps), DiagConsumer);
+                               std::move(PCHContainerOps), Consumer);
 }
 
 bool FrontendActionFactory::runInvocation(
@@ -353,6 +366,15 @@ void ClangTool::clearArgumentsAdjusters() {
   ArgsAdjuster = nullptr;
 }
 
+void ClangTool::setSharedFileCaches(
+    IntrusiveRefCntPtr<SharedStatCache> Stats,
+    IntrusiveRefCntPtr<FileContentCache> Contents) {
+  SharedStats = std::move(Stats);
+  SharedContents = std::move(Contents);
+  Files->setSharedStatCache(SharedStats);
+  Files->setFileContentCache(SharedContents);
+}
+
 static void injectResourceDir(CommandLineArguments &Args, const char *Argv0,
                               void *MainAddr) {
   // Allow users to override the resource dir.
@@ -468,6 +490,238 @@ int ClangTool::run(ToolAction *Action) {
 
 namespace {
 
+/// Records the diagnostics of a file processed by ClangTool::runInParallel(),
+/// so that they can be replayed to the tool's DiagnosticConsumer in the order
+/// of the source paths.
+class BufferedDiagnosticConsumer : public DiagnosticConsumer {
+  /// A source file begun by the compilation, with the objects needed to
+  /// resolve the locations of its diagnostics after the compilation is over.
+  struct SourceFile {
+    LangOptions LangOpts;
+    IntrusiveRefCntPtr<FileManager> Files;
+    IntrusiveRefCntPtr<SourceManager> Sources;
+    IntrusiveRefCntPtr<DiagnosticsEngine> Diags;
+  };
+
+  struct Event {
+    enum EventKind { BeginFile, Report, EndFile, Finish } Kind;
+    /// The index of the last source file begun before the event, or
+    /// NoSourceFile.
+    unsigned File;
+    StoredDiagnostic Diag;
+  };
+
+  static const unsigned NoSourceFile = ~0U;
+
+  DiagnosticConsumer &Consumer;
+  std::vector<std::unique_ptr<SourceFile>> SourceFiles;
+  std::vector<Event> Events;
+
+  unsigned lastSourceFile() const {
+    return SourceFiles.empty() ? NoSourceFile : SourceFiles.size() - 1;
+  }
+
+public:
+  BufferedDiagnosticConsumer(DiagnosticConsumer &Consumer)
+      : Consumer(Consumer) {}
+
+  void BeginSourceFile(const LangOptions &LangOpts,
+                       const Preprocessor *PP) override {
+    auto File = llvm::make_unique<SourceFile>();
+    File->LangOpts = LangOpts;
+    if (PP) {
+      File->Sources = &PP->getSourceManager();
+      File->Files = &File->Sources->getFileManager();
+      File->Diags = &PP->getDiagnostics();
+    }
+    SourceFiles.push_back(std::move(File));
+    Events.push_back({Event::BeginFile, lastSourceFile(), StoredDiagnostic()});
+  }
+
+  void EndSourceFile() override {
+    Events.push_back({Event::EndFile, lastSourceFile(), StoredDiagnostic()});
+  }
+
+  void finish() override {
+    Events.push_back({Event::Finish, lastSourceFile(), StoredDiagnostic()});
+  }
+
+  bool IncludeInDiagnosticCounts() const override {
+    return Consumer.IncludeInDiagnosticCounts();
+  }
+
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(DiagLevel, Info);
+    Events.push_back({Event::Report, lastSourceFile(),
+                      StoredDiagnostic(DiagLevel, Info)});
+  }
+
+  /// Passes the recorded events to the tool's consumer. Must not be called
+  /// concurrently with any other call to the tool's consumer.
+  void replay() {
+    // Diagnostics of the driver have no source manager.
+    DiagnosticsEngine DriverDiags(new DiagnosticIDs(), new DiagnosticOptions(),
+                                  &Consumer, /*ShouldOwnClient=*/false);
+    for (const Event &E : Events) {
+      switch (E.Kind) {
+      case Event::BeginFile:
+        // The preprocessor of the compilation is gone.
+        Consumer.BeginSourceFile(SourceFiles[E.File]->LangOpts, nullptr);
+        break;
+      case Event::EndFile:
+        Consumer.EndSourceFile();
+        break;
+      case Event::Finish:
+        Consumer.finish();
+        break;
+      case Event::Report: {
+        DiagnosticsEngine *Diags = &DriverDiags;
+        if (E.File != NoSourceFile && SourceFiles[E.File]->Diags)
+          Diags = SourceFiles[E.File]->Diags.get();
+        Diags->setClient(&Consumer, /*ShouldOwnClient=*/false);
+        Diags->Report(E.Diag);
+        break;
+      }
+      }
+    }
+  }
+};
+
+/// A compile command to be run by ClangTool::runInParallel(), and its
+/// results.
+struct ParallelToolJob {
+  std::string File;
+  std::string Directory;
+  std::vector<std::string> CommandLine;
+
+  /// Diagnostics and messages, printed once all earlier jobs are printed.
+  std::string Output;
+  /// Diagnostics for the tool's DiagnosticConsumer, replayed once all earlier
+  /// jobs are printed.
+  std::unique_ptr<BufferedDiagnosticConsumer> Diagnostics;
+  bool Failed = false;
+};
+
+} // end anonymous namespace
+
+int ClangTool::runInParallel(ToolAction *Action, unsigned ThreadCount) {
+  // Exists solely for the purpose of lookup of the resource path.
+  // This just needs to be some symbol in the binary.
+  static int StaticSymbol;
+
+  llvm::SmallString<128> InitialDirectory;
+  if (std::error_code EC = llvm::sys::fs::current_path(InitialDirectory))
+    llvm::report_fatal_error("Cannot detect current path: " +
+                             Twine(EC.message()));
+
+  if (SeenWorkingDirectories.insert("/").second)
+    for (const auto &MappedFile : MappedFileContents)
+      if (llvm::sys::path::is_absolute(MappedFile.first))
+        InMemoryFileSystem->addFile(
+            MappedFile.first, 0,
+            llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+
+  // Compilation databases and the in-memory file system are not thread-safe,
+  // so set up all jobs before starting the first one.
+  std::vector<ParallelToolJob> Jobs;
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty()) {
+      ParallelToolJob Job;
+      Job.Output = "Skipping " + File + ". Compile command not found.\n";
+      Jobs.push_back(std::move(Job));
+      continue;
+    }
+    for (CompileCommand &CompileCommand : CompileCommandsForFile) {
+      // Relative file mappings are resolved against the working directory of
+      // the in-memory file system when they are added.
+      if (SeenWorkingDirectories.insert(CompileCommand.Directory).second) {
+        InMemoryFileSystem->setCurrentWorkingDirectory(
+            CompileCommand.Directory);
+        for (const auto &MappedFile : MappedFileContents)
+          if (!llvm::sys::path::is_absolute(MappedFile.first))
+            InMemoryFileSystem->addFile(
+                MappedFile.first, 0,
+                llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+      }
+
+      ParallelToolJob Job;
+      Job.File = File;
+      Job.Directory = CompileCommand.Directory;
+      Job.CommandLine = CompileCommand.CommandLine;
+      if (ArgsAdjuster)
+        Job.CommandLine =
+            ArgsAdjuster(Job.CommandLine, CompileCommand.Filename);
+      assert(!Job.CommandLine.empty());
+      injectResourceDir(Job.CommandLine, "clang_tool", &StaticSymbol);
+
+      // Changing the current directory would affect all threads, so resolve
+      // relative paths with -working-directory instead.
+      if (!Job.Directory.empty())
+        Job.CommandLine.insert(Job.CommandLine.begin() + 1,
+                               "-working-directory=" + Job.Directory);
+      Jobs.push_back(std::move(Job));
+    }
+  }
+  InMemoryFileSystem->setCurrentWorkingDirectory(InitialDirectory);
+
+  auto RunJob = [&](ParallelToolJob &Job) {
+    FileSystemOptions FileSystemOpts;
+    FileSystemOpts.WorkingDir = Job.Directory;
+    llvm::IntrusiveRefCntPtr<FileManager> JobFiles(
+        new FileManager(FileSystemOpts, OverlayFileSystem));
+    JobFiles->setSharedStatCache(SharedStats);
+    JobFiles->setFileContentCache(SharedContents);
+
+    ToolInvocation Invocation(std::move(Job.CommandLine), Action,
+                              JobFiles.get(), PCHContainerOps);
+    llvm::raw_string_ostream OS(Job.Output);
+    Invocation.setDiagnosticOutput(OS);
+    if (DiagConsumer) {
+      Job.Diagnostics =
+          llvm::make_unique<BufferedDiagnosticConsumer>(*DiagConsumer);
+      Invocation.setDiagnosticConsumer(Job.Diagnostics.get());
+    }
+
+    if (!Invocation.run()) {
+      // FIXME: Diagnostics should be used instead.
+      OS << "Error while processing " << Job.File << ".\n";
+      Job.Failed = true;
+    }
+  };
+
+  if (!ThreadCount)
+    ThreadCount = llvm::heavyweight_hardware_concurrency();
+  llvm::ThreadPool Pool(ThreadCount);
+  std::vector<std::shared_future<llvm::ThreadPool::VoidTy>> Futures;
+  for (ParallelToolJob &Job : Jobs)
+    if (!Job.CommandLine.empty())
+      Futures.push_back(Pool.async([&] { RunJob(Job); }));
+    else
+      Futures.emplace_back();
+
+  // Print the results in the order of the source paths as they become
+  // available.
+  bool ProcessingFailed = false;
+  for (size_t I = 0, E = Jobs.size(); I != E; ++I) {
+    if (Futures[I].valid())
+      Futures[I].wait();
+    DEBUG({ llvm::dbgs() << "Processed: " << Jobs[I].File << ".\n"; });
+    if (Jobs[I].Diagnostics) {
+      Jobs[I].Diagnostics->replay();
+      Jobs[I].Diagnostics.reset();
+    }
+    llvm::errs() << Jobs[I].Output;
+    ProcessingFailed |= Jobs[I].Failed;
+  }
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
 class ASTBuilderAction : public ToolAction {
   std::vector<std::unique_ptr<ASTUnit>> &ASTs;
 
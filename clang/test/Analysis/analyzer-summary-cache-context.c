@@ -0,0 +1,28 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/a.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core \
+// RUN:   -analyzer-config summary-cache-dir=%t/cache -verify %t/a.c
+// RUN: ls %t/cache | count 1
+// A declaration the function does not refer to is not part of the key.
+// RUN: sed 's|^// UNRELATED$|int unrelated;|' %s > %t/a.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core \
+// RUN:   -analyzer-config summary-cache-dir=%t/cache -verify %t/a.c
+// RUN: ls %t/cache | count 1
+// A declaration the function refers to is.
+// RUN: sed 's|^  int pad;$|  int pad, pad2;|' %s > %t/a.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core \
+// RUN:   -analyzer-config summary-cache-dir=%t/cache -verify %t/a.c
+// RUN: ls %t/cache | count 2
+
+struct S {
+  int pad;
+  int *p;
+};
+
+// UNRELATED
+
+void deref(struct S *s) {
+  if (s->p)
+    return;
+  *s->p = 1; // expected-warning {{Dereference of null pointer}}
+}
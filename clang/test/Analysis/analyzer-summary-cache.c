@@ -0,0 +1,41 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=text \
+// RUN:   -analyzer-config summary-cache-dir=%t -verify %s
+// RUN: ls %t | count 2
+// The second run reports the warnings and their paths from the summaries.
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=text \
+// RUN:   -analyzer-config summary-cache-dir=%t -verify %s
+// RUN: ls %t | count 2
+// The summaries depend on the configuration of the analysis.
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=text \
+// RUN:   -analyzer-config summary-cache-dir=%t \
+// RUN:   -analyzer-config max-nodes=1000 -verify %s
+// RUN: ls %t | count 4
+
+void deref(int *p) {
+  if (p)
+    // expected-note@-1 {{Assuming 'p' is null}}
+    // expected-note@-2 {{Taking false branch}}
+    return;
+  *p = 1; // expected-warning {{Dereference of null pointer (loaded from variable 'p')}}
+  // expected-note@-1 {{Dereference of null pointer (loaded from variable 'p')}}
+}
+
+// The functions inlined into testSimple are not analyzed on their own, in
+// either run.
+void use(int *ptr, int val) {
+  *ptr = val; // expected-warning {{Dereference of null pointer (loaded from variable 'ptr')}}
+  // expected-note@-1 {{Dereference of null pointer (loaded from variable 'ptr')}}
+}
+
+int compute() {
+  return 2 + 3;
+}
+
+void testSimple() {
+  int *p = 0;
+  // expected-note@-1 {{'p' initialized to a null pointer value}}
+  use(p, compute());
+  // expected-note@-1 {{Passing null pointer value via 1st parameter 'ptr'}}
+  // expected-note@-2 {{Calling 'use'}}
+}
@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-threads 4 -verify %s
+
+// The call graph has no edge for the call through a pointer. If store and
+// callStore were analyzed by different workers, the warning would be reported
+// both by the worker analyzing store and by the one inlining it, so the
+// functions which take the address of a function and the functions whose
+// address is taken are analyzed by the same worker.
+static void store(int *p) {
+  if (p)
+    return;
+  *p = 0; // expected-warning{{Dereference of null pointer}}
+}
+
+void callStore() {
+  void (*f)(int *) = store;
+  f(0);
+}
+
+// The other functions are still split between workers.
+void deref1(int *p) {
+  if (p)
+    return;
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+int div1(int x) {
+  if (x)
+    return 0;
+  return 1 / x; // expected-warning{{Division by zero}}
+}
@@ -0,0 +1,49 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-threads 1 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-threads 4 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-threads 0 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-threads 4 \
+// RUN:   -analyzer-output=plist -o %t.plist -verify %s
+// RUN: FileCheck -check-prefix=PLIST %s < %t.plist
+
+// Every worker reports the warnings of the functions it analyzed.
+void deref1(int *p) {
+  if (p)
+    return;
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+void deref2(int *p) {
+  if (p)
+    return;
+  *p = 2; // expected-warning{{Dereference of null pointer}}
+}
+
+int div1(int x) {
+  if (x)
+    return 0;
+  return 1 / x; // expected-warning{{Division by zero}}
+}
+
+int div2(int x) {
+  if (x)
+    return 0;
+  return 2 / x; // expected-warning{{Division by zero}}
+}
+
+// A function is analyzed by the same worker as its callers, so it is not
+// analyzed again once it has been inlined and its warning is reported once.
+static void store(int *p) {
+  *p = 0; // expected-warning{{Dereference of null pointer}}
+}
+
+void callStore() {
+  store(0);
+}
+
+// The plist output is written for the whole translation unit, so it is not
+// split between workers.
+// PLIST-DAG: <key>description</key><string>Dereference of null pointer
+// PLIST-DAG: <key>description</key><string>Dereference of null pointer
+// PLIST-DAG: <key>description</key><string>Dereference of null pointer
+// PLIST-DAG: <key>description</key><string>Division by zero</string>
+// PLIST-DAG: <key>description</key><string>Division by zero</string>
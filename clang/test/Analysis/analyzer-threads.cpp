@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-threads 4 -verify %s
+
+// The call graph has no edges for the implicit calls of constructors and for
+// virtual calls, so they are analyzed by the same worker as their callers,
+// and each warning is reported once.
+struct Store {
+  Store(int *p) {
+    if (p)
+      return;
+    *p = 0; // expected-warning{{Dereference of null pointer}}
+  }
+};
+
+void construct() {
+  Store S(0);
+}
+
+struct Base {
+  virtual int div(int x) {
+    if (x)
+      return 0;
+    return 1 / x; // expected-warning{{Division by zero}}
+  }
+};
+
+int callDiv(Base &B) {
+  return B.div(0);
+}
+
+void deref(int *p) {
+  if (p)
+    return;
+  *p = 1; // expected-warning{{Dereference of null pointer}}
+}
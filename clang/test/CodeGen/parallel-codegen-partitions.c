@@ -0,0 +1,41 @@
+// REQUIRES: x86-registered-target
+
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -emit-obj \
+// RUN:   -fembed-bitcode=all -parallel-codegen-output %t1.o -o %t0.o %s
+// RUN: llvm-readobj -sections %t0.o | FileCheck --check-prefix=FIRST %s
+// RUN: llvm-readobj -sections %t1.o | FileCheck --check-prefix=OTHER %s
+// RUN: llvm-nm %t0.o | FileCheck --check-prefix=ASM %s
+// RUN: llvm-nm %t1.o | FileCheck --check-prefix=NOASM %s
+
+// The embedded bitcode and command line, and the module-level inline asm, are
+// only emitted into the first partition.
+// FIRST-DAG: Name: .llvmbc
+// FIRST-DAG: Name: .llvmcmd
+// OTHER-NOT: .llvmbc
+// OTHER-NOT: .llvmcmd
+// ASM: T module_asm
+// NOASM-NOT: module_asm
+
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -emit-obj \
+// RUN:   -DBAD_ASM -parallel-codegen-output %t1.o -o %t0.o %s 2>&1 \
+// RUN:   | FileCheck --check-prefix=ERR %s
+
+// Errors in any partition are reported through the frontend's diagnostics.
+// ERR-DAG: parallel-codegen-partitions.c:{{[0-9]+}}:{{[0-9]+}}: error: invalid instruction mnemonic 'bad_first'
+// ERR-DAG: parallel-codegen-partitions.c:{{[0-9]+}}:{{[0-9]+}}: error: invalid instruction mnemonic 'bad_second'
+
+__asm__(".globl module_asm\n"
+        "module_asm:\n"
+        "  ret\n");
+
+#ifdef BAD_ASM
+int first(int x) {
+  __asm__("bad_first");
+  return x + 1;
+}
+
+int second(int x) {
+  __asm__("bad_second");
+  return x - 1;
+}
+#endif
@@ -0,0 +1,27 @@
+// REQUIRES: x86-registered-target
+
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -emit-obj \
+// RUN:   -parallel-codegen-output %t1.o -o %t0.o %s
+// RUN: llvm-nm %t0.o %t1.o | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -O2 -emit-obj \
+// RUN:   -fexperimental-new-pass-manager \
+// RUN:   -parallel-codegen-output %t1.o -o %t0.o %s
+// RUN: llvm-nm %t0.o %t1.o | FileCheck %s
+
+// Every definition ends up in one of the partitions, and static ones stay
+// local to theirs.
+// CHECK-DAG: T first
+// CHECK-DAG: T second
+// CHECK-DAG: D counter
+// CHECK-DAG: t helper
+// CHECK-NOT: {{[A-Z]}} helper
+
+int counter = 1;
+
+__attribute__((noinline)) static int helper(int x) {
+  return x * counter;
+}
+
+int first(int x) { return helper(x) + 1; }
+
+int second(int x) { return x - 1; }
@@ -0,0 +1,2 @@
+#warning second
+int second_file;
@@ -0,0 +1,14 @@
+// RUN: %clang -### -M -fminimize-dependency-scan %s 2>&1 | FileCheck %s
+// RUN: %clang -### -MM -fminimize-dependency-scan %s 2>&1 | FileCheck %s
+// CHECK: "-Eonly"
+// CHECK-SAME: "-minimize-dependency-sources"
+
+// RUN: %clang -### -M -fminimize-dependency-scan \
+// RUN:   -fno-minimize-dependency-scan %s 2>&1 | FileCheck -check-prefix=NO %s
+// NO-NOT: "-minimize-dependency-sources"
+
+// -MD and -MMD are part of a compilation, which needs the full sources.
+// RUN: %clang -### -c -MD -fminimize-dependency-scan %s 2>&1 | \
+// RUN:   FileCheck -check-prefix=MD %s
+// MD: argument unused during compilation: '-fminimize-dependency-scan'
+// MD-NOT: "-minimize-dependency-sources"
@@ -0,0 +1,38 @@
+// Check that -fparallel-codegen=N generates code for N partitions of the
+// module and links them into the requested object file.
+//
+// RUN: %clang -target x86_64-unknown-linux-gnu -fparallel-codegen=3 -c \
+// RUN:   -o %t.o -### %s 2>&1 | FileCheck -check-prefix=ELF %s
+// ELF: "-cc1"
+// ELF-SAME: "-o" "[[P0:[^"]*parallel-codegen[^"]*\.o]]"
+// ELF-SAME: "-parallel-codegen-output" "[[P1:[^"]*\.o]]"
+// ELF-SAME: "-parallel-codegen-output" "[[P2:[^"]*\.o]]"
+// ELF: ld{{(.exe)?}}" "-m" "elf_x86_64" "-r" "-o" "{{.*}}.o" "[[P0]]" "[[P1]]" "[[P2]]"
+//
+// RUN: %clang -target x86_64-apple-darwin10 -fparallel-codegen=2 -c \
+// RUN:   -o %t.o -### %s 2>&1 | FileCheck -check-prefix=MACHO %s
+// MACHO: "-cc1"
+// MACHO-SAME: "-o" "[[P0:[^"]*\.o]]" "-parallel-codegen-output" "[[P1:[^"]*\.o]]"
+// MACHO: ld{{(.exe)?}}" "-arch" "x86_64" "-r" "-o" "{{.*}}.o" "[[P0]]" "[[P1]]"
+
+// Code is generated as usual when the output cannot be split.
+//
+// RUN: %clang -target x86_64-unknown-linux-gnu -fparallel-codegen=1 -c \
+// RUN:   -### %s 2>&1 | FileCheck -check-prefix=NO-SPLIT %s
+// RUN: %clang -target x86_64-unknown-linux-gnu -fparallel-codegen=4 -S \
+// RUN:   -### %s 2>&1 | FileCheck -check-prefix=NO-SPLIT %s
+// RUN: %clang -target x86_64-unknown-linux-gnu -fparallel-codegen=4 -c \
+// RUN:   -flto -### %s 2>&1 | FileCheck -check-prefix=NO-SPLIT %s
+// RUN: %clang -target x86_64-unknown-linux-gnu -fparallel-codegen=4 -c \
+// RUN:   -gsplit-dwarf -### %s 2>&1 | FileCheck -check-prefix=NO-SPLIT %s
+// RUN: %clang -target x86_64-pc-windows-msvc -fparallel-codegen=4 -c \
+// RUN:   -### %s 2>&1 | FileCheck -check-prefix=NO-SPLIT %s
+// NO-SPLIT-NOT: argument unused
+// NO-SPLIT-NOT: -parallel-codegen-output
+// NO-SPLIT-NOT: "-r"
+
+// RUN: %clang -target x86_64-unknown-linux-gnu -fparallel-codegen=0 -c \
+// RUN:   -### %s 2>&1 | FileCheck -check-prefix=INVALID %s
+// INVALID: invalid integral value '0' in '-fparallel-codegen=0'
+
+int f(void) { return 0; }
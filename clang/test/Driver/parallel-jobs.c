@@ -0,0 +1,27 @@
+// Check that -j prints the output of the jobs in command line order.
+// RUN: %clang -fsyntax-only -j 4 %s %S/Inputs/parallel-jobs.c %s 2>&1 \
+// RUN:   | FileCheck %s
+// CHECK: parallel-jobs.c:{{.*}} warning: first
+// CHECK: Inputs{{/|\\}}parallel-jobs.c:{{.*}} warning: second
+// CHECK: parallel-jobs.c:{{.*}} warning: first
+
+// RUN: %clang -E -j 2 %s %S/Inputs/parallel-jobs.c \
+// RUN:   | FileCheck -check-prefix=CPP %s
+// CPP: int first_file;
+// CPP: int second_file;
+
+// Check that nothing after the first failing job is reported.
+// RUN: not %clang -fsyntax-only -j 4 -DFAIL %s %S/Inputs/parallel-jobs.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=FAIL %s
+// FAIL: error: failed
+// FAIL-NOT: warning: second
+
+// RUN: not %clang -fsyntax-only -j 0 %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// INVALID: invalid integral value '0' in '-j{{ ?}}0'
+
+#ifdef FAIL
+#error failed
+#endif
+#warning first
+int first_file;
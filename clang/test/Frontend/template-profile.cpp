@@ -0,0 +1,40 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -ftemplate-profile=%t.json \
+// RUN:   -ftemplate-profile-report %s 2>&1 | FileCheck -check-prefix=REPORT %s
+// RUN: FileCheck -check-prefix=TRACE %s < %t.json
+// RUN: %clang -### -c -ftemplate-profile=%t.json -ftemplate-profile-report %s \
+// RUN:   2>&1 | FileCheck -check-prefix=DRIVER %s
+
+namespace ns {
+template <unsigned N> struct Fib {
+  static const unsigned Value = Fib<N - 1>::Value + Fib<N - 2>::Value;
+};
+template <> struct Fib<1> { static const unsigned Value = 1; };
+template <> struct Fib<0> { static const unsigned Value = 0; };
+
+template <typename T> struct Box {
+  T Value;
+  T get() const { return Value; }
+};
+}
+
+unsigned f() {
+  ns::Box<int> B = {ns::Fib<5>::Value};
+  return B.get();
+}
+
+// The explicit specializations of Fib are not instantiated.
+// REPORT: Template instantiation report
+// REPORT: 6 instantiations of 3 templates
+// REPORT-DAG: {{ +}}4  ns::Fib{{$}}
+// REPORT-DAG: {{ +}}1  ns::Box{{$}}
+// REPORT-DAG: {{ +}}1  ns::Box::get{{$}}
+
+// TRACE: {"traceEvents": [
+// TRACE-DAG: {"name": "ns::Fib<2>", "cat": "InstantiateClass", "ph": "X", {{.*}} "args": {"template": "ns::Fib", "depth": 3,
+// TRACE-DAG: {"name": "ns::Fib<5>", "cat": "InstantiateClass", "ph": "X", {{.*}} "args": {"template": "ns::Fib", "depth": 0,
+// TRACE-DAG: {"name": "ns::Box<int>", "cat": "InstantiateClass", {{.*}} "depth": 0,
+// TRACE-DAG: {"name": "ns::Box<int>::get", "cat": "InstantiateFunction", {{.*}} "template": "ns::Box::get", "depth": 0,
+// TRACE: ], "displayTimeUnit": "ms"}
+
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-ftemplate-profile={{.*}}.json" "-ftemplate-profile-report"
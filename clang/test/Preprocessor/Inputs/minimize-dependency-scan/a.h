@@ -0,0 +1,3 @@
+#pragma once
+#define B_HEADER "b.h"
+#include "a.h"
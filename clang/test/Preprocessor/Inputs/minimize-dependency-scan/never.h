@@ -0,0 +1 @@
+int never(void);
@@ -0,0 +1 @@
+int sys2(void);
@@ -0,0 +1,39 @@
+// RUN: %clang -M -I %S/Inputs/minimize-dependency-scan %s > %t.full.d
+// RUN: %clang -M -fminimize-dependency-scan \
+// RUN:   -I %S/Inputs/minimize-dependency-scan %s > %t.min.d
+// RUN: diff %t.full.d %t.min.d
+// RUN: FileCheck %s < %t.min.d
+// RUN: %clang -MM -fminimize-dependency-scan \
+// RUN:   -I %S/Inputs/minimize-dependency-scan %s | \
+// RUN:   FileCheck -check-prefix=MM %s
+
+// CHECK: minimize-dependency-scan.o:
+// CHECK-SAME: minimize-dependency-scan.c
+// CHECK: a.h
+// CHECK: b.h
+// CHECK: sys{{/|\\\\}}sys.h
+// CHECK: sys2.h
+// CHECK-NOT: never.h
+
+// MM-NOT: sys2.h
+
+/* Directives in comments are not kept.
+#include "never.h"
+*/
+// #include "never.h"
+const char *s = "\
+#include \"never.h\"";
+
+#include "a.h"
+#include "a.h"
+
+#if defined(B_HEADER) && \
+    1
+# include B_HEADER
+#else
+#include "never.h"
+#endif
+
+#pragma clang diagnostic ignored "-Wunused"
+#line 42 "never.h"
+#include <sys/sys.h>
@@ -12,6 +12,7 @@
 #include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -246,6 +247,89 @@ TEST_F(FileManagerTest, addRemoveStatCache) {
   manager.removeStatCache(statCache);
 }
 
+// FileManagers sharing a SharedStatCache see the same successful 'stat'
+// results until they are invalidated. Failed ones are not shared.
+TEST(SharedFileCachesTest, SharedStatCache) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/shared/foo.h", 0, MemoryBuffer::getMemBuffer("foo"));
+  IntrusiveRefCntPtr<SharedStatCache> Stats(new SharedStatCache);
+
+  FileManager First(FileSystemOptions(), FS);
+  First.setSharedStatCache(Stats);
+  const FileEntry *Foo = First.getFile("/shared/foo.h");
+  ASSERT_NE(nullptr, Foo);
+  EXPECT_EQ(3, Foo->getSize());
+  EXPECT_EQ(nullptr, First.getFile("/shared/bar.h"));
+
+  FS->addFile("/shared/bar.h", 0, MemoryBuffer::getMemBuffer("bar"));
+  FileManager Second(FileSystemOptions(), FS);
+  Second.setSharedStatCache(Stats);
+  EXPECT_NE(nullptr, Second.getFile("/shared/foo.h"));
+  EXPECT_NE(nullptr, Second.getFile("/shared/bar.h"));
+
+  // A file system on which foo.h was rewritten, as another compilation could
+  // do. The shared result is used until a caller asks for a fresh one.
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> NewFS(
+      new vfs::InMemoryFileSystem);
+  NewFS->addFile("/shared/foo.h", 0, MemoryBuffer::getMemBuffer("fooo"));
+  FileManager Third(FileSystemOptions(), NewFS);
+  Third.setSharedStatCache(Stats);
+  // The shared cache is not removed with the other stat caches.
+  Third.clearStatCaches();
+  Foo = Third.getFile("/shared/foo.h");
+  ASSERT_NE(nullptr, Foo);
+  EXPECT_EQ(3, Foo->getSize());
+  Third.invalidateCache(Foo);
+  Foo = Third.getFile("/shared/foo.h");
+  ASSERT_NE(nullptr, Foo);
+  EXPECT_EQ(4, Foo->getSize());
+
+  FileManager Fourth(FileSystemOptions(), FS);
+  Fourth.setSharedStatCache(Stats);
+  Foo = Fourth.getFile("/shared/foo.h", /*OpenFile=*/false,
+                       /*CacheFailure=*/false);
+  ASSERT_NE(nullptr, Foo);
+  EXPECT_EQ(3, Foo->getSize());
+
+  Stats->invalidate();
+  FileManager Fifth(FileSystemOptions(), NewFS);
+  Fifth.setSharedStatCache(Stats);
+  Foo = Fifth.getFile("/shared/foo.h");
+  ASSERT_NE(nullptr, Foo);
+  EXPECT_EQ(4, Foo->getSize());
+}
+
+// A file read by one FileManager is not read again by the others sharing a
+// FileContentCache.
+TEST(SharedFileCachesTest, FileContentCache) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/shared/foo.h", 0, MemoryBuffer::getMemBuffer("foo"));
+  IntrusiveRefCntPtr<FileContentCache> Contents(new FileContentCache);
+
+  FileManager First(FileSystemOptions(), FS);
+  First.setFileContentCache(Contents);
+  const FileEntry *File = First.getFile("/shared/foo.h");
+  ASSERT_NE(nullptr, File);
+  EXPECT_EQ(nullptr, Contents->lookup(File));
+
+  auto Buffer = First.getBufferForFile(File);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("foo", (*Buffer)->getBuffer());
+
+  FileManager Second(FileSystemOptions(), FS);
+  Second.setFileContentCache(Contents);
+  const FileEntry *SecondFile = Second.getFile("/shared/foo.h");
+  ASSERT_NE(nullptr, SecondFile);
+  std::unique_ptr<MemoryBuffer> Cached = Contents->lookup(SecondFile);
+  ASSERT_NE(nullptr, Cached);
+  EXPECT_EQ((*Buffer)->getBufferStart(), Cached->getBufferStart());
+
+  // Buffers stay valid after the cache is invalidated.
+  Contents->invalidate();
+  EXPECT_EQ(nullptr, Contents->lookup(SecondFile));
+  EXPECT_EQ("foo", Cached->getBuffer());
+}
+
 #endif  // !LLVM_ON_WIN32
 
 } // anonymous namespace
@@ -0,0 +1,80 @@
+//===- unittests/Frontend/PrecompiledPreambleStoreTest.cpp ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/PrecompiledPreambleStore.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+std::unique_ptr<StoredPreamble> makePreamble(size_t Size) {
+  auto Preamble = llvm::make_unique<StoredPreamble>();
+  Preamble->PCH = MemoryBuffer::getMemBufferCopy(std::string(Size, 'x'));
+  return Preamble;
+}
+
+TEST(PrecompiledPreambleStoreTest, LookupAndInsert) {
+  PrecompiledPreambleStore Store(1000);
+  EXPECT_FALSE(Store.lookup("a"));
+
+  auto A = Store.insert("a", makePreamble(100));
+  ASSERT_TRUE(A);
+  EXPECT_EQ(A, Store.lookup("a"));
+  EXPECT_FALSE(Store.lookup("b"));
+  EXPECT_EQ(101u, Store.getMemoryUsage());
+
+  // The first preamble stored under a key is kept.
+  EXPECT_EQ(A, Store.insert("a", makePreamble(100)));
+  EXPECT_EQ(101u, Store.getMemoryUsage());
+
+  // Unless the caller found it out of date.
+  auto B = Store.insert("a", makePreamble(200), A.get());
+  EXPECT_NE(A, B);
+  EXPECT_EQ(B, Store.lookup("a"));
+  EXPECT_EQ(201u, Store.getMemoryUsage());
+  EXPECT_EQ(100u, A->PCH->getBufferSize());
+
+  Store.invalidate();
+  EXPECT_FALSE(Store.lookup("a"));
+  EXPECT_EQ(0u, Store.getMemoryUsage());
+}
+
+TEST(PrecompiledPreambleStoreTest, EvictsLeastRecentlyUsed) {
+  PrecompiledPreambleStore Store(350);
+  auto A = Store.insert("a", makePreamble(99));
+  Store.insert("b", makePreamble(99));
+  Store.insert("c", makePreamble(99));
+  EXPECT_EQ(300u, Store.getMemoryUsage());
+
+  // Looking up "a" makes "b" the least recently used preamble.
+  EXPECT_TRUE(Store.lookup("a"));
+  Store.insert("d", makePreamble(99));
+  EXPECT_TRUE(Store.lookup("a"));
+  EXPECT_FALSE(Store.lookup("b"));
+  EXPECT_TRUE(Store.lookup("c"));
+  EXPECT_TRUE(Store.lookup("d"));
+  EXPECT_EQ(300u, Store.getMemoryUsage());
+
+  // Preambles which are dropped stay alive while they are in use.
+  Store.setMemoryBudget(100);
+  EXPECT_FALSE(Store.lookup("a"));
+  EXPECT_TRUE(Store.lookup("d"));
+  EXPECT_EQ(99u, A->PCH->getBufferSize());
+
+  // A preamble which does not fit the budget is not kept.
+  auto E = Store.insert("e", makePreamble(200));
+  ASSERT_TRUE(E);
+  EXPECT_FALSE(Store.lookup("e"));
+  EXPECT_EQ(0u, Store.getMemoryUsage());
+}
+
+} // anonymous namespace
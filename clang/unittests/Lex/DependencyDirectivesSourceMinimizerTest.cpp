@@ -0,0 +1,117 @@
+//===- unittests/Lex/DependencyDirectivesSourceMinimizerTest.cpp ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+using namespace llvm;
+
+namespace {
+
+std::string minimize(StringRef Input) {
+  SmallString<128> Output;
+  minimizeSourceToDependencyDirectives(Input, Output);
+  return Output.str();
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Empty) {
+  EXPECT_EQ("", minimize(""));
+  EXPECT_EQ("", minimize("int x = 0;\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, KeepsDirectives) {
+  EXPECT_EQ("#ifndef A\n"
+            "#define A(x) x + 1\n"
+            "#include \"a.h\"\n"
+            "#  include_next <b.h>\n"
+            "#import <c.h>\n"
+            "#elif B\n"
+            "#else\n"
+            "#undef A\n"
+            "#error no\n"
+            "#endif\n",
+            minimize("#ifndef A\n"
+                     "#define A(x) x + 1 // comment\n"
+                     "int a;\n"
+                     "#include \"a.h\" /* comment */\n"
+                     "  #  include_next <b.h>\n"
+                     "#import <c.h>\n"
+                     "#elif B\n"
+                     "#else\n"
+                     "void f() {}\n"
+                     "#undef A\n"
+                     "#error no\n"
+                     "#endif\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, LogicalLines) {
+  EXPECT_EQ("#define A 1 + \\\n  2\n"
+            "#if A && \\\n    B\n"
+            "#endif\n",
+            minimize("#define A 1 + \\\n  2\n"
+                     "#if A && \\\n    B // \\\n  comment\n"
+                     "#endif\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, IgnoresNonDirectives) {
+  EXPECT_EQ("#include \"b.h\"\n",
+            minimize("/*\n"
+                     "#include \"a.h\"\n"
+                     "*/\n"
+                     "// #include \"a.h\"\n"
+                     "const char *s = \"\\\n"
+                     "#include \\\"a.h\\\"\";\n"
+                     "int x; #include \"a.h\"\n"
+                     "#include \"b.h\"\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, DropsDirectives) {
+  EXPECT_EQ("", minimize("#\n"
+                         "# 42 \"a.h\"\n"
+                         "#line 42\n"
+                         "#ident \"a\"\n"
+                         "#sccs \"a\"\n"
+                         "#pragma mark a\n"
+                         "#pragma clang diagnostic push\n"
+                         "#pragma\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, Pragmas) {
+  EXPECT_EQ("#pragma once\n"
+            "#pragma push_macro(\"A\")\n"
+            "#pragma pop_macro(\"A\")\n"
+            "#pragma include_alias(<a.h>, \"b.h\")\n"
+            "#pragma GCC system_header\n"
+            "#pragma clang system_header\n"
+            "#pragma clang module import A\n",
+            minimize("#pragma once\n"
+                     "#pragma push_macro(\"A\")\n"
+                     "#pragma pop_macro(\"A\")\n"
+                     "#pragma include_alias(<a.h>, \"b.h\")\n"
+                     "#pragma GCC system_header\n"
+                     "#pragma clang system_header\n"
+                     "#pragma clang module import A\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, AngledHeaderNames) {
+  EXPECT_EQ("#include <a//b.h>\n"
+            "#include <a'b.h>\n",
+            minimize("#include <a//b.h>\n"
+                     "#include <a'b.h>\n"));
+}
+
+TEST(MinimizeSourceToDependencyDirectivesTest, AtImport) {
+  EXPECT_EQ("@import A.B;\n", minimize("@import A.B;\n"
+                                       "@interface I\n"
+                                       "@end\n"));
+}
+
+} // end anonymous namespace
@@ -380,4 +380,37 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, LexTokensLongerThanScanChunks) {
+  LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = true;
+
+  // Each of these runs is longer than the 16 bytes the fast scanners look at
+  // at a time, and has a character that needs the slow path in the middle.
+  const char *Source =
+      "an_identifier_which_is_longer_than_a_chunk"
+      "                  \t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+      "an_identifier_with_a_$_in_the_middle_of_it\n"
+      "// A line comment which is longer than a chunk, with an escaped \\\n"
+      "   newline and a continuation line.\n"
+      "\"a string literal with an escaped \\\n"
+      "newline, \\\" escapes, and ?? which is longer than a chunk\"\n"
+      "R\"x(a raw string literal with ) and )\" in it, which is long)x\"\n"
+      "end";
+  std::vector<tok::TokenKind> ExpectedTokens = {
+      tok::identifier, tok::identifier, tok::string_literal,
+      tok::string_literal, tok::identifier};
+  std::vector<Token> toks = CheckLex(Source, ExpectedTokens);
+
+  EXPECT_EQ("an_identifier_which_is_longer_than_a_chunk",
+            getSourceText(toks[0], toks[0]));
+  EXPECT_EQ("an_identifier_with_a_$_in_the_middle_of_it",
+            getSourceText(toks[1], toks[1]));
+  EXPECT_TRUE(toks[2].isAtStartOfLine());
+  EXPECT_EQ("\"a string literal with an escaped \\\n"
+            "newline, \\\" escapes, and ?? which is longer than a chunk\"",
+            getSourceText(toks[2], toks[2]));
+  EXPECT_EQ("R\"x(a raw string literal with ) and )\" in it, which is long)x\"",
+            getSourceText(toks[3], toks[3]));
+  EXPECT_EQ("end", getSourceText(toks[4], toks[4]));
+}
+
 } // anonymous namespace
@@ -1089,5 +1089,28 @@ TEST(DeduplicateByFileTest, NonExistingFilePath) {
   EXPECT_TRUE(FileToReplaces.empty());
 }
 
+TEST(RefactoringToolTest, AddReplacementIsOrderIndependent) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  Replacement A("/a.cc", 0, 1, "a");
+  Replacement B("/a.cc", 0, 1, "b");
+  Replacement C("/b.cc", 4, 0, "c");
+
+  RefactoringTool First(Compilations, std::vector<std::string>());
+  First.addReplacement(C);
+  First.addReplacement(B);
+  First.addReplacement(A);
+  First.addReplacement(C);
+
+  RefactoringTool Second(Compilations, std::vector<std::string>());
+  Second.addReplacement(A);
+  Second.addReplacement(C);
+  Second.addReplacement(B);
+
+  EXPECT_EQ(First.getReplacements(), Second.getReplacements());
+  EXPECT_EQ(2u, First.getReplacements().size());
+  EXPECT_EQ(1u, First.getReplacements()["/a.cc"].size());
+  EXPECT_EQ(1u, First.getReplacements()["/b.cc"].size());
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -14,6 +14,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
@@ -23,6 +24,7 @@
 #include "llvm/Support/TargetSelect.h"
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <atomic>
 #include <string>
 
 namespace clang {
@@ -531,6 +533,78 @@ TEST(ClangToolTest, InjectDiagnosticConsumerInBuildASTs) {
   EXPECT_EQ(1u, ASTs.size());
   EXPECT_EQ(1u, Consumer.NumDiagnosticsSeen);
 }
+
+namespace {
+class CountingAction : public FrontendActionFactory {
+public:
+  CountingAction() : NumCreated(0) {}
+  clang::FrontendAction *create() override {
+    ++NumCreated;
+    return new SyntaxOnlyAction;
+  }
+  std::atomic<unsigned> NumCreated;
+};
+} // end anonymous namespace
+
+TEST(ClangToolTest, RunInParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources = {"/a.cc", "/b.cc", "/c.cc", "/d.cc"};
+  ClangTool Tool(Compilations, Sources);
+  for (const std::string &Source : Sources)
+    Tool.mapVirtualFile(Source, "void f() {}");
+  CountingAction Action;
+  EXPECT_EQ(0, Tool.runInParallel(&Action, 2));
+  EXPECT_EQ(4u, Action.NumCreated);
+}
+
+TEST(ClangToolTest, RunInParallelWithDiagnosticConsumer) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources = {"/a.cc", "/b.cc", "/c.cc"};
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/a.cc", "int x = undeclared;");
+  Tool.mapVirtualFile("/b.cc", "int y = 0;");
+  Tool.mapVirtualFile("/c.cc", "int z = undeclared;");
+  TestDiagnosticConsumer Consumer;
+  Tool.setDiagnosticConsumer(&Consumer);
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(1, Tool.runInParallel(Action.get(), 3));
+  EXPECT_EQ(2u, Consumer.NumDiagnosticsSeen);
+}
+
+TEST(ClangToolTest, RunInParallelWithTextDiagnosticPrinter) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources = {"/a.cc", "/b.cc", "/c.cc", "/d.cc"};
+  ClangTool Tool(Compilations, Sources);
+  Tool.mapVirtualFile("/a.cc", "int a = undeclared_a;");
+  Tool.mapVirtualFile("/b.cc", "int b = undeclared_b;");
+  Tool.mapVirtualFile("/c.cc", "int c = 0;");
+  Tool.mapVirtualFile("/d.cc", "int d = undeclared_d;");
+  std::string Output;
+  llvm::raw_string_ostream OS(Output);
+  TextDiagnosticPrinter Printer(OS, new DiagnosticOptions());
+  Tool.setDiagnosticConsumer(&Printer);
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(1, Tool.runInParallel(Action.get(), 4));
+  OS.flush();
+
+  // The diagnostics are printed with their locations, in the order of the
+  // source paths.
+  size_t A = Output.find("/a.cc:1:9: error: use of undeclared identifier "
+                         "'undeclared_a'");
+  size_t B = Output.find("/b.cc:1:9: error: use of undeclared identifier "
+                         "'undeclared_b'");
+  size_t D = Output.find("/d.cc:1:9: error: use of undeclared identifier "
+                         "'undeclared_d'");
+  ASSERT_NE(std::string::npos, A);
+  ASSERT_NE(std::string::npos, B);
+  ASSERT_NE(std::string::npos, D);
+  EXPECT_LT(A, B);
+  EXPECT_LT(B, D);
+  EXPECT_EQ(std::string::npos, Output.find("/c.cc"));
+  EXPECT_EQ(3u, Printer.getNumErrors());
+}
 #endif
 
 } // end namespace tooling
@@ -0,0 +1,103 @@
+//===- LexBench - Benchmark the clang Lexer -------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program runs the raw lexer over the given files, typically large real
+// headers, and outputs the run time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/LangOptions.h"
+#include "clang/Lex/Lexer.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace llvm;
+
+static cl::list<std::string> Inputs(cl::Positional, cl::desc("<input files>"),
+                                    cl::OneOrMore);
+
+static cl::opt<unsigned>
+    Iterations("iterations", cl::desc("Number of times to lex each file"),
+               cl::init(100));
+
+static cl::opt<bool> DumpTokenCount(
+    "token-count",
+    cl::desc("Print the number of tokens in each file instead of timing"),
+    cl::init(false));
+
+/// Lex \p Buffer with a raw lexer, returning the number of tokens.
+static unsigned lexBuffer(const MemoryBuffer &Buffer,
+                          const LangOptions &LangOpts) {
+  Lexer L(SourceLocation(), LangOpts, Buffer.getBufferStart(),
+          Buffer.getBufferStart(), Buffer.getBufferEnd());
+  unsigned NumTokens = 0;
+  Token Tok;
+  do {
+    L.LexFromRawLexer(Tok);
+    ++NumTokens;
+  } while (Tok.isNot(tok::eof));
+  return NumTokens;
+}
+
+static void benchmark(TimerGroup &Group, StringRef Name,
+                      const MemoryBuffer &Buffer,
+                      const LangOptions &LangOpts) {
+  StringRef Text = Buffer.getBuffer();
+  Timer BaseLine((Name + ".loop").str(), (Name + ": Loop").str(), Group);
+  BaseLine.startTimer();
+  char C = 0;
+  for (unsigned I = 0; I != Iterations; ++I)
+    for (char TextC : Text)
+      C += TextC;
+  BaseLine.stopTimer();
+  volatile char DontOptimizeOut = C; (void)DontOptimizeOut;
+
+  Timer Lexing((Name + ".lexing").str(), (Name + ": Raw lexing").str(),
+               Group);
+  Lexing.startTimer();
+  unsigned NumTokens = 0;
+  for (unsigned I = 0; I != Iterations; ++I)
+    NumTokens += lexBuffer(Buffer, LangOpts);
+  Lexing.stopTimer();
+  volatile unsigned DontOptimizeOutTokens = NumTokens;
+  (void)DontOptimizeOutTokens;
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "clang lexer benchmark\n");
+
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = LangOpts.CPlusPlus14 = true;
+  LangOpts.LineComment = true;
+  LangOpts.Digraphs = true;
+  LangOpts.ObjC1 = LangOpts.ObjC2 = true;
+
+  TimerGroup Group("lex", "Lexer benchmark");
+  for (const std::string &Input : Inputs) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFileOrSTDIN(Input);
+    if (!BufOrErr) {
+      errs() << "error: cannot read '" << Input
+             << "': " << BufOrErr.getError().message() << "\n";
+      return 1;
+    }
+
+    if (DumpTokenCount) {
+      outs() << Input << ": " << lexBuffer(**BufOrErr, LangOpts)
+             << " tokens\n";
+      continue;
+    }
+    benchmark(Group, Input, **BufOrErr, LangOpts);
+  }
+
+  return 0;
+}
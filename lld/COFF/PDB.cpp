@@ -13,6 +13,8 @@
 #include "Error.h"
 #include "SymbolTable.h"
 #include "Symbols.h"
+#include "lld/Core/Parallel.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/DebugInfo/CodeView/CVDebugRecord.h"
 #include "llvm/DebugInfo/CodeView/CVTypeDumper.h"
 #include "llvm/DebugInfo/CodeView/SymbolDumper.h"
@@ -36,6 +38,8 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <memory>
 
 using namespace lld;
@@ -66,39 +70,107 @@ static SectionChunk *findByName(std::vector<SectionChunk *> &Sections,
   return nullptr;
 }
 
-static ArrayRef<uint8_t> getDebugSection(ObjectFile *File, StringRef SecName) {
+// Returns the contents of a debug section without the leading magic. Sets
+// Err instead of reporting an error so that it can be called from worker
+// threads.
+static ArrayRef<uint8_t> readDebugSection(ObjectFile *File, StringRef SecName,
+                                          std::string &Err) {
   SectionChunk *Sec = findByName(File->getDebugChunks(), SecName);
   if (!Sec)
     return {};
 
   // First 4 bytes are section magic.
   ArrayRef<uint8_t> Data = Sec->getContents();
-  if (Data.size() < 4)
-    fatal(SecName + " too short");
-  if (read32le(Data.data()) != COFF::DEBUG_SECTION_MAGIC)
-    fatal(SecName + " has an invalid magic");
+  if (Data.size() < 4) {
+    Err = (SecName + " too short").str();
+    return {};
+  }
+  if (read32le(Data.data()) != COFF::DEBUG_SECTION_MAGIC) {
+    Err = (SecName + " has an invalid magic").str();
+    return {};
+  }
   return Data.slice(4);
 }
 
+static ArrayRef<uint8_t> getDebugSection(ObjectFile *File, StringRef SecName) {
+  std::string Err;
+  ArrayRef<uint8_t> Data = readDebugSection(File, SecName, Err);
+  if (!Err.empty())
+    fatal(Err);
+  return Data;
+}
+
 // Merge .debug$T sections and returns it.
+//
+// Type records are deduplicated by TypeTableBuilder, which has a hash
+// table keyed on record contents. However, merging a type stream is
+// inherently sequential because a type index of a record depends on
+// all records added before it. What we can do in parallel is to read
+// .debug$T sections and hash their records. A record hash also covers
+// the records it refers to, so a record whose hash was seen in an
+// earlier file is mapped to the existing record without being copied.
+// Object files compiled from similar sources often have identical type
+// streams. Such streams would add no new records, so we merge only the
+// first one of them.
 static std::vector<uint8_t> mergeDebugT(SymbolTable *Symtab) {
-  ScopedPrinter W(outs());
-
-  // Visit all .debug$T sections to add them to Builder.
-  codeview::TypeTableBuilder Builder(BAlloc);
-  for (ObjectFile *File : Symtab->ObjectFiles) {
-    ArrayRef<uint8_t> Data = getDebugSection(File, ".debug$T");
+  std::vector<ObjectFile *> &Files = Symtab->ObjectFiles;
+  std::vector<ArrayRef<uint8_t>> Sections(Files.size());
+  std::vector<uint64_t> Hashes(Files.size());
+  std::vector<std::string> Errors(Files.size());
+  parallel_for(size_t(0), Files.size(), [&](size_t I) {
+    ArrayRef<uint8_t> Data = readDebugSection(Files[I], ".debug$T", Errors[I]);
+    Sections[I] = Data;
+    Hashes[I] = xxHash64(StringRef((const char *)Data.data(), Data.size()));
+  });
+  for (std::string &Err : Errors)
+    if (!Err.empty())
+      fatal(Err);
+
+  // Select the streams to merge in file order.
+  DenseMap<uint64_t, size_t> Seen;
+  std::vector<size_t> ToMerge;
+  for (size_t I = 0, E = Files.size(); I != E; ++I) {
+    ArrayRef<uint8_t> Data = Sections[I];
     if (Data.empty())
       continue;
+    auto P = Seen.insert({Hashes[I], I});
+    if (!P.second && Sections[P.first->second].equals(Data))
+      continue;
+    ToMerge.push_back(I);
+  }
 
-    msf::ByteStream Stream(Data);
-    codeview::CVTypeArray Types;
-    msf::StreamReader Reader(Stream);
-    if (auto EC = Reader.readArray(Types, Reader.getLength()))
-      fatal(EC, "Reader::readArray failed");
-    if (!codeview::mergeTypeStreams(Builder, Types))
+  // Parse the selected streams and hash their records in parallel.
+  std::vector<msf::ByteStream> Streams;
+  for (size_t I : ToMerge)
+    Streams.emplace_back(Sections[I]);
+  std::vector<codeview::CVTypeArray> Types(ToMerge.size());
+  std::vector<SmallVector<uint64_t, 0>> RecordHashes(ToMerge.size());
+  std::vector<std::string> ReadErrors(ToMerge.size());
+  parallel_for(size_t(0), ToMerge.size(), [&](size_t I) {
+    msf::StreamReader Reader(Streams[I]);
+    if (auto EC = Reader.readArray(Types[I], Reader.getLength())) {
+      ReadErrors[I] = "Reader::readArray failed: " +
+                      errorToErrorCode(std::move(EC)).message();
+      return;
+    }
+    if (!codeview::hashTypeStream(Types[I], RecordHashes[I]))
+      ReadErrors[I] = "codeview::hashTypeStream failed";
+  });
+  for (std::string &Err : ReadErrors)
+    if (!Err.empty())
+      fatal(Err);
+
+  // Visit the selected .debug$T sections to add them to Builder.
+  codeview::TypeTableBuilder Builder(BAlloc);
+  DenseMap<uint64_t, TypeIndex> HashedIndices;
+  for (size_t I = 0, E = ToMerge.size(); I != E; ++I)
+    if (!codeview::mergeTypeStreams(Builder, Types[I], RecordHashes[I],
+                                    HashedIndices))
       fatal("codeview::mergeTypeStreams failed");
-  }
+
+  if (Config->Verbose)
+    outs() << "Merged " << ToMerge.size() << " of " << Files.size()
+           << " .debug$T sections\n";
 
   // Construct section contents.
   std::vector<uint8_t> V;
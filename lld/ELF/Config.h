@@ -73,6 +73,7 @@ struct Configuration {
   InputFile *FirstElf = nullptr;
   uint8_t OSABI = 0;
   llvm::StringMap<uint64_t> SectionStartMap;
+  llvm::StringRef CacheDir;
   llvm::StringRef DynamicLinker;
   llvm::StringRef Entry;
   llvm::StringRef Emulation;
@@ -98,6 +99,7 @@ struct Configuration {
   bool Bsymbolic;
   bool BsymbolicFunctions;
   bool ColorDiagnostics = false;
+  bool CompressDebugSections;
   bool DefineCommon;
   bool Demangle = true;
   bool DisableVerify;
@@ -109,7 +111,10 @@ struct Configuration {
   bool GdbIndex;
   bool GnuHash = false;
   bool ICF;
+  bool Incremental;
+  bool LTOParallelOpt;
   bool Mips64EL = false;
+  bool MmapOutputFile;
   bool MipsN32Abi = false;
   bool NoGnuUnique;
   bool NoUndefinedVersion;
@@ -119,6 +124,7 @@ struct Configuration {
   bool Pic;
   bool Pie;
   bool PrintGcSections;
+  bool PrintStats;
   bool Rela;
   bool Relocatable;
   bool SaveTemps;
@@ -128,6 +134,7 @@ struct Configuration {
   bool SysvHash = true;
   bool Target1Rel;
   bool Threads;
+  bool TimeReport;
   bool Trace;
   bool Verbose;
   bool WarnCommon;
@@ -149,10 +156,12 @@ struct Configuration {
   ELFKind EKind = ELFNoneKind;
   uint16_t DefaultSymbolVersion = llvm::ELF::VER_NDX_GLOBAL;
   uint16_t EMachine = llvm::ELF::EM_NONE;
+  uint64_t CachePruneAfter;
   uint64_t ErrorLimit = 20;
   uint64_t ImageBase;
   uint64_t MaxPageSize;
   uint64_t ZStackSize;
+  unsigned CacheMaxSize;
   unsigned LTOPartitions;
   unsigned LTOO;
   unsigned Optimize;
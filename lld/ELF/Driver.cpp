@@ -31,6 +31,8 @@
 #include "InputSection.h"
 #include "LinkerScript.h"
 #include "Memory.h"
+#include "ParseCache.h"
+#include "Stats.h"
 #include "Strings.h"
 #include "SymbolTable.h"
 #include "Target.h"
@@ -42,6 +44,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Object/Decompressor.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
@@ -235,6 +238,10 @@ static void checkOptions(opt::InputArgList &Args) {
       error("-r and --icf may not be used together");
     if (Config->Pie)
       error("-r and -pie may not be used together");
+    if (Config->CompressDebugSections)
+      error("-r and --compress-debug-sections may not be used together");
+    if (Config->Incremental)
+      error("-r and --incremental may not be used together");
   }
 }
 
@@ -325,6 +332,7 @@ void LinkerDriver::main(ArrayRef<const char *> ArgsArr, bool CanExitEarly) {
 
   readConfigs(Args);
   initLLVM(Args);
+  startPhase("read");
   createFiles(Args);
   inferMachineType();
   checkOptions(Args);
@@ -399,6 +407,24 @@ static Target2Policy getTarget2Option(opt::InputArgList &Args) {
   return Target2Policy::GotRel;
 }
 
+static bool getCompressDebugSections(opt::InputArgList &Args) {
+  if (auto *Arg = Args.getLastArg(OPT_compress_debug_sections)) {
+    StringRef S = Arg->getValue();
+    if (S == "none")
+      return false;
+    if (S != "zlib") {
+      error("unknown --compress-debug-sections value: " + S);
+      return false;
+    }
+    if (!zlib::isAvailable()) {
+      error("--compress-debug-sections: zlib is not available");
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
+
 static bool isOutputFormatBinary(opt::InputArgList &Args) {
   if (auto *Arg = Args.getLastArg(OPT_oformat)) {
     StringRef S = Arg->getValue();
@@ -524,12 +550,17 @@ void LinkerDriver::readConfigs(opt::InputArgList &Args) {
   Config->GcSections = getArg(Args, OPT_gc_sections, OPT_no_gc_sections, false);
   Config->GdbIndex = Args.hasArg(OPT_gdb_index);
   Config->ICF = Args.hasArg(OPT_icf);
+  Config->Incremental = Args.hasArg(OPT_incremental);
+  Config->LTOParallelOpt = Args.hasArg(OPT_lto_parallel_opt);
+  Config->MmapOutputFile =
+      getArg(Args, OPT_mmap_output_file, OPT_no_mmap_output_file, true);
   Config->NoGnuUnique = Args.hasArg(OPT_no_gnu_unique);
   Config->NoUndefinedVersion = Args.hasArg(OPT_no_undefined_version);
   Config->Nostdlib = Args.hasArg(OPT_nostdlib);
   Config->OMagic = Args.hasArg(OPT_omagic);
   Config->Pie = getArg(Args, OPT_pie, OPT_nopie, false);
   Config->PrintGcSections = Args.hasArg(OPT_print_gc_sections);
+  Config->PrintStats = Args.hasArg(OPT_print_stats);
   Config->Relocatable = Args.hasArg(OPT_relocatable);
   Config->DefineCommon = getArg(Args, OPT_define_common, OPT_no_define_common,
                                 !Config->Relocatable);
@@ -539,10 +570,12 @@ void LinkerDriver::readConfigs(opt::InputArgList &Args) {
   Config->Shared = Args.hasArg(OPT_shared);
   Config->Target1Rel = getArg(Args, OPT_target1_rel, OPT_target1_abs, false);
   Config->Threads = getArg(Args, OPT_threads, OPT_no_threads, true);
+  Config->TimeReport = Args.hasArg(OPT_time_report);
   Config->Trace = Args.hasArg(OPT_trace);
   Config->Verbose = Args.hasArg(OPT_verbose);
   Config->WarnCommon = Args.hasArg(OPT_warn_common);
 
+  Config->CacheDir = getString(Args, OPT_cache_dir);
   Config->DynamicLinker = getString(Args, OPT_dynamic_linker);
   Config->Entry = getString(Args, OPT_entry);
   Config->Fini = getString(Args, OPT_fini, "_fini");
@@ -554,6 +587,9 @@ void LinkerDriver::readConfigs(opt::InputArgList &Args) {
   Config->SoName = getString(Args, OPT_soname);
   Config->Sysroot = getString(Args, OPT_sysroot);
 
+  Config->CacheMaxSize = getInteger(Args, OPT_cache_max_size, 75);
+  Config->CachePruneAfter =
+      getInteger(Args, OPT_cache_prune_after, 7 * 24 * 60 * 60);
   Config->Optimize = getInteger(Args, OPT_O, 1);
   Config->LTOO = getInteger(Args, OPT_lto_O, 2);
   if (Config->LTOO > 3)
@@ -574,6 +610,7 @@ void LinkerDriver::readConfigs(opt::InputArgList &Args) {
   Config->ZStackSize = getZOptionValue(Args, "stack-size", -1);
   Config->ZWxneeded = hasZOption(Args, "wxneeded");
 
+  Config->CompressDebugSections = getCompressDebugSections(Args);
   Config->OFormatBinary = isOutputFormatBinary(Args);
   Config->SectionStartMap = getSectionStartMap(Args);
   Config->SortSection = getSortKind(Args);
@@ -811,6 +848,7 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
 
   // Add all files to the symbol table. This will add almost all
   // symbols that we need to the symbol table.
+  startPhase("resolve");
   for (InputFile *F : Files)
     Symtab.addFile(F);
 
@@ -828,6 +866,7 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
   Symtab.scanShlibUndefined();
   Symtab.scanVersionScript();
 
+  startPhase("lto");
   Symtab.addCombinedLTOObject();
   if (ErrorCount)
     return;
@@ -846,14 +885,24 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
     for (InputSectionData *S : F->getSections())
       Symtab.Sections.push_back(cast<InputSection<ELFT>>(S));
 
+  // If --cache-dir is given, read the results of splitting sections
+  // from the cache. This needs to be done before GC, which splits
+  // .eh_frame sections.
+  std::unique_ptr<ParseCache<ELFT>> Cache;
+  if (!Config->CacheDir.empty())
+    Cache.reset(new ParseCache<ELFT>(Symtab.getObjectFiles()));
+
   // Do size optimizations: garbage collection and identical code folding.
+  startPhase("gc");
   if (Config->GcSections)
     markLive<ELFT>();
+  startPhase("icf");
   if (Config->ICF)
     doIcf<ELFT>();
 
   // MergeInputSection::splitIntoPieces needs to be called before
   // any call of MergeInputSection::getOffset. Do that.
+  startPhase("split-sections");
   forEach(Symtab.Sections.begin(), Symtab.Sections.end(),
           [](InputSectionBase<ELFT> *S) {
             if (!S->Live)
@@ -862,8 +911,15 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &Args) {
               S->uncompress();
             if (auto *MS = dyn_cast<MergeInputSection<ELFT>>(S))
               MS->splitIntoPieces();
+            else if (auto *EH = dyn_cast<EhInputSection<ELFT>>(S))
+              EH->split();
           });
 
+  if (Cache) {
+    Cache->save();
+    Cache->prune();
+  }
+
   // Write the result to the file.
   writeResult<ELFT>();
 }
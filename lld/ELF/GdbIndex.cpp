@@ -86,19 +86,29 @@ GdbIndexBuilder<ELFT>::readCUList() {
   return Ret;
 }
 
+// Iterative hash function for symbol's name is described in .gdb_index format
+// specification. Note that we use one for version 5 to 7 here, it is different
+// for version 4.
+static uint32_t hash(StringRef Str) {
+  uint32_t R = 0;
+  for (uint8_t C : Str)
+    R = R * 67 + tolower(C) - 113;
+  return R;
+}
+
 template <class ELFT>
-std::vector<std::pair<StringRef, uint8_t>>
-GdbIndexBuilder<ELFT>::readPubNamesAndTypes() {
+std::vector<NameTypeEntry> GdbIndexBuilder<ELFT>::readPubNamesAndTypes() {
   const bool IsLE = ELFT::TargetEndianness == llvm::support::little;
   StringRef Data[] = {Dwarf->getGnuPubNamesSection(),
                       Dwarf->getGnuPubTypesSection()};
 
-  std::vector<std::pair<StringRef, uint8_t>> Ret;
+  std::vector<NameTypeEntry> Ret;
   for (StringRef D : Data) {
     DWARFDebugPubTable PubTable(D, IsLE, true);
     for (const DWARFDebugPubTable::Set &S : PubTable.getData())
       for (const DWARFDebugPubTable::Entry &E : S.Entries)
-        Ret.push_back({E.Name, E.Descriptor.toBits()});
+        Ret.push_back({CachedHashStringRef(E.Name), hash(E.Name),
+                       E.Descriptor.toBits(), 0});
   }
   return Ret;
 }
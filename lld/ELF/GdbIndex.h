@@ -11,6 +11,7 @@
 #define LLD_ELF_GDB_INDEX_H
 
 #include "InputFiles.h"
+#include "llvm/ADT/CachedHashString.h"
 #include "llvm/Object/ELF.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 
@@ -27,6 +28,30 @@ template <class ELFT> struct AddressEntry {
   size_t CuIndex;
 };
 
+// A public name or type read from .debug_gnu_pubnames or
+// .debug_gnu_pubtypes.
+struct NameTypeEntry {
+  llvm::CachedHashStringRef Name;
+  uint32_t GdbHash;
+  uint8_t Type;
+
+  // An index of the unique symbol for this name in its shard. Set when
+  // names are uniquified in GdbIndexSection.
+  uint32_t SymIndex;
+};
+
+// Data extracted from one .debug_info section. Chunks do not depend on
+// each other, so they are created in parallel.
+template <class ELFT> struct GdbIndexChunk {
+  InputSection<ELFT> *DebugInfoSec;
+  std::vector<std::pair<typename ELFT::uint, typename ELFT::uint>>
+      CompilationUnits;
+
+  // CU indices in this vector are local to the chunk.
+  std::vector<AddressEntry<ELFT>> AddressArea;
+  std::vector<NameTypeEntry> NamesAndTypes;
+};
+
 // GdbIndexBuilder is a helper class used for extracting data required
 // for building .gdb_index section from objects.
 template <class ELFT> class GdbIndexBuilder : public llvm::LoadedObjectInfo {
@@ -39,6 +64,9 @@ template <class ELFT> class GdbIndexBuilder : public llvm::LoadedObjectInfo {
 public:
   GdbIndexBuilder(InputSection<ELFT> *DebugInfoSec);
 
+  // Returns false if the DWARF context could not be created.
+  bool isValid() const { return Dwarf != nullptr; }
+
   // Extracts the compilation units. Each first element of pair is a offset of a
   // CU in the .debug_info section and second is the length of that CU.
   std::vector<std::pair<uintX_t, uintX_t>> readCUList();
@@ -47,9 +75,9 @@ public:
   // parsed CU.
   std::vector<AddressEntry<ELFT>> readAddressArea(size_t CurrentCU);
 
-  // Method extracts public names and types. It returns list of name and
-  // gnu_pub* kind pairs.
-  std::vector<std::pair<StringRef, uint8_t>> readPubNamesAndTypes();
+  // Method extracts public names and types along with their gnu_pub*
+  // kinds and hash values.
+  std::vector<NameTypeEntry> readPubNamesAndTypes();
 
 private:
   // Method returns section file offset as a load addres for DWARF parser. That
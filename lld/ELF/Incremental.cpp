@@ -0,0 +1,369 @@
+//===- Incremental.cpp ----------------------------------------------------===//
+//
+//                             The LLVM Linker
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --incremental.
+//
+// Relinking a large program after editing a few source files usually
+// produces an output file that is almost identical to the previous one.
+// With --incremental, the linker saves the layout of the output to a state
+// file next to it (<output>.lld-state), and the next link reuses it.
+//
+// The next link does everything as usual until the layout is fixed, except
+// that it reserves the same space as before for each output section if its
+// new contents still fit. If the resulting layout is the same as the
+// previous one, the linker patches the previous output file in place
+// instead of creating a new file. It writes only input sections that may
+// have changed, along with all synthetic sections such as .got or .symtab.
+// If the layout is different, it falls back to a full link and saves a new
+// state.
+//
+// The contents of an input section in the output are determined by its
+// contents in the input file, its location in the output, and the values
+// applied by its relocations. So, an input section needs to be written
+// again only if the file containing it changed, or if its location or its
+// relocated values changed. The latter covers changes in symbol resolution
+// as well as symbols defined in other files that moved.
+//
+// The state file is a text file. It records a hash value of the previous
+// output file's headers, the name and content hash of each object file,
+// the location and padding of each output section, and a hash value of the
+// location and relocated values of each input section.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Incremental.h"
+#include "Config.h"
+#include "Error.h"
+#include "InputFiles.h"
+#include "InputSection.h"
+#include "LinkerScript.h"
+#include "OutputSections.h"
+#include "SymbolTable.h"
+#include "Threads.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace llvm;
+using namespace llvm::ELF;
+using namespace llvm::object;
+
+using namespace lld;
+using namespace lld::elf;
+
+static const char Magic[] = "lld-incremental-v1";
+
+static std::string getStatePath() {
+  return (Config->OutputFile + ".lld-state").str();
+}
+
+// Returns a hash value of the output file's size, modification time, ELF
+// header and section header table. If the file has been modified by
+// someone else since the last link, the value does not match the one in
+// the state file.
+template <class ELFT> static uint64_t getOutputHash() {
+  typedef typename ELFT::Ehdr Elf_Ehdr;
+
+  sys::fs::file_status Status;
+  if (sys::fs::status(Config->OutputFile, Status))
+    return 0;
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(Config->OutputFile, -1, false);
+  if (!MBOrErr)
+    return 0;
+
+  StringRef Buf = (*MBOrErr)->getBuffer();
+  if (Buf.size() < sizeof(Elf_Ehdr))
+    return 0;
+  auto *EHdr = reinterpret_cast<const Elf_Ehdr *>(Buf.data());
+  uint64_t ShSize = (uint64_t)EHdr->e_shnum * EHdr->e_shentsize;
+  if (EHdr->e_shoff > Buf.size() || ShSize > Buf.size() - EHdr->e_shoff)
+    return 0;
+
+  uint64_t V[] = {Status.getSize(),
+                  (uint64_t)Status.getLastModificationTime()
+                      .time_since_epoch()
+                      .count(),
+                  xxHash64(Buf.substr(0, sizeof(Elf_Ehdr))),
+                  xxHash64(Buf.substr(EHdr->e_shoff, ShSize))};
+  return xxHash64(StringRef((const char *)V, sizeof(V)));
+}
+
+template <class ELFT> IncrementalLink<ELFT>::IncrementalLink() {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(getStatePath());
+  if (!MBOrErr)
+    return;
+  StateBuf = std::move(*MBOrErr);
+
+  if (!parseState(StateBuf->getBuffer())) {
+    log("--incremental: ignoring malformed state file " + getStatePath());
+    return;
+  }
+  if (PrevOutputHash != getOutputHash<ELFT>()) {
+    log("--incremental: " + Config->OutputFile +
+        " has been modified since the last link");
+    return;
+  }
+  HasState = true;
+}
+
+static bool toInt(StringRef S, uint64_t &V) { return !S.getAsInteger(16, V); }
+
+template <class ELFT> bool IncrementalLink<ELFT>::parseState(StringRef S) {
+  SmallVector<StringRef, 0> Lines;
+  S.split(Lines, '\n', -1, false);
+  if (Lines.empty() || Lines[0] != Magic)
+    return false;
+
+  for (StringRef Line : makeArrayRef(Lines).slice(1)) {
+    SmallVector<StringRef, 6> F;
+    Line.split(F, '\t');
+
+    if (F[0] == "output" && F.size() == 3) {
+      if (!toInt(F[1], PrevFileSize) || !toInt(F[2], PrevOutputHash))
+        return false;
+      continue;
+    }
+
+    if (F[0] == "file" && F.size() == 3) {
+      FileState File;
+      File.Name = F[2];
+      if (!toInt(F[1], File.Hash))
+        return false;
+      PrevFiles.push_back(File);
+      continue;
+    }
+
+    if (F[0] == "sec" && F.size() == 6) {
+      OutputSectionState Sec;
+      Sec.Name = F[1];
+      if (!toInt(F[2], Sec.Addr) || !toInt(F[3], Sec.Offset) ||
+          !toInt(F[4], Sec.Size) || !toInt(F[5], Sec.Padding))
+        return false;
+      PrevSections.push_back(Sec);
+      continue;
+    }
+
+    if (F[0] == "isec" && F.size() == 4) {
+      // Section indices are DenseMap keys, so the empty and tombstone
+      // keys (and anything that doesn't fit in 32 bits) are rejected.
+      uint64_t FileIndex, SecIndex, Hash;
+      if (!toInt(F[1], FileIndex) || !toInt(F[2], SecIndex) ||
+          !toInt(F[3], Hash) || FileIndex >= PrevFiles.size() ||
+          SecIndex >= DenseMapInfo<uint32_t>::getTombstoneKey())
+        return false;
+      PrevRelocHashes.resize(PrevFiles.size());
+      PrevRelocHashes[FileIndex][SecIndex] = Hash;
+      continue;
+    }
+    return false;
+  }
+  PrevRelocHashes.resize(PrevFiles.size());
+  return true;
+}
+
+template <class ELFT>
+const typename IncrementalLink<ELFT>::OutputSectionState *
+IncrementalLink<ELFT>::getPrevSection(OutputSectionBase *Sec) {
+  size_t I = Sec->SectionIndex - 1;
+  if (!HasState || I >= PrevSections.size() ||
+      PrevSections[I].Name != Sec->Name)
+    return nullptr;
+  return &PrevSections[I];
+}
+
+template <class ELFT>
+uint64_t IncrementalLink<ELFT>::getPadding(OutputSectionBase *Sec) {
+  uint64_t Padding;
+  const OutputSectionState *Prev = getPrevSection(Sec);
+  if (Prev && Sec->Size <= Prev->Size + Prev->Padding)
+    Padding = Prev->Size + Prev->Padding - Sec->Size;
+  else
+    Padding = std::max<uint64_t>(Sec->Size / 8, 64);
+  Paddings[Sec] = Padding;
+  return Padding;
+}
+
+// Returns S as an InputSection if it is a regular input section that
+// can be left as is in the output.
+template <class ELFT>
+static InputSection<ELFT> *getRegularSection(InputSectionBase<ELFT> *S) {
+  if (!S || S == &InputSection<ELFT>::Discarded || !S->Live || !S->OutSec)
+    return nullptr;
+  if (S->kind() != InputSectionData::Regular ||
+      !isa<OutputSection<ELFT>>(S->OutSec))
+    return nullptr;
+
+  // Thunks are not covered by getRelocHash().
+  auto *IS = cast<InputSection<ELFT>>(S);
+  if (IS->getThunksSize())
+    return nullptr;
+  return IS;
+}
+
+template <class ELFT> void IncrementalLink<ELFT>::computeHashes() {
+  if (HashesComputed)
+    return;
+  HashesComputed = true;
+
+  ArrayRef<ObjectFile<ELFT> *> Files = Symtab<ELFT>::X->getObjectFiles();
+  FileHashes.resize(Files.size());
+  RelocHashes.resize(Files.size());
+
+  forLoop(0, Files.size(), [&](size_t I) {
+    FileHashes[I] = xxHash64(Files[I]->MB.getBuffer());
+    ArrayRef<InputSectionBase<ELFT> *> Sections = Files[I]->getSections();
+    for (size_t J = 0, E = Sections.size(); J != E; ++J)
+      if (InputSection<ELFT> *IS = getRegularSection(Sections[J]))
+        RelocHashes[I].push_back({J, IS->getRelocHash()});
+  });
+}
+
+template <class ELFT>
+bool IncrementalLink<ELFT>::canPatch(
+    ArrayRef<OutputSectionBase *> OutputSections, uint64_t FileSize) {
+  computeHashes();
+  if (!HasState)
+    return false;
+
+  auto Fail = [](const Twine &Msg) {
+    log("--incremental: full link: " + Msg);
+    return false;
+  };
+
+  if (ScriptConfig->HasSections)
+    return Fail("SECTIONS command is not supported");
+  if (Config->OFormatBinary)
+    return Fail("--oformat binary is not supported");
+  if (OutputSections.size() != PrevSections.size())
+    return Fail("number of output sections changed");
+  for (OutputSectionBase *Sec : OutputSections) {
+    const OutputSectionState *Prev = getPrevSection(Sec);
+    if (!Prev)
+      return Fail("output sections changed");
+    if (Sec->Addr != Prev->Addr || Sec->Offset != Prev->Offset)
+      return Fail(Sec->Name + " moved");
+  }
+  if (FileSize != PrevFileSize)
+    return Fail("output file size changed");
+
+  // Find input sections that remain the same in the output.
+  ArrayRef<ObjectFile<ELFT> *> Files = Symtab<ELFT>::X->getObjectFiles();
+  forLoop(0, Files.size(), [&](size_t I) {
+    if (I >= PrevFiles.size() || PrevFiles[I].Hash != FileHashes[I] ||
+        PrevFiles[I].Name != toString(Files[I]))
+      return;
+    ArrayRef<InputSectionBase<ELFT> *> Sections = Files[I]->getSections();
+    for (std::pair<uint32_t, uint64_t> &P : RelocHashes[I]) {
+      auto It = PrevRelocHashes[I].find(P.first);
+      if (It != PrevRelocHashes[I].end() && It->second == P.second)
+        Sections[P.first]->Unchanged = true;
+    }
+  });
+
+  if (Config->Verbose) {
+    size_t NumSections = 0;
+    size_t NumUnchanged = 0;
+    for (ObjectFile<ELFT> *File : Files) {
+      for (InputSectionBase<ELFT> *S : File->getSections()) {
+        if (!getRegularSection(S))
+          continue;
+        ++NumSections;
+        if (S->Unchanged)
+          ++NumUnchanged;
+      }
+    }
+    log("--incremental: patching " + Config->OutputFile + "; " +
+        Twine(NumSections - NumUnchanged) + " of " + Twine(NumSections) +
+        " input sections changed");
+  }
+  return true;
+}
+
+template <class ELFT>
+uint8_t *IncrementalLink<ELFT>::openOutput(uint64_t FileSize) {
+  int FD;
+  if (std::error_code EC = sys::fs::openFileForWrite(
+          Config->OutputFile, FD, sys::fs::F_RW | sys::fs::F_Append)) {
+    log("--incremental: cannot open " + Config->OutputFile + ": " +
+        EC.message());
+    return nullptr;
+  }
+
+  std::error_code EC;
+  Map.reset(new sys::fs::mapped_file_region(
+      FD, sys::fs::mapped_file_region::readwrite, FileSize, 0, EC));
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  if (EC) {
+    log("--incremental: cannot map " + Config->OutputFile + ": " +
+        EC.message());
+    Map.reset();
+    return nullptr;
+  }
+  return (uint8_t *)Map->data();
+}
+
+template <class ELFT>
+void IncrementalLink<ELFT>::clearStaleBytes(
+    uint8_t *Buf, ArrayRef<OutputSectionBase *> OutputSections) {
+  for (OutputSectionBase *Sec : OutputSections) {
+    if (Sec->Type == SHT_NOBITS)
+      continue;
+    uint64_t PrevSize = getPrevSection(Sec)->Size;
+
+    // Regular output sections are written by writeChangedTo(), which
+    // clears gaps around input sections it writes. Other sections are
+    // written as a whole, so we clear them entirely.
+    if (isa<OutputSection<ELFT>>(Sec) && Sec->CompressedData.empty()) {
+      if (Sec->Size < PrevSize)
+        memset(Buf + Sec->Offset + Sec->Size, 0, PrevSize - Sec->Size);
+      continue;
+    }
+    memset(Buf + Sec->Offset, 0, std::max<uint64_t>(Sec->Size, PrevSize));
+  }
+}
+
+template <class ELFT>
+void IncrementalLink<ELFT>::writeState(
+    ArrayRef<OutputSectionBase *> OutputSections, uint64_t FileSize) {
+  computeHashes();
+
+  std::error_code EC;
+  raw_fd_ostream OS(getStatePath(), EC, sys::fs::F_None);
+  if (EC) {
+    error("cannot open " + getStatePath() + ": " + EC.message());
+    return;
+  }
+
+  OS << Magic << '\n';
+  OS << "output\t" << utohexstr(FileSize) << '\t'
+     << utohexstr(getOutputHash<ELFT>()) << '\n';
+
+  ArrayRef<ObjectFile<ELFT> *> Files = Symtab<ELFT>::X->getObjectFiles();
+  for (size_t I = 0, E = Files.size(); I != E; ++I)
+    OS << "file\t" << utohexstr(FileHashes[I]) << '\t' << toString(Files[I])
+       << '\n';
+
+  for (OutputSectionBase *Sec : OutputSections)
+    OS << "sec\t" << Sec->Name << '\t' << utohexstr(Sec->Addr) << '\t'
+       << utohexstr(Sec->Offset) << '\t' << utohexstr(Sec->Size) << '\t'
+       << utohexstr(Paddings.lookup(Sec)) << '\n';
+
+  for (size_t I = 0, E = Files.size(); I != E; ++I)
+    for (std::pair<uint32_t, uint64_t> &P : RelocHashes[I])
+      OS << "isec\t" << utohexstr(I) << '\t' << utohexstr(P.first) << '\t'
+         << utohexstr(P.second) << '\n';
+}
+
+template class elf::IncrementalLink<ELF32LE>;
+template class elf::IncrementalLink<ELF32BE>;
+template class elf::IncrementalLink<ELF64LE>;
+template class elf::IncrementalLink<ELF64BE>;
@@ -0,0 +1,95 @@
+//===- Incremental.h --------------------------------------------*- C++ -*-===//
+//
+//                             The LLVM Linker
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_INCREMENTAL_H
+#define LLD_ELF_INCREMENTAL_H
+
+#include "lld/Core/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <vector>
+
+namespace lld {
+namespace elf {
+
+class OutputSectionBase;
+
+// This class implements --incremental. See Incremental.cpp for details.
+template <class ELFT> class IncrementalLink {
+public:
+  // Reads the state file of the previous link if it exists and is
+  // consistent with the current output file.
+  IncrementalLink();
+
+  // Returns the number of bytes to be reserved after a given output
+  // section. Sections are given the same space as in the previous link
+  // if their contents still fit, so that following sections do not move.
+  uint64_t getPadding(OutputSectionBase *Sec);
+
+  // Returns true if the layout of the output is the same as the previous
+  // one. If true, it also sets the Unchanged bits of input sections that
+  // do not need to be written again.
+  bool canPatch(ArrayRef<OutputSectionBase *> OutputSections,
+                uint64_t FileSize);
+
+  // Maps the previous output file to memory. Returns nullptr on failure.
+  uint8_t *openOutput(uint64_t FileSize);
+  void closeOutput() { Map.reset(); }
+
+  // Clears bytes in the previous output that are not going to be
+  // overwritten but may be stale.
+  void clearStaleBytes(uint8_t *Buf,
+                       ArrayRef<OutputSectionBase *> OutputSections);
+
+  // Saves the state of this link for the next one.
+  void writeState(ArrayRef<OutputSectionBase *> OutputSections,
+                  uint64_t FileSize);
+
+private:
+  struct OutputSectionState {
+    StringRef Name;
+    uint64_t Addr;
+    uint64_t Offset;
+    uint64_t Size;
+    uint64_t Padding;
+  };
+
+  struct FileState {
+    StringRef Name;
+    uint64_t Hash;
+  };
+
+  bool parseState(StringRef S);
+  void computeHashes();
+  const OutputSectionState *getPrevSection(OutputSectionBase *Sec);
+
+  // The state of the previous link.
+  std::unique_ptr<llvm::MemoryBuffer> StateBuf;
+  bool HasState = false;
+  uint64_t PrevFileSize = 0;
+  uint64_t PrevOutputHash = 0;
+  std::vector<OutputSectionState> PrevSections;
+  std::vector<FileState> PrevFiles;
+  std::vector<llvm::DenseMap<uint32_t, uint64_t>> PrevRelocHashes;
+
+  // The state of the current link.
+  bool HashesComputed = false;
+  std::vector<uint64_t> FileHashes;
+  std::vector<std::vector<std::pair<uint32_t, uint64_t>>> RelocHashes;
+  llvm::DenseMap<OutputSectionBase *, uint64_t> Paddings;
+
+  std::unique_ptr<llvm::sys::fs::mapped_file_region> Map;
+};
+
+} // namespace elf
+} // namespace lld
+
+#endif
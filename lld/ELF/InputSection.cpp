@@ -22,6 +22,7 @@
 #include "llvm/Object/Decompressor.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/xxhash.h"
 #include <mutex>
 
 using namespace llvm;
@@ -466,6 +467,44 @@ void InputSection<ELFT>::relocateNonAlloc(uint8_t *Buf, ArrayRef<RelTy> Rels) {
   }
 }
 
+template <class ELFT>
+template <class RelTy>
+void InputSection<ELFT>::hashNonAllocRelocs(std::vector<uint64_t> &V,
+                                            ArrayRef<RelTy> Rels) {
+  for (const RelTy &Rel : Rels) {
+    uint32_t Type = Rel.getType(Config->Mips64EL);
+    uintX_t Addend = getAddend<ELFT>(Rel);
+    if (!RelTy::IsRela)
+      Addend += Target->getImplicitAddend(this->Data.data() + Rel.r_offset,
+                                          Type);
+
+    SymbolBody &Sym = this->File->getRelocTargetSym(Rel);
+    uintX_t AddrLoc = this->OutSec->Addr + this->getOffset(Rel.r_offset);
+    if (!Sym.isTls() || Out<ELFT>::TlsPhdr)
+      V.push_back(getRelocTargetVA<ELFT>(Type, Addend, AddrLoc, Sym, R_ABS));
+  }
+}
+
+template <class ELFT> uint64_t InputSection<ELFT>::getRelocHash() {
+  std::vector<uint64_t> V = {this->OutSec->Addr, this->OutSec->Offset,
+                             OutSecOff, this->getSize()};
+
+  if (!(this->Flags & SHF_ALLOC)) {
+    if (this->AreRelocsRela)
+      hashNonAllocRelocs(V, this->relas());
+    else
+      hashNonAllocRelocs(V, this->rels());
+  } else {
+    for (const Relocation &Rel : this->Relocations) {
+      uintX_t AddrLoc = this->OutSec->Addr + this->getOffset(Rel.Offset);
+      V.push_back(getRelocTargetVA<ELFT>(Rel.Type, Rel.Addend, AddrLoc,
+                                         *Rel.Sym, Rel.Expr));
+    }
+  }
+  return xxHash64(
+      StringRef((const char *)V.data(), V.size() * sizeof(uint64_t)));
+}
+
 template <class ELFT>
 void InputSectionBase<ELFT>::relocate(uint8_t *Buf, uint8_t *BufEnd) {
   // scanReloc function in Writer.cpp constructs Relocations
@@ -614,6 +653,13 @@ template <class ELFT> void EhInputSection<ELFT>::split() {
   if (!this->Pieces.empty())
     return;
 
+  if (!CachedPieces.empty()) {
+    for (const CachedPiece &P : CachedPieces)
+      this->Pieces.emplace_back(P.InputOff, this, P.HashOrSize,
+                                P.FirstRelocation);
+    return;
+  }
+
   if (this->NumRelocations) {
     if (this->AreRelocsRela)
       split(this->relas());
@@ -701,10 +747,19 @@ MergeInputSection<ELFT>::MergeInputSection(elf::ObjectFile<ELFT> *F,
 template <class ELFT> void MergeInputSection<ELFT>::splitIntoPieces() {
   ArrayRef<uint8_t> Data = this->Data;
   uintX_t EntSize = this->Entsize;
-  if (this->Flags & SHF_STRINGS)
+  if (!CachedPieces.empty()) {
+    bool IsAlloc = this->Flags & SHF_ALLOC;
+    Pieces.reserve(CachedPieces.size());
+    Hashes.reserve(CachedPieces.size());
+    for (const CachedPiece &P : CachedPieces) {
+      Pieces.emplace_back(P.InputOff, !IsAlloc);
+      Hashes.push_back(P.HashOrSize);
+    }
+  } else if (this->Flags & SHF_STRINGS) {
     splitStrings(Data, EntSize);
-  else
+  } else {
     splitNonStrings(Data, EntSize);
+  }
 
   if (Config->GcSections && (this->Flags & SHF_ALLOC))
     for (uintX_t Off : LiveOffsets)
@@ -46,8 +46,8 @@ public:
   // If GC is disabled, all sections are considered live by default.
   InputSectionData(Kind SectionKind, StringRef Name, ArrayRef<uint8_t> Data,
                    bool Live)
-      : SectionKind(SectionKind), Live(Live), Assigned(false), Name(Name),
-        Data(Data) {}
+      : SectionKind(SectionKind), Live(Live), Assigned(false),
+        Unchanged(false), Name(Name), Data(Data) {}
 
 private:
   unsigned SectionKind : 3;
@@ -57,6 +57,7 @@ public:
 
   unsigned Live : 1;       // for garbage collection
   unsigned Assigned : 1;   // for linker script
+  unsigned Unchanged : 1;  // for --incremental
   uint32_t Alignment;
   StringRef Name;
   ArrayRef<uint8_t> Data;
@@ -161,6 +162,15 @@ struct SectionPiece {
 static_assert(sizeof(SectionPiece) == 2 * sizeof(size_t),
               "SectionPiece is too big");
 
+// A SectionPiece read from the cache of --cache-dir. For mergeable
+// sections, HashOrSize is the hash value of the piece. For .eh_frame
+// sections, it is the size of the piece. See ParseCache.cpp.
+struct CachedPiece {
+  uint64_t InputOff;
+  uint32_t HashOrSize;
+  uint32_t FirstRelocation;
+};
+
 // This corresponds to a SHF_MERGE section of an input file.
 template <class ELFT> class MergeInputSection : public InputSectionBase<ELFT> {
   typedef typename ELFT::uint uintX_t;
@@ -206,6 +216,10 @@ public:
   SectionPiece *getSectionPiece(uintX_t Offset);
   const SectionPiece *getSectionPiece(uintX_t Offset) const;
 
+  // If non-empty, splitIntoPieces() uses them instead of splitting
+  // section contents.
+  ArrayRef<CachedPiece> CachedPieces;
+
 private:
   void splitStrings(ArrayRef<uint8_t> A, size_t Size);
   void splitNonStrings(ArrayRef<uint8_t> A, size_t Size);
@@ -244,6 +258,9 @@ public:
   // Splittable sections are handled as a sequence of data
   // rather than a single large blob of data.
   std::vector<EhSectionPiece> Pieces;
+
+  // If non-empty, split() uses them instead of splitting section contents.
+  ArrayRef<CachedPiece> CachedPieces;
 };
 
 // This corresponds to a non SHF_MERGE section of an input file.
@@ -294,6 +311,11 @@ public:
   template <class RelTy>
   void relocateNonAlloc(uint8_t *Buf, llvm::ArrayRef<RelTy> Rels);
 
+  // Returns a hash value of this section's location and the values
+  // relocate() would apply to it. Used by --incremental to find sections
+  // whose contents in the output have not changed since the last link.
+  uint64_t getRelocHash();
+
   // Used by ICF.
   uint32_t Class[2] = {0, 0};
 
@@ -304,6 +326,9 @@ private:
   template <class RelTy>
   void copyRelocations(uint8_t *Buf, llvm::ArrayRef<RelTy> Rels);
 
+  template <class RelTy>
+  void hashNonAllocRelocs(std::vector<uint64_t> &V, llvm::ArrayRef<RelTy> Rels);
+
   llvm::TinyPtrVector<const Thunk<ELFT> *> Thunks;
 };
 
@@ -866,8 +866,11 @@ static void writeInt(uint8_t *Buf, uint64_t Data, uint64_t Size) {
   }
 }
 
+// Writes the data commands of the given section that start in the range
+// [Begin, End) of the section. Buf corresponds to the offset Begin.
 template <class ELFT>
-void LinkerScript<ELFT>::writeDataBytes(StringRef Name, uint8_t *Buf) {
+void LinkerScript<ELFT>::writeDataBytes(StringRef Name, uint8_t *Buf,
+                                        uint64_t Begin, uint64_t End) {
   int I = getSectionIndex(Name);
   if (I == INT_MAX)
     return;
@@ -875,7 +878,9 @@ void LinkerScript<ELFT>::writeDataBytes(StringRef Name, uint8_t *Buf) {
   auto *Cmd = dyn_cast<OutputSectionCommand>(Opt.Commands[I].get());
   for (const std::unique_ptr<BaseCommand> &Base : Cmd->Commands)
     if (auto *Data = dyn_cast<BytesDataCommand>(Base.get()))
-      writeInt<ELFT>(Buf + Data->Offset, Data->Expression(0), Data->Size);
+      if (Begin <= Data->Offset && Data->Offset < End)
+        writeInt<ELFT>(Buf + Data->Offset - Begin, Data->Expression(0),
+                       Data->Size);
 }
 
 template <class ELFT> bool LinkerScript<ELFT>::hasLMA(StringRef Name) {
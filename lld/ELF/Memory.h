@@ -41,18 +41,25 @@ struct SpecificAllocBase {
   SpecificAllocBase() { Instances.push_back(this); }
   virtual ~SpecificAllocBase() = default;
   virtual void reset() = 0;
+  virtual size_t getBytesAllocated() const = 0;
   static std::vector<SpecificAllocBase *> Instances;
 };
 
 template <class T> struct SpecificAlloc : public SpecificAllocBase {
-  void reset() override { Alloc.DestroyAll(); }
+  void reset() override {
+    Alloc.DestroyAll();
+    NumObjects = 0;
+  }
+  size_t getBytesAllocated() const override { return NumObjects * sizeof(T); }
   llvm::SpecificBumpPtrAllocator<T> Alloc;
+  size_t NumObjects = 0;
 };
 
 // Use this arena if your object has a destructor.
 // Your destructor will be invoked from freeArena().
 template <typename T, typename... U> T *make(U &&... Args) {
   static SpecificAlloc<T> Alloc;
+  ++Alloc.NumObjects;
   return new (Alloc.Alloc.Allocate()) T(std::forward<U>(Args)...);
 }
 
@@ -17,6 +17,7 @@
 #include "SyntheticSections.h"
 #include "Target.h"
 #include "Threads.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/Support/MathExtras.h"
@@ -62,6 +63,84 @@ void OutputSectionBase::writeHeaderTo(typename ELFT::Shdr *Shdr) {
   Shdr->sh_name = ShName;
 }
 
+// Compresses Data as a zlib stream and appends it to Out.
+//
+// In order to utilize multiple cores, we split the input into 1 MiB
+// chunks and deflate them independently. Each chunk except the last one
+// is terminated by a sync flush, which byte-aligns the output without
+// ending the stream, so the concatenation of the chunks is a single valid
+// deflate stream. The Adler-32 checksum of the whole input is computed
+// by combining checksums of the chunks.
+static void deflateChunked(ArrayRef<uint8_t> Data, std::vector<uint8_t> &Out) {
+  const size_t ChunkSize = 1024 * 1024;
+  size_t NumChunks = (Data.size() + ChunkSize - 1) / ChunkSize;
+  std::vector<SmallVector<char, 0>> Chunks(NumChunks);
+  std::vector<uint32_t> Checksums(NumChunks);
+
+  // Prefer speed over size unless -O2 is given.
+  zlib::CompressionLevel Level = (Config->Optimize >= 2)
+                                     ? zlib::DefaultCompression
+                                     : zlib::BestSpeedCompression;
+
+  // Errors are reported after the loop because fatal() must not be
+  // called from worker threads.
+  std::vector<std::string> Errors(NumChunks);
+  forLoop(0, NumChunks, [&](size_t I) {
+    StringRef In = toStringRef(Data.slice(I * ChunkSize));
+    In = In.substr(0, ChunkSize);
+    if (Error E = zlib::compressChunk(In, Chunks[I], Level,
+                                      /*IsLast=*/I == NumChunks - 1))
+      Errors[I] = toString(std::move(E));
+    Checksums[I] = zlib::adler32(In);
+  });
+  for (const std::string &Err : Errors)
+    if (!Err.empty())
+      fatal("--compress-debug-sections: " + Err);
+
+  uint8_t Header[2];
+  write16be(Header, zlib::getHeader(Level));
+  Out.insert(Out.end(), Header, Header + 2);
+
+  uint32_t Checksum = zlib::adler32("");
+  for (size_t I = 0; I < NumChunks; ++I) {
+    Out.insert(Out.end(), Chunks[I].begin(), Chunks[I].end());
+    size_t Len = std::min(ChunkSize, Data.size() - I * ChunkSize);
+    Checksum = zlib::adler32Combine(Checksum, Checksums[I], Len);
+  }
+
+  uint8_t Trailer[4];
+  write32be(Trailer, Checksum);
+  Out.insert(Out.end(), Trailer, Trailer + 4);
+}
+
+// Compresses this section if it is a debug section and
+// --compress-debug-sections is given. This must be called after
+// addresses are fixed because debug sections contain relocations
+// pointing to allocated sections. It changes the size of the section,
+// so file offsets need to be (re)computed after this.
+template <class ELFT> void OutputSectionBase::maybeCompress() {
+  typedef typename ELFT::Chdr Elf_Chdr;
+
+  if (!Config->CompressDebugSections || (Flags & SHF_ALLOC) || Size == 0 ||
+      !Name.startswith(".debug_"))
+    return;
+
+  // Write the uncompressed contents to a temporary buffer.
+  std::vector<uint8_t> Buf(Size);
+  writeTo(Buf.data());
+
+  // The compressed contents start with a compression header.
+  CompressedData.resize(sizeof(Elf_Chdr));
+  deflateChunked(Buf, CompressedData);
+  auto *Hdr = reinterpret_cast<Elf_Chdr *>(CompressedData.data());
+  Hdr->ch_type = ELFCOMPRESS_ZLIB;
+  Hdr->ch_size = Size;
+  Hdr->ch_addralign = Addralign;
+
+  Size = CompressedData.size();
+  Flags |= SHF_COMPRESSED;
+}
+
 template <class ELFT> static uint64_t getEntsize(uint32_t Type) {
   switch (Type) {
   case SHT_RELA:
@@ -265,7 +344,47 @@ template <class ELFT> void OutputSection<ELFT>::writeTo(uint8_t *Buf) {
 
   // Linker scripts may have BYTE()-family commands with which you
   // can write arbitrary bytes to the output. Process them if any.
-  Script<ELFT>::X->writeDataBytes(this->Name, Buf);
+  Script<ELFT>::X->writeDataBytes(this->Name, Buf, 0, this->Size);
+}
+
+// Used by --incremental to patch the previous output. Writes only input
+// sections whose Unchanged bits are not set. The space between such a
+// section and its neighbors is cleared first because the previous output
+// may have other contents there.
+template <class ELFT> void OutputSection<ELFT>::writeChangedTo(uint8_t *Buf) {
+  Loc = Buf;
+  if (this->Type == SHT_NOBITS)
+    return;
+
+  // Each changed section clears itself and the gap after it. The gap
+  // before it is cleared only if the previous section is unchanged, so
+  // that no two threads write to the same bytes.
+  forLoop(0, Sections.size(), [&](size_t I) {
+    InputSection<ELFT> *IS = Sections[I];
+    if (IS->Unchanged)
+      return;
+    uintX_t Begin = 0;
+    if (I > 0) {
+      InputSection<ELFT> *Prev = Sections[I - 1];
+      Begin = Prev->Unchanged ? Prev->OutSecOff + Prev->getSize()
+                              : IS->OutSecOff;
+    }
+    uintX_t End = this->Size;
+    if (I + 1 < Sections.size())
+      End = Sections[I + 1]->OutSecOff;
+    memset(Buf + Begin, 0, End - Begin);
+    IS->writeTo(Buf);
+  });
+}
+
+// The number of shards used to deduplicate section pieces.
+// Must be a power of 2.
+static const size_t NumShards = 32;
+
+// Pieces are assigned to shards by the upper bits of their hash values
+// because DenseMap uses the lower bits to select buckets.
+static size_t getShardId(uint32_t Hash) {
+  return Hash >> (32 - llvm::countTrailingZeros(NumShards));
 }
 
 template <class ELFT>
@@ -279,13 +398,23 @@ void EhOutputSection<ELFT>::forEachInputSection(
     F(S);
 }
 
-// Search for an existing CIE record or create a new one.
-// CIE records from input object files are uniquified by their contents
-// and where their relocations point to.
-template <class ELFT>
-template <class RelTy>
-CieRecord *EhOutputSection<ELFT>::addCie(EhSectionPiece &Piece,
-                                         ArrayRef<RelTy> Rels) {
+namespace {
+// A CIE record of an input section and FDEs associated with it.
+struct LocalCie {
+  EhSectionPiece *Piece;
+  SymbolBody *Personality;
+  uint32_t Hash;
+  std::vector<EhSectionPiece *> FdePieces;
+
+  // The first CIE in input order that has the same contents and
+  // personality function as this one.
+  LocalCie *Leader = nullptr;
+  CieRecord *Out = nullptr;
+};
+} // anonymous namespace
+
+template <class ELFT, class RelTy>
+static LocalCie readCie(EhSectionPiece &Piece, ArrayRef<RelTy> Rels) {
   auto *Sec = cast<EhInputSection<ELFT>>(Piece.ID);
   const endianness E = ELFT::TargetEndianness;
   if (read32<E>(Piece.data().data() + 4) != 0)
@@ -296,23 +425,21 @@ CieRecord *EhOutputSection<ELFT>::addCie(EhSectionPiece &Piece,
   if (FirstRelI != (unsigned)-1)
     Personality = &Sec->getFile()->getRelocTargetSym(Rels[FirstRelI]);
 
-  // Search for an existing CIE by CIE contents/relocation target pair.
-  CieRecord *Cie = &CieMap[{Piece.data(), Personality}];
-
-  // If not found, create a new one.
-  if (Cie->Piece == nullptr) {
-    Cie->Piece = &Piece;
-    Cies.push_back(Cie);
-  }
+  ArrayRef<uint8_t> D = Piece.data();
+  uint32_t Hash =
+      hash_combine(hash_value(StringRef((const char *)D.data(), D.size())),
+                   Personality);
+  LocalCie Cie;
+  Cie.Piece = &Piece;
+  Cie.Personality = Personality;
+  Cie.Hash = Hash;
   return Cie;
 }
 
 // There is one FDE per function. Returns true if a given FDE
 // points to a live function.
-template <class ELFT>
-template <class RelTy>
-bool EhOutputSection<ELFT>::isFdeLive(EhSectionPiece &Piece,
-                                      ArrayRef<RelTy> Rels) {
+template <class ELFT, class RelTy>
+static bool isFdeLive(EhSectionPiece &Piece, ArrayRef<RelTy> Rels) {
   auto *Sec = cast<EhInputSection<ELFT>>(Piece.ID);
   unsigned FirstRelI = Piece.FirstRelocation;
   if (FirstRelI == (unsigned)-1)
@@ -328,15 +455,14 @@ bool EhOutputSection<ELFT>::isFdeLive(EhSectionPiece &Piece,
 
 // .eh_frame is a sequence of CIE or FDE records. In general, there
 // is one CIE record per input object file which is followed by
-// a list of FDEs. This function searches an existing CIE or create a new
-// one and associates FDEs to the CIE.
-template <class ELFT>
-template <class RelTy>
-void EhOutputSection<ELFT>::addSectionAux(EhInputSection<ELFT> *Sec,
-                                          ArrayRef<RelTy> Rels) {
+// a list of FDEs. This function reads CIEs of a given section and
+// associates live FDEs with them. This function is thread-safe.
+template <class ELFT, class RelTy>
+static void readCiesAndFdes(EhInputSection<ELFT> *Sec, ArrayRef<RelTy> Rels,
+                            std::vector<LocalCie> &Cies) {
   const endianness E = ELFT::TargetEndianness;
 
-  DenseMap<size_t, CieRecord *> OffsetToCie;
+  DenseMap<size_t, size_t> OffsetToCie;
   for (EhSectionPiece &Piece : Sec->Pieces) {
     // The empty record is the end marker.
     if (Piece.size() == 4)
@@ -345,22 +471,34 @@ void EhOutputSection<ELFT>::addSectionAux(EhInputSection<ELFT> *Sec,
     size_t Offset = Piece.InputOff;
     uint32_t ID = read32<E>(Piece.data().data() + 4);
     if (ID == 0) {
-      OffsetToCie[Offset] = addCie(Piece, Rels);
+      OffsetToCie[Offset] = Cies.size();
+      Cies.push_back(readCie<ELFT>(Piece, Rels));
       continue;
     }
 
     uint32_t CieOffset = Offset + 4 - ID;
-    CieRecord *Cie = OffsetToCie[CieOffset];
-    if (!Cie)
+    auto It = OffsetToCie.find(CieOffset);
+    if (It == OffsetToCie.end())
       fatal(toString(Sec) + ": invalid CIE reference");
 
-    if (!isFdeLive(Piece, Rels))
+    if (!isFdeLive<ELFT>(Piece, Rels))
       continue;
-    Cie->FdePieces.push_back(&Piece);
-    NumFdes++;
+    Cies[It->second].FdePieces.push_back(&Piece);
   }
 }
 
+template <class ELFT>
+static void readCiesAndFdes(EhInputSection<ELFT> *Sec,
+                            std::vector<LocalCie> &Cies) {
+  if (Sec->NumRelocations == 0)
+    readCiesAndFdes(Sec, makeArrayRef<typename ELFT::Rela>(nullptr, nullptr),
+                    Cies);
+  else if (Sec->AreRelocsRela)
+    readCiesAndFdes(Sec, Sec->relas(), Cies);
+  else
+    readCiesAndFdes(Sec, Sec->rels(), Cies);
+}
+
 template <class ELFT>
 void EhOutputSection<ELFT>::addSection(InputSectionData *C) {
   auto *Sec = cast<EhInputSection<ELFT>>(C);
@@ -372,17 +510,6 @@ void EhOutputSection<ELFT>::addSection(InputSectionData *C) {
   // splits it into pieces so that we can call
   // SplitInputSection::getSectionPiece on the section.
   Sec->split();
-  if (Sec->Pieces.empty())
-    return;
-
-  if (Sec->NumRelocations) {
-    if (Sec->AreRelocsRela)
-      addSectionAux(Sec, Sec->relas());
-    else
-      addSectionAux(Sec, Sec->rels());
-    return;
-  }
-  addSectionAux(Sec, makeArrayRef<Elf_Rela>(nullptr, nullptr));
 }
 
 template <class ELFT>
@@ -395,8 +522,51 @@ static void writeCieFde(uint8_t *Buf, ArrayRef<uint8_t> D) {
 }
 
 template <class ELFT> void EhOutputSection<ELFT>::finalize() {
-  if (this->Size)
-    return; // Already finalized.
+  if (Finalized)
+    return;
+  Finalized = true;
+
+  // Read CIEs and FDEs. This is done for each input section in parallel.
+  std::vector<std::vector<LocalCie>> LocalCies(Sections.size());
+  forLoop(0, Sections.size(),
+          [&](size_t I) { readCiesAndFdes(Sections[I], LocalCies[I]); });
+
+  // CIE records from input object files are uniquified by their contents
+  // and personality functions. As is done for mergeable sections, CIEs
+  // are distributed to shards by their hash values, and each shard is
+  // processed by one thread. The first CIE of each kind in input order
+  // becomes the leader.
+  std::vector<DenseMap<std::pair<ArrayRef<uint8_t>, SymbolBody *>, LocalCie *>>
+      Maps(NumShards);
+  size_t Concurrency = getShardConcurrency(NumShards);
+  forLoop(0, Concurrency, [&](size_t ThreadId) {
+    for (std::vector<LocalCie> &V : LocalCies) {
+      for (LocalCie &Cie : V) {
+        size_t ShardId = getShardId(Cie.Hash);
+        if ((ShardId & (Concurrency - 1)) != ThreadId)
+          continue;
+        Cie.Leader =
+            Maps[ShardId]
+                .insert({{Cie.Piece->data(), Cie.Personality}, &Cie})
+                .first->second;
+      }
+    }
+  });
+
+  // Create output CIE records in input order. This makes the output
+  // deterministic regardless of the number of threads.
+  for (std::vector<LocalCie> &V : LocalCies) {
+    for (LocalCie &Cie : V) {
+      if (Cie.Leader == &Cie) {
+        Cie.Out = make<CieRecord>();
+        Cie.Out->Piece = Cie.Piece;
+        Cies.push_back(Cie.Out);
+      }
+      std::vector<EhSectionPiece *> &Fdes = Cie.Leader->Out->FdePieces;
+      Fdes.insert(Fdes.end(), Cie.FdePieces.begin(), Cie.FdePieces.end());
+      NumFdes += Cie.FdePieces.size();
+    }
+  }
 
   size_t Off = 0;
   for (CieRecord *Cie : Cies) {
@@ -446,7 +616,7 @@ typename ELFT::uint EhOutputSection<ELFT>::getFdePc(uint8_t *Buf, size_t FdeOff,
 
 template <class ELFT> void EhOutputSection<ELFT>::writeTo(uint8_t *Buf) {
   const endianness E = ELFT::TargetEndianness;
-  for (CieRecord *Cie : Cies) {
+  forEach(Cies.begin(), Cies.end(), [&](CieRecord *Cie) {
     size_t CieOffset = Cie->Piece->OutputOff;
     writeCieFde<ELFT>(Buf + CieOffset, Cie->Piece->data());
 
@@ -458,23 +628,52 @@ template <class ELFT> void EhOutputSection<ELFT>::writeTo(uint8_t *Buf) {
       // Write it.
       write32<E>(Buf + Off + 4, Off + 4 - CieOffset);
     }
-  }
+  });
 
-  for (EhInputSection<ELFT> *S : Sections)
-    S->relocate(Buf, nullptr);
+  forEach(Sections.begin(), Sections.end(),
+          [&](EhInputSection<ELFT> *S) { S->relocate(Buf, nullptr); });
 
   // Construct .eh_frame_hdr. .eh_frame_hdr is a binary search table
   // to get a FDE from an address to which FDE is applied. So here
   // we obtain two addresses and pass them to EhFrameHdr object.
+  // Each CIE's FDEs are stored to a precomputed range of the table,
+  // so that CIEs can be processed in parallel.
   if (In<ELFT>::EhFrameHdr) {
+    std::vector<size_t> Starts;
+    size_t NumEntries = 0;
     for (CieRecord *Cie : Cies) {
+      Starts.push_back(NumEntries);
+      NumEntries += Cie->FdePieces.size();
+    }
+
+    std::vector<typename EhFrameHeader<ELFT>::FdeData> &Fdes =
+        In<ELFT>::EhFrameHdr->Fdes;
+    Fdes.resize(NumEntries);
+    forLoop(0, Cies.size(), [&](size_t I) {
+      CieRecord *Cie = Cies[I];
       uint8_t Enc = getFdeEncoding<ELFT>(Cie->Piece);
-      for (SectionPiece *Fde : Cie->FdePieces) {
+      for (size_t J = 0, E = Cie->FdePieces.size(); J != E; ++J) {
+        SectionPiece *Fde = Cie->FdePieces[J];
         uintX_t Pc = getFdePc(Buf, Fde->OutputOff, Enc);
         uintX_t FdeVA = this->Addr + Fde->OutputOff;
-        In<ELFT>::EhFrameHdr->addFde(Pc, FdeVA);
+        Fdes[Starts[I] + J] = {(uint32_t)Pc, (uint32_t)FdeVA};
       }
-    }
+    });
+
+    // Sort the FDE list by their PC and uniqueify. Usually there is only
+    // one FDE for a PC (i.e. function), but if ICF merges two functions
+    // into one, there can be more than one FDEs pointing to the address.
+    // We keep the first one in the output, so FDE addresses are used as
+    // tie-breakers to make the parallel sort deterministic. This is done
+    // here rather than in EhFrameHeader::writeTo, which runs inside the
+    // parallel loop of OutputSection::writeTo and must not start another.
+    typedef typename EhFrameHeader<ELFT>::FdeData FdeData;
+    auto Less = [](const FdeData &A, const FdeData &B) {
+      return std::tie(A.Pc, A.FdeVA) < std::tie(B.Pc, B.FdeVA);
+    };
+    parallelSort(Fdes.begin(), Fdes.end(), Less);
+    auto Eq = [](const FdeData &A, const FdeData &B) { return A.Pc == B.Pc; };
+    Fdes.erase(std::unique(Fdes.begin(), Fdes.end(), Eq), Fdes.end());
   }
 }
 
@@ -482,10 +681,42 @@ template <class ELFT>
 MergeOutputSection<ELFT>::MergeOutputSection(StringRef Name, uint32_t Type,
                                              uintX_t Flags, uintX_t Alignment)
     : OutputSectionBase(Name, Type, Flags),
-      Builder(StringTableBuilder::RAW, Alignment) {}
+      Builder(StringTableBuilder::RAW, Alignment), Alignment(Alignment) {}
 
 template <class ELFT> void MergeOutputSection<ELFT>::writeTo(uint8_t *Buf) {
-  Builder.write(Buf);
+  if (shouldTailMerge()) {
+    Builder.write(Buf);
+    return;
+  }
+
+  // Unique pieces never overlap, so shards can be written in parallel.
+  forLoop(0, Shards.size(), [&](size_t I) {
+    for (const UniquePiece &P : Shards[I]) {
+      StringRef S = P.Sec->getData(P.Index).val();
+      memcpy(Buf + P.OutputOff, S.data(), S.size());
+    }
+  });
+}
+
+template <class ELFT>
+void MergeOutputSection<ELFT>::writeRangeTo(uint8_t *Buf, uintX_t Begin,
+                                            uintX_t End) {
+  assert(!shouldTailMerge());
+
+  // Unique pieces are laid out in the order they appear in each shard,
+  // so we can binary-search for the first piece in the range.
+  for (std::vector<UniquePiece> &Shard : Shards) {
+    auto It = std::partition_point(
+        Shard.begin(), Shard.end(), [&](const UniquePiece &P) {
+          return P.OutputOff + P.Sec->getData(P.Index).size() <= Begin;
+        });
+    for (; It != Shard.end() && It->OutputOff < End; ++It) {
+      StringRef S = It->Sec->getData(It->Index).val();
+      uintX_t From = std::max(It->OutputOff, Begin);
+      uintX_t To = std::min<uintX_t>(It->OutputOff + S.size(), End);
+      memcpy(Buf + From - Begin, S.data() + From - It->OutputOff, To - From);
+    }
+  }
 }
 
 template <class ELFT>
@@ -523,17 +754,68 @@ template <class ELFT> void MergeOutputSection<ELFT>::finalizeTailMerge() {
 }
 
 template <class ELFT> void MergeOutputSection<ELFT>::finalizeNoTailMerge() {
-  // Add all string pieces to the string table builder to create section
-  // contents. Because we are not tail-optimizing, offsets of strings are
-  // fixed when they are added to the builder (string table builder contains
-  // a hash table from strings to offsets).
-  for (MergeInputSection<ELFT> *Sec : Sections)
-    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I)
-      if (Sec->Pieces[I].Live)
-        Sec->Pieces[I].OutputOff = Builder.add(Sec->getData(I));
+  // Uniquify pieces. Pieces are distributed to shards by their hash
+  // values, so identical pieces always belong to the same shard, and
+  // each shard can be processed by a different thread. The first piece
+  // of each kind in input order becomes a unique piece, and, for now,
+  // each live piece's OutputOff is set to the index of its unique piece
+  // in the shard.
+  Shards.resize(NumShards);
+  size_t Concurrency = getShardConcurrency(NumShards);
+
+  forLoop(0, Concurrency, [&](size_t ThreadId) {
+    std::vector<DenseMap<CachedHashStringRef, size_t>> Maps(NumShards);
+    for (MergeInputSection<ELFT> *Sec : Sections) {
+      for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+        // Check the shard first so that we never touch pieces owned by
+        // other threads.
+        CachedHashStringRef Data = Sec->getData(I);
+        size_t ShardId = getShardId(Data.hash());
+        if ((ShardId & (Concurrency - 1)) != ThreadId)
+          continue;
+        SectionPiece &Piece = Sec->Pieces[I];
+        if (!Piece.Live)
+          continue;
+        std::vector<UniquePiece> &Shard = Shards[ShardId];
+        auto P = Maps[ShardId].insert({Data, Shard.size()});
+        if (P.second)
+          Shard.push_back({Sec, I, 0});
+        Piece.OutputOff = P.first->second;
+      }
+    }
+  });
+
+  // Lay out unique pieces in input order. This is the only serial part,
+  // but it doesn't involve hashing or string comparison, and it makes the
+  // output identical to what a single string table would produce
+  // regardless of the number of threads.
+  uintX_t Off = 0;
+  for (MergeInputSection<ELFT> *Sec : Sections) {
+    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+      SectionPiece &Piece = Sec->Pieces[I];
+      if (!Piece.Live)
+        continue;
+      CachedHashStringRef Data = Sec->getData(I);
+      UniquePiece &U = Shards[getShardId(Data.hash())][Piece.OutputOff];
+      if (U.Sec != Sec || U.Index != I)
+        continue;
+      Off = alignTo(Off, Alignment);
+      U.OutputOff = Off;
+      Off += Data.size();
+    }
+  }
+  this->Size = Off;
 
-  Builder.finalizeInOrder();
-  this->Size = Builder.getSize();
+  // Replace shard indices with output section offsets.
+  forEach(Sections.begin(), Sections.end(), [&](MergeInputSection<ELFT> *Sec) {
+    for (size_t I = 0, E = Sec->Pieces.size(); I != E; ++I) {
+      SectionPiece &Piece = Sec->Pieces[I];
+      if (Piece.Live)
+        Piece.OutputOff =
+            Shards[getShardId(Sec->getData(I).hash())][Piece.OutputOff]
+                .OutputOff;
+    }
+  });
 }
 
 template <class ELFT> void MergeOutputSection<ELFT>::finalize() {
@@ -703,6 +985,11 @@ template void OutputSectionBase::writeHeaderTo<ELF32BE>(ELF32BE::Shdr *Shdr);
 template void OutputSectionBase::writeHeaderTo<ELF64LE>(ELF64LE::Shdr *Shdr);
 template void OutputSectionBase::writeHeaderTo<ELF64BE>(ELF64BE::Shdr *Shdr);
 
+template void OutputSectionBase::maybeCompress<ELF32LE>();
+template void OutputSectionBase::maybeCompress<ELF32BE>();
+template void OutputSectionBase::maybeCompress<ELF64LE>();
+template void OutputSectionBase::maybeCompress<ELF64BE>();
+
 template class OutputSection<ELF32LE>;
 template class OutputSection<ELF32BE>;
 template class OutputSection<ELF64LE>;
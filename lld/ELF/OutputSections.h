@@ -86,6 +86,14 @@ public:
   virtual void writeTo(uint8_t *Buf) {}
   virtual ~OutputSectionBase() = default;
 
+  template <class ELFT> void maybeCompress();
+
+  // If --compress-debug-sections is given, .debug_* sections are
+  // compressed, and this vector holds the compressed contents including
+  // the Elf_Chdr header. Such sections are written from this vector
+  // instead of by writeTo().
+  std::vector<uint8_t> CompressedData;
+
   StringRef Name;
 
   // The following fields correspond to Elf_Shdr members.
@@ -116,6 +124,7 @@ public:
   void sortInitFini();
   void sortCtorsDtors();
   void writeTo(uint8_t *Buf) override;
+  void writeChangedTo(uint8_t *Buf);
   void finalize() override;
   void forEachInputSection(std::function<void(InputSectionData *)> F) override;
   void assignOffsets() override;
@@ -140,6 +149,11 @@ public:
   void writeTo(uint8_t *Buf) override;
   void finalize() override;
   bool shouldTailMerge() const;
+
+  // Writes the part [Begin, End) of the section contents to Buf, which
+  // corresponds to the offset Begin. Tail merging must be disabled.
+  void writeRangeTo(uint8_t *Buf, uintX_t Begin, uintX_t End);
+
   Kind getKind() const override { return Merge; }
   static bool classof(const OutputSectionBase *B) {
     return B->getKind() == Merge;
@@ -151,6 +165,19 @@ private:
 
   llvm::StringTableBuilder Builder;
   std::vector<MergeInputSection<ELFT> *> Sections;
+  uintX_t Alignment;
+
+  // A unique piece that is copied to the output. Used if tail merging
+  // is disabled.
+  struct UniquePiece {
+    MergeInputSection<ELFT> *Sec;
+    size_t Index;
+    uintX_t OutputOff;
+  };
+
+  // Unique pieces distributed by hash values so that each shard can be
+  // deduplicated by a different thread.
+  std::vector<std::vector<UniquePiece>> Shards;
 };
 
 struct CieRecord {
@@ -181,22 +208,11 @@ public:
   size_t NumFdes = 0;
 
 private:
-  template <class RelTy>
-  void addSectionAux(EhInputSection<ELFT> *S, llvm::ArrayRef<RelTy> Rels);
-
-  template <class RelTy>
-  CieRecord *addCie(EhSectionPiece &Piece, ArrayRef<RelTy> Rels);
-
-  template <class RelTy>
-  bool isFdeLive(EhSectionPiece &Piece, ArrayRef<RelTy> Rels);
-
   uintX_t getFdePc(uint8_t *Buf, size_t Off, uint8_t Enc);
 
   std::vector<EhInputSection<ELFT> *> Sections;
   std::vector<CieRecord *> Cies;
-
-  // CIE records are uniquified by their contents and personality functions.
-  llvm::DenseMap<std::pair<ArrayRef<uint8_t>, SymbolBody *>, CieRecord> CieMap;
+  bool Finalized = false;
 };
 
 // All output sections that are hadnled by the linker specially are
@@ -0,0 +1,299 @@
+//===- ParseCache.cpp -----------------------------------------------------===//
+//
+//                             The LLVM Linker
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --cache-dir, an on-disk cache of the results of
+// splitting input sections.
+//
+// Most of the work to read an object file is already cheap because the
+// section and symbol tables are used in place from a memory-mapped file.
+// What is not cheap is splitting mergeable sections into pieces and
+// hashing them, and splitting .eh_frame sections into CIE and FDE records.
+// For programs with lots of debug info, hashing strings in .debug_str
+// alone takes a significant portion of link time. The result of that
+// work depends only on the file contents, so we save it to a file in
+// the cache directory and reuse it in the next link of the same file.
+//
+// Cache entries are named after a hash value of the file contents, so
+// unchanged files including archive members hit the cache no matter
+// where they are read from. An entry is a flat array of the following
+// structs which can be used in place after mapping the file to memory:
+//
+//   CacheHeader
+//   CacheSection x NumSections
+//   CachedPiece  x (sum of NumPieces)
+//
+//===----------------------------------------------------------------------===//
+
+#include "ParseCache.h"
+#include "Config.h"
+#include "Error.h"
+#include "InputFiles.h"
+#include "InputSection.h"
+#include "Threads.h"
+#include "lld/Config/Version.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include <atomic>
+
+using namespace llvm;
+using namespace llvm::ELF;
+using namespace llvm::object;
+using namespace llvm::support;
+using namespace llvm::support::endian;
+
+using namespace lld;
+using namespace lld::elf;
+
+namespace {
+struct CacheHeader {
+  char Magic[8];
+  uint64_t Version;
+  uint32_t NumSections;
+  uint32_t Reserved;
+};
+
+enum CacheSectionKind : uint32_t { MergeKind, EhKind };
+
+struct CacheSection {
+  uint32_t Index;
+  uint32_t Kind;
+  uint64_t NumPieces;
+};
+} // anonymous namespace
+
+static const char Magic[8] = {'L', 'L', 'D', 'P', 'C', 'A', 'C', 'H'};
+
+// Cache entries are not compatible between different versions of the
+// linker because hash functions may change.
+static uint64_t getVersion() {
+  static uint64_t Version =
+      xxHash64(getLLDVersion()) ^ sizeof(CachedPiece) ^ sys::IsBigEndianHost;
+  return Version;
+}
+
+static std::string getPath(MemoryBufferRef MB) {
+  StringRef S = MB.getBuffer();
+  SmallString<128> Path(Config->CacheDir);
+  sys::path::append(Path, "lld-" + utohexstr(xxHash64(S)) + "-" +
+                              Twine(S.size()));
+  return Path.str();
+}
+
+template <class ELFT>
+ParseCache<ELFT>::ParseCache(ArrayRef<ObjectFile<ELFT> *> Files)
+    : Files(Files.begin(), Files.end()), Paths(Files.size()),
+      Buffers(Files.size()) {
+  if (auto EC = sys::fs::create_directories(Config->CacheDir)) {
+    warn("--cache-dir: cannot create " + Config->CacheDir + ": " +
+         EC.message());
+    return;
+  }
+
+  std::atomic<size_t> NumHits(0);
+  forLoop(0, Files.size(), [&](size_t I) {
+    Paths[I] = getPath(Files[I]->MB);
+    if (load(I))
+      ++NumHits;
+  });
+  log("--cache-dir: " + Twine(NumHits) + " of " + Twine(Files.size()) +
+      " files found in cache");
+}
+
+// A cache entry may be stale or corrupted, so the pieces read from it
+// are checked against the section contents before they are used. These
+// checks are cheap compared to splitting and hashing the contents. Hash
+// values cannot be checked, but a wrong hash value only prevents pieces
+// from being merged.
+template <class ELFT>
+static bool isValid(MergeInputSection<ELFT> *S, ArrayRef<CachedPiece> V) {
+  ArrayRef<uint8_t> Data = S->Data;
+  size_t EntSize = S->Entsize;
+  bool IsStrings = S->Flags & SHF_STRINGS;
+  if (V.empty() || V[0].InputOff != 0 || EntSize == 0)
+    return false;
+
+  for (size_t I = 0, E = V.size(); I != E; ++I) {
+    uint64_t Begin = V[I].InputOff;
+    uint64_t End = (I + 1 == E) ? Data.size() : V[I + 1].InputOff;
+    if (End <= Begin || End > Data.size())
+      return false;
+    if (!IsStrings) {
+      if (End - Begin != EntSize)
+        return false;
+      continue;
+    }
+    // A string must end with a null character of EntSize bytes.
+    if (End - Begin < EntSize || (End - Begin) % EntSize != 0)
+      return false;
+    for (size_t J = End - EntSize; J != End; ++J)
+      if (Data[J] != 0)
+        return false;
+  }
+  return true;
+}
+
+template <class ELFT>
+static bool isValid(EhInputSection<ELFT> *S, ArrayRef<CachedPiece> V) {
+  const endianness E = ELFT::TargetEndianness;
+  ArrayRef<uint8_t> Data = S->Data;
+  uint64_t Off = 0;
+  for (const CachedPiece &P : V) {
+    // Records are contiguous and start with their length.
+    if (P.InputOff != Off || Data.size() - Off < 4 ||
+        P.HashOrSize != uint64_t(read32<E>(Data.data() + Off)) + 4 ||
+        P.HashOrSize > Data.size() - Off)
+      return false;
+    if (P.FirstRelocation != (uint32_t)-1 &&
+        P.FirstRelocation >= S->NumRelocations)
+      return false;
+    Off += P.HashOrSize;
+  }
+  return true;
+}
+
+// Reads a cache entry for the I'th file and sets CachedPieces of its
+// sections. Returns true on success.
+template <class ELFT> bool ParseCache<ELFT>::load(size_t I) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(Paths[I], -1, false);
+  if (!MBOrErr)
+    return false;
+  std::unique_ptr<MemoryBuffer> &MB = *MBOrErr;
+
+  // Verify the header and the section table before using them.
+  ArrayRef<uint8_t> Buf((const uint8_t *)MB->getBufferStart(),
+                        MB->getBufferSize());
+  if (Buf.size() < sizeof(CacheHeader))
+    return false;
+  auto *Hdr = reinterpret_cast<const CacheHeader *>(Buf.data());
+  if (memcmp(Hdr->Magic, Magic, sizeof(Magic)) != 0 ||
+      Hdr->Version != getVersion())
+    return false;
+  Buf = Buf.slice(sizeof(CacheHeader));
+
+  if (Buf.size() / sizeof(CacheSection) < Hdr->NumSections)
+    return false;
+  ArrayRef<CacheSection> Secs(
+      reinterpret_cast<const CacheSection *>(Buf.data()), Hdr->NumSections);
+  Buf = Buf.slice(Hdr->NumSections * sizeof(CacheSection));
+
+  ArrayRef<InputSectionBase<ELFT> *> Sections = Files[I]->getSections();
+  auto *Pieces = reinterpret_cast<const CachedPiece *>(Buf.data());
+  size_t NumPieces = Buf.size() / sizeof(CachedPiece);
+
+  // Pieces are given to sections only after all records are checked,
+  // so that we can fall back to splitting sections as usual.
+  std::vector<std::pair<MergeInputSection<ELFT> *, ArrayRef<CachedPiece>>>
+      MergePieces;
+  std::vector<std::pair<EhInputSection<ELFT> *, ArrayRef<CachedPiece>>>
+      EhPieces;
+
+  for (const CacheSection &Sec : Secs) {
+    if (Sec.Index >= Sections.size() || Sec.NumPieces > NumPieces)
+      return false;
+    ArrayRef<CachedPiece> V(Pieces, Sec.NumPieces);
+    Pieces += Sec.NumPieces;
+    NumPieces -= Sec.NumPieces;
+
+    InputSectionBase<ELFT> *S = Sections[Sec.Index];
+    if (!S || S == &InputSection<ELFT>::Discarded)
+      continue;
+    if (Sec.Kind == MergeKind) {
+      if (auto *MS = dyn_cast<MergeInputSection<ELFT>>(S)) {
+        if (!isValid(MS, V))
+          return false;
+        MergePieces.push_back({MS, V});
+      }
+    } else if (Sec.Kind == EhKind) {
+      if (auto *EH = dyn_cast<EhInputSection<ELFT>>(S)) {
+        if (!isValid(EH, V))
+          return false;
+        EhPieces.push_back({EH, V});
+      }
+    }
+  }
+
+  for (auto &P : MergePieces)
+    P.first->CachedPieces = P.second;
+  for (auto &P : EhPieces)
+    P.first->CachedPieces = P.second;
+  Buffers[I] = std::move(MB);
+  return true;
+}
+
+template <class ELFT> void ParseCache<ELFT>::save() {
+  forLoop(0, Files.size(), [&](size_t I) {
+    if (!Buffers[I] && !Paths[I].empty())
+      save(I);
+  });
+}
+
+// Writes split sections of the I'th file to the cache.
+template <class ELFT> void ParseCache<ELFT>::save(size_t I) {
+  std::vector<CacheSection> Secs;
+  std::vector<CachedPiece> Pieces;
+
+  ArrayRef<InputSectionBase<ELFT> *> Sections = Files[I]->getSections();
+  for (size_t J = 0, E = Sections.size(); J != E; ++J) {
+    InputSectionBase<ELFT> *S = Sections[J];
+    if (!S || S == &InputSection<ELFT>::Discarded)
+      continue;
+
+    if (auto *MS = dyn_cast<MergeInputSection<ELFT>>(S)) {
+      if (MS->Pieces.empty())
+        continue;
+      Secs.push_back({(uint32_t)J, MergeKind, MS->Pieces.size()});
+      for (size_t K = 0, N = MS->Pieces.size(); K != N; ++K)
+        Pieces.push_back({MS->Pieces[K].InputOff, MS->getData(K).hash(), 0});
+    } else if (auto *EH = dyn_cast<EhInputSection<ELFT>>(S)) {
+      if (EH->Pieces.empty())
+        continue;
+      Secs.push_back({(uint32_t)J, EhKind, EH->Pieces.size()});
+      for (EhSectionPiece &P : EH->Pieces)
+        Pieces.push_back({P.InputOff, P.Size, P.FirstRelocation});
+    }
+  }
+
+  CacheHeader Hdr;
+  memcpy(Hdr.Magic, Magic, sizeof(Magic));
+  Hdr.Version = getVersion();
+  Hdr.NumSections = Secs.size();
+  Hdr.Reserved = 0;
+
+  // Write to a temporary file first and rename it so that concurrent
+  // links sharing the same cache directory never see partial entries.
+  int FD;
+  SmallString<128> TempPath;
+  if (sys::fs::createUniqueFile(Paths[I] + ".tmp%%%%%%%", FD, TempPath))
+    return;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write((const char *)&Hdr, sizeof(Hdr));
+    OS.write((const char *)Secs.data(), Secs.size() * sizeof(CacheSection));
+    OS.write((const char *)Pieces.data(), Pieces.size() * sizeof(CachedPiece));
+  }
+  if (sys::fs::rename(TempPath, Paths[I]))
+    sys::fs::remove(TempPath);
+}
+
+template <class ELFT> void ParseCache<ELFT>::prune() {
+  CachePruning(Config->CacheDir)
+      .setPruningInterval(std::chrono::seconds(1200))
+      .setEntryExpiration(std::chrono::seconds(Config->CachePruneAfter))
+      .setMaxSize(Config->CacheMaxSize)
+      .prune();
+}
+
+template class elf::ParseCache<ELF32LE>;
+template class elf::ParseCache<ELF32BE>;
+template class elf::ParseCache<ELF64LE>;
+template class elf::ParseCache<ELF64BE>;
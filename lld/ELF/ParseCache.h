@@ -0,0 +1,50 @@
+//===- ParseCache.h ---------------------------------------------*- C++ -*-===//
+//
+//                             The LLVM Linker
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_PARSE_CACHE_H
+#define LLD_ELF_PARSE_CACHE_H
+
+#include "lld/Core/LLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lld {
+namespace elf {
+
+template <class ELFT> class ObjectFile;
+
+// This class implements --cache-dir. See ParseCache.cpp for details.
+template <class ELFT> class ParseCache {
+public:
+  // Looks up the cache for given files. Sections of files found in
+  // the cache are given pieces read from the cache.
+  explicit ParseCache(ArrayRef<ObjectFile<ELFT> *> Files);
+
+  // Writes cache entries for files that were not found in the cache.
+  // Must be called after sections are split.
+  void save();
+
+  // Removes old cache entries.
+  void prune();
+
+private:
+  bool load(size_t I);
+  void save(size_t I);
+
+  std::vector<ObjectFile<ELFT> *> Files;
+  std::vector<std::string> Paths;
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> Buffers;
+};
+
+} // namespace elf
+} // namespace lld
+
+#endif
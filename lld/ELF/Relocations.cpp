@@ -49,6 +49,7 @@
 #include "SyntheticSections.h"
 #include "Target.h"
 #include "Thunks.h"
+#include "Threads.h"
 
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/raw_ostream.h"
@@ -454,21 +455,26 @@ template <class ELFT> static void addCopyRelSymbol(SharedSymbol<ELFT> *SS) {
 }
 
 template <class ELFT>
-static RelExpr adjustExpr(const elf::ObjectFile<ELFT> &File, SymbolBody &Body,
-                          bool IsWrite, RelExpr Expr, uint32_t Type,
-                          const uint8_t *Data, InputSectionBase<ELFT> &S,
-                          typename ELFT::uint RelOff) {
-  bool Preemptible = isPreemptible(Body, Type);
+static RelExpr getSymbolExpr(const elf::ObjectFile<ELFT> &File,
+                             SymbolBody &Body, RelExpr Expr, uint32_t Type,
+                             const uint8_t *Data) {
   if (Body.isGnuIFunc()) {
     Expr = toPlt(Expr);
-  } else if (!Preemptible) {
+  } else if (!isPreemptible(Body, Type)) {
     if (needsPlt(Expr))
       Expr = fromPlt(Expr);
     if (Expr == R_GOT_PC && !isAbsoluteValue<ELFT>(Body))
       Expr = Target->adjustRelaxExpr(Type, Data, Expr);
   }
-  Expr = Target->getThunkExpr(Expr, Type, &File, Body);
+  return Target->getThunkExpr(Expr, Type, &File, Body);
+}
 
+template <class ELFT>
+static RelExpr adjustExpr(const elf::ObjectFile<ELFT> &File, SymbolBody &Body,
+                          bool IsWrite, RelExpr Expr, uint32_t Type,
+                          const uint8_t *Data, InputSectionBase<ELFT> &S,
+                          typename ELFT::uint RelOff) {
+  Expr = getSymbolExpr(File, Body, Expr, Type, Data);
   if (IsWrite || isStaticLinkTimeConstant<ELFT>(Expr, Type, Body, S, RelOff))
     return Expr;
 
@@ -589,6 +595,37 @@ mergeMipsN32RelTypes(uint32_t Type, uint32_t Offset, RelTy *I, RelTy *E) {
   return std::make_pair(Type, Processed);
 }
 
+// Computes the offset of a relocation in its output section. If the
+// relocation is in an .eh_frame section, the offset is translated using
+// the section pieces. PieceI must be advanced monotonically, so
+// relocations must be given in ascending order. Returns false if the
+// relocation points to a dead piece.
+template <class uintX_t>
+static bool getOutputOffset(uintX_t RelOff,
+                            ArrayRef<EhSectionPiece>::iterator &PieceI,
+                            ArrayRef<EhSectionPiece>::iterator PieceE,
+                            uintX_t &Offset) {
+  while (PieceI != PieceE && (PieceI->InputOff + PieceI->size() <= RelOff))
+    ++PieceI;
+
+  if (PieceI == PieceE) {
+    Offset = RelOff;
+    return true;
+  }
+  assert(PieceI->InputOff <= RelOff && "Relocation not in any piece");
+  if (PieceI->OutputOff == -1)
+    return false;
+  Offset = PieceI->OutputOff + RelOff - PieceI->InputOff;
+  return true;
+}
+
+template <class ELFT>
+static ArrayRef<EhSectionPiece> getEhPieces(InputSectionBase<ELFT> &C) {
+  if (auto *Eh = dyn_cast<EhInputSection<ELFT>>(&C))
+    return Eh->Pieces;
+  return {};
+}
+
 // The reason we have to do this early scan is as follows
 // * To mmap the output file, we need to know the size
 // * For that, we need to know how many dynamic relocs we will have.
@@ -602,8 +639,15 @@ mergeMipsN32RelTypes(uint32_t Type, uint32_t Offset, RelTy *I, RelTy *E) {
 // sections. Given that it is ro, we will need an extra PT_LOAD. This
 // complicates things for the dynamic linker and means we would have to reserve
 // space for the extra PT_LOAD even if we end up not using it.
+//
+// This function scans the relocation pointed by I and returns the number of
+// relocations processed. It can be greater than one if the following
+// relocations are consumed by TLS relaxation or MIPS N32 relocation packing.
 template <class ELFT, class RelTy>
-static void scanRelocs(InputSectionBase<ELFT> &C, ArrayRef<RelTy> Rels) {
+static size_t scanReloc(InputSectionBase<ELFT> &C, const RelTy *I,
+                        const RelTy *E,
+                        ArrayRef<EhSectionPiece>::iterator &PieceI,
+                        ArrayRef<EhSectionPiece>::iterator PieceE) {
   typedef typename ELFT::uint uintX_t;
 
   bool IsWrite = C.Flags & SHF_WRITE;
@@ -613,196 +657,365 @@ static void scanRelocs(InputSectionBase<ELFT> &C, ArrayRef<RelTy> Rels) {
   };
 
   const elf::ObjectFile<ELFT> *File = C.getFile();
-  ArrayRef<uint8_t> SectionData = C.Data;
-  const uint8_t *Buf = SectionData.begin();
+  const uint8_t *Buf = C.Data.begin();
 
-  ArrayRef<EhSectionPiece> Pieces;
-  if (auto *Eh = dyn_cast<EhInputSection<ELFT>>(&C))
-    Pieces = Eh->Pieces;
+  const RelTy &RI = *I;
+  SymbolBody &Body = File->getRelocTargetSym(RI);
+  uint32_t Type = RI.getType(Config->Mips64EL);
+
+  size_t Processed = 1;
+  if (Config->MipsN32Abi) {
+    uint32_t NumMerged;
+    std::tie(Type, NumMerged) =
+        mergeMipsN32RelTypes(Type, RI.r_offset, I + 1, E);
+    Processed += NumMerged;
+  }
+
+  // We only report undefined symbols if they are referenced somewhere in the
+  // code.
+  if (!Body.isLocal() && Body.isUndefined() && !Body.symbol()->isWeak())
+    reportUndefined(Body, C, RI.r_offset);
+
+  RelExpr Expr = Target->getRelExpr(Type, Body);
+  bool Preemptible = isPreemptible(Body, Type);
+  Expr = adjustExpr(*File, Body, IsWrite, Expr, Type, Buf + RI.r_offset, C,
+                    RI.r_offset);
+  if (ErrorCount)
+    return Processed;
+
+  // Skip a relocation that points to a dead piece
+  // in a eh_frame section.
+  uintX_t Offset;
+  if (!getOutputOffset<uintX_t>(RI.r_offset, PieceI, PieceE, Offset))
+    return Processed;
+
+  // This relocation does not require got entry, but it is relative to got and
+  // needs it to be created. Here we request for that.
+  if (Expr == R_GOTONLY_PC || Expr == R_GOTONLY_PC_FROM_END ||
+      Expr == R_GOTREL || Expr == R_GOTREL_FROM_END || Expr == R_PPC_TOC)
+    In<ELFT>::Got->HasGotOffRel = true;
+
+  uintX_t Addend = computeAddend(*File, Buf, E, RI, Expr, Body);
+
+  if (unsigned NumTls =
+          handleTlsRelocation<ELFT>(Type, Body, C, Offset, Addend, Expr))
+    return Processed + NumTls - 1;
+
+  // Ignore "hint" and TLS Descriptor call relocation because they are
+  // only markers for relaxation.
+  if (isRelExprOneOf<R_HINT, R_TLSDESC_CALL>(Expr))
+    return Processed;
+
+  if (needsPlt(Expr) ||
+      isRelExprOneOf<R_THUNK_ABS, R_THUNK_PC, R_THUNK_PLT_PC>(Expr) ||
+      refersToGotEntry(Expr) || !isPreemptible(Body, Type)) {
+    // If the relocation points to something in the file, we can process it.
+    bool Constant =
+        isStaticLinkTimeConstant<ELFT>(Expr, Type, Body, C, RI.r_offset);
+
+    // If the output being produced is position independent, the final value
+    // is still not known. In that case we still need some help from the
+    // dynamic linker. We can however do better than just copying the incoming
+    // relocation. We can process some of it and and just ask the dynamic
+    // linker to add the load address.
+    if (!Constant)
+      AddDyn({Target->RelativeRel, &C, Offset, true, &Body, Addend});
+
+    // If the produced value is a constant, we just remember to write it
+    // when outputting this section. We also have to do it if the format
+    // uses Elf_Rel, since in that case the written value is the addend.
+    if (Constant || !RelTy::IsRela)
+      C.Relocations.push_back({Expr, Type, Offset, Addend, &Body});
+  } else {
+    // We don't know anything about the finaly symbol. Just ask the dynamic
+    // linker to handle the relocation for us.
+    if (!Target->isPicRel(Type))
+      error(C.getLocation(Offset) + ": relocation " + toString(Type) +
+            " cannot be used against shared object; recompile with -fPIC.");
+    AddDyn({Target->getDynRel(Type), &C, Offset, false, &Body, Addend});
+
+    // MIPS ABI turns using of GOT and dynamic relocations inside out.
+    // While regular ABI uses dynamic relocations to fill up GOT entries
+    // MIPS ABI requires dynamic linker to fills up GOT entries using
+    // specially sorted dynamic symbol table. This affects even dynamic
+    // relocations against symbols which do not require GOT entries
+    // creation explicitly, i.e. do not have any GOT-relocations. So if
+    // a preemptible symbol has a dynamic relocation we anyway have
+    // to create a GOT entry for it.
+    // If a non-preemptible symbol has a dynamic relocation against it,
+    // dynamic linker takes it st_value, adds offset and writes down
+    // result of the dynamic relocation. In case of preemptible symbol
+    // dynamic linker performs symbol resolution, writes the symbol value
+    // to the GOT entry and reads the GOT entry when it needs to perform
+    // a dynamic relocation.
+    // ftp://www.linux-mips.org/pub/linux/mips/doc/ABI/mipsabi.pdf p.4-19
+    if (Config->EMachine == EM_MIPS)
+      In<ELFT>::MipsGot->addEntry(Body, Addend, Expr);
+    return Processed;
+  }
+
+  // At this point we are done with the relocated position. Some relocations
+  // also require us to create a got or plt entry.
+
+  // If a relocation needs PLT, we create a PLT and a GOT slot for the symbol.
+  if (needsPlt(Expr)) {
+    if (Body.isInPlt())
+      return Processed;
+
+    if (Body.isGnuIFunc() && !Preemptible) {
+      In<ELFT>::Iplt->addEntry(Body);
+      In<ELFT>::IgotPlt->addEntry(Body);
+      In<ELFT>::RelaIplt->addReloc({Target->IRelativeRel, In<ELFT>::IgotPlt,
+                                    Body.getGotPltOffset<ELFT>(),
+                                    !Preemptible, &Body, 0});
+    } else {
+      In<ELFT>::Plt->addEntry(Body);
+      In<ELFT>::GotPlt->addEntry(Body);
+      In<ELFT>::RelaPlt->addReloc({Target->PltRel, In<ELFT>::GotPlt,
+                                   Body.getGotPltOffset<ELFT>(), !Preemptible,
+                                   &Body, 0});
+    }
+    return Processed;
+  }
+
+  if (refersToGotEntry(Expr)) {
+    if (Config->EMachine == EM_MIPS) {
+      // MIPS ABI has special rules to process GOT entries and doesn't
+      // require relocation entries for them. A special case is TLS
+      // relocations. In that case dynamic loader applies dynamic
+      // relocations to initialize TLS GOT entries.
+      // See "Global Offset Table" in Chapter 5 in the following document
+      // for detailed description:
+      // ftp://www.linux-mips.org/pub/linux/mips/doc/ABI/mipsabi.pdf
+      In<ELFT>::MipsGot->addEntry(Body, Addend, Expr);
+      if (Body.isTls() && Body.isPreemptible())
+        AddDyn({Target->TlsGotRel, In<ELFT>::MipsGot,
+                Body.getGotOffset<ELFT>(), false, &Body, 0});
+      return Processed;
+    }
+
+    if (Body.isInGot())
+      return Processed;
+
+    In<ELFT>::Got->addEntry(Body);
+    uintX_t Off = Body.getGotOffset<ELFT>();
+    uint32_t DynType;
+    RelExpr GotRE = R_ABS;
+    if (Body.isTls()) {
+      DynType = Target->TlsGotRel;
+      GotRE = R_TLS;
+    } else if (!Preemptible && Config->Pic && !isAbsolute<ELFT>(Body))
+      DynType = Target->RelativeRel;
+    else
+      DynType = Target->GotRel;
+
+    // FIXME: this logic is almost duplicated above.
+    bool Constant = !Preemptible && !(Config->Pic && !isAbsolute<ELFT>(Body));
+    if (!Constant)
+      AddDyn({DynType, In<ELFT>::Got, Off, !Preemptible, &Body, 0});
+    if (Constant || (!RelTy::IsRela && !Preemptible))
+      In<ELFT>::Got->Relocations.push_back({GotRE, DynType, Off, 0, &Body});
+    return Processed;
+  }
+  return Processed;
+}
+
+template <class ELFT, class RelTy>
+static void scanRelocs(InputSectionBase<ELFT> &C, ArrayRef<RelTy> Rels) {
+  ArrayRef<EhSectionPiece> Pieces = getEhPieces(C);
+  ArrayRef<EhSectionPiece>::iterator PieceI = Pieces.begin();
+  ArrayRef<EhSectionPiece>::iterator PieceE = Pieces.end();
+
+  for (const RelTy *I = Rels.begin(), *E = Rels.end(); I != E;)
+    I += scanReloc(C, I, E, PieceI, PieceE);
+}
+
+template <class ELFT> void scanRelocations(InputSectionBase<ELFT> &S) {
+  if (S.AreRelocsRela)
+    scanRelocs(S, S.relas());
+  else
+    scanRelocs(S, S.rels());
+}
+
+// Scanning relocations is one of the heaviest serial passes in the linker,
+// but most relocations don't need any synchronization. If a relocation
+// refers to a non-preemptible, non-TLS, non-IFUNC defined symbol, it never
+// needs GOT, PLT or copy relocation and its outcome does not depend on the
+// state of the symbol, so it can be scanned on a worker thread. Other
+// relocations, which may need GOT/PLT entries, copy relocations or
+// diagnostics, are deferred to a serial merge step that visits relocations
+// in the same order as the single-threaded scan. Therefore, the output is
+// identical regardless of the number of threads.
+template <class ELFT> struct RelocScanResult {
+  // A relocation that needs to be scanned in the merge step.
+  struct Deferred {
+    // Index of the relocation in the relocation section.
+    size_t RelIndex;
+    // Sizes of Relocations and DynRelocs when the relocation was deferred.
+    // They are used to interleave the results in the original order.
+    size_t RelocPos;
+    size_t DynPos;
+  };
+
+  std::vector<Relocation> Relocations;
+  std::vector<DynamicReloc<ELFT>> DynRelocs;
+  std::vector<Deferred> DeferredRelocs;
+  bool HasGotOffRel = false;
+};
+
+// Returns true if a relocation against Body can be scanned on a worker
+// thread. See the comment for RelocScanResult.
+static bool canScanConcurrently(const SymbolBody &Body, uint32_t Type) {
+  return Body.isDefined() && !Body.isTls() && !Body.isGnuIFunc() &&
+         !isPreemptible(Body, Type);
+}
 
+// This function is called from parallel_for. It must not modify anything
+// other than C and Res.
+template <class ELFT, class RelTy>
+static void scanRelocsConcurrently(InputSectionBase<ELFT> &C,
+                                   ArrayRef<RelTy> Rels,
+                                   RelocScanResult<ELFT> &Res) {
+  typedef typename ELFT::uint uintX_t;
+
+  bool IsWrite = C.Flags & SHF_WRITE;
+  const elf::ObjectFile<ELFT> *File = C.getFile();
+  const uint8_t *Buf = C.Data.begin();
+
+  ArrayRef<EhSectionPiece> Pieces = getEhPieces(C);
   ArrayRef<EhSectionPiece>::iterator PieceI = Pieces.begin();
   ArrayRef<EhSectionPiece>::iterator PieceE = Pieces.end();
 
-  for (auto I = Rels.begin(), E = Rels.end(); I != E; ++I) {
-    const RelTy &RI = *I;
+  // TLS relaxation may consume relocations following a TLS relocation.
+  // Such relocations are deferred too.
+  size_t TlsSkip = std::max<size_t>(2, Target->TlsGdRelaxSkip);
+  size_t DeferUntil = 0;
+
+  for (size_t Idx = 0, End = Rels.size(); Idx != End; ++Idx) {
+    const RelTy &RI = Rels[Idx];
     SymbolBody &Body = File->getRelocTargetSym(RI);
     uint32_t Type = RI.getType(Config->Mips64EL);
 
-    if (Config->MipsN32Abi) {
-      uint32_t Processed;
-      std::tie(Type, Processed) =
-          mergeMipsN32RelTypes(Type, RI.r_offset, I + 1, E);
-      I += Processed;
+    auto Defer = [&] {
+      Res.DeferredRelocs.push_back(
+          {Idx, Res.Relocations.size(), Res.DynRelocs.size()});
+    };
+
+    if (Idx < DeferUntil || !canScanConcurrently(Body, Type)) {
+      if (Body.isTls())
+        DeferUntil = std::max(DeferUntil, Idx + TlsSkip);
+      Defer();
+      continue;
     }
 
-    // We only report undefined symbols if they are referenced somewhere in the
-    // code.
-    if (!Body.isLocal() && Body.isUndefined() && !Body.symbol()->isWeak())
-      reportUndefined(Body, C, RI.r_offset);
+    RelExpr Expr = getSymbolExpr(*File, Body, Target->getRelExpr(Type, Body),
+                                 Type, Buf + RI.r_offset);
 
-    RelExpr Expr = Target->getRelExpr(Type, Body);
-    bool Preemptible = isPreemptible(Body, Type);
-    Expr = adjustExpr(*File, Body, IsWrite, Expr, Type, Buf + RI.r_offset, C,
-                      RI.r_offset);
-    if (ErrorCount)
+    // Relocations that need GOT or PLT entries, or may be reported
+    // as errors, are handled in the merge step.
+    if (needsPlt(Expr) || refersToGotEntry(Expr) ||
+        (Config->Pic && isAbsoluteValue<ELFT>(Body) && isRelExpr(Expr))) {
+      Defer();
       continue;
+    }
+    bool Constant =
+        isStaticLinkTimeConstant<ELFT>(Expr, Type, Body, C, RI.r_offset);
+    if (!Constant && !IsWrite) {
+      Defer();
+      continue;
+    }
 
-    // Skip a relocation that points to a dead piece
-    // in a eh_frame section.
-    while (PieceI != PieceE &&
-           (PieceI->InputOff + PieceI->size() <= RI.r_offset))
-      ++PieceI;
-
-    // Compute the offset of this section in the output section. We do it here
-    // to try to compute it only once.
     uintX_t Offset;
-    if (PieceI != PieceE) {
-      assert(PieceI->InputOff <= RI.r_offset && "Relocation not in any piece");
-      if (PieceI->OutputOff == -1)
-        continue;
-      Offset = PieceI->OutputOff + RI.r_offset - PieceI->InputOff;
-    } else {
-      Offset = RI.r_offset;
-    }
+    if (!getOutputOffset<uintX_t>(RI.r_offset, PieceI, PieceE, Offset))
+      continue;
 
-    // This relocation does not require got entry, but it is relative to got and
-    // needs it to be created. Here we request for that.
     if (Expr == R_GOTONLY_PC || Expr == R_GOTONLY_PC_FROM_END ||
         Expr == R_GOTREL || Expr == R_GOTREL_FROM_END || Expr == R_PPC_TOC)
-      In<ELFT>::Got->HasGotOffRel = true;
-
-    uintX_t Addend = computeAddend(*File, Buf, E, RI, Expr, Body);
+      Res.HasGotOffRel = true;
 
-    if (unsigned Processed =
-            handleTlsRelocation<ELFT>(Type, Body, C, Offset, Addend, Expr)) {
-      I += (Processed - 1);
-      continue;
-    }
+    uintX_t Addend = computeAddend(*File, Buf, Rels.end(), RI, Expr, Body);
 
-    // Ignore "hint" and TLS Descriptor call relocation because they are
-    // only markers for relaxation.
     if (isRelExprOneOf<R_HINT, R_TLSDESC_CALL>(Expr))
       continue;
 
-    if (needsPlt(Expr) ||
-        isRelExprOneOf<R_THUNK_ABS, R_THUNK_PC, R_THUNK_PLT_PC>(Expr) ||
-        refersToGotEntry(Expr) || !isPreemptible(Body, Type)) {
-      // If the relocation points to something in the file, we can process it.
-      bool Constant =
-          isStaticLinkTimeConstant<ELFT>(Expr, Type, Body, C, RI.r_offset);
-
-      // If the output being produced is position independent, the final value
-      // is still not known. In that case we still need some help from the
-      // dynamic linker. We can however do better than just copying the incoming
-      // relocation. We can process some of it and and just ask the dynamic
-      // linker to add the load address.
-      if (!Constant)
-        AddDyn({Target->RelativeRel, &C, Offset, true, &Body, Addend});
-
-      // If the produced value is a constant, we just remember to write it
-      // when outputting this section. We also have to do it if the format
-      // uses Elf_Rel, since in that case the written value is the addend.
-      if (Constant || !RelTy::IsRela)
-        C.Relocations.push_back({Expr, Type, Offset, Addend, &Body});
-    } else {
-      // We don't know anything about the finaly symbol. Just ask the dynamic
-      // linker to handle the relocation for us.
-      if (!Target->isPicRel(Type))
-        error(C.getLocation(Offset) + ": relocation " + toString(Type) +
-              " cannot be used against shared object; recompile with -fPIC.");
-      AddDyn({Target->getDynRel(Type), &C, Offset, false, &Body, Addend});
-
-      // MIPS ABI turns using of GOT and dynamic relocations inside out.
-      // While regular ABI uses dynamic relocations to fill up GOT entries
-      // MIPS ABI requires dynamic linker to fills up GOT entries using
-      // specially sorted dynamic symbol table. This affects even dynamic
-      // relocations against symbols which do not require GOT entries
-      // creation explicitly, i.e. do not have any GOT-relocations. So if
-      // a preemptible symbol has a dynamic relocation we anyway have
-      // to create a GOT entry for it.
-      // If a non-preemptible symbol has a dynamic relocation against it,
-      // dynamic linker takes it st_value, adds offset and writes down
-      // result of the dynamic relocation. In case of preemptible symbol
-      // dynamic linker performs symbol resolution, writes the symbol value
-      // to the GOT entry and reads the GOT entry when it needs to perform
-      // a dynamic relocation.
-      // ftp://www.linux-mips.org/pub/linux/mips/doc/ABI/mipsabi.pdf p.4-19
-      if (Config->EMachine == EM_MIPS)
-        In<ELFT>::MipsGot->addEntry(Body, Addend, Expr);
-      continue;
-    }
+    if (!Constant)
+      Res.DynRelocs.push_back(
+          {Target->RelativeRel, &C, Offset, true, &Body, Addend});
+    if (Constant || !RelTy::IsRela)
+      Res.Relocations.push_back({Expr, Type, Offset, Addend, &Body});
+  }
+}
 
-    // At this point we are done with the relocated position. Some relocations
-    // also require us to create a got or plt entry.
-
-    // If a relocation needs PLT, we create a PLT and a GOT slot for the symbol.
-    if (needsPlt(Expr)) {
-      if (Body.isInPlt())
-        continue;
-
-      if (Body.isGnuIFunc() && !Preemptible) {
-        In<ELFT>::Iplt->addEntry(Body);
-        In<ELFT>::IgotPlt->addEntry(Body);
-        In<ELFT>::RelaIplt->addReloc({Target->IRelativeRel, In<ELFT>::IgotPlt,
-                                      Body.getGotPltOffset<ELFT>(),
-                                      !Preemptible, &Body, 0});
-      } else {
-        In<ELFT>::Plt->addEntry(Body);
-        In<ELFT>::GotPlt->addEntry(Body);
-        In<ELFT>::RelaPlt->addReloc({Target->PltRel, In<ELFT>::GotPlt,
-                                     Body.getGotPltOffset<ELFT>(), !Preemptible,
-                                     &Body, 0});
-      }
-      continue;
-    }
+// Commits the result of scanRelocsConcurrently. Deferred relocations are
+// scanned here in the original order.
+template <class ELFT, class RelTy>
+static void mergeScanResult(InputSectionBase<ELFT> &C, ArrayRef<RelTy> Rels,
+                            RelocScanResult<ELFT> &Res) {
+  if (Res.HasGotOffRel)
+    In<ELFT>::Got->HasGotOffRel = true;
 
-    if (refersToGotEntry(Expr)) {
-      if (Config->EMachine == EM_MIPS) {
-        // MIPS ABI has special rules to process GOT entries and doesn't
-        // require relocation entries for them. A special case is TLS
-        // relocations. In that case dynamic loader applies dynamic
-        // relocations to initialize TLS GOT entries.
-        // See "Global Offset Table" in Chapter 5 in the following document
-        // for detailed description:
-        // ftp://www.linux-mips.org/pub/linux/mips/doc/ABI/mipsabi.pdf
-        In<ELFT>::MipsGot->addEntry(Body, Addend, Expr);
-        if (Body.isTls() && Body.isPreemptible())
-          AddDyn({Target->TlsGotRel, In<ELFT>::MipsGot,
-                  Body.getGotOffset<ELFT>(), false, &Body, 0});
-        continue;
-      }
+  ArrayRef<EhSectionPiece> Pieces = getEhPieces(C);
+  ArrayRef<EhSectionPiece>::iterator PieceI = Pieces.begin();
+  ArrayRef<EhSectionPiece>::iterator PieceE = Pieces.end();
 
-      if (Body.isInGot())
-        continue;
-
-      In<ELFT>::Got->addEntry(Body);
-      uintX_t Off = Body.getGotOffset<ELFT>();
-      uint32_t DynType;
-      RelExpr GotRE = R_ABS;
-      if (Body.isTls()) {
-        DynType = Target->TlsGotRel;
-        GotRE = R_TLS;
-      } else if (!Preemptible && Config->Pic && !isAbsolute<ELFT>(Body))
-        DynType = Target->RelativeRel;
-      else
-        DynType = Target->GotRel;
-
-      // FIXME: this logic is almost duplicated above.
-      bool Constant = !Preemptible && !(Config->Pic && !isAbsolute<ELFT>(Body));
-      if (!Constant)
-        AddDyn({DynType, In<ELFT>::Got, Off, !Preemptible, &Body, 0});
-      if (Constant || (!RelTy::IsRela && !Preemptible))
-        In<ELFT>::Got->Relocations.push_back({GotRE, DynType, Off, 0, &Body});
-      continue;
+  // Like the serial scan, stop adding relocations once an error has been
+  // reported. Deferred relocations are still scanned for diagnostics.
+  size_t RelocPos = 0;
+  size_t DynPos = 0;
+  auto Flush = [&](size_t RelocEnd, size_t DynEnd) {
+    if (ErrorCount) {
+      RelocPos = RelocEnd;
+      DynPos = DynEnd;
+      return;
     }
+    C.Relocations.insert(C.Relocations.end(),
+                         Res.Relocations.begin() + RelocPos,
+                         Res.Relocations.begin() + RelocEnd);
+    RelocPos = RelocEnd;
+    for (; DynPos < DynEnd; ++DynPos)
+      In<ELFT>::RelaDyn->addReloc(Res.DynRelocs[DynPos]);
+  };
+
+  // Index of the first relocation that is not consumed yet.
+  size_t Next = 0;
+  for (const typename RelocScanResult<ELFT>::Deferred &D : Res.DeferredRelocs) {
+    Flush(D.RelocPos, D.DynPos);
+    if (D.RelIndex < Next)
+      continue;
+    Next = D.RelIndex +
+           scanReloc(C, Rels.begin() + D.RelIndex, Rels.end(), PieceI, PieceE);
   }
+  Flush(Res.Relocations.size(), Res.DynRelocs.size());
 }
 
-template <class ELFT> void scanRelocations(InputSectionBase<ELFT> &S) {
-  if (S.AreRelocsRela)
-    scanRelocs(S, S.relas());
-  else
-    scanRelocs(S, S.rels());
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase<ELFT> *> Sections) {
+  // MIPS relocations almost always need the MIPS GOT, so it doesn't make
+  // sense to scan them concurrently. If an error has already been reported,
+  // the serial scan only reports diagnostics, which must be in order.
+  if (!Config->Threads || Config->EMachine == EM_MIPS || ErrorCount) {
+    for (InputSectionBase<ELFT> *S : Sections)
+      scanRelocations(*S);
+    return;
+  }
+
+  std::vector<RelocScanResult<ELFT>> Results(Sections.size());
+  forLoop(0, Sections.size(), [&](size_t I) {
+    InputSectionBase<ELFT> &S = *Sections[I];
+    if (S.AreRelocsRela)
+      scanRelocsConcurrently(S, S.relas(), Results[I]);
+    else
+      scanRelocsConcurrently(S, S.rels(), Results[I]);
+  });
+
+  for (size_t I = 0, E = Sections.size(); I != E; ++I) {
+    InputSectionBase<ELFT> &S = *Sections[I];
+    if (S.AreRelocsRela)
+      mergeScanResult(S, S.relas(), Results[I]);
+    else
+      mergeScanResult(S, S.rels(), Results[I]);
+    Results[I] = RelocScanResult<ELFT>();
+  }
 }
 
 template <class ELFT>
@@ -839,6 +1052,11 @@ template void scanRelocations<ELF32BE>(InputSectionBase<ELF32BE> &);
 template void scanRelocations<ELF64LE>(InputSectionBase<ELF64LE> &);
 template void scanRelocations<ELF64BE>(InputSectionBase<ELF64BE> &);
 
+template void scanRelocations<ELF32LE>(ArrayRef<InputSectionBase<ELF32LE> *>);
+template void scanRelocations<ELF32BE>(ArrayRef<InputSectionBase<ELF32BE> *>);
+template void scanRelocations<ELF64LE>(ArrayRef<InputSectionBase<ELF64LE> *>);
+template void scanRelocations<ELF64BE>(ArrayRef<InputSectionBase<ELF64BE> *>);
+
 template void createThunks<ELF32LE>(ArrayRef<OutputSectionBase *>);
 template void createThunks<ELF32BE>(ArrayRef<OutputSectionBase *>);
 template void createThunks<ELF64LE>(ArrayRef<OutputSectionBase *>);
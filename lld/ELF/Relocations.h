@@ -114,6 +114,9 @@ struct Relocation {
 
 template <class ELFT> void scanRelocations(InputSectionBase<ELFT> &);
 
+template <class ELFT>
+void scanRelocations(ArrayRef<InputSectionBase<ELFT> *> Sections);
+
 template <class ELFT>
 void createThunks(ArrayRef<OutputSectionBase *> OutputSections);
 
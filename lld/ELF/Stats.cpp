@@ -0,0 +1,169 @@
+//===- Stats.cpp ----------------------------------------------------------===//
+//
+//                             The LLVM Linker
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --time-report and --print-stats. The linker is
+// split into sequential phases such as symbol resolution or writing the
+// output, and for each phase we record the wall-clock time, the CPU time
+// and the memory usage. CPU time divided by wall-clock time is the
+// average number of busy threads, which tells how well a phase is
+// parallelized.
+//
+// --time-report prints out a human-readable table, and --print-stats
+// prints out the same information in JSON so that it can be processed
+// by scripts.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Stats.h"
+#include "Config.h"
+#include "Memory.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <thread>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace llvm;
+
+using namespace lld;
+using namespace lld::elf;
+
+namespace {
+struct Phase {
+  StringRef Name;
+  TimeRecord Start;
+  TimeRecord End;
+  uint64_t ArenaStart;
+  uint64_t ArenaEnd;
+  uint64_t PeakRss;
+};
+} // anonymous namespace
+
+static std::vector<Phase> Phases;
+
+// Returns the number of bytes allocated by BAlloc and make<>.
+static uint64_t getArenaBytes() {
+  uint64_t Ret = BAlloc.getBytesAllocated();
+  for (SpecificAllocBase *Alloc : SpecificAllocBase::Instances)
+    Ret += Alloc->getBytesAllocated();
+  return Ret;
+}
+
+// Returns the peak resident set size of this process, or 0 if unknown.
+static uint64_t getPeakRss() {
+#ifdef LLVM_ON_UNIX
+  struct rusage RU;
+  if (getrusage(RUSAGE_SELF, &RU) == 0) {
+#ifdef __APPLE__
+    return RU.ru_maxrss;
+#else
+    return uint64_t(RU.ru_maxrss) * 1024;
+#endif
+  }
+#endif
+  return 0;
+}
+
+static void endPhase() {
+  if (Phases.empty())
+    return;
+  Phase &P = Phases.back();
+  P.End = TimeRecord::getCurrentTime(false);
+  P.ArenaEnd = getArenaBytes();
+  P.PeakRss = getPeakRss();
+}
+
+void elf::startPhase(StringRef Name) {
+  if (!Config->TimeReport && !Config->PrintStats)
+    return;
+  endPhase();
+  Phases.push_back({Name, TimeRecord::getCurrentTime(true), TimeRecord(),
+                    getArenaBytes(), 0, 0});
+}
+
+static double getWallTime(const Phase &P) {
+  return P.End.getWallTime() - P.Start.getWallTime();
+}
+
+static double getCpuTime(const Phase &P) {
+  return P.End.getProcessTime() - P.Start.getProcessTime();
+}
+
+static double getUtilization(const Phase &P) {
+  double Wall = getWallTime(P);
+  return Wall > 0 ? getCpuTime(P) / Wall : 0;
+}
+
+static unsigned getNumThreads() {
+  if (!Config->Threads)
+    return 1;
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+static void printTimeReport(raw_ostream &OS) {
+  OS << "Link phases:\n"
+     << "    Wall (s)     CPU (s)  Threads  Arena (MB)  Peak RSS (MB)  Name\n";
+  double TotalWall = 0;
+  double TotalCpu = 0;
+  for (const Phase &P : Phases) {
+    TotalWall += getWallTime(P);
+    TotalCpu += getCpuTime(P);
+    OS << format("%12.4f%12.4f%9.2f%12.1f%15.1f  ", getWallTime(P),
+                 getCpuTime(P), getUtilization(P),
+                 (P.ArenaEnd - P.ArenaStart) / 1048576.0,
+                 P.PeakRss / 1048576.0)
+       << P.Name << "\n";
+  }
+  OS << format("%12.4f%12.4f", TotalWall, TotalCpu) << "  Total\n";
+}
+
+static void printJson(raw_ostream &OS) {
+  uint64_t ArenaBytes = Phases.back().ArenaEnd;
+  uint64_t PeakRss = Phases.back().PeakRss;
+  double TotalWall = 0;
+  for (const Phase &P : Phases)
+    TotalWall += getWallTime(P);
+
+  OS << "{\n";
+  OS << "  \"output\": \"";
+  OS.write_escaped(Config->OutputFile);
+  OS << "\",\n";
+  OS << "  \"threads\": " << getNumThreads() << ",\n";
+  OS << "  \"wall_time\": " << format("%.6f", TotalWall) << ",\n";
+  OS << "  \"peak_rss\": " << PeakRss << ",\n";
+  OS << "  \"arena_bytes\": " << ArenaBytes << ",\n";
+  OS << "  \"phases\": [";
+  for (size_t I = 0, E = Phases.size(); I != E; ++I) {
+    const Phase &P = Phases[I];
+    OS << (I ? "," : "") << "\n    {\"name\": \"" << P.Name << "\""
+       << ", \"wall_time\": " << format("%.6f", getWallTime(P))
+       << ", \"user_time\": "
+       << format("%.6f", P.End.getUserTime() - P.Start.getUserTime())
+       << ", \"system_time\": "
+       << format("%.6f", P.End.getSystemTime() - P.Start.getSystemTime())
+       << ", \"utilization\": " << format("%.3f", getUtilization(P))
+       << ", \"arena_bytes\": " << P.ArenaEnd - P.ArenaStart
+       << ", \"peak_rss\": " << P.PeakRss << "}";
+  }
+  OS << "\n  ]\n}\n";
+}
+
+void elf::printStats() {
+  if (Phases.empty())
+    return;
+  endPhase();
+  if (Config->TimeReport)
+    printTimeReport(errs());
+  if (Config->PrintStats)
+    printJson(outs());
+  Phases.clear();
+}
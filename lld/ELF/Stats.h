@@ -0,0 +1,29 @@
+//===- Stats.h --------------------------------------------------*- C++ -*-===//
+//
+//                             The LLVM Linker
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_STATS_H
+#define LLD_ELF_STATS_H
+
+#include "lld/Core/LLVM.h"
+
+namespace lld {
+namespace elf {
+
+// Starts a new link phase for --time-report and --print-stats.
+// The current phase, if any, ends at the same time. This is a no-op
+// unless one of the options is given.
+void startPhase(StringRef Name);
+
+// Ends the current phase and prints out the statistics.
+void printStats();
+
+} // namespace elf
+} // namespace lld
+
+#endif
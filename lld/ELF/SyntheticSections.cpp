@@ -1512,54 +1512,105 @@ GdbIndexSection<ELFT>::GdbIndexSection()
       StringPool(llvm::StringTableBuilder::ELF) {}
 
 template <class ELFT> void GdbIndexSection<ELFT>::parseDebugSections() {
+  // A DWARF context covers all debug sections of a file, so we parse
+  // each file only once even if it has more than one .debug_info.
+  DenseSet<ObjectFile<ELFT> *> Seen;
+  std::vector<InputSection<ELFT> *> DebugInfoSecs;
   for (InputSectionBase<ELFT> *S : Symtab<ELFT>::X->Sections)
     if (InputSection<ELFT> *IS = dyn_cast<InputSection<ELFT>>(S))
-      if (IS->OutSec && IS->Name == ".debug_info")
-        readDwarf(IS);
-}
+      if (IS->OutSec && IS->Name == ".debug_info" &&
+          Seen.insert(IS->getFile()).second)
+        DebugInfoSecs.push_back(IS);
+
+  // Parsing DWARF is the most expensive part of this section,
+  // and files are independent of each other.
+  Chunks.resize(DebugInfoSecs.size());
+  forLoop(0, DebugInfoSecs.size(),
+          [&](size_t I) { Chunks[I] = readDwarf(DebugInfoSecs[I]); });
+  if (ErrorCount)
+    return;
 
-// Iterative hash function for symbol's name is described in .gdb_index format
-// specification. Note that we use one for version 5 to 7 here, it is different
-// for version 4.
-static uint32_t hash(StringRef Str) {
-  uint32_t R = 0;
-  for (uint8_t C : Str)
-    R = R * 67 + tolower(C) - 113;
-  return R;
+  // Concatenate CU lists and address areas. CU indices in address
+  // areas are local to each chunk, so rebase them.
+  std::vector<size_t> CuBases;
+  for (GdbIndexChunk<ELFT> &Chunk : Chunks) {
+    size_t CuBase = CompilationUnits.size();
+    CuBases.push_back(CuBase);
+    CompilationUnits.insert(CompilationUnits.end(),
+                            Chunk.CompilationUnits.begin(),
+                            Chunk.CompilationUnits.end());
+    for (AddressEntry<ELFT> &E : Chunk.AddressArea) {
+      E.CuIndex += CuBase;
+      AddressArea.push_back(E);
+    }
+  }
+
+  buildSymbolTable(CuBases);
 }
 
 template <class ELFT>
-void GdbIndexSection<ELFT>::readDwarf(InputSection<ELFT> *I) {
-  GdbIndexBuilder<ELFT> Builder(I);
-  if (ErrorCount)
-    return;
+GdbIndexChunk<ELFT> GdbIndexSection<ELFT>::readDwarf(InputSection<ELFT> *I) {
+  GdbIndexChunk<ELFT> Ret;
+  Ret.DebugInfoSec = I;
 
-  size_t CuId = CompilationUnits.size();
-  std::vector<std::pair<uintX_t, uintX_t>> CuList = Builder.readCUList();
-  CompilationUnits.insert(CompilationUnits.end(), CuList.begin(), CuList.end());
+  GdbIndexBuilder<ELFT> Builder(I);
+  if (!Builder.isValid())
+    return Ret;
 
-  std::vector<AddressEntry<ELFT>> AddrArea = Builder.readAddressArea(CuId);
-  AddressArea.insert(AddressArea.end(), AddrArea.begin(), AddrArea.end());
+  Ret.CompilationUnits = Builder.readCUList();
+  Ret.AddressArea = Builder.readAddressArea(0);
+  Ret.NamesAndTypes = Builder.readPubNamesAndTypes();
+  return Ret;
+}
 
-  std::vector<std::pair<StringRef, uint8_t>> NamesAndTypes =
-      Builder.readPubNamesAndTypes();
+static const size_t NumNameShards = 32;
 
-  for (std::pair<StringRef, uint8_t> &Pair : NamesAndTypes) {
-    uint32_t Hash = hash(Pair.first);
-    size_t Offset = StringPool.add(Pair.first);
+// Names are assigned to shards by the upper bits of their hash values
+// because DenseMap uses the lower bits to select buckets.
+static size_t getNameShardId(uint32_t Hash) {
+  return Hash >> (32 - llvm::countTrailingZeros(NumNameShards));
+}
 
-    bool IsNew;
-    GdbSymbol *Sym;
-    std::tie(IsNew, Sym) = SymbolTable.add(Hash, Offset);
-    if (IsNew) {
+// Builds the symbol table and the CU vectors. All names from a file are
+// attributed to the first CU of the file.
+template <class ELFT>
+void GdbIndexSection<ELFT>::buildSymbolTable(ArrayRef<size_t> CuBases) {
+  // Uniquify names. Names are distributed to shards by their hash
+  // values, so identical names always belong to the same shard, and
+  // each shard can be processed by a different thread. Each entry's
+  // SymIndex is set to the index of its unique name in the shard.
+  NameShards.resize(NumNameShards);
+  size_t Concurrency = getShardConcurrency(NumNameShards);
+
+  forLoop(0, Concurrency, [&](size_t ThreadId) {
+    std::vector<DenseMap<CachedHashStringRef, size_t>> Maps(NumNameShards);
+    for (size_t I = 0, E = Chunks.size(); I != E; ++I) {
+      for (NameTypeEntry &Ent : Chunks[I].NamesAndTypes) {
+        size_t ShardId = getNameShardId(Ent.Name.hash());
+        if ((ShardId & (Concurrency - 1)) != ThreadId)
+          continue;
+        std::vector<UniqueName> &Shard = NameShards[ShardId];
+        auto P = Maps[ShardId].insert({Ent.Name, Shard.size()});
+        if (P.second)
+          Shard.push_back({&Ent, {}});
+        Shard[P.first->second].CuVector.push_back({CuBases[I], Ent.Type});
+        Ent.SymIndex = P.first->second;
+      }
+    }
+  });
+
+  // Add unique names to the string pool and the hash table in input
+  // order, so that the output doesn't depend on the number of threads.
+  for (GdbIndexChunk<ELFT> &Chunk : Chunks) {
+    for (NameTypeEntry &Ent : Chunk.NamesAndTypes) {
+      UniqueName &U = NameShards[getNameShardId(Ent.Name.hash())][Ent.SymIndex];
+      if (U.Entry != &Ent)
+        continue;
+      size_t Offset = StringPool.add(Ent.Name);
+      GdbSymbol *Sym = SymbolTable.add(Ent.GdbHash, Offset).second;
       Sym->CuVectorIndex = CuVectors.size();
-      CuVectors.push_back({{CuId, Pair.second}});
-      continue;
+      CuVectors.push_back(std::move(U.CuVector));
     }
-
-    std::vector<std::pair<uint32_t, uint8_t>> &CuVec =
-        CuVectors[Sym->CuVectorIndex];
-    CuVec.push_back({CuId, Pair.second});
   }
 }
 
@@ -1608,40 +1659,49 @@ template <class ELFT> void GdbIndexSection<ELFT>::writeTo(uint8_t *Buf) {
     Buf += 16;
   }
 
+  // This function is called from a parallel loop over input sections,
+  // so the tables are written serially. Nesting another parallel loop
+  // here could deadlock when all worker threads are busy.
+
   // Write the address area.
-  for (AddressEntry<ELFT> &E : AddressArea) {
-    uintX_t BaseAddr = E.Section->OutSec->Addr + E.Section->getOffset(0);
-    write64le(Buf, BaseAddr + E.LowAddress);
-    write64le(Buf + 8, BaseAddr + E.HighAddress);
-    write32le(Buf + 16, E.CuIndex);
-    Buf += 20;
+  for (size_t I = 0, E = AddressArea.size(); I < E; ++I) {
+    AddressEntry<ELFT> &Ent = AddressArea[I];
+    uint8_t *P = Buf + I * AddressEntrySize;
+    uintX_t BaseAddr = Ent.Section->OutSec->Addr + Ent.Section->getOffset(0);
+    write64le(P, BaseAddr + Ent.LowAddress);
+    write64le(P + 8, BaseAddr + Ent.HighAddress);
+    write32le(P + 16, Ent.CuIndex);
   }
+  Buf += AddressArea.size() * AddressEntrySize;
 
   // Write the symbol table.
-  for (size_t I = 0; I < SymbolTable.getCapacity(); ++I) {
+  for (size_t I = 0, E = SymbolTable.getCapacity(); I < E; ++I) {
     GdbSymbol *Sym = SymbolTable.getSymbol(I);
-    if (Sym) {
-      size_t NameOffset =
-          Sym->NameOffset + StringPoolOffset - ConstantPoolOffset;
-      size_t CuVectorOffset = CuVectorsOffset[Sym->CuVectorIndex];
-      write32le(Buf, NameOffset);
-      write32le(Buf + 4, CuVectorOffset);
-    }
-    Buf += 8;
+    if (!Sym)
+      continue;
+    uint8_t *P = Buf + I * SymTabEntrySize;
+    size_t NameOffset = Sym->NameOffset + StringPoolOffset - ConstantPoolOffset;
+    size_t CuVectorOffset = CuVectorsOffset[Sym->CuVectorIndex];
+    write32le(P, NameOffset);
+    write32le(P + 4, CuVectorOffset);
   }
+  Buf += SymbolTable.getCapacity() * SymTabEntrySize;
 
   // Write the CU vectors into the constant pool.
-  for (std::vector<std::pair<uint32_t, uint8_t>> &CuVec : CuVectors) {
-    write32le(Buf, CuVec.size());
-    Buf += 4;
-    for (std::pair<uint32_t, uint8_t> &P : CuVec) {
-      uint32_t Index = P.first;
-      uint8_t Flags = P.second;
+  for (size_t I = 0, E = CuVectors.size(); I < E; ++I) {
+    std::vector<std::pair<uint32_t, uint8_t>> &CuVec = CuVectors[I];
+    uint8_t *P = Buf + CuVectorsOffset[I];
+    write32le(P, CuVec.size());
+    P += 4;
+    for (std::pair<uint32_t, uint8_t> &Pair : CuVec) {
+      uint32_t Index = Pair.first;
+      uint8_t Flags = Pair.second;
       Index |= Flags << 24;
-      write32le(Buf, Index);
-      Buf += 4;
+      write32le(P, Index);
+      P += 4;
     }
   }
+  Buf += CuVectorsSize;
 
   StringPool.write(Buf);
 }
@@ -1661,14 +1721,7 @@ EhFrameHeader<ELFT>::EhFrameHeader()
 template <class ELFT> void EhFrameHeader<ELFT>::writeTo(uint8_t *Buf) {
   const endianness E = ELFT::TargetEndianness;
 
-  // Sort the FDE list by their PC and uniqueify. Usually there is only
-  // one FDE for a PC (i.e. function), but if ICF merges two functions
-  // into one, there can be more than one FDEs pointing to the address.
-  auto Less = [](const FdeData &A, const FdeData &B) { return A.Pc < B.Pc; };
-  std::stable_sort(Fdes.begin(), Fdes.end(), Less);
-  auto Eq = [](const FdeData &A, const FdeData &B) { return A.Pc == B.Pc; };
-  Fdes.erase(std::unique(Fdes.begin(), Fdes.end(), Eq), Fdes.end());
-
+  // Fdes are sorted and uniquified by EhOutputSection::writeTo.
   Buf[0] = 1;
   Buf[1] = DW_EH_PE_pcrel | DW_EH_PE_sdata4;
   Buf[2] = DW_EH_PE_udata4;
@@ -1690,11 +1743,6 @@ template <class ELFT> size_t EhFrameHeader<ELFT>::getSize() const {
   return 12 + Out<ELFT>::EhFrame->NumFdes * 8;
 }
 
-template <class ELFT>
-void EhFrameHeader<ELFT>::addFde(uint32_t Pc, uint32_t FdeVA) {
-  Fdes.push_back({Pc, FdeVA});
-}
-
 template <class ELFT> bool EhFrameHeader<ELFT>::empty() const {
   return Out<ELFT>::EhFrame->empty();
 }
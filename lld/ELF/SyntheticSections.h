@@ -516,8 +516,22 @@ public:
   std::vector<AddressEntry<ELFT>> AddressArea;
 
 private:
+  // A unique name in the symbol table and the CUs that define it.
+  struct UniqueName {
+    NameTypeEntry *Entry;
+    std::vector<std::pair<uint32_t, uint8_t>> CuVector;
+  };
+
   void parseDebugSections();
-  void readDwarf(InputSection<ELFT> *I);
+  GdbIndexChunk<ELFT> readDwarf(InputSection<ELFT> *I);
+  void buildSymbolTable(ArrayRef<size_t> CuBases);
+
+  // Data extracted from each input file, in input order.
+  std::vector<GdbIndexChunk<ELFT>> Chunks;
+
+  // Unique names distributed by hash values so that each shard can be
+  // processed by a different thread.
+  std::vector<std::vector<UniqueName>> NameShards;
 
   uint32_t CuTypesOffset;
   uint32_t SymTabOffset;
@@ -547,15 +561,14 @@ public:
   EhFrameHeader();
   void writeTo(uint8_t *Buf) override;
   size_t getSize() const override;
-  void addFde(uint32_t Pc, uint32_t FdeVA);
   bool empty() const override;
 
-private:
   struct FdeData {
     uint32_t Pc;
     uint32_t FdeVA;
   };
 
+  // Filled, sorted and uniquified by EhOutputSection::writeTo().
   std::vector<FdeData> Fdes;
 };
 
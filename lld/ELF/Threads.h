@@ -62,8 +62,10 @@
 #include "Config.h"
 
 #include "lld/Core/Parallel.h"
+#include "llvm/Support/MathExtras.h"
 #include <algorithm>
 #include <functional>
+#include <thread>
 
 namespace lld {
 namespace elf {
@@ -84,6 +86,25 @@ inline void forLoop(size_t Begin, size_t End, std::function<void(size_t)> Fn) {
       Fn(I);
   }
 }
+
+template <class IterTy, class Comp>
+void parallelSort(IterTy Begin, IterTy End, const Comp &C) {
+  if (Config->Threads)
+    parallel_sort(Begin, End, C);
+  else
+    std::sort(Begin, End, C);
+}
+
+// Returns the number of threads to process NumShards shards, where
+// NumShards is a power of two. Thread I processes shards whose IDs are
+// congruent to I modulo the return value.
+inline size_t getShardConcurrency(size_t NumShards) {
+  if (!Config->Threads)
+    return 1;
+  return std::min<size_t>(
+      llvm::PowerOf2Floor(std::max(1U, std::thread::hardware_concurrency())),
+      NumShards);
+}
 }
 }
 
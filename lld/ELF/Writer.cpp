@@ -9,23 +9,32 @@
 
 #include "Writer.h"
 #include "Config.h"
+#include "Incremental.h"
 #include "LinkerScript.h"
 #include "MapFile.h"
 #include "Memory.h"
 #include "OutputSections.h"
 #include "Relocations.h"
+#include "Stats.h"
 #include "Strings.h"
 #include "SymbolTable.h"
 #include "SyntheticSections.h"
 #include "Target.h"
+#include "Threads.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include <climits>
 #include <thread>
 
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <unistd.h>
+#define LLD_HAS_PWRITE 1
+#endif
+
 using namespace llvm;
 using namespace llvm::ELF;
 using namespace llvm::object;
@@ -36,6 +45,24 @@ using namespace lld;
 using namespace lld::elf;
 
 namespace {
+// An output file that is written with pwrite(2) instead of being mapped
+// to memory. This is used if --no-mmap-output-file is given. Like
+// FileOutputBuffer, it writes to a temporary file first and renames it
+// to the final name on commit.
+class StreamingOutputFile {
+public:
+  ~StreamingOutputFile();
+  std::error_code create(StringRef Path, uint64_t Size);
+  void write(uint64_t Offset, ArrayRef<uint8_t> Data);
+  std::error_code commit();
+  int getFD() const { return FD; }
+
+private:
+  SmallString<128> FinalPath;
+  SmallString<128> TempPath;
+  int FD = -1;
+};
+
 // The writer writes a SymbolTable result to a file.
 template <class ELFT> class Writer {
 public:
@@ -70,13 +97,31 @@ private:
   void fixSectionAlignments();
   void fixPredefinedSymbols();
   void openFile();
-  void writeHeader();
+  void writeHeader(uint8_t *Buf, uint8_t *SHdrBuf);
   void writeSections();
+  void writeSectionsStreaming();
+  void writeSectionStreaming(OutputSectionBase *Sec);
+  void writeBatchesStreaming(OutputSectionBase *Sec, ArrayRef<uint64_t> Bounds,
+                             std::function<void(uint8_t *, size_t)> Fn);
+  void writeHeaderStreaming();
+  void writeBuildIdStreaming();
   void writeSectionsBinary();
   void writeBuildId();
+  uint8_t *getBufferStart();
+  uint64_t getPadding(OutputSectionBase *Sec);
 
   std::unique_ptr<FileOutputBuffer> Buffer;
 
+  // Non-null if the output is written with pwrite(2) instead of mmap.
+  std::unique_ptr<StreamingOutputFile> Stream;
+  std::vector<uint8_t> OpdStaging;
+
+  // Non-null if --incremental is given. If Patching is true, we are
+  // writing to the previous output file in place instead of to Buffer.
+  std::unique_ptr<IncrementalLink<ELFT>> Incremental;
+  uint8_t *PatchBuf = nullptr;
+  bool Patching = false;
+
   std::vector<OutputSectionBase *> OutputSections;
   OutputSectionFactory<ELFT> Factory;
 
@@ -150,6 +195,11 @@ template <class ELFT> void Writer<ELFT>::removeEmptyPTLoad() {
 
 // The main function of the writer.
 template <class ELFT> void Writer<ELFT>::run() {
+  if (Config->Incremental)
+    Incremental.reset(new IncrementalLink<ELFT>());
+
+  startPhase("create-sections");
+
   // Create linker-synthesized sections such as .got or .plt.
   // Such sections are of type input section.
   createSyntheticSections();
@@ -187,6 +237,7 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (ErrorCount)
     return;
 
+  startPhase("layout");
   if (Config->Relocatable) {
     assignFileOffsets();
   } else {
@@ -209,17 +260,44 @@ template <class ELFT> void Writer<ELFT>::run() {
 
     setPhdrs();
     fixPredefinedSymbols();
+
+    // Compress .debug_* sections if --compress-debug-sections is given.
+    // Their contents depend on addresses, so we can do this only now.
+    // Compression shrinks sections, so file offsets are recomputed.
+    if (Config->CompressDebugSections && !Config->OFormatBinary) {
+      for (OutputSectionBase *Sec : OutputSections)
+        Sec->maybeCompress<ELFT>();
+      assignFileOffsets();
+      setPhdrs();
+    }
   }
 
   // It does not make sense try to open the file if we have error already.
   if (ErrorCount)
     return;
+
+  startPhase("open");
+
+  // If the layout is the same as the previous link, patch the previous
+  // output in place. See Incremental.cpp for details.
+  if (Incremental && Incremental->canPatch(OutputSections, FileSize)) {
+    PatchBuf = Incremental->openOutput(FileSize);
+    Patching = PatchBuf != nullptr;
+  }
+
   // Write the result down to a file.
-  openFile();
+  if (!Patching)
+    openFile();
   if (ErrorCount)
     return;
-  if (!Config->OFormatBinary) {
-    writeHeader();
+
+  startPhase("write");
+  if (Stream) {
+    writeHeaderStreaming();
+    writeSectionsStreaming();
+  } else if (!Config->OFormatBinary) {
+    uint8_t *Buf = getBufferStart();
+    writeHeader(Buf, Buf + SectionHeaderOff);
     writeSections();
   } else {
     writeSectionsBinary();
@@ -227,7 +305,11 @@ template <class ELFT> void Writer<ELFT>::run() {
 
   // Backfill .note.gnu.build-id section content. This is done at last
   // because the content is usually a hash value of the entire output file.
-  writeBuildId();
+  startPhase("build-id");
+  if (Stream)
+    writeBuildIdStreaming();
+  else
+    writeBuildId();
   if (ErrorCount)
     return;
 
@@ -236,9 +318,22 @@ template <class ELFT> void Writer<ELFT>::run() {
   if (ErrorCount)
     return;
 
-  if (auto EC = Buffer->commit())
+  startPhase("commit");
+  std::error_code EC;
+  if (Patching)
+    Incremental->closeOutput();
+  else if (Stream)
+    EC = Stream->commit();
+  else
+    EC = Buffer->commit();
+  if (EC)
     error("failed to write to the output file: " + EC.message());
 
+  if (Incremental && !ErrorCount)
+    Incremental->writeState(OutputSections, FileSize);
+
+  printStats();
+
   // Flush the output streams and exit immediately. A full shutdown
   // is a good test that we are keeping track of all allocated memory,
   // but actually freeing it is a waste of time in a regular linker run.
@@ -1024,7 +1119,11 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
 
   // Scan relocations. This must be done after every symbol is declared so that
   // we can correctly decide if a dynamic relocation is needed.
-  forEachRelSec(scanRelocations<ELFT>);
+  startPhase("scan-relocs");
+  std::vector<InputSectionBase<ELFT> *> RelSecs;
+  forEachRelSec([&](InputSectionBase<ELFT> &S) { RelSecs.push_back(&S); });
+  scanRelocations<ELFT>(RelSecs);
+  startPhase("finalize-sections");
 
   if (In<ELFT>::Plt && !In<ELFT>::Plt->empty())
     In<ELFT>::Plt->addSymbols();
@@ -1411,7 +1510,7 @@ template <class ELFT> void Writer<ELFT>::assignAddresses() {
     if (needsPtLoad<ELFT>(Sec)) {
       VA = alignTo(VA, Alignment);
       Sec->Addr = VA;
-      VA += Sec->Size;
+      VA += Sec->Size + getPadding(Sec);
     } else if (Sec->Flags & SHF_TLS && Sec->Type == SHT_NOBITS) {
       uintX_t TVA = VA + ThreadBssOffset;
       TVA = alignTo(TVA, Alignment);
@@ -1468,8 +1567,11 @@ template <class ELFT> void Writer<ELFT>::assignFileOffsets() {
   setOffset<ELFT>(Out<ELFT>::ElfHeader, Off);
   setOffset<ELFT>(Out<ELFT>::ProgramHeaders, Off);
 
-  for (OutputSectionBase *Sec : OutputSections)
+  for (OutputSectionBase *Sec : OutputSections) {
     setOffset<ELFT>(Sec, Off);
+    if (Sec->Type != SHT_NOBITS)
+      Off += getPadding(Sec);
+  }
 
   SectionHeaderOff = alignTo(Off, sizeof(uintX_t));
   FileSize = SectionHeaderOff + (OutputSections.size() + 1) * sizeof(Elf_Shdr);
@@ -1616,8 +1718,10 @@ template <class ELFT> void Writer<ELFT>::fixPredefinedSymbols() {
   }
 }
 
-template <class ELFT> void Writer<ELFT>::writeHeader() {
-  uint8_t *Buf = Buffer->getBufferStart();
+// Writes the ELF header and the program header table to Buf and the
+// section header table to SHdrBuf.
+template <class ELFT>
+void Writer<ELFT>::writeHeader(uint8_t *Buf, uint8_t *SHdrBuf) {
   memcpy(Buf, "\177ELF", 4);
 
   // Write the ELF header.
@@ -1665,7 +1769,7 @@ template <class ELFT> void Writer<ELFT>::writeHeader() {
   }
 
   // Write the section header table. Note that the first table entry is null.
-  auto *SHdrs = reinterpret_cast<Elf_Shdr *>(Buf + EHdr->e_shoff);
+  auto *SHdrs = reinterpret_cast<Elf_Shdr *>(SHdrBuf);
   for (OutputSectionBase *Sec : OutputSections)
     Sec->writeHeaderTo<ELFT>(++SHdrs);
 }
@@ -1705,9 +1809,70 @@ static void unlinkAsync(StringRef Path) {
   std::thread([=] { ::remove(TempPath.str().str().c_str()); }).detach();
 }
 
+StreamingOutputFile::~StreamingOutputFile() {
+  if (FD == -1)
+    return;
+  sys::Process::SafelyCloseFileDescriptor(FD);
+  sys::fs::remove(TempPath);
+}
+
+std::error_code StreamingOutputFile::create(StringRef Path, uint64_t Size) {
+  FinalPath = Path;
+  unsigned Mode = sys::fs::all_read | sys::fs::all_write | sys::fs::all_exe;
+  if (auto EC = sys::fs::createUniqueFile(Path + ".tmp%%%%%%%", FD, TempPath,
+                                          Mode))
+    return EC;
+
+  // Allocate disk blocks upfront so that we do not fail with ENOSPC
+  // in the middle of writing and the file is less fragmented.
+  return sys::fs::resize_file(FD, Size);
+}
+
+// This function is called from multiple threads.
+void StreamingOutputFile::write(uint64_t Offset, ArrayRef<uint8_t> Data) {
+#ifdef LLD_HAS_PWRITE
+  while (!Data.empty()) {
+    ssize_t N = ::pwrite(FD, Data.data(), Data.size(), Offset);
+    if (N < 0) {
+      if (errno == EINTR)
+        continue;
+      error("failed to write to " + TempPath + ": " +
+            std::error_code(errno, std::generic_category()).message());
+      return;
+    }
+    Data = Data.drop_front(N);
+    Offset += N;
+  }
+#else
+  llvm_unreachable("--no-mmap-output-file is not supported on this host");
+#endif
+}
+
+std::error_code StreamingOutputFile::commit() {
+  std::error_code EC = sys::Process::SafelyCloseFileDescriptor(FD);
+  FD = -1;
+  if (!EC)
+    EC = sys::fs::rename(TempPath, FinalPath);
+  if (EC)
+    sys::fs::remove(TempPath);
+  return EC;
+}
+
 // Open a result file.
 template <class ELFT> void Writer<ELFT>::openFile() {
   unlinkAsync(Config->OutputFile);
+
+#ifdef LLD_HAS_PWRITE
+  // We need random access to the output to create a flat binary,
+  // which is usually small anyway.
+  if (!Config->MmapOutputFile && !Config->OFormatBinary) {
+    Stream.reset(new StreamingOutputFile);
+    if (auto EC = Stream->create(Config->OutputFile, FileSize))
+      error("failed to open " + Config->OutputFile + ": " + EC.message());
+    return;
+  }
+#endif
+
   ErrorOr<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
       FileOutputBuffer::create(Config->OutputFile, FileSize,
                                FileOutputBuffer::F_executable);
@@ -1718,8 +1883,23 @@ template <class ELFT> void Writer<ELFT>::openFile() {
     Buffer = std::move(*BufferOrErr);
 }
 
+template <class ELFT> uint8_t *Writer<ELFT>::getBufferStart() {
+  if (Patching)
+    return PatchBuf;
+  return Buffer->getBufferStart();
+}
+
+// With --incremental, we reserve some space after each output section
+// so that the section can grow without moving other sections.
+template <class ELFT>
+uint64_t Writer<ELFT>::getPadding(OutputSectionBase *Sec) {
+  if (!Incremental)
+    return 0;
+  return Incremental->getPadding(Sec);
+}
+
 template <class ELFT> void Writer<ELFT>::writeSectionsBinary() {
-  uint8_t *Buf = Buffer->getBufferStart();
+  uint8_t *Buf = getBufferStart();
   for (OutputSectionBase *Sec : OutputSections)
     if (Sec->Flags & SHF_ALLOC)
       Sec->writeTo(Buf + Sec->Offset);
@@ -1727,26 +1907,212 @@ template <class ELFT> void Writer<ELFT>::writeSectionsBinary() {
 
 // Write section contents to a mmap'ed file.
 template <class ELFT> void Writer<ELFT>::writeSections() {
-  uint8_t *Buf = Buffer->getBufferStart();
+  uint8_t *Buf = getBufferStart();
+  if (Patching)
+    Incremental->clearStaleBytes(Buf, OutputSections);
+
+  // If we are patching the previous output, we write only input
+  // sections that may have changed.
+  auto Write = [&](OutputSectionBase *Sec) {
+    if (!Sec->CompressedData.empty())
+      memcpy(Buf + Sec->Offset, Sec->CompressedData.data(),
+             Sec->CompressedData.size());
+    else if (Patching && isa<OutputSection<ELFT>>(Sec))
+      cast<OutputSection<ELFT>>(Sec)->writeChangedTo(Buf + Sec->Offset);
+    else
+      Sec->writeTo(Buf + Sec->Offset);
+  };
 
   // PPC64 needs to process relocations in the .opd section
   // before processing relocations in code-containing sections.
   Out<ELFT>::Opd = findSection(".opd");
   if (Out<ELFT>::Opd) {
     Out<ELFT>::OpdBuf = Buf + Out<ELFT>::Opd->Offset;
-    Out<ELFT>::Opd->writeTo(Buf + Out<ELFT>::Opd->Offset);
+    Write(Out<ELFT>::Opd);
   }
 
   OutputSectionBase *EhFrameHdr =
       In<ELFT>::EhFrameHdr ? In<ELFT>::EhFrameHdr->OutSec : nullptr;
   for (OutputSectionBase *Sec : OutputSections)
     if (Sec != Out<ELFT>::Opd && Sec != EhFrameHdr)
-      Sec->writeTo(Buf + Sec->Offset);
+      Write(Sec);
 
   // The .eh_frame_hdr depends on .eh_frame section contents, therefore
   // it should be written after .eh_frame is written.
   if (!Out<ELFT>::EhFrame->empty() && EhFrameHdr)
-    EhFrameHdr->writeTo(Buf + EhFrameHdr->Offset);
+    Write(EhFrameHdr);
+}
+
+// The following functions are used if --no-mmap-output-file is given.
+// Instead of writing sections directly to a memory-mapped output file,
+// we write them to small buffers and then copy the buffers to the file
+// using pwrite(2). Memory usage is bounded by the size of the buffers
+// rather than by the size of the output, and we do not take a page
+// fault for each page of the output.
+template <class ELFT> void Writer<ELFT>::writeHeaderStreaming() {
+  std::vector<uint8_t> Buf(getHeaderSize<ELFT>());
+  std::vector<uint8_t> SHdrBuf((OutputSections.size() + 1) * sizeof(Elf_Shdr));
+  writeHeader(Buf.data(), SHdrBuf.data());
+  Stream->write(0, Buf);
+  Stream->write(SectionHeaderOff, SHdrBuf);
+}
+
+template <class ELFT> void Writer<ELFT>::writeSectionsStreaming() {
+  // .opd must be written first and kept in memory because
+  // relocations in other sections read its contents.
+  Out<ELFT>::Opd = findSection(".opd");
+  if (Out<ELFT>::Opd) {
+    OpdStaging.resize(Out<ELFT>::Opd->Size);
+    Out<ELFT>::OpdBuf = OpdStaging.data();
+    Out<ELFT>::Opd->writeTo(OpdStaging.data());
+    Stream->write(Out<ELFT>::Opd->Offset, OpdStaging);
+  }
+
+  OutputSectionBase *EhFrameHdr =
+      In<ELFT>::EhFrameHdr ? In<ELFT>::EhFrameHdr->OutSec : nullptr;
+  for (OutputSectionBase *Sec : OutputSections)
+    if (Sec != Out<ELFT>::Opd && Sec != EhFrameHdr)
+      writeSectionStreaming(Sec);
+  if (!Out<ELFT>::EhFrame->empty() && EhFrameHdr)
+    writeSectionStreaming(EhFrameHdr);
+}
+
+// Fills Buf with the linker script filler, assuming that Buf
+// corresponds to the offset Begin of a section.
+static void fillAt(uint8_t *Buf, size_t Size, uint32_t Filler, uint64_t Begin) {
+  uint8_t V[4];
+  write32be(V, Filler);
+  for (size_t I = 0; I < Size; ++I)
+    Buf[I] = V[(Begin + I) % 4];
+}
+
+// Writes each range [Bounds[I], Bounds[I + 1]) of Sec in parallel. Fn
+// is called with a zero-filled buffer for the range and I. Each thread
+// reuses its own buffer, so memory usage is bounded by the batch size
+// times the number of threads.
+template <class ELFT>
+void Writer<ELFT>::writeBatchesStreaming(
+    OutputSectionBase *Sec, ArrayRef<uint64_t> Bounds,
+    std::function<void(uint8_t *, size_t)> Fn) {
+  size_t NumBatches = Bounds.size() - 1;
+  size_t Concurrency = 1;
+  if (Config->Threads)
+    Concurrency = std::min<size_t>(
+        NumBatches, std::max(1U, std::thread::hardware_concurrency()));
+
+  forLoop(0, Concurrency, [&](size_t ThreadId) {
+    std::vector<uint8_t> Buf;
+    for (size_t I = ThreadId; I < NumBatches; I += Concurrency) {
+      Buf.assign(Bounds[I + 1] - Bounds[I], 0);
+      Fn(Buf.data(), I);
+      Stream->write(Sec->Offset + Bounds[I], Buf);
+    }
+  });
+}
+
+template <class ELFT>
+void Writer<ELFT>::writeSectionStreaming(OutputSectionBase *Sec) {
+  if (Sec->Type == SHT_NOBITS || Sec->Size == 0)
+    return;
+  if (!Sec->CompressedData.empty()) {
+    Stream->write(Sec->Offset, Sec->CompressedData);
+    return;
+  }
+
+  // Mergeable sections are split at fixed intervals because pieces can
+  // be copied partially.
+  const uint64_t BatchSize = 1024 * 1024;
+  auto *MS = dyn_cast<MergeOutputSection<ELFT>>(Sec);
+  if (MS && !MS->shouldTailMerge()) {
+    std::vector<uint64_t> Bounds;
+    for (uint64_t Off = 0; Off < MS->Size; Off += BatchSize)
+      Bounds.push_back(Off);
+    Bounds.push_back(MS->Size);
+    writeBatchesStreaming(MS, Bounds, [&](uint8_t *Buf, size_t I) {
+      MS->writeRangeTo(Buf, Bounds[I], Bounds[I + 1]);
+    });
+    return;
+  }
+
+  // .eh_frame and tail-merged string sections are synthesized as a
+  // whole, so they are staged in memory.
+  auto *OS = dyn_cast<OutputSection<ELFT>>(Sec);
+  if (!OS) {
+    std::vector<uint8_t> Buf(Sec->Size);
+    Sec->writeTo(Buf.data());
+    Stream->write(Sec->Offset, Buf);
+    return;
+  }
+
+  // Split input sections into batches of about 1 MiB. Each batch also
+  // covers the gap after its last input section, which may contain
+  // linker script fillers and data commands.
+  std::vector<uint64_t> Bounds = {0};
+  std::vector<size_t> Firsts = {0};
+  for (size_t I = 0, E = OS->Sections.size(); I < E; ++I) {
+    uint64_t Off = OS->Sections[I]->OutSecOff;
+    if (Off - Bounds.back() >= BatchSize) {
+      Bounds.push_back(Off);
+      Firsts.push_back(I);
+    }
+  }
+  Bounds.push_back(OS->Size);
+  Firsts.push_back(OS->Sections.size());
+
+  // Error messages cannot point to output locations because each
+  // batch is written to a different buffer.
+  OS->Loc = nullptr;
+
+  // Synthetic sections are skipped here and written below because
+  // some of them run parallel loops in writeTo, which must not be
+  // nested in this one.
+  uint32_t Filler = Script<ELFT>::X->getFiller(OS->Name);
+  writeBatchesStreaming(OS, Bounds, [&](uint8_t *Buf, size_t I) {
+    uint64_t Begin = Bounds[I];
+    if (Filler)
+      fillAt(Buf, Bounds[I + 1] - Begin, Filler, Begin);
+    for (size_t J = Firsts[I]; J < Firsts[I + 1]; ++J) {
+      InputSection<ELFT> *IS = OS->Sections[J];
+      if (IS->kind() != InputSectionData::Synthetic)
+        IS->writeTo(Buf - Begin);
+    }
+    Script<ELFT>::X->writeDataBytes(OS->Name, Buf, Begin, Bounds[I + 1]);
+  });
+
+  std::vector<uint8_t> Buf;
+  for (InputSection<ELFT> *IS : OS->Sections) {
+    if (IS->kind() != InputSectionData::Synthetic || IS->getSize() == 0)
+      continue;
+    Buf.assign(IS->getSize(), 0);
+    if (Filler)
+      fillAt(Buf.data(), Buf.size(), Filler, IS->OutSecOff);
+    IS->writeTo(Buf.data() - IS->OutSecOff);
+    Stream->write(OS->Offset + IS->OutSecOff, Buf);
+  }
+}
+
+template <class ELFT> void Writer<ELFT>::writeBuildIdStreaming() {
+  BuildIdSection<ELFT> *BuildId = In<ELFT>::BuildId;
+  if (!BuildId || !BuildId->OutSec)
+    return;
+
+  // The build ID is a hash of the entire output, so we need to read
+  // the file back. The hash value is computed to a local buffer and
+  // then written to the file.
+  std::vector<uint8_t> Note(BuildId->getSize());
+  BuildId->writeTo(Note.data());
+
+  std::error_code EC;
+  sys::fs::mapped_file_region Map(Stream->getFD(),
+                                  sys::fs::mapped_file_region::readonly,
+                                  FileSize, 0, EC);
+  if (EC) {
+    error("failed to read " + Config->OutputFile + ": " + EC.message());
+    return;
+  }
+  BuildId->writeBuildId(
+      {reinterpret_cast<const uint8_t *>(Map.const_data()), FileSize});
+  Stream->write(BuildId->OutSec->Offset + BuildId->OutSecOff, Note);
 }
 
 template <class ELFT> void Writer<ELFT>::writeBuildId() {
@@ -1754,7 +2120,7 @@ template <class ELFT> void Writer<ELFT>::writeBuildId() {
     return;
 
   // Compute a hash of all sections of the output file.
-  uint8_t *Start = Buffer->getBufferStart();
+  uint8_t *Start = getBufferStart();
   uint8_t *End = Start + FileSize;
   In<ELFT>::BuildId->writeBuildId({Start, End});
 }
@@ -0,0 +1,9 @@
+.text
+.globl foo
+.type foo, @function
+foo:
+  movl $VAL, %eax
+  ret
+.ifdef BIG
+  .zero 4096
+.endif
@@ -0,0 +1,59 @@
+# REQUIRES: x86
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t.o
+# RUN: rm -rf %t.cache
+# RUN: ld.lld %t.o -o %t1
+# RUN: ld.lld --cache-dir=%t.cache -verbose %t.o -o %t2 | FileCheck -check-prefix=MISS %s
+# RUN: cmp %t1 %t2
+# RUN: ld.lld --cache-dir=%t.cache -verbose %t.o -o %t2 | FileCheck -check-prefix=HIT %s
+# RUN: cmp %t1 %t2
+
+# RUN: ld.lld --gc-sections %t.o -o %t1
+# RUN: ld.lld --gc-sections --cache-dir=%t.cache -verbose %t.o -o %t2 \
+# RUN:   | FileCheck -check-prefix=HIT %s
+# RUN: cmp %t1 %t2
+
+## A cache entry with an invalid piece offset is ignored and rewritten.
+# RUN: %python -c "import glob, struct; \
+# RUN:   f = open(glob.glob('%t.cache/lld-*')[0], 'r+b'); \
+# RUN:   n = struct.unpack('<I', f.read(20)[16:])[0]; \
+# RUN:   f.seek(24 + 16 * n); f.write(struct.pack('<Q', 0xffffffff))"
+# RUN: ld.lld --gc-sections --cache-dir=%t.cache -verbose %t.o -o %t2 \
+# RUN:   | FileCheck -check-prefix=MISS %s
+# RUN: cmp %t1 %t2
+# RUN: ld.lld --gc-sections --cache-dir=%t.cache -verbose %t.o -o %t2 \
+# RUN:   | FileCheck -check-prefix=HIT %s
+
+# MISS: --cache-dir: 0 of 1 files found in cache
+# HIT:  --cache-dir: 1 of 1 files found in cache
+
+.globl _start
+.type _start,@function
+_start:
+  .cfi_startproc
+  movl $s1, %eax
+  movl $s2, %eax
+  call foo
+  ret
+  .cfi_endproc
+
+.section .text.foo,"ax",@progbits
+.type foo,@function
+foo:
+  .cfi_startproc
+  movl $s3, %eax
+  ret
+  .cfi_endproc
+
+.section .rodata.str1.1,"aMS",@progbits,1
+s1:
+  .asciz "foo"
+s2:
+  .asciz "bar"
+s3:
+  .asciz "foo"
+
+.section .rodata.cst8,"aM",@progbits,8
+  .quad 1
+  .quad 2
+  .quad 1
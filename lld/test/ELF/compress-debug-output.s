@@ -0,0 +1,59 @@
+# REQUIRES: x86, zlib
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t.o
+
+# RUN: ld.lld %t.o -o %t1 --compress-debug-sections=zlib
+# RUN: llvm-readobj -sections %t1 | FileCheck -check-prefix=ZLIB %s
+# ZLIB:      Section {
+# ZLIB:        Name: .debug_str
+# ZLIB-NEXT:   Type: SHT_PROGBITS
+# ZLIB-NEXT:   Flags [
+# ZLIB-NEXT:     SHF_COMPRESSED (0x800)
+# ZLIB-NEXT:     SHF_MERGE (0x10)
+# ZLIB-NEXT:     SHF_STRINGS (0x20)
+# ZLIB-NEXT:   ]
+
+## Compressed contents are spread over multiple chunks. They are
+## compressed independently and must form a single valid stream.
+# RUN: llvm-dwarfdump -debug-dump=str %t1 | FileCheck -check-prefix=DUMP %s
+# RUN: ld.lld %t.o -o %t2 --compress-debug-sections=zlib -no-threads
+# RUN: llvm-dwarfdump -debug-dump=str %t2 | FileCheck -check-prefix=DUMP %s
+# RUN: ld.lld %t.o -o %t3 --compress-debug-sections=zlib -O2
+# RUN: llvm-dwarfdump -debug-dump=str %t3 | FileCheck -check-prefix=DUMP-O2 %s
+# DUMP:      .debug_str contents:
+# DUMP-NEXT: 0x00000000: "aaaaaaaaaa
+# DUMP-NEXT: 0x00200000: "foo"
+# DUMP-NEXT: 0x00200004: "bar"
+
+## Tail merging sorts the strings.
+# DUMP-O2:      .debug_str contents:
+# DUMP-O2-NEXT: 0x00000000: "bar"
+# DUMP-O2-NEXT: 0x00000004: "foo"
+# DUMP-O2-NEXT: 0x00000008: "aaaaaaaaaa
+
+# RUN: ld.lld %t.o -o %t4 --compress-debug-sections=none
+# RUN: llvm-readobj -sections %t4 | FileCheck -check-prefix=NONE %s
+# NONE:      Name: .debug_str
+# NONE-NEXT: Type: SHT_PROGBITS
+# NONE-NEXT: Flags [
+# NONE-NEXT:   SHF_MERGE (0x10)
+# NONE-NEXT:   SHF_STRINGS (0x20)
+# NONE-NEXT: ]
+
+# RUN: not ld.lld %t.o -o %t5 --compress-debug-sections=zlib-gabi 2>&1 | \
+# RUN:   FileCheck -check-prefix=ERR %s
+# ERR: unknown --compress-debug-sections value: zlib-gabi
+
+# RUN: not ld.lld %t.o -o %t5 -r --compress-debug-sections=zlib 2>&1 | \
+# RUN:   FileCheck -check-prefix=ERR-R %s
+# ERR-R: -r and --compress-debug-sections may not be used together
+
+.globl _start
+_start:
+  ret
+
+.section .debug_str,"MS",@progbits,1
+.fill 0x1fffff, 1, 0x61
+.byte 0
+.asciz "foo"
+.asciz "bar"
@@ -3,6 +3,8 @@
 # RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t
 # RUN: ld.lld %t -o %t2 --icf=all --eh-frame-hdr
 # RUN: llvm-objdump -s %t2 | FileCheck %s
+# RUN: ld.lld %t -o %t3 --icf=all --eh-frame-hdr -no-threads
+# RUN: cmp %t2 %t3
 
 # CHECK: Contents of section .eh_frame_hdr:
 # CHECK-NEXT: 200158 011b033b 1c000000 01000000 a80e0000
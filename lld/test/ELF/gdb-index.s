@@ -13,6 +13,9 @@
 # RUN: ld.lld --gdb-index -e main %p/Inputs/gdb-index-a.elf %p/Inputs/gdb-index-b.elf -o %t
 # RUN: llvm-dwarfdump -debug-dump=gdb_index %t | FileCheck %s
 # RUN: llvm-objdump -d %t | FileCheck %s --check-prefix=DISASM
+# RUN: ld.lld --gdb-index -no-threads -e main %p/Inputs/gdb-index-a.elf \
+# RUN:   %p/Inputs/gdb-index-b.elf -o %t2
+# RUN: cmp %t %t2
 
 # DISASM:       Disassembly of section .text:
 # DISASM:       main:
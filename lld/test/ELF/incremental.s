@@ -0,0 +1,62 @@
+# REQUIRES: x86
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t1.o
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux -defsym VAL=1 \
+# RUN:   %p/Inputs/incremental.s -o %t2.o
+# RUN: rm -f %t %t.lld-state %t.fresh %t.fresh.lld-state
+
+## The first link is always a full link.
+# RUN: ld.lld --incremental -verbose %t1.o %t2.o -o %t 2>&1 \
+# RUN:   | FileCheck --check-prefix=FULL %s
+# FULL-NOT: --incremental: patching
+# RUN: cp %t %t.orig
+
+## Nothing changed.
+# RUN: ld.lld --incremental -verbose %t1.o %t2.o -o %t 2>&1 \
+# RUN:   | FileCheck --check-prefix=SAME %s
+# SAME: --incremental: patching {{.*}}; 0 of {{[0-9]+}} input sections changed
+# RUN: cmp %t %t.orig
+
+## foo changed, but its size did not.
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux -defsym VAL=2 \
+# RUN:   %p/Inputs/incremental.s -o %t2.o
+# RUN: ld.lld --incremental -verbose %t1.o %t2.o -o %t 2>&1 \
+# RUN:   | FileCheck --check-prefix=PATCH %s
+# PATCH: --incremental: patching
+# RUN: llvm-objdump -d %t | FileCheck --check-prefix=DISASM %s
+# DISASM:      foo:
+# DISASM-NEXT:   movl $2, %eax
+
+## The patched output is the same as a new one.
+# RUN: ld.lld --incremental %t1.o %t2.o -o %t.fresh
+# RUN: cmp %t %t.fresh
+
+## foo no longer fits in the space reserved for .text.
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux -defsym VAL=2 \
+# RUN:   -defsym BIG=1 %p/Inputs/incremental.s -o %t2.o
+# RUN: ld.lld --incremental -verbose %t1.o %t2.o -o %t 2>&1 \
+# RUN:   | FileCheck --check-prefix=GROW %s
+# GROW: --incremental: full link:
+# RUN: ld.lld --incremental -verbose %t1.o %t2.o -o %t 2>&1 \
+# RUN:   | FileCheck --check-prefix=SAME %s
+
+## A state file with an invalid section index is ignored.
+# RUN: sed -e 's/^isec\t0\t2\t/isec\t0\tFFFFFFFF\t/' %t.lld-state > %t.bad
+# RUN: mv %t.bad %t.lld-state
+# RUN: ld.lld --incremental -verbose %t1.o %t2.o -o %t 2>&1 \
+# RUN:   | FileCheck --check-prefix=BAD %s
+# BAD: ignoring malformed state file
+
+# RUN: not ld.lld -r --incremental %t1.o -o %t.o 2>&1 \
+# RUN:   | FileCheck --check-prefix=ERR %s
+# ERR: -r and --incremental may not be used together
+
+.text
+.globl _start
+_start:
+  call foo
+  movq data(%rip), %rax
+
+.data
+data:
+  .quad foo
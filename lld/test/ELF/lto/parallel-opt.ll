@@ -0,0 +1,52 @@
+; REQUIRES: x86
+; RUN: llvm-as -o %t.bc %s
+; RUN: rm -f %t.lto.o %t1.lto.o
+; RUN: ld.lld -m elf_x86_64 --lto-partitions=2 --lto-parallel-opt -save-temps \
+; RUN:   -o %t %t.bc -shared
+; RUN: llvm-objdump -d %t.lto.o | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-objdump -d %t1.lto.o | FileCheck --check-prefix=CHECK1 %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The function passes run on each partition after the inliner ran on the whole
+; module.
+
+; CHECK0: foo:
+; CHECK0-NEXT: movl $10, %eax
+; CHECK0-NEXT: retq
+define i32 @foo() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
+
+define internal i32 @bar() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, 10
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
+
+; CHECK1: baz:
+; CHECK1-NEXT: movl $20, %eax
+; CHECK1-NEXT: retq
+define i32 @baz() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, 20
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
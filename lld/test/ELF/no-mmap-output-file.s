@@ -0,0 +1,56 @@
+# REQUIRES: x86
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t.o
+# RUN: ld.lld --build-id %t.o -o %t1
+# RUN: ld.lld --build-id --no-mmap-output-file %t.o -o %t2
+# RUN: cmp %t1 %t2
+# RUN: ld.lld --build-id --no-mmap-output-file -no-threads %t.o -o %t2
+# RUN: cmp %t1 %t2
+
+## Linker script fillers and data commands.
+# RUN: echo "SECTIONS { .text : { *(.text*) } =0x11223344 \
+# RUN:   .data : { *(.data.big) BYTE(0x55) *(.data.small) QUAD(0x66) } =0x778899aa \
+# RUN:   .rodata : { *(.rodata*) } }" > %t.script
+# RUN: ld.lld --build-id -T %t.script %t.o -o %t1
+# RUN: ld.lld --build-id -T %t.script --no-mmap-output-file %t.o -o %t2
+# RUN: cmp %t1 %t2
+
+# RUN: ld.lld -r %t.o -o %t1
+# RUN: ld.lld -r --no-mmap-output-file %t.o -o %t2
+# RUN: cmp %t1 %t2
+
+# RUN: ld.lld --no-mmap-output-file --mmap-output-file %t.o -o %t2
+# RUN: ld.lld --time-report %t.o -o %t2 2>&1 | FileCheck %s
+
+# CHECK: Link phases
+# CHECK-DAG: sections
+# CHECK-DAG: layout
+# CHECK-DAG: write
+# CHECK-DAG: build-id
+# CHECK-DAG: commit
+
+.globl _start
+_start:
+  call foo
+  movl $str, %eax
+
+.section .text.foo,"ax",@progbits
+.p2align 4
+foo:
+  ret
+
+.section .rodata.str,"aMS",@progbits,1
+str:
+  .asciz "foo"
+  .asciz "bar"
+  .fill 0x180000, 1, 0x41
+  .byte 0
+  .asciz "baz"
+
+.section .data.big,"aw",@progbits
+  .fill 0x180000, 1, 0xcc
+  .quad _start
+
+.section .data.small,"aw",@progbits
+.p2align 3
+  .quad foo
@@ -0,0 +1,39 @@
+# REQUIRES: x86
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t.o
+# RUN: ld.lld --print-stats %t.o -o %t | FileCheck %s
+# RUN: ld.lld --time-report %t.o -o %t 2>&1 | FileCheck -check-prefix=TEXT %s
+# RUN: ld.lld %t.o -o %t | count 0
+
+# CHECK:      {
+# CHECK-NEXT:   "output": "{{.*}}print-stats.s.tmp",
+# CHECK-NEXT:   "threads": {{[0-9]+}},
+# CHECK-NEXT:   "wall_time": {{[0-9.]+}},
+# CHECK-NEXT:   "peak_rss": {{[0-9]+}},
+# CHECK-NEXT:   "arena_bytes": {{[0-9]+}},
+# CHECK-NEXT:   "phases": [
+# CHECK-NEXT:     {"name": "read", "wall_time": {{[0-9.]+}}, "user_time": {{[0-9.]+}}, "system_time": {{[0-9.]+}}, "utilization": {{[0-9.]+}}, "arena_bytes": {{[0-9]+}}, "peak_rss": {{[0-9]+}}},
+# CHECK-NEXT:     {"name": "resolve",
+# CHECK-NEXT:     {"name": "lto",
+# CHECK-NEXT:     {"name": "gc",
+# CHECK-NEXT:     {"name": "icf",
+# CHECK-NEXT:     {"name": "split-sections",
+# CHECK-NEXT:     {"name": "create-sections",
+# CHECK-NEXT:     {"name": "scan-relocs",
+# CHECK-NEXT:     {"name": "finalize-sections",
+# CHECK-NEXT:     {"name": "layout",
+# CHECK-NEXT:     {"name": "open",
+# CHECK-NEXT:     {"name": "write",
+# CHECK-NEXT:     {"name": "build-id",
+# CHECK-NEXT:     {"name": "commit",
+# CHECK-NEXT:   ]
+# CHECK-NEXT: }
+
+# TEXT:      Link phases:
+# TEXT-NEXT: Wall (s) CPU (s) Threads Arena (MB) Peak RSS (MB) Name
+# TEXT-NEXT: {{[0-9.]+ +[0-9.]+ +[0-9.]+ +[0-9.]+ +[0-9.]+}} read
+# TEXT:      {{[0-9.]+ +[0-9.]+}} Total
+
+.globl _start
+_start:
+  nop
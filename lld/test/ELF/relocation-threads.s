@@ -0,0 +1,45 @@
+# REQUIRES: x86
+
+# Relocations are scanned concurrently unless -no-threads is given.
+# The output must not depend on it.
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux %s -o %t.o
+# RUN: llvm-mc -filetype=obj -triple=x86_64-unknown-linux \
+# RUN:   %p/Inputs/shared.s -o %t2.o
+# RUN: ld.lld -shared %t2.o -o %t2.so
+# RUN: ld.lld -pie -threads %t.o %t2.so -o %t1
+# RUN: ld.lld -pie -no-threads %t.o %t2.so -o %t2
+# RUN: cmp %t1 %t2
+# RUN: llvm-readobj -r %t1 | FileCheck %s
+
+# CHECK:     Section ({{.*}}) .rela.dyn {
+# CHECK-DAG:   R_X86_64_RELATIVE - 0x
+# CHECK-DAG:   R_X86_64_64 zed 0x0
+# CHECK-DAG:   R_X86_64_GLOB_DAT bar2 0x0
+# CHECK:     Section ({{.*}}) .rela.plt {
+# CHECK-NEXT:  R_X86_64_JUMP_SLOT bar 0x0
+
+.globl _start
+_start:
+  call bar@PLT
+  movq bar2@GOTPCREL(%rip), %rax
+  movq local@GOTPCREL(%rip), %rax
+  leaq local(%rip), %rax
+  data16
+  leaq tls@TLSGD(%rip), %rdi
+  data16
+  data16
+  rex64
+  call __tls_get_addr@PLT
+  call bar@PLT
+
+.data
+local:
+  .quad local
+  .quad zed
+  .quad local
+
+.section .tbss,"awT",@nobits
+.globl tls
+tls:
+  .zero 8
@@ -35,13 +35,46 @@ class raw_pwrite_stream;
 /// Writes bitcode for individual partitions into output streams in BCOSs, if
 /// BCOSs is not empty.
 ///
+/// If OptimizePartition is set, it is called on each partition (or on M if
+/// OSs.size() == 1) before generating code for it, on the same thread and with
+/// the same TargetMachine. It may for example run the function passes which
+/// do not need the whole module. The bitcode written to BCOSs is taken before
+/// it runs.
+///
+/// Each partition other than M lives in its own LLVMContext, whose
+/// diagnostics, including those of inline assembly, are forwarded to the
+/// handlers of M's context one at a time.
+///
+/// If PreparePartition is set, it is called with the index of each partition
+/// and the partition (or with 0 and M if OSs.size() == 1) before
+/// OptimizePartition, on the same thread. It may for example add what only one
+/// of the object files should define.
+///
 /// \returns M if OSs.size() == 1, otherwise returns std::unique_ptr<Module>().
 std::unique_ptr<Module>
 splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_pwrite_stream *> OSs,
              ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
              const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
              TargetMachine::CodeGenFileType FT = TargetMachine::CGFT_ObjectFile,
-             bool PreserveLocals = false);
+             bool PreserveLocals = false,
+             const std::function<void(Module &, TargetMachine &)>
+                 &OptimizePartition = nullptr,
+             const std::function<void(unsigned, Module &)> &PreparePartition =
+                 nullptr);
+
+/// Like splitCodeGen above, but leaves M with the caller. M is only modified
+/// if it has to be externalized to be split, that is if PreserveLocals is not
+/// set and OSs.size() > 1.
+void
+splitCodeGen(Module &M, ArrayRef<raw_pwrite_stream *> OSs,
+             ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
+             const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
+             TargetMachine::CodeGenFileType FT = TargetMachine::CGFT_ObjectFile,
+             bool PreserveLocals = false,
+             const std::function<void(Module &, TargetMachine &)>
+                 &OptimizePartition = nullptr,
+             const std::function<void(unsigned, Module &)> &PreparePartition =
+                 nullptr);
 
 } // namespace llvm
 
@@ -11,6 +11,7 @@
 #define LLVM_DEBUGINFO_CODEVIEW_TYPESTREAMMERGER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/DebugInfo/CodeView/TypeTableBuilder.h"
 
@@ -20,6 +21,22 @@ namespace codeview {
 /// Merges one type stream into another. Returns true on success.
 bool mergeTypeStreams(TypeTableBuilder &DestStream, const CVTypeArray &Types);
 
+/// Computes a hash for each record in a type stream that covers the record and
+/// every record it refers to, so that records of different streams that merge
+/// into the same destination record get the same hash. A hash of zero means
+/// that the record could not be hashed. Streams can be hashed concurrently.
+/// Returns true on success.
+bool hashTypeStream(const CVTypeArray &Types,
+                    SmallVectorImpl<uint64_t> &Hashes);
+
+/// Merges one type stream into another like the function above. \p Hashes are
+/// the record hashes computed by hashTypeStream. A record whose hash is in
+/// \p HashedIndices is not copied but mapped to the index found there, and
+/// the hashes of copied records are added to it. Returns true on success.
+bool mergeTypeStreams(TypeTableBuilder &DestStream, const CVTypeArray &Types,
+                      ArrayRef<uint64_t> Hashes,
+                      DenseMap<uint64_t, TypeIndex> &HashedIndices);
+
 } // end namespace codeview
 } // end namespace llvm
 
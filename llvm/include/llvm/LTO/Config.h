@@ -47,6 +47,12 @@ struct Config {
   /// Disable entirely the optimizer, including importing for ThinLTO
   bool CodeGenOnly = false;
 
+  /// With parallel code generation, run only the interprocedural passes on
+  /// the whole regular LTO module, and the function passes on each partition
+  /// in parallel with its code generation. Only applies to the default
+  /// pipeline of the legacy pass manager.
+  bool ParallelOpt = false;
+
   /// If this field is set, the set of passes run in the middle-end optimizer
   /// will be the one specified by the string. Only works with the new pass
   /// manager as the old one doesn't have this ability.
@@ -117,7 +123,8 @@ struct Config {
   /// This hook is called after importing from other modules (ThinLTO-specific).
   ModuleHookFn PostImportModuleHook;
 
-  /// This module hook is called after optimization is complete.
+  /// This module hook is called after optimization is complete. With
+  /// ParallelOpt, it is called for each partition.
   ModuleHookFn PostOptModuleHook;
 
   /// This module hook is called before code generation. It is similar to the
@@ -55,6 +55,8 @@ void thinLTOResolveWeakForLinkerInIndex(
 /// Update the linkages in the given \p Index to mark exported values
 /// as external and non-exported values as internal. The ThinLTO backends
 /// must apply the changes to the Module via thinLTOInternalizeModule.
+/// The index is processed in parallel, so \p isExported may be called
+/// concurrently.
 void thinLTOInternalizeAndPromoteInIndex(
     ModuleSummaryIndex &Index,
     function_ref<bool(StringRef, GlobalValue::GUID)> isExported);
@@ -293,6 +295,13 @@ ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           bool ShouldEmitImportsFiles,
                                           std::string LinkedObjectsFile);
 
+/// This ThinBackend writes a module summary index table to \p TablePath
+/// instead of running the individual backend jobs. Like the individual
+/// indexes of createWriteIndexesThinBackend, the table holds the summaries
+/// needed by the backend of each module, but the backends map the table and
+/// only decode their own summaries (see ModuleSummaryIndexTable).
+ThinBackend createWriteIndexTableThinBackend(std::string TablePath);
+
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
 /// ThinLTO. You can use it from a linker in the following way:
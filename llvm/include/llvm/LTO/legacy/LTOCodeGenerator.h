@@ -44,6 +44,7 @@
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -112,6 +113,15 @@ struct LTOCodeGenerator {
 
   void addMustPreserveSymbol(StringRef Sym) { MustPreserveSymbols[Sym] = 1; }
 
+  /// Optimize the partitions of the module in parallel.
+  ///
+  /// When set, optimize() only runs the interprocedural passes on the merged
+  /// module, and compileOptimized() runs the function passes on each partition
+  /// before generating its code, in parallel if there is more than one
+  /// partition. It is ignored, with a warning, when optimization remarks are
+  /// written to a file.
+  void setParallelOptimization(bool Value) { ParallelOptimization = Value; }
+
   /// Pass options to the driver and optimization passes.
   ///
   /// These options are not necessarily for debugging purpose (the function
@@ -235,6 +245,9 @@ private:
   bool ShouldInternalize = true;
   bool ShouldEmbedUselists = false;
   bool ShouldRestoreGlobalsLinkage = false;
+  bool ParallelOptimization = false;
+  /// The passes left by optimize() to run on each partition.
+  std::function<void(Module &, TargetMachine &)> OptimizePartition;
   TargetMachine::CodeGenFileType FileType = TargetMachine::CGFT_ObjectFile;
   std::unique_ptr<tool_output_file> DiagnosticOutputFile;
 };
@@ -91,6 +91,11 @@ public:
 /// summary index object if found, or nullptr if not.
 Expected<std::unique_ptr<ModuleSummaryIndex>>
 getModuleSummaryIndexForFile(StringRef Path);
+
+/// Like getModuleSummaryIndexForFile, for an IR file already read into
+/// \p Buffer.
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+getModuleSummaryIndexForBuffer(MemoryBufferRef Buffer);
 }
 
 #endif
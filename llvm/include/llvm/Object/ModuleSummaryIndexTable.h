@@ -0,0 +1,207 @@
+//===- ModuleSummaryIndexTable.h - Mappable summary index -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a file format for combined module summary indexes which
+// is read in place from a mapped file, and its reader and writer.
+//
+// A table holds fixed-size records for the summaries, sorted by module, with
+// a hash table from GUIDs to their summaries and, for each module, the list of
+// summaries its ThinLTO backend needs. A backend maps the table and decodes
+// only the summaries it needs instead of parsing the whole combined index.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_MODULESUMMARYINDEXTABLE_H
+#define LLVM_OBJECT_MODULESUMMARYINDEXTABLE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/ModuleSummaryIndex.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+
+namespace object {
+
+/// On-disk structures of a module summary index table. All integers are
+/// little-endian; all offsets are from the start of the file.
+namespace summary_table {
+using support::ulittle32_t;
+using support::ulittle64_t;
+
+const char Magic[4] = {'L', 'S', 'I', 'T'};
+const uint32_t Version = 1;
+
+/// Marks a summary without an aliasee.
+const uint32_t NoSummary = ~0u;
+
+struct Header {
+  char Magic[4];
+  ulittle32_t Version;
+  ulittle32_t NumModules;
+  ulittle32_t NumSummaries;
+  /// A power of two.
+  ulittle32_t NumBuckets;
+  ulittle32_t NumGUIDs;
+  ulittle32_t NumCalls;
+  ulittle32_t NumSummaryIndices;
+  ulittle32_t StringTableSize;
+  ulittle32_t Reserved;
+  ulittle64_t ModulesOffset;
+  ulittle64_t BucketsOffset;
+  ulittle64_t SummariesOffset;
+  ulittle64_t GUIDsOffset;
+  ulittle64_t CallsOffset;
+  ulittle64_t SummaryIndicesOffset;
+  ulittle64_t StringTableOffset;
+};
+
+struct Module {
+  /// The path in the string table.
+  ulittle32_t PathOffset;
+  ulittle32_t PathSize;
+  ulittle64_t ModuleId;
+  ulittle32_t Hash[5];
+  /// The range of the summaries defined by the module.
+  ulittle32_t SummariesBegin;
+  ulittle32_t NumSummaries;
+  /// The range in the summary indices of the summaries needed by the ThinLTO
+  /// backend of the module.
+  ulittle32_t BackendSummariesBegin;
+  ulittle32_t NumBackendSummaries;
+  ulittle32_t Reserved;
+};
+
+/// A slot of the hash table from GUIDs to the range of their summaries in the
+/// summary indices, which is empty if NumSummaries is zero. The slot of a GUID
+/// is found by linear probing from its low bits.
+struct Bucket {
+  ulittle64_t GUID;
+  ulittle32_t SummaryIndicesBegin;
+  ulittle32_t NumSummaries;
+};
+
+struct Summary {
+  ulittle64_t GUID;
+  ulittle64_t OriginalName;
+  ulittle32_t Module;
+  /// A GlobalValueSummary::SummaryKind.
+  uint8_t Kind;
+  uint8_t Linkage;
+  /// Bit 0: NotEligibleToImport, bit 1: LiveRoot.
+  uint8_t Flags;
+  uint8_t Reserved;
+  ulittle32_t InstCount;
+  /// The index of the aliasee summary, or NoSummary.
+  ulittle32_t Aliasee;
+  /// The ranges in the GUIDs of the references and type tests, and in the
+  /// calls of the call edges.
+  ulittle32_t RefsBegin;
+  ulittle32_t NumRefs;
+  ulittle32_t TypeTestsBegin;
+  ulittle32_t NumTypeTests;
+  ulittle32_t CallsBegin;
+  ulittle32_t NumCalls;
+};
+
+struct Call {
+  ulittle64_t Callee;
+  /// A CalleeInfo::HotnessType.
+  uint8_t Hotness;
+  uint8_t Reserved[7];
+};
+} // end namespace summary_table
+
+/// Builds a module summary index table from a combined index.
+class ModuleSummaryIndexTableBuilder {
+  const ModuleSummaryIndex &Index;
+  std::vector<StringRef> ModulePaths;
+  StringMap<uint32_t> ModuleIndices;
+  /// The summaries and their GUIDs, in the order of the table.
+  std::vector<std::pair<GlobalValue::GUID, GlobalValueSummary *>> Summaries;
+  DenseMap<const GlobalValueSummary *, uint32_t> SummaryIndices;
+  std::vector<std::vector<uint32_t>> BackendSummaries;
+
+public:
+  explicit ModuleSummaryIndexTableBuilder(const ModuleSummaryIndex &Index);
+
+  /// Record the summaries needed by the ThinLTO backend of \p ModulePath, as
+  /// computed by gatherImportedSummariesForModule.
+  void addBackendSummaries(
+      StringRef ModulePath,
+      const std::map<std::string, GVSummaryMapTy> &ModuleToSummariesForIndex);
+
+  void write(raw_ostream &OS);
+};
+
+/// A module summary index table, read in place.
+class ModuleSummaryIndexTable {
+  MemoryBufferRef Buffer;
+  ArrayRef<summary_table::Module> Modules;
+  ArrayRef<summary_table::Bucket> Buckets;
+  ArrayRef<summary_table::Summary> Summaries;
+  ArrayRef<summary_table::ulittle64_t> GUIDs;
+  ArrayRef<summary_table::Call> Calls;
+  ArrayRef<summary_table::ulittle32_t> SummaryIndices;
+  StringRef StringTable;
+
+  explicit ModuleSummaryIndexTable(MemoryBufferRef Buffer) : Buffer(Buffer) {}
+  Error initialize();
+
+public:
+  /// Return true if \p Buffer starts with the magic of a table.
+  static bool isModuleSummaryIndexTable(MemoryBufferRef Buffer);
+
+  /// Check the header of the table in \p Buffer, which must outlive the
+  /// table. The records are only checked when they are decoded.
+  static Expected<std::unique_ptr<ModuleSummaryIndexTable>>
+  create(MemoryBufferRef Buffer);
+
+  unsigned getNumModules() const { return Modules.size(); }
+  unsigned getNumSummaries() const { return Summaries.size(); }
+
+  Expected<StringRef> getModulePath(unsigned Module) const;
+
+  /// Return the index of the module with path \p ModulePath, or an error.
+  Expected<unsigned> findModule(StringRef ModulePath) const;
+
+  /// Return the indices of the summaries of \p GUID, in the order of the
+  /// combined index.
+  Expected<ArrayRef<summary_table::ulittle32_t>>
+  findSummaries(GlobalValue::GUID GUID) const;
+
+  /// Decode the summaries with the given indices, and their modules, into a
+  /// new index. Aliasees must be among the decoded summaries.
+  Expected<std::unique_ptr<ModuleSummaryIndex>>
+  loadSummaries(ArrayRef<summary_table::ulittle32_t> Indices) const;
+
+  /// Decode the summaries needed by the ThinLTO backend of \p ModulePath. The
+  /// result is the same as the individual index written for the module by
+  /// the distributed ThinLTO backend.
+  Expected<std::unique_ptr<ModuleSummaryIndex>>
+  loadIndexForModule(StringRef ModulePath) const;
+};
+} // end namespace object
+
+/// Load the summary index needed by the ThinLTO backend of \p ModulePath from
+/// the file at \p Path, which is either a module summary index table or a
+/// bitcode file read with getModuleSummaryIndexForBuffer.
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+getModuleSummaryIndexForModule(StringRef Path, StringRef ModulePath);
+} // end namespace llvm
+
+#endif // LLVM_OBJECT_MODULESUMMARYINDEXTABLE_H
@@ -44,6 +44,23 @@ Error uncompress(StringRef InputBuffer,
 
 uint32_t crc32(StringRef Buffer);
 
+/// Compress \p InputBuffer as a raw deflate stream without a zlib header or
+/// trailer and append it to \p CompressedBuffer. If \p IsLast is false, the
+/// output ends with a sync flush instead of the final block, so the outputs
+/// for consecutive parts of a buffer can be concatenated into one stream.
+Error compressChunk(StringRef InputBuffer,
+                    SmallVectorImpl<char> &CompressedBuffer,
+                    CompressionLevel Level, bool IsLast);
+
+/// Return the two-byte zlib stream header for \p Level.
+uint16_t getHeader(CompressionLevel Level);
+
+uint32_t adler32(StringRef Buffer);
+
+/// Combine the Adler-32 checksum \p Adler1 of a buffer with the checksum
+/// \p Adler2 of the \p Len2 bytes following it.
+uint32_t adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Len2);
+
 }  // End of namespace zlib
 
 } // End of namespace llvm
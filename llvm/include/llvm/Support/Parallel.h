@@ -0,0 +1,247 @@
+//===- llvm/Support/Parallel.h - Parallel algorithms ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines parallel versions of common algorithms, which run on the
+// default WorkStealingPool. Its concurrency, set with
+// WorkStealingPool::setDefaultConcurrency, caps the number of threads used by
+// all of them; with a concurrency of one they run on the calling thread.
+//
+// The work is split in chunks which depend on the size of the input only, so
+// the results do not depend on the number of threads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLEL_H
+#define LLVM_SUPPORT_PARALLEL_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/WorkStealingPool.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace llvm {
+
+namespace detail {
+/// The maximum number of chunks a parallel loop is split in.
+const size_t MaxParallelChunks = 1024;
+
+/// Inputs smaller than this are sorted serially.
+const ptrdiff_t MinParallelSortSize = 1024;
+
+inline bool isParallelismEnabled() {
+  return WorkStealingPool::getDefaultConcurrency() > 1;
+}
+
+inline size_t getNumParallelChunks(size_t N) {
+  return std::min(N, MaxParallelChunks);
+}
+
+/// Call \p Fn(Chunk, Begin, End) for each of the getNumParallelChunks(N)
+/// chunks partitioning [0, N).
+template <class FuncTy> void forEachParallelChunk(size_t N, FuncTy Fn) {
+  size_t NumChunks = getNumParallelChunks(N);
+  auto RunChunk = [=, &Fn](size_t Chunk) {
+    Fn(Chunk, N * Chunk / NumChunks, N * (Chunk + 1) / NumChunks);
+  };
+
+  if (NumChunks <= 1 || !isParallelismEnabled()) {
+    for (size_t Chunk = 0; Chunk != NumChunks; ++Chunk)
+      RunChunk(Chunk);
+    return;
+  }
+
+  TaskGroup Tasks;
+  for (size_t Chunk = 1; Chunk != NumChunks; ++Chunk)
+    Tasks.spawn([=, &RunChunk] { RunChunk(Chunk); });
+  RunChunk(0);
+  Tasks.wait();
+}
+
+template <class RandomAccessIterator, class Comp>
+void parallelMergeSort(RandomAccessIterator Start, RandomAccessIterator End,
+                       const Comp &Compare, unsigned Depth) {
+  // Do a sequential sort for small inputs.
+  if (std::distance(Start, End) < MinParallelSortSize || Depth == 0) {
+    std::stable_sort(Start, End, Compare);
+    return;
+  }
+
+  RandomAccessIterator Mid = Start + std::distance(Start, End) / 2;
+  {
+    TaskGroup Tasks;
+    Tasks.spawn(
+        [=, &Compare] { parallelMergeSort(Start, Mid, Compare, Depth - 1); });
+    parallelMergeSort(Mid, End, Compare, Depth - 1);
+  }
+  std::inplace_merge(Start, Mid, End, Compare);
+}
+} // end namespace detail
+
+/// Call \p Fn on each index of [Begin, End) in parallel.
+template <class IndexTy, class FuncTy>
+void parallelFor(IndexTy Begin, IndexTy End, FuncTy Fn) {
+  if (End <= Begin)
+    return;
+  detail::forEachParallelChunk(End - Begin, [&](size_t, size_t B, size_t E) {
+    for (IndexTy I = Begin + B, ChunkEnd = Begin + E; I != ChunkEnd; ++I)
+      Fn(I);
+  });
+}
+
+/// Call \p Fn on each element of [Begin, End) in parallel.
+template <class RandomAccessIterator, class FuncTy>
+void parallelForEach(RandomAccessIterator Begin, RandomAccessIterator End,
+                     FuncTy Fn) {
+  detail::forEachParallelChunk(std::distance(Begin, End),
+                               [&](size_t, size_t B, size_t E) {
+                                 std::for_each(Begin + B, Begin + E, Fn);
+                               });
+}
+
+/// Sort [Start, End) in parallel, preserving the order of equivalent elements
+/// like std::stable_sort.
+template <class RandomAccessIterator, class Comp>
+void parallelSort(RandomAccessIterator Start, RandomAccessIterator End,
+                  const Comp &Compare) {
+  if (!detail::isParallelismEnabled()) {
+    std::stable_sort(Start, End, Compare);
+    return;
+  }
+  // Stop splitting once there are a few chunks per thread.
+  unsigned Depth = Log2_32_Ceil(WorkStealingPool::getDefaultConcurrency()) + 2;
+  detail::parallelMergeSort(Start, End, Compare, Depth);
+}
+
+template <class RandomAccessIterator>
+void parallelSort(RandomAccessIterator Start, RandomAccessIterator End) {
+  parallelSort(
+      Start, End,
+      std::less<
+          typename std::iterator_traits<RandomAccessIterator>::value_type>());
+}
+
+/// Return the reduction with \p Reduce of \p Transform applied to each element
+/// of [Begin, End), computed in parallel. \p Init must be an identity of
+/// \p Reduce, which must be associative. The elements are combined in a fixed
+/// order which does not depend on the number of threads, so the result is
+/// deterministic even if \p Reduce is not commutative, or is only
+/// approximately associative like a floating-point addition.
+template <class RandomAccessIterator, class ResultTy, class ReduceFuncTy,
+          class TransformFuncTy>
+ResultTy parallelTransformReduce(RandomAccessIterator Begin,
+                                 RandomAccessIterator End, ResultTy Init,
+                                 ReduceFuncTy Reduce,
+                                 TransformFuncTy Transform) {
+  size_t N = std::distance(Begin, End);
+  std::vector<ResultTy> Results(detail::getNumParallelChunks(N), Init);
+  detail::forEachParallelChunk(N, [&](size_t Chunk, size_t B, size_t E) {
+    ResultTy R = Init;
+    for (size_t I = B; I != E; ++I)
+      R = Reduce(std::move(R), Transform(Begin[I]));
+    Results[Chunk] = std::move(R);
+  });
+
+  for (ResultTy &R : Results)
+    Init = Reduce(std::move(Init), std::move(R));
+  return Init;
+}
+
+/// A DenseMap split in shards by key hash, which can be built in parallel.
+///
+/// Each shard is filled by a single task, in the order of the input, so the
+/// contents of the map and the iteration order of each shard do not depend on
+/// the number of threads.
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class ShardedDenseMap {
+public:
+  typedef DenseMap<KeyT, ValueT, KeyInfoT> MapTy;
+
+  explicit ShardedDenseMap(unsigned NumShards = 64) : Shards(NumShards) {
+    assert(NumShards && "A map needs at least one shard");
+  }
+
+  /// Insert (KeyFn(X), ValueFn(X)) for each element X of [Begin, End) in
+  /// parallel. When several elements have the same key, the first one is
+  /// inserted, as with sequential calls to DenseMap::insert. \p KeyFn is
+  /// called once per element.
+  template <class RandomAccessIterator, class KeyFuncTy, class ValueFuncTy>
+  void insertParallel(RandomAccessIterator Begin, RandomAccessIterator End,
+                      KeyFuncTy KeyFn, ValueFuncTy ValueFn) {
+    size_t N = std::distance(Begin, End);
+    std::vector<KeyT> Keys(N);
+    std::vector<unsigned> ShardIndices(N);
+    parallelFor(size_t(0), N, [&](size_t I) {
+      Keys[I] = KeyFn(Begin[I]);
+      ShardIndices[I] = getShardIndex(Keys[I]);
+    });
+
+    // Bucket the elements by shard, keeping them in input order, so that each
+    // task only visits the elements of its shard.
+    std::vector<size_t> Offsets(Shards.size() + 1);
+    for (unsigned Shard : ShardIndices)
+      ++Offsets[Shard + 1];
+    for (size_t Shard = 0; Shard != Shards.size(); ++Shard)
+      Offsets[Shard + 1] += Offsets[Shard];
+    std::vector<size_t> Order(N);
+    {
+      std::vector<size_t> Next(Offsets.begin(), Offsets.end() - 1);
+      for (size_t I = 0; I != N; ++I)
+        Order[Next[ShardIndices[I]]++] = I;
+    }
+
+    parallelFor(size_t(0), Shards.size(), [&](size_t Shard) {
+      MapTy &Map = Shards[Shard];
+      Map.reserve(Map.size() + Offsets[Shard + 1] - Offsets[Shard]);
+      for (size_t J = Offsets[Shard], E = Offsets[Shard + 1]; J != E; ++J) {
+        size_t I = Order[J];
+        Map.insert(std::make_pair(std::move(Keys[I]), ValueFn(Begin[I])));
+      }
+    });
+  }
+
+  MapTy &getShard(const KeyT &Key) { return Shards[getShardIndex(Key)]; }
+  const MapTy &getShard(const KeyT &Key) const {
+    return Shards[getShardIndex(Key)];
+  }
+
+  ArrayRef<MapTy> shards() const { return Shards; }
+
+  size_t size() const {
+    size_t Size = 0;
+    for (const MapTy &Map : Shards)
+      Size += Map.size();
+    return Size;
+  }
+
+  size_t count(const KeyT &Key) const { return getShard(Key).count(Key); }
+
+  /// Return the value for \p Key, or a default-constructed value if the key
+  /// is not in the map.
+  ValueT lookup(const KeyT &Key) const { return getShard(Key).lookup(Key); }
+
+private:
+  unsigned getShardIndex(const KeyT &Key) const {
+    // DenseMap uses the low bits of the hash, which are the same for all the
+    // keys of a shard if it is selected by them, so scramble the hash first.
+    uint32_t Hash = KeyInfoT::getHashValue(Key) * 2654435769u;
+    return (uint64_t(Hash) * Shards.size()) >> 32;
+  }
+
+  std::vector<MapTy> Shards;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_PARALLEL_H
@@ -0,0 +1,158 @@
+//===-- llvm/Support/WorkStealingPool.h - Work-stealing pool ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a work-stealing thread pool, and TaskGroup to wait for a
+// set of tasks submitted to it.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_WORKSTEALINGPOOL_H
+#define LLVM_SUPPORT_WORKSTEALINGPOOL_H
+
+#include "llvm/Support/thread.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+class TaskGroup;
+
+/// A thread pool for fine-grained and nested parallelism.
+///
+/// Each worker thread has its own deque of tasks. Tasks submitted from a worker
+/// go to the back of its deque and it runs them most recent first; idle
+/// workers steal the oldest tasks of other workers. Tasks submitted from other
+/// threads are shared by all workers. Unlike ThreadPool, submitting a task does
+/// not allocate a future: use a TaskGroup to wait for tasks instead.
+///
+/// A pool with no threads runs its tasks only when a thread waits for them.
+class WorkStealingPool {
+public:
+  using TaskTy = std::function<void()>;
+
+  /// Construct a pool with one thread per hardware thread.
+  WorkStealingPool();
+
+  /// Construct a pool of \p ThreadCount threads.
+  explicit WorkStealingPool(unsigned ThreadCount);
+
+  /// Blocking destructor: runs the tasks still queued and joins the threads.
+  /// The tasks it runs may submit more tasks, which are run as well, but no
+  /// other thread may submit tasks once it started.
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  /// Asynchronous submission of a task to the pool.
+  void async(TaskTy Task) { asyncImpl(std::move(Task), nullptr); }
+
+  /// Run one queued task on the calling thread, preferring those submitted
+  /// from it. Returns false if no task was queued.
+  bool runQueuedTask();
+
+  /// Return the number of threads in the pool.
+  unsigned getThreadCount() const { return Threads.size(); }
+
+  /// Return the pool shared by the whole process. Threads waiting for its
+  /// task groups run tasks too, so it has one thread less than the default
+  /// concurrency.
+  static WorkStealingPool &getDefault();
+
+  /// Set the maximum number of threads running tasks of the default pool,
+  /// including the threads waiting for them. Zero means one per hardware
+  /// thread. Must be called before the default pool is first used.
+  static void setDefaultConcurrency(unsigned N);
+
+  /// Return the maximum number of threads running tasks of the default pool.
+  static unsigned getDefaultConcurrency();
+
+private:
+  friend class TaskGroup;
+
+  struct Task {
+    TaskTy Run;
+    TaskGroup *Group;
+  };
+
+  /// The tasks submitted from one thread.
+  struct TaskQueue {
+    std::mutex Lock;
+    std::deque<Task> Tasks;
+  };
+
+  void asyncImpl(TaskTy Run, TaskGroup *Group);
+  TaskQueue &getQueueForCurrentThread();
+  bool popTask(Task &T);
+  void runTask(Task &T);
+  void runWorker(unsigned Index);
+
+  /// Threads in flight.
+  std::vector<llvm::thread> Threads;
+
+  /// The tasks submitted by each thread of the pool.
+  std::vector<std::unique_ptr<TaskQueue>> WorkerQueues;
+
+  /// The tasks submitted by threads outside of the pool.
+  TaskQueue ExternalQueue;
+
+  /// The number of tasks in all queues.
+  std::atomic<unsigned> QueuedTasks;
+
+  /// Locking and signaling for threads which ran out of tasks.
+  std::mutex SleepLock;
+  std::condition_variable SleepCondition;
+  std::atomic<unsigned> SleepingThreads;
+
+  /// Signal for the destruction of the pool, asking threads to exit once the
+  /// queues are empty.
+  std::atomic<bool> Stopping;
+};
+
+/// A set of tasks run by a WorkStealingPool which can be waited for together.
+///
+/// A thread which waits for a group runs queued tasks until all tasks of the
+/// group are done, so tasks of a group can themselves wait for nested groups
+/// without tying up the pool.
+class TaskGroup {
+  friend class WorkStealingPool;
+
+  WorkStealingPool &Pool;
+  unsigned PendingTasks;
+  std::mutex Lock;
+  std::condition_variable Done;
+
+  void finish();
+
+public:
+  explicit TaskGroup(WorkStealingPool &Pool = WorkStealingPool::getDefault())
+      : Pool(Pool), PendingTasks(0) {}
+
+  /// Blocking destructor: waits for the tasks of the group.
+  ~TaskGroup() { wait(); }
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  /// Submit a task of this group to the pool.
+  void spawn(WorkStealingPool::TaskTy Task);
+
+  /// Wait for all tasks spawned in this group so far, running queued tasks of
+  /// the pool in the meantime.
+  void wait();
+};
+}
+
+#endif // LLVM_SUPPORT_WORKSTEALINGPOOL_H
@@ -181,6 +181,8 @@ private:
                          legacy::PassManagerBase &PM) const;
   void addInitialAliasAnalysisPasses(legacy::PassManagerBase &PM) const;
   void addLTOOptimizationPasses(legacy::PassManagerBase &PM);
+  void addLTOIPOPasses(legacy::PassManagerBase &PM);
+  void addLTOFunctionPasses(legacy::PassManagerBase &PM);
   void addLateLTOOptimizationPasses(legacy::PassManagerBase &PM);
   void addPGOInstrPasses(legacy::PassManagerBase &MPM);
   void addFunctionSimplificationPasses(legacy::PassManagerBase &MPM);
@@ -196,6 +198,14 @@ public:
   void populateModulePassManager(legacy::PassManagerBase &MPM);
   void populateLTOPassManager(legacy::PassManagerBase &PM);
   void populateThinLTOPassManager(legacy::PassManagerBase &PM);
+
+  /// populateLTOIPOPassManager and populateLTOPartitionPassManager split the
+  /// pipeline of populateLTOPassManager in two. The first part runs the
+  /// interprocedural passes, including the inliner, and needs the whole
+  /// program. The second part runs the function passes and may run
+  /// independently on each partition of the module produced by SplitModule.
+  void populateLTOIPOPassManager(legacy::PassManagerBase &PM);
+  void populateLTOPartitionPassManager(legacy::PassManagerBase &PM);
 };
 
 /// Registers a function for adding a standard set of passes.  This should be
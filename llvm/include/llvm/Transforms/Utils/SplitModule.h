@@ -39,6 +39,14 @@ void SplitModule(
     function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
     bool PreserveLocals = false);
 
+/// Splits the module M into N linkable partitions without taking ownership of
+/// it. Unless PreserveLocals is set, the local symbols of M are externalized
+/// in place.
+void SplitModule(
+    Module &M, unsigned N,
+    function_ref<void(std::unique_ptr<Module> MPart)> ModuleCallback,
+    bool PreserveLocals = false);
+
 } // End llvm namespace
 
 #endif
@@ -14,22 +14,68 @@
 #include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
+#include <mutex>
 
 using namespace llvm;
 
-static void codegen(Module *M, llvm::raw_pwrite_stream &OS,
-                    function_ref<std::unique_ptr<TargetMachine>()> TMFactory,
-                    TargetMachine::CodeGenFileType FileType) {
+namespace {
+
+/// Forwards the diagnostics of the partitions, which live in their own
+/// contexts, to the context of the module being split. Handlers of that
+/// context are called one at a time.
+class PartitionDiagnostics {
+  LLVMContext &Ctx;
+  std::mutex Mutex;
+
+public:
+  PartitionDiagnostics(LLVMContext &Ctx) : Ctx(Ctx) {}
+
+  void install(LLVMContext &PartCtx) {
+    PartCtx.setDiagnosticHandler(handleDiagnostic, this);
+    if (Ctx.getInlineAsmDiagnosticHandler())
+      PartCtx.setInlineAsmDiagnosticHandler(handleInlineAsmDiagnostic, this);
+    PartCtx.setDiagnosticHotnessRequested(Ctx.getDiagnosticHotnessRequested());
+  }
+
+  static void handleDiagnostic(const DiagnosticInfo &DI, void *Context) {
+    auto *Self = static_cast<PartitionDiagnostics *>(Context);
+    std::lock_guard<std::mutex> Lock(Self->Mutex);
+    Self->Ctx.diagnose(DI);
+  }
+
+  static void handleInlineAsmDiagnostic(const SMDiagnostic &D, void *Context,
+                                        unsigned LocCookie) {
+    auto *Self = static_cast<PartitionDiagnostics *>(Context);
+    std::lock_guard<std::mutex> Lock(Self->Mutex);
+    Self->Ctx.getInlineAsmDiagnosticHandler()(
+        D, Self->Ctx.getInlineAsmDiagnosticContext(), LocCookie);
+  }
+};
+
+} // end anonymous namespace
+
+static void codegen(
+    Module *M, unsigned Index, llvm::raw_pwrite_stream &OS,
+    function_ref<std::unique_ptr<TargetMachine>()> TMFactory,
+    TargetMachine::CodeGenFileType FileType,
+    const std::function<void(Module &, TargetMachine &)> &OptimizePartition,
+    const std::function<void(unsigned, Module &)> &PreparePartition) {
+  if (PreparePartition)
+    PreparePartition(Index, *M);
   std::unique_ptr<TargetMachine> TM = TMFactory();
+  if (OptimizePartition)
+    OptimizePartition(*M, *TM);
   legacy::PassManager CodeGenPasses;
   if (TM->addPassesToEmitFile(CodeGenPasses, OS, FileType))
     report_fatal_error("Failed to setup codegen");
@@ -40,24 +86,43 @@ std::unique_ptr<Module> llvm::splitCodeGen(
     std::unique_ptr<Module> M, ArrayRef<llvm::raw_pwrite_stream *> OSs,
     ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
     const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
-    TargetMachine::CodeGenFileType FileType, bool PreserveLocals) {
+    TargetMachine::CodeGenFileType FileType, bool PreserveLocals,
+    const std::function<void(Module &, TargetMachine &)> &OptimizePartition,
+    const std::function<void(unsigned, Module &)> &PreparePartition) {
+  splitCodeGen(*M, OSs, BCOSs, TMFactory, FileType, PreserveLocals,
+               OptimizePartition, PreparePartition);
+  if (OSs.size() == 1)
+    return M;
+  return {};
+}
+
+void llvm::splitCodeGen(
+    Module &M, ArrayRef<llvm::raw_pwrite_stream *> OSs,
+    ArrayRef<llvm::raw_pwrite_stream *> BCOSs,
+    const std::function<std::unique_ptr<TargetMachine>()> &TMFactory,
+    TargetMachine::CodeGenFileType FileType, bool PreserveLocals,
+    const std::function<void(Module &, TargetMachine &)> &OptimizePartition,
+    const std::function<void(unsigned, Module &)> &PreparePartition) {
   assert(BCOSs.empty() || BCOSs.size() == OSs.size());
 
   if (OSs.size() == 1) {
     if (!BCOSs.empty())
-      WriteBitcodeToFile(M.get(), *BCOSs[0]);
-    codegen(M.get(), *OSs[0], TMFactory, FileType);
-    return M;
+      WriteBitcodeToFile(&M, *BCOSs[0]);
+    codegen(&M, 0, *OSs[0], TMFactory, FileType, OptimizePartition,
+            PreparePartition);
+    return;
   }
 
+  PartitionDiagnostics Diagnostics(M.getContext());
+
   // Create ThreadPool in nested scope so that threads will be joined
   // on destruction.
   {
     ThreadPool CodegenThreadPool(OSs.size());
-    int ThreadCount = 0;
+    unsigned ThreadCount = 0;
 
     SplitModule(
-        std::move(M), OSs.size(),
+        M, OSs.size(),
         [&](std::unique_ptr<Module> MPart) {
           // We want to clone the module in a new context to multi-thread the
           // codegen. We do it by serializing partition modules to bitcode
@@ -74,11 +139,14 @@ std::unique_ptr<Module> llvm::splitCodeGen(
             BCOSs[ThreadCount]->flush();
           }
 
-          llvm::raw_pwrite_stream *ThreadOS = OSs[ThreadCount++];
+          unsigned Index = ThreadCount++;
+          llvm::raw_pwrite_stream *ThreadOS = OSs[Index];
           // Enqueue the task
           CodegenThreadPool.async(
-              [TMFactory, FileType, ThreadOS](const SmallString<0> &BC) {
+              [TMFactory, FileType, Index, ThreadOS, OptimizePartition,
+               PreparePartition, &Diagnostics](const SmallString<0> &BC) {
                 LLVMContext Ctx;
+                Diagnostics.install(Ctx);
                 Expected<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
                     MemoryBufferRef(StringRef(BC.data(), BC.size()),
                                     "<split-module>"),
@@ -87,7 +155,8 @@ std::unique_ptr<Module> llvm::splitCodeGen(
                   report_fatal_error("Failed to read bitcode");
                 std::unique_ptr<Module> MPartInCtx = std::move(MOrErr.get());
 
-                codegen(MPartInCtx.get(), *ThreadOS, TMFactory, FileType);
+                codegen(MPartInCtx.get(), Index, *ThreadOS, TMFactory,
+                        FileType, OptimizePartition, PreparePartition);
               },
               // Pass BC using std::move to ensure that it get moved rather than
               // copied into the thread's context.
@@ -95,6 +164,4 @@ std::unique_ptr<Module> llvm::splitCodeGen(
         },
         PreserveLocals);
   }
-
-  return {};
 }
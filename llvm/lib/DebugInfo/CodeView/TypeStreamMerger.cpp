@@ -19,6 +19,7 @@
 #include "llvm/DebugInfo/CodeView/TypeVisitorCallbacks.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ScopedPrinter.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace llvm;
 using namespace llvm::codeview;
@@ -55,8 +56,11 @@ namespace {
 class TypeStreamMerger : public TypeVisitorCallbacks {
 public:
   TypeStreamMerger(TypeTableBuilder &DestStream)
-      : DestStream(DestStream), FieldListBuilder(DestStream) {
+      : DestStream(DestStream), FieldListBuilder(DestStream),
+        Visitor(Pipeline) {
     assert(!hadError());
+    Pipeline.addCallbackToPipeline(Deserializer);
+    Pipeline.addCallbackToPipeline(*this);
   }
 
 /// TypeVisitorCallbacks overrides.
@@ -74,7 +78,24 @@ public:
   Error visitTypeEnd(CVType &Record) override;
   Error visitMemberEnd(CVMemberRecord &Record) override;
 
-  bool mergeStream(const CVTypeArray &Types);
+  bool mergeStream(const CVTypeArray &Types, ArrayRef<uint64_t> Hashes = None,
+                   DenseMap<uint64_t, TypeIndex> *HashedIndices = nullptr);
+
+  /// Merges one record of the source stream and returns its destination
+  /// type index.
+  Expected<TypeIndex> mergeRecord(CVType &Rec) {
+    size_t Size = IndexMap.size();
+    if (auto EC = Visitor.visitTypeRecord(Rec))
+      return std::move(EC);
+    assert(IndexMap.size() == Size + 1);
+    (void)Size;
+    return IndexMap.back();
+  }
+
+  /// Changes the type index that the last merged record is mapped to.
+  void remapLastRecord(TypeIndex Index) { IndexMap.back() = Index; }
+
+  bool hadError() { return FoundBadTypeIndex; }
 
 private:
   template <typename RecordType>
@@ -99,8 +120,6 @@ private:
     return Error::success();
   }
 
-  bool hadError() { return FoundBadTypeIndex; }
-
   bool FoundBadTypeIndex = false;
 
   BumpPtrAllocator Allocator;
@@ -108,6 +127,10 @@ private:
   TypeTableBuilder &DestStream;
   FieldListRecordBuilder FieldListBuilder;
 
+  TypeDeserializer Deserializer;
+  TypeVisitorCallbackPipeline Pipeline;
+  CVTypeVisitor Visitor;
+
   bool IsInFieldList{false};
   size_t BeginIndexMapSize = 0;
 
@@ -163,19 +186,28 @@ Error TypeStreamMerger::visitUnknownType(CVType &Rec) {
   return llvm::make_error<CodeViewError>(cv_error_code::corrupt_record);
 }
 
-bool TypeStreamMerger::mergeStream(const CVTypeArray &Types) {
+bool TypeStreamMerger::mergeStream(
+    const CVTypeArray &Types, ArrayRef<uint64_t> Hashes,
+    DenseMap<uint64_t, TypeIndex> *HashedIndices) {
   assert(IndexMap.empty());
-  TypeVisitorCallbackPipeline Pipeline;
-
-  TypeDeserializer Deserializer;
-  Pipeline.addCallbackToPipeline(Deserializer);
-  Pipeline.addCallbackToPipeline(*this);
-
-  CVTypeVisitor Visitor(Pipeline);
-
-  if (auto EC = Visitor.visitTypeStream(Types)) {
-    consumeError(std::move(EC));
-    return false;
+  size_t I = 0;
+  for (CVType Rec : Types) {
+    uint64_t Hash = I < Hashes.size() ? Hashes[I] : 0;
+    ++I;
+    if (Hash) {
+      auto It = HashedIndices->find(Hash);
+      if (It != HashedIndices->end()) {
+        IndexMap.push_back(It->second);
+        continue;
+      }
+    }
+    auto Index = mergeRecord(Rec);
+    if (!Index) {
+      consumeError(Index.takeError());
+      return false;
+    }
+    if (Hash)
+      HashedIndices->insert({Hash, *Index});
   }
   IndexMap.clear();
   return !hadError();
@@ -185,3 +217,79 @@ bool llvm::codeview::mergeTypeStreams(TypeTableBuilder &DestStream,
                                       const CVTypeArray &Types) {
   return TypeStreamMerger(DestStream).mergeStream(Types);
 }
+
+bool llvm::codeview::mergeTypeStreams(
+    TypeTableBuilder &DestStream, const CVTypeArray &Types,
+    ArrayRef<uint64_t> Hashes, DenseMap<uint64_t, TypeIndex> &HashedIndices) {
+  return TypeStreamMerger(DestStream).mergeStream(Types, Hashes,
+                                                  &HashedIndices);
+}
+
+static uint64_t hashRecord(ArrayRef<uint8_t> Rec) {
+  return xxHash64(StringRef((const char *)Rec.data(), Rec.size()));
+}
+
+// Two records merge into the same destination record if they have the same
+// contents and the records they refer to merge into the same records. So we
+// merge each stream into two scratch tables in which a type index is mapped
+// not to a destination index but to the lower or upper half of the hash of
+// the record it refers to, and hash the resulting records.
+//
+// A record that cannot be hashed this way, a field list that is split or is a
+// duplicate of an earlier field list, gets a hash of zero. The records that
+// refer to it see a value derived from its address, which is unique to the
+// stream, so they never match records of other streams.
+bool llvm::codeview::hashTypeStream(const CVTypeArray &Types,
+                                    SmallVectorImpl<uint64_t> &Hashes) {
+  BumpPtrAllocator Alloc;
+  TypeTableBuilder LoTable(Alloc), HiTable(Alloc);
+  TypeStreamMerger LoMerger(LoTable), HiMerger(HiTable);
+  TypeTableBuilder *Tables[] = {&LoTable, &HiTable};
+  TypeStreamMerger *Mergers[] = {&LoMerger, &HiMerger};
+  size_t Begin = Hashes.size();
+
+  for (CVType Rec : Types) {
+    uint64_t Halves[2];
+    bool Hashable = true;
+    for (int I = 0; I < 2; ++I) {
+      size_t NumRecords = Tables[I]->records().size();
+      auto Index = Mergers[I]->mergeRecord(Rec);
+      if (!Index || Mergers[I]->hadError()) {
+        if (!Index)
+          consumeError(Index.takeError());
+        Hashes.resize(Begin);
+        return false;
+      }
+
+      // A field list is written by FieldListRecordBuilder, which does not
+      // return the right index for a duplicate. Other duplicates are fine.
+      ArrayRef<MutableArrayRef<uint8_t>> Records = Tables[I]->records();
+      if (Records.size() == NumRecords + 1) {
+        Halves[I] = hashRecord(Records.back());
+      } else if (Rec.kind() != LF_FIELDLIST && Records.size() == NumRecords) {
+        Halves[I] = hashRecord(
+            Records[Index->getIndex() - TypeIndex::FirstNonSimpleIndex]);
+      } else {
+        Hashable = false;
+      }
+    }
+
+    uint64_t Hash;
+    if (Hashable) {
+      Hash = xxHash64(StringRef((const char *)Halves, sizeof(Halves)));
+      // Zero means unhashed, and with the top bit clear a hash is never a
+      // DenseMap empty or tombstone key.
+      Hash = (Hash | 1) & ~(uint64_t(1) << 63);
+      Hashes.push_back(Hash);
+    } else {
+      const uint8_t *Addr = Rec.data().data();
+      Hash = xxHash64(StringRef((const char *)&Addr, sizeof(Addr)));
+      Hashes.push_back(0);
+    }
+
+    // The top bit keeps the indices out of the range of simple types.
+    LoMerger.remapLastRecord(TypeIndex(uint32_t(Hash) | 0x80000000));
+    HiMerger.remapLastRecord(TypeIndex(uint32_t(Hash >> 32) | 0x80000000));
+  }
+  return true;
+}
@@ -23,8 +23,10 @@
 #include "llvm/LTO/LTOBackend.h"
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
+#include "llvm/Object/ModuleSummaryIndexTable.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/SourceMgr.h"
@@ -214,8 +216,15 @@ static void thinLTOInternalizeAndPromoteGUID(
 void llvm::thinLTOInternalizeAndPromoteInIndex(
     ModuleSummaryIndex &Index,
     function_ref<bool(StringRef, GlobalValue::GUID)> isExported) {
-  for (auto &I : Index)
-    thinLTOInternalizeAndPromoteGUID(I.second, I.first, isExported);
+  // Each GUID only updates its own summaries, so they are processed in
+  // parallel.
+  std::vector<gvsummary_iterator> Entries;
+  Entries.reserve(Index.size());
+  for (auto I = Index.begin(), E = Index.end(); I != E; ++I)
+    Entries.push_back(I);
+  parallelForEach(Entries.begin(), Entries.end(), [&](gvsummary_iterator I) {
+    thinLTOInternalizeAndPromoteGUID(I->second, I->first, isExported);
+  });
 }
 
 struct InputFile::InputModule {
@@ -831,6 +840,59 @@ ThinBackend lto::createWriteIndexesThinBackend(std::string OldPrefix,
   };
 }
 
+namespace {
+class WriteIndexTableThinBackend : public ThinBackendProc {
+  std::string TablePath;
+  object::ModuleSummaryIndexTableBuilder Builder;
+
+public:
+  WriteIndexTableThinBackend(
+      Config &Conf, ModuleSummaryIndex &CombinedIndex,
+      const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+      std::string TablePath)
+      : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        TablePath(TablePath), Builder(CombinedIndex) {}
+
+  Error start(
+      unsigned Task, BitcodeModule BM,
+      const FunctionImporter::ImportMapTy &ImportList,
+      const FunctionImporter::ExportSetTy &ExportList,
+      const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
+      MapVector<StringRef, BitcodeModule> &ModuleMap) override {
+    StringRef ModulePath = BM.getModuleIdentifier();
+    std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+    gatherImportedSummariesForModule(ModulePath, ModuleToDefinedGVSummaries,
+                                     ImportList, ModuleToSummariesForIndex);
+    Builder.addBackendSummaries(ModulePath, ModuleToSummariesForIndex);
+    return Error::success();
+  }
+
+  Error wait() override {
+    std::error_code EC;
+    raw_fd_ostream OS(TablePath, EC, sys::fs::OpenFlags::F_None);
+    if (EC)
+      return errorCodeToError(EC);
+    Builder.write(OS);
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      return make_error<StringError>("failed to write " + TablePath,
+                                     inconvertibleErrorCode());
+    }
+    return Error::success();
+  }
+};
+} // end anonymous namespace
+
+ThinBackend lto::createWriteIndexTableThinBackend(std::string TablePath) {
+  return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return llvm::make_unique<WriteIndexTableThinBackend>(
+        Conf, CombinedIndex, ModuleToDefinedGVSummaries, TablePath);
+  };
+}
+
 Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       bool HasRegularLTO) {
   if (ThinLTO.ModuleMap.empty())
@@ -222,8 +222,19 @@ static void runNewPMCustomPasses(Module &Mod, TargetMachine *TM,
   MPM.run(Mod, MAM);
 }
 
+/// The part of the regular LTO pipeline run by runOldPMPasses.
+enum class RegularLTOPart {
+  /// The whole pipeline.
+  All,
+  /// The interprocedural passes, run on the whole module.
+  IPO,
+  /// The function passes, run on a partition of the module.
+  Partition
+};
+
 static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
-                           bool IsThinLTO, ModuleSummaryIndex &CombinedIndex) {
+                           bool IsThinLTO, ModuleSummaryIndex &CombinedIndex,
+                           RegularLTOPart Part = RegularLTOPart::All) {
   legacy::PassManager passes;
   passes.add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
 
@@ -241,6 +252,10 @@ static void runOldPMPasses(Config &Conf, Module &Mod, TargetMachine *TM,
   PMB.PGOSampleUse = Conf.SampleProfile;
   if (IsThinLTO)
     PMB.populateThinLTOPassManager(passes);
+  else if (Part == RegularLTOPart::IPO)
+    PMB.populateLTOIPOPassManager(passes);
+  else if (Part == RegularLTOPart::Partition)
+    PMB.populateLTOPartitionPassManager(passes);
   else
     PMB.populateLTOPassManager(passes);
   passes.run(Mod);
@@ -277,9 +292,13 @@ void codegen(Config &Conf, TargetMachine *TM, AddStreamFn AddStream,
   CodeGenPasses.run(Mod);
 }
 
+/// Split \p Mod and generate code for the partitions in parallel. If
+/// \p OptimizePartitions is set, the function passes also run on each
+/// partition, in the thread of its code generation.
 void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
                   unsigned ParallelCodeGenParallelismLevel,
-                  std::unique_ptr<Module> Mod) {
+                  std::unique_ptr<Module> Mod, bool OptimizePartitions,
+                  ModuleSummaryIndex &CombinedIndex) {
   ThreadPool CodegenThreadPool(ParallelCodeGenParallelismLevel);
   unsigned ThreadCount = 0;
   const Target *T = &TM->getTarget();
@@ -311,6 +330,14 @@ void splitCodeGen(Config &C, TargetMachine *TM, AddStreamFn AddStream,
               std::unique_ptr<TargetMachine> TM =
                   createTargetMachine(C, MPartInCtx->getTargetTriple(), T);
 
+              if (OptimizePartitions) {
+                runOldPMPasses(C, *MPartInCtx, TM.get(), /*IsThinLTO=*/false,
+                               CombinedIndex, RegularLTOPart::Partition);
+                if (C.PostOptModuleHook &&
+                    !C.PostOptModuleHook(ThreadId, *MPartInCtx))
+                  return;
+              }
+
               codegen(C, TM.get(), AddStream, ThreadId, *MPartInCtx);
             },
             // Pass BC using std::move to ensure that it get moved rather than
@@ -366,7 +393,15 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
 
   handleAsmUndefinedRefs(*Mod, *TM);
 
-  if (!C.CodeGenOnly)
+  // Custom pipelines and the new pass manager cannot be split, so they run on
+  // the whole module.
+  bool OptimizePartitions = C.ParallelOpt && !C.CodeGenOnly &&
+                            ParallelCodeGenParallelismLevel != 1 &&
+                            C.OptPipeline.empty() && !LTOUseNewPM;
+  if (OptimizePartitions)
+    runOldPMPasses(C, *Mod, TM.get(), /*IsThinLTO=*/false, CombinedIndex,
+                   RegularLTOPart::IPO);
+  else if (!C.CodeGenOnly)
     if (!opt(C, TM.get(), 0, *Mod, /*IsThinLTO=*/false, CombinedIndex))
       return Error::success();
 
@@ -374,7 +409,7 @@ Error lto::backend(Config &C, AddStreamFn AddStream,
     codegen(C, TM.get(), AddStream, 0, *Mod);
   } else {
     splitCodeGen(C, TM.get(), AddStream, ParallelCodeGenParallelismLevel,
-                 std::move(Mod));
+                 std::move(Mod), OptimizePartitions, CombinedIndex);
   }
   return Error::success();
 }
@@ -571,7 +571,41 @@ bool LTOCodeGenerator::optimize(bool DisableVerify, bool DisableInline,
   PMB.VerifyInput = !DisableVerify;
   PMB.VerifyOutput = !DisableVerify;
 
-  PMB.populateLTOPassManager(passes);
+  // Remarks are written to the file by the context of the module they are
+  // emitted in, and each partition has its own.
+  bool OptimizePartitions = ParallelOptimization;
+  if (OptimizePartitions && DiagnosticOutputFile) {
+    emitWarning("optimizing the partitions in parallel is not supported when "
+                "writing optimization remarks to a file");
+    OptimizePartitions = false;
+  }
+
+  OptimizePartition = nullptr;
+  if (OptimizePartitions) {
+    PMB.populateLTOIPOPassManager(passes);
+
+    unsigned OptLevel = this->OptLevel;
+    OptimizePartition = [=](Module &M, TargetMachine &TM) {
+      legacy::PassManager Passes;
+      Passes.add(
+          createTargetTransformInfoWrapperPass(TM.getTargetIRAnalysis()));
+
+      PassManagerBuilder PMB;
+      PMB.DisableGVNLoadPRE = DisableGVNLoadPRE;
+      PMB.LoopVectorize = !DisableVectorization;
+      PMB.SLPVectorize = !DisableVectorization;
+      PMB.LibraryInfo = new TargetLibraryInfoImpl(TM.getTargetTriple());
+      PMB.OptLevel = OptLevel;
+      PMB.VerifyOutput = !DisableVerify;
+      PMB.populateLTOPartitionPassManager(Passes);
+
+      // See compileOptimized().
+      Passes.add(createObjCARCContractPass());
+      Passes.run(M);
+    };
+  } else {
+    PMB.populateLTOPassManager(passes);
+  }
 
   // Run our queue of passes all at once now, efficiently.
   passes.run(*MergedModule);
@@ -587,12 +621,14 @@ bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   // been called in optimize(), this call will return early.
   verifyMergedModuleOnce();
 
-  legacy::PassManager preCodeGenPasses;
-
   // If the bitcode files contain ARC code and were compiled with optimization,
-  // the ObjCARCContractPass must be run, so do it unconditionally here.
-  preCodeGenPasses.add(createObjCARCContractPass());
-  preCodeGenPasses.run(*MergedModule);
+  // the ObjCARCContractPass must be run, so do it unconditionally here. It is
+  // run on each partition instead if they are optimized separately.
+  if (!OptimizePartition) {
+    legacy::PassManager preCodeGenPasses;
+    preCodeGenPasses.add(createObjCARCContractPass());
+    preCodeGenPasses.run(*MergedModule);
+  }
 
   // Re-externalize globals that may have been internalized to increase scope
   // for splitting
@@ -605,7 +641,7 @@ bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   // MergedModule.
   MergedModule = splitCodeGen(std::move(MergedModule), Out, {},
                               [&]() { return createTargetMachine(); }, FileType,
-                              ShouldRestoreGlobalsLinkage);
+                              ShouldRestoreGlobalsLinkage, OptimizePartition);
 
   // If statistics were requested, print them out after codegen.
   if (llvm::AreStatisticsEnabled())
@@ -102,7 +102,11 @@ llvm::getModuleSummaryIndexForFile(StringRef Path) {
   std::error_code EC = FileOrErr.getError();
   if (EC)
     return errorCodeToError(EC);
-  MemoryBufferRef BufferRef = (FileOrErr.get())->getMemBufferRef();
+  return getModuleSummaryIndexForBuffer((FileOrErr.get())->getMemBufferRef());
+}
+
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+llvm::getModuleSummaryIndexForBuffer(MemoryBufferRef BufferRef) {
   if (IgnoreEmptyThinLTOIndexFile && !BufferRef.getBufferSize())
     return nullptr;
   Expected<std::unique_ptr<object::ModuleSummaryIndexObjectFile>> ObjOrErr =
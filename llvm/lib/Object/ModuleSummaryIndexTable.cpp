@@ -0,0 +1,468 @@
+//===- ModuleSummaryIndexTable.cpp - Mappable summary index ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the reader and writer of module summary index tables.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ModuleSummaryIndexTable.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Object/ModuleSummaryIndexObjectFile.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::object;
+using namespace llvm::object::summary_table;
+
+static_assert(sizeof(Header) == 96, "unexpected Header size");
+static_assert(sizeof(summary_table::Module) == 56, "unexpected Module size");
+static_assert(sizeof(Bucket) == 16, "unexpected Bucket size");
+static_assert(sizeof(Summary) == 56, "unexpected Summary size");
+static_assert(sizeof(Call) == 16, "unexpected Call size");
+
+static Error createError(const Twine &Message) {
+  return make_error<StringError>("invalid module summary index table: " +
+                                     Message,
+                                 inconvertibleErrorCode());
+}
+
+/// Return the slot of \p GUID in a hash table of \p NumBuckets buckets.
+static uint32_t getFirstBucket(GlobalValue::GUID GUID, uint32_t NumBuckets) {
+  // GUIDs are MD5 hashes, so their low bits are evenly distributed.
+  return GUID & (NumBuckets - 1);
+}
+
+ModuleSummaryIndexTableBuilder::ModuleSummaryIndexTableBuilder(
+    const ModuleSummaryIndex &Index)
+    : Index(Index) {
+  // Order the modules by ID, and their summaries by GUID, so that the table
+  // does not depend on the order of the string maps.
+  for (auto &MPI : Index.modulePaths())
+    ModulePaths.push_back(MPI.first());
+  std::sort(ModulePaths.begin(), ModulePaths.end(),
+            [&](StringRef A, StringRef B) {
+              uint64_t IdA = Index.getModuleId(A), IdB = Index.getModuleId(B);
+              return IdA != IdB ? IdA < IdB : A < B;
+            });
+  for (uint32_t I = 0, E = ModulePaths.size(); I != E; ++I)
+    ModuleIndices[ModulePaths[I]] = I;
+
+  std::vector<std::vector<std::pair<GlobalValue::GUID, GlobalValueSummary *>>>
+      ModuleSummaries(ModulePaths.size());
+  for (auto &GlobalList : Index) {
+    for (auto &Summary : GlobalList.second) {
+      auto It = ModuleIndices.find(Summary->modulePath());
+      assert(It != ModuleIndices.end() && "Summary of an unknown module");
+      ModuleSummaries[It->second].push_back(
+          std::make_pair(GlobalList.first, Summary.get()));
+    }
+  }
+  for (auto &List : ModuleSummaries) {
+    for (auto &Summary : List) {
+      SummaryIndices[Summary.second] = Summaries.size();
+      Summaries.push_back(Summary);
+    }
+  }
+
+  BackendSummaries.resize(ModulePaths.size());
+}
+
+void ModuleSummaryIndexTableBuilder::addBackendSummaries(
+    StringRef ModulePath,
+    const std::map<std::string, GVSummaryMapTy> &ModuleToSummariesForIndex) {
+  assert(ModuleIndices.count(ModulePath) && "Unknown module");
+  std::vector<uint32_t> &List = BackendSummaries[ModuleIndices[ModulePath]];
+  List.clear();
+  for (auto &MSI : ModuleToSummariesForIndex)
+    for (auto &GVS : MSI.second)
+      List.push_back(SummaryIndices.lookup(GVS.second));
+  std::sort(List.begin(), List.end());
+}
+
+/// Write the contents of \p Records at the current position of \p OS.
+template <class T>
+static void writeArray(raw_ostream &OS, const std::vector<T> &Records) {
+  OS.write(reinterpret_cast<const char *>(Records.data()),
+           Records.size() * sizeof(T));
+}
+
+void ModuleSummaryIndexTableBuilder::write(raw_ostream &OS) {
+  std::vector<summary_table::Module> ModuleRecords(ModulePaths.size());
+  std::vector<Summary> SummaryRecords(Summaries.size());
+  std::vector<ulittle64_t> GUIDRecords;
+  std::vector<Call> CallRecords;
+  std::vector<ulittle32_t> SummaryIndexRecords;
+  std::string StringTable;
+
+  for (uint32_t I = 0, E = ModulePaths.size(); I != E; ++I) {
+    summary_table::Module &M = ModuleRecords[I];
+    std::memset(&M, 0, sizeof(M));
+    M.PathOffset = StringTable.size();
+    M.PathSize = ModulePaths[I].size();
+    StringTable += ModulePaths[I];
+    M.ModuleId = Index.getModuleId(ModulePaths[I]);
+    const ModuleHash &Hash = Index.getModuleHash(ModulePaths[I]);
+    for (unsigned J = 0; J != 5; ++J)
+      M.Hash[J] = Hash[J];
+    M.BackendSummariesBegin = SummaryIndexRecords.size();
+    M.NumBackendSummaries = BackendSummaries[I].size();
+    SummaryIndexRecords.insert(SummaryIndexRecords.end(),
+                               BackendSummaries[I].begin(),
+                               BackendSummaries[I].end());
+  }
+
+  for (uint32_t I = 0, E = Summaries.size(); I != E; ++I) {
+    GlobalValueSummary *S = Summaries[I].second;
+    Summary &R = SummaryRecords[I];
+    std::memset(&R, 0, sizeof(R));
+    R.GUID = Summaries[I].first;
+    R.OriginalName = S->getOriginalName();
+    R.Module = ModuleIndices.lookup(S->modulePath());
+    R.Kind = S->getSummaryKind();
+    R.Linkage = S->linkage();
+    R.Flags = (S->notEligibleToImport() ? 1 : 0) | (S->liveRoot() ? 2 : 0);
+    R.Aliasee = NoSummary;
+
+    // The summaries of a module are contiguous.
+    summary_table::Module &M = ModuleRecords[R.Module];
+    if (M.NumSummaries == 0)
+      M.SummariesBegin = I;
+    M.NumSummaries = M.NumSummaries + 1;
+
+    R.RefsBegin = GUIDRecords.size();
+    R.NumRefs = S->refs().size();
+    for (const ValueInfo &Ref : S->refs())
+      GUIDRecords.push_back(ulittle64_t(Ref.getGUID()));
+
+    R.TypeTestsBegin = GUIDRecords.size();
+    R.CallsBegin = CallRecords.size();
+    if (auto *FS = dyn_cast<FunctionSummary>(S)) {
+      R.InstCount = FS->instCount();
+      R.NumTypeTests = FS->type_tests().size();
+      for (GlobalValue::GUID TypeTest : FS->type_tests())
+        GUIDRecords.push_back(ulittle64_t(TypeTest));
+      R.NumCalls = FS->calls().size();
+      for (const FunctionSummary::EdgeTy &Edge : FS->calls()) {
+        Call C;
+        std::memset(&C, 0, sizeof(C));
+        C.Callee = Edge.first.getGUID();
+        C.Hotness = static_cast<uint8_t>(Edge.second.Hotness);
+        CallRecords.push_back(C);
+      }
+    } else if (auto *AS = dyn_cast<AliasSummary>(S)) {
+      R.Aliasee = SummaryIndices.lookup(&AS->getAliasee());
+    }
+  }
+
+  // Lay out the hash table, keeping the load factor under 3/4.
+  uint32_t NumBuckets = NextPowerOf2(Index.size() * 4 / 3);
+  std::vector<Bucket> BucketRecords(NumBuckets);
+  std::memset(BucketRecords.data(), 0, NumBuckets * sizeof(Bucket));
+  for (auto &GlobalList : Index) {
+    if (GlobalList.second.empty())
+      continue;
+    uint32_t Slot = getFirstBucket(GlobalList.first, NumBuckets);
+    while (BucketRecords[Slot].NumSummaries != 0)
+      Slot = (Slot + 1) & (NumBuckets - 1);
+    Bucket &B = BucketRecords[Slot];
+    B.GUID = GlobalList.first;
+    B.SummaryIndicesBegin = SummaryIndexRecords.size();
+    B.NumSummaries = GlobalList.second.size();
+    for (auto &Summary : GlobalList.second)
+      SummaryIndexRecords.push_back(
+          ulittle32_t(SummaryIndices.lookup(Summary.get())));
+  }
+
+  Header H;
+  std::memset(&H, 0, sizeof(H));
+  std::memcpy(H.Magic, summary_table::Magic, sizeof(H.Magic));
+  H.Version = summary_table::Version;
+  H.NumModules = ModuleRecords.size();
+  H.NumSummaries = SummaryRecords.size();
+  H.NumBuckets = NumBuckets;
+  H.NumGUIDs = GUIDRecords.size();
+  H.NumCalls = CallRecords.size();
+  H.NumSummaryIndices = SummaryIndexRecords.size();
+  H.StringTableSize = StringTable.size();
+
+  // Lay out the arrays in order after the header, the 8-byte records first.
+  uint64_t Offset = sizeof(Header);
+  auto Allocate = [&](uint64_t Size) {
+    uint64_t Start = Offset;
+    Offset += Size;
+    return Start;
+  };
+  H.BucketsOffset = Allocate(BucketRecords.size() * sizeof(Bucket));
+  H.SummariesOffset = Allocate(SummaryRecords.size() * sizeof(Summary));
+  H.GUIDsOffset = Allocate(GUIDRecords.size() * sizeof(ulittle64_t));
+  H.CallsOffset = Allocate(CallRecords.size() * sizeof(Call));
+  H.ModulesOffset =
+      Allocate(ModuleRecords.size() * sizeof(summary_table::Module));
+  H.SummaryIndicesOffset =
+      Allocate(SummaryIndexRecords.size() * sizeof(ulittle32_t));
+  H.StringTableOffset = Allocate(StringTable.size());
+
+  OS.write(reinterpret_cast<const char *>(&H), sizeof(H));
+  writeArray(OS, BucketRecords);
+  writeArray(OS, SummaryRecords);
+  writeArray(OS, GUIDRecords);
+  writeArray(OS, CallRecords);
+  writeArray(OS, ModuleRecords);
+  writeArray(OS, SummaryIndexRecords);
+  OS << StringTable;
+}
+
+bool ModuleSummaryIndexTable::isModuleSummaryIndexTable(
+    MemoryBufferRef Buffer) {
+  return Buffer.getBufferSize() >= sizeof(Header) &&
+         std::memcmp(Buffer.getBufferStart(), summary_table::Magic,
+                     sizeof(summary_table::Magic)) == 0;
+}
+
+Expected<std::unique_ptr<ModuleSummaryIndexTable>>
+ModuleSummaryIndexTable::create(MemoryBufferRef Buffer) {
+  std::unique_ptr<ModuleSummaryIndexTable> Table(
+      new ModuleSummaryIndexTable(Buffer));
+  if (Error E = Table->initialize())
+    return std::move(E);
+  return std::move(Table);
+}
+
+/// Set \p Array to the \p Count records of type T at \p Offset in \p Buffer.
+template <class T>
+static Error getArray(MemoryBufferRef Buffer, uint64_t Offset, uint64_t Count,
+                      ArrayRef<T> &Array, const char *Name) {
+  uint64_t Size = Buffer.getBufferSize();
+  if (Offset > Size || Count > (Size - Offset) / sizeof(T))
+    return createError(Twine(Name) + " out of bounds");
+  Array = makeArrayRef(
+      reinterpret_cast<const T *>(Buffer.getBufferStart() + Offset), Count);
+  return Error::success();
+}
+
+Error ModuleSummaryIndexTable::initialize() {
+  if (!isModuleSummaryIndexTable(Buffer))
+    return createError("bad magic");
+  const Header &H = *reinterpret_cast<const Header *>(Buffer.getBufferStart());
+  if (H.Version != summary_table::Version)
+    return createError("unsupported version " + Twine(H.Version));
+  if (!isPowerOf2_32(H.NumBuckets))
+    return createError("the number of buckets is not a power of two");
+
+  ArrayRef<char> Strings;
+  if (Error E = getArray(Buffer, H.ModulesOffset, H.NumModules, Modules,
+                         "modules"))
+    return E;
+  if (Error E = getArray(Buffer, H.BucketsOffset, H.NumBuckets, Buckets,
+                         "buckets"))
+    return E;
+  if (Error E = getArray(Buffer, H.SummariesOffset, H.NumSummaries, Summaries,
+                         "summaries"))
+    return E;
+  if (Error E = getArray(Buffer, H.GUIDsOffset, H.NumGUIDs, GUIDs, "GUIDs"))
+    return E;
+  if (Error E = getArray(Buffer, H.CallsOffset, H.NumCalls, Calls, "calls"))
+    return E;
+  if (Error E = getArray(Buffer, H.SummaryIndicesOffset, H.NumSummaryIndices,
+                         SummaryIndices, "summary indices"))
+    return E;
+  if (Error E = getArray(Buffer, H.StringTableOffset, H.StringTableSize,
+                         Strings, "string table"))
+    return E;
+  StringTable = StringRef(Strings.data(), Strings.size());
+  return Error::success();
+}
+
+/// Return the \p Count elements of \p Array from \p Begin.
+template <class T>
+static Expected<ArrayRef<T>> getRange(ArrayRef<T> Array, uint32_t Begin,
+                                      uint32_t Count, const char *Name) {
+  if (Begin > Array.size() || Count > Array.size() - Begin)
+    return createError(Twine(Name) + " out of bounds");
+  return Array.slice(Begin, Count);
+}
+
+Expected<StringRef>
+ModuleSummaryIndexTable::getModulePath(unsigned Module) const {
+  if (Module >= Modules.size())
+    return createError("module index out of bounds");
+  const summary_table::Module &M = Modules[Module];
+  if (M.PathOffset > StringTable.size() ||
+      M.PathSize > StringTable.size() - M.PathOffset)
+    return createError("module path out of bounds");
+  return StringTable.substr(M.PathOffset, M.PathSize);
+}
+
+Expected<unsigned>
+ModuleSummaryIndexTable::findModule(StringRef ModulePath) const {
+  for (unsigned I = 0, E = Modules.size(); I != E; ++I) {
+    Expected<StringRef> PathOrErr = getModulePath(I);
+    if (!PathOrErr)
+      return PathOrErr.takeError();
+    if (*PathOrErr == ModulePath)
+      return I;
+  }
+  return createError("no module '" + ModulePath + "'");
+}
+
+Expected<ArrayRef<ulittle32_t>>
+ModuleSummaryIndexTable::findSummaries(GlobalValue::GUID GUID) const {
+  uint32_t NumBuckets = Buckets.size();
+  uint32_t Slot = getFirstBucket(GUID, NumBuckets);
+  for (uint32_t I = 0; I != NumBuckets; ++I) {
+    const Bucket &B = Buckets[Slot];
+    if (B.NumSummaries == 0)
+      break;
+    if (B.GUID == GUID)
+      return getRange(SummaryIndices, B.SummaryIndicesBegin, B.NumSummaries,
+                      "summaries of a GUID");
+    Slot = (Slot + 1) & (NumBuckets - 1);
+  }
+  return ArrayRef<ulittle32_t>();
+}
+
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+ModuleSummaryIndexTable::loadSummaries(ArrayRef<ulittle32_t> Indices) const {
+  auto Index = llvm::make_unique<ModuleSummaryIndex>();
+  DenseMap<uint32_t, StringRef> LoadedModules;
+  DenseMap<uint32_t, GlobalValueSummary *> LoadedSummaries;
+  std::vector<std::pair<AliasSummary *, uint32_t>> Aliases;
+
+  for (uint32_t SummaryIndex : Indices) {
+    if (SummaryIndex >= Summaries.size())
+      return createError("summary index out of bounds");
+    if (LoadedSummaries.count(SummaryIndex))
+      continue;
+    const Summary &R = Summaries[SummaryIndex];
+
+    // Register the module of the summary, which owns its path. Check the
+    // index first, it must not be a reserved key of LoadedModules.
+    if (R.Module >= Modules.size())
+      return createError("module index out of bounds");
+    StringRef &ModulePath = LoadedModules[R.Module];
+    if (ModulePath.empty()) {
+      Expected<StringRef> PathOrErr = getModulePath(R.Module);
+      if (!PathOrErr)
+        return PathOrErr.takeError();
+      const summary_table::Module &M = Modules[R.Module];
+      ModuleHash Hash;
+      for (unsigned J = 0; J != 5; ++J)
+        Hash[J] = M.Hash[J];
+      ModulePath = Index->addModulePath(*PathOrErr, M.ModuleId, Hash)->first();
+    }
+
+    auto RefsOrErr = getRange(GUIDs, R.RefsBegin, R.NumRefs, "references");
+    if (!RefsOrErr)
+      return RefsOrErr.takeError();
+    std::vector<ValueInfo> Refs;
+    Refs.reserve(RefsOrErr->size());
+    for (uint64_t Ref : *RefsOrErr)
+      Refs.push_back(ValueInfo(Ref));
+
+    GlobalValueSummary::GVFlags Flags(
+        static_cast<GlobalValue::LinkageTypes>(R.Linkage & 0xf), R.Flags & 1,
+        R.Flags & 2);
+    std::unique_ptr<GlobalValueSummary> S;
+    switch (R.Kind) {
+    case GlobalValueSummary::FunctionKind: {
+      auto TypeTestsOrErr =
+          getRange(GUIDs, R.TypeTestsBegin, R.NumTypeTests, "type tests");
+      if (!TypeTestsOrErr)
+        return TypeTestsOrErr.takeError();
+      auto CallsOrErr = getRange(Calls, R.CallsBegin, R.NumCalls, "calls");
+      if (!CallsOrErr)
+        return CallsOrErr.takeError();
+      std::vector<GlobalValue::GUID> TypeTests(TypeTestsOrErr->begin(),
+                                               TypeTestsOrErr->end());
+      std::vector<FunctionSummary::EdgeTy> Edges;
+      Edges.reserve(CallsOrErr->size());
+      for (const Call &C : *CallsOrErr)
+        Edges.push_back(std::make_pair(
+            ValueInfo(C.Callee),
+            CalleeInfo(static_cast<CalleeInfo::HotnessType>(C.Hotness & 3))));
+      S = llvm::make_unique<FunctionSummary>(Flags, R.InstCount,
+                                             std::move(Refs), std::move(Edges),
+                                             std::move(TypeTests));
+      break;
+    }
+    case GlobalValueSummary::GlobalVarKind:
+      S = llvm::make_unique<GlobalVarSummary>(Flags, std::move(Refs));
+      break;
+    case GlobalValueSummary::AliasKind: {
+      // The aliasee is looked up in LoadedSummaries, which reserves some keys.
+      if (R.Aliasee >= Summaries.size())
+        return createError("aliasee index out of bounds");
+      auto AS = llvm::make_unique<AliasSummary>(Flags, std::move(Refs));
+      Aliases.push_back(std::make_pair(AS.get(), uint32_t(R.Aliasee)));
+      S = std::move(AS);
+      break;
+    }
+    default:
+      return createError("unknown summary kind " + Twine(R.Kind));
+    }
+
+    S->setModulePath(ModulePath);
+    S->setOriginalName(R.OriginalName);
+    LoadedSummaries[SummaryIndex] = S.get();
+    Index->addGlobalValueSummary(R.GUID, std::move(S));
+  }
+
+  for (auto &Alias : Aliases) {
+    GlobalValueSummary *Aliasee = LoadedSummaries.lookup(Alias.second);
+    if (!Aliasee)
+      return createError("alias summary loaded without its aliasee");
+    Alias.first->setAliasee(Aliasee);
+  }
+  return std::move(Index);
+}
+
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+ModuleSummaryIndexTable::loadIndexForModule(StringRef ModulePath) const {
+  Expected<unsigned> ModuleOrErr = findModule(ModulePath);
+  if (!ModuleOrErr)
+    return ModuleOrErr.takeError();
+  const summary_table::Module &M = Modules[*ModuleOrErr];
+  auto IndicesOrErr = getRange(SummaryIndices, M.BackendSummariesBegin,
+                               M.NumBackendSummaries, "backend summaries");
+  if (!IndicesOrErr)
+    return IndicesOrErr.takeError();
+  auto IndexOrErr = loadSummaries(*IndicesOrErr);
+  if (!IndexOrErr)
+    return IndexOrErr.takeError();
+
+  // The importing module is always part of its index, even without summaries.
+  if (!(*IndexOrErr)->modulePaths().count(ModulePath)) {
+    ModuleHash Hash;
+    for (unsigned J = 0; J != 5; ++J)
+      Hash[J] = M.Hash[J];
+    (*IndexOrErr)->addModulePath(ModulePath, M.ModuleId, Hash);
+  }
+  return IndexOrErr;
+}
+
+Expected<std::unique_ptr<ModuleSummaryIndex>>
+llvm::getModuleSummaryIndexForModule(StringRef Path, StringRef ModulePath) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
+      MemoryBuffer::getFileOrSTDIN(Path);
+  if (!FileOrErr)
+    return errorCodeToError(FileOrErr.getError());
+  MemoryBufferRef Buffer = (*FileOrErr)->getMemBufferRef();
+  if (!ModuleSummaryIndexTable::isModuleSummaryIndexTable(Buffer))
+    return getModuleSummaryIndexForBuffer(Buffer);
+
+  Expected<std::unique_ptr<ModuleSummaryIndexTable>> TableOrErr =
+      ModuleSummaryIndexTable::create(Buffer);
+  if (!TableOrErr)
+    return TableOrErr.takeError();
+  return (*TableOrErr)->loadIndexForModule(ModulePath);
+}
@@ -98,6 +98,71 @@ uint32_t zlib::crc32(StringRef Buffer) {
   return ::crc32(0, (const Bytef *)Buffer.data(), Buffer.size());
 }
 
+Error zlib::compressChunk(StringRef InputBuffer,
+                          SmallVectorImpl<char> &CompressedBuffer,
+                          CompressionLevel Level, bool IsLast) {
+  // Negative windowBits means a raw deflate stream without a header.
+  z_stream S = {};
+  int Res = deflateInit2(&S, encodeZlibCompressionLevel(Level), Z_DEFLATED,
+                         -15, 8, Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return createError(convertZlibCodeToString(Res));
+
+  size_t Begin = CompressedBuffer.size();
+  // A sync flush appends an empty stored block of at most 6 bytes.
+  CompressedBuffer.resize(Begin + deflateBound(&S, InputBuffer.size()) + 6);
+  S.next_in = (Bytef *)InputBuffer.data();
+  S.avail_in = InputBuffer.size();
+  S.next_out = (Bytef *)CompressedBuffer.data() + Begin;
+  S.avail_out = CompressedBuffer.size() - Begin;
+
+  int Flush = IsLast ? Z_FINISH : Z_SYNC_FLUSH;
+  for (;;) {
+    Res = ::deflate(&S, Flush);
+    if (Res == Z_STREAM_ERROR)
+      break;
+    if (Res == Z_STREAM_END || (!IsLast && S.avail_out != 0))
+      break;
+    if (S.avail_out == 0) {
+      size_t Done = CompressedBuffer.size();
+      CompressedBuffer.resize(Done * 2);
+      S.next_out = (Bytef *)CompressedBuffer.data() + Done;
+      S.avail_out = CompressedBuffer.size() - Done;
+    }
+  }
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented ZLib.
+  __msan_unpoison(CompressedBuffer.data() + Begin, S.total_out);
+  CompressedBuffer.resize(Begin + S.total_out);
+  deflateEnd(&S);
+  return Res == Z_STREAM_ERROR ? createError(convertZlibCodeToString(Res))
+                               : Error::success();
+}
+
+uint16_t zlib::getHeader(CompressionLevel Level) {
+  // A 32K window and deflate. The low bits of the second byte make the
+  // header a multiple of 31, and its high bits encode the level.
+  switch (Level) {
+  case NoCompression:
+  case BestSpeedCompression:
+    return 0x7801;
+  case DefaultCompression:
+    return 0x789c;
+  case BestSizeCompression:
+    return 0x78da;
+  }
+  llvm_unreachable("Invalid zlib::CompressionLevel!");
+}
+
+uint32_t zlib::adler32(StringRef Buffer) {
+  return ::adler32(::adler32(0, Z_NULL, 0), (const Bytef *)Buffer.data(),
+                   Buffer.size());
+}
+
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Len2) {
+  return ::adler32_combine(Adler1, Adler2, Len2);
+}
+
 #else
 bool zlib::isAvailable() { return false; }
 Error zlib::compress(StringRef InputBuffer,
@@ -117,5 +182,19 @@ Error zlib::uncompress(StringRef InputBuffer,
 uint32_t zlib::crc32(StringRef Buffer) {
   llvm_unreachable("zlib::crc32 is unavailable");
 }
+Error zlib::compressChunk(StringRef InputBuffer,
+                          SmallVectorImpl<char> &CompressedBuffer,
+                          CompressionLevel Level, bool IsLast) {
+  llvm_unreachable("zlib::compressChunk is unavailable");
+}
+uint16_t zlib::getHeader(CompressionLevel Level) {
+  llvm_unreachable("zlib::getHeader is unavailable");
+}
+uint32_t zlib::adler32(StringRef Buffer) {
+  llvm_unreachable("zlib::adler32 is unavailable");
+}
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Len2) {
+  llvm_unreachable("zlib::adler32Combine is unavailable");
+}
 #endif
 
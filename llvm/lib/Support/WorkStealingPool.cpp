@@ -0,0 +1,226 @@
+//==-- llvm/Support/WorkStealingPool.cpp - Work-stealing pool ----*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a work-stealing thread pool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/WorkStealingPool.h"
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+
+using namespace llvm;
+
+/// The pool the current thread belongs to, if any, and its index in the pool.
+static LLVM_THREAD_LOCAL WorkStealingPool *CurrentPool = nullptr;
+static LLVM_THREAD_LOCAL unsigned CurrentWorker = 0;
+
+/// The pool whose task the current thread is running, if any.
+static LLVM_THREAD_LOCAL WorkStealingPool *RunningPool = nullptr;
+
+/// The concurrency of the default pool, zero meaning one thread per hardware
+/// thread, and whether the default pool has been created.
+static std::atomic<unsigned> DefaultConcurrency(0);
+static std::atomic<bool> DefaultPoolCreated(false);
+
+WorkStealingPool::WorkStealingPool()
+    : WorkStealingPool(std::thread::hardware_concurrency()) {}
+
+WorkStealingPool::WorkStealingPool(unsigned ThreadCount)
+    : QueuedTasks(0), SleepingThreads(0), Stopping(false) {
+#if LLVM_ENABLE_THREADS
+  for (unsigned I = 0; I < ThreadCount; ++I)
+    WorkerQueues.push_back(llvm::make_unique<TaskQueue>());
+  Threads.reserve(ThreadCount);
+  for (unsigned I = 0; I < ThreadCount; ++I)
+    Threads.emplace_back([this, I] { runWorker(I); });
+#else
+  // No threads are launched, tasks run when they are waited for.
+  if (ThreadCount) {
+    errs() << "Warning: request a WorkStealingPool with " << ThreadCount
+           << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
+  }
+#endif
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::unique_lock<std::mutex> LockGuard(SleepLock);
+    Stopping = true;
+  }
+  SleepCondition.notify_all();
+  for (auto &Worker : Threads)
+    Worker.join();
+
+  // Without threads, nobody else runs the remaining tasks.
+  while (runQueuedTask())
+    ;
+}
+
+WorkStealingPool &WorkStealingPool::getDefault() {
+  static WorkStealingPool Pool([] {
+    DefaultPoolCreated = true;
+    return getDefaultConcurrency() - 1;
+  }());
+  return Pool;
+}
+
+void WorkStealingPool::setDefaultConcurrency(unsigned N) {
+  assert(!DefaultPoolCreated &&
+         "Setting the concurrency after creating the default pool");
+  DefaultConcurrency = N;
+}
+
+unsigned WorkStealingPool::getDefaultConcurrency() {
+  if (unsigned N = DefaultConcurrency)
+    return N;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+WorkStealingPool::TaskQueue &WorkStealingPool::getQueueForCurrentThread() {
+  if (CurrentPool == this)
+    return *WorkerQueues[CurrentWorker];
+  return ExternalQueue;
+}
+
+void WorkStealingPool::asyncImpl(TaskTy Run, TaskGroup *Group) {
+  assert((!Stopping || RunningPool == this) &&
+         "Queuing a task during WorkStealingPool destruction");
+
+  // Count the task before queuing it, so that a thread which finds the count
+  // non-zero keeps looking for the task rather than going to sleep.
+  ++QueuedTasks;
+  TaskQueue &Queue = getQueueForCurrentThread();
+  {
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    Queue.Tasks.push_back(Task{std::move(Run), Group});
+  }
+
+  // A thread going to sleep registers itself before checking QueuedTasks, so
+  // either it sees the task or we see it. Notifying under the lock ensures it
+  // is already waiting.
+  if (SleepingThreads) {
+    std::unique_lock<std::mutex> LockGuard(SleepLock);
+    SleepCondition.notify_one();
+  }
+}
+
+bool WorkStealingPool::popTask(Task &T) {
+  if (!QueuedTasks)
+    return false;
+
+  // Run the most recent task submitted from this thread first: its data is
+  // most likely to be in cache.
+  TaskQueue &Own = getQueueForCurrentThread();
+  {
+    std::unique_lock<std::mutex> LockGuard(Own.Lock);
+    if (!Own.Tasks.empty()) {
+      T = std::move(Own.Tasks.back());
+      Own.Tasks.pop_back();
+      --QueuedTasks;
+      return true;
+    }
+  }
+
+  // Otherwise steal the oldest task of another queue, which is likely to be
+  // the biggest, starting with the tasks submitted from outside of the pool
+  // and then with the next worker, so that thieves spread out.
+  unsigned NumQueues = WorkerQueues.size() + 1;
+  unsigned Start = CurrentPool == this ? CurrentWorker + 1 : 0;
+  for (unsigned I = 0; I < NumQueues; ++I) {
+    unsigned Index = (Start + I) % NumQueues;
+    TaskQueue &Victim =
+        Index == WorkerQueues.size() ? ExternalQueue : *WorkerQueues[Index];
+    if (&Victim == &Own)
+      continue;
+    std::unique_lock<std::mutex> LockGuard(Victim.Lock);
+    if (!Victim.Tasks.empty()) {
+      T = std::move(Victim.Tasks.front());
+      Victim.Tasks.pop_front();
+      --QueuedTasks;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::runTask(Task &T) {
+  WorkStealingPool *OuterPool = RunningPool;
+  RunningPool = this;
+  T.Run();
+  RunningPool = OuterPool;
+  // Release what the task captured before its group may be destroyed.
+  T.Run = nullptr;
+  if (T.Group)
+    T.Group->finish();
+}
+
+bool WorkStealingPool::runQueuedTask() {
+  Task T;
+  if (!popTask(T))
+    return false;
+  runTask(T);
+  return true;
+}
+
+void WorkStealingPool::runWorker(unsigned Index) {
+  CurrentPool = this;
+  CurrentWorker = Index;
+  while (true) {
+    if (runQueuedTask())
+      continue;
+
+    std::unique_lock<std::mutex> LockGuard(SleepLock);
+    ++SleepingThreads;
+    SleepCondition.wait(LockGuard, [&] { return Stopping || QueuedTasks; });
+    --SleepingThreads;
+    // Exit condition
+    if (Stopping && !QueuedTasks)
+      return;
+  }
+}
+
+void TaskGroup::spawn(WorkStealingPool::TaskTy Task) {
+  {
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    ++PendingTasks;
+  }
+  Pool.asyncImpl(std::move(Task), this);
+}
+
+void TaskGroup::finish() {
+  // Notify under the lock: the group may be destroyed as soon as a waiter
+  // sees that no task is pending.
+  std::unique_lock<std::mutex> LockGuard(Lock);
+  if (--PendingTasks == 0)
+    Done.notify_all();
+}
+
+void TaskGroup::wait() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> LockGuard(Lock);
+      if (!PendingTasks)
+        return;
+    }
+
+    // Help with the queued tasks, which likely include those of this group.
+    if (Pool.runQueuedTask())
+      continue;
+
+    // The remaining tasks of the group are running on other threads.
+    std::unique_lock<std::mutex> LockGuard(Lock);
+    Done.wait(LockGuard, [&] { return !PendingTasks; });
+    return;
+  }
+}
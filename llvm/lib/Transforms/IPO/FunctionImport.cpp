@@ -28,6 +28,7 @@
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
@@ -192,19 +193,19 @@ using EdgeInfo = std::tuple<const FunctionSummary *, unsigned /* Threshold */,
 
 /// Compute the list of functions to import for a given caller. Mark these
 /// imported functions and the symbols they reference in their source module as
-/// exported from their source module.
+/// exported from their source module. Debug output is written to \p DbgOS.
 static void computeImportForFunction(
     const FunctionSummary &Summary, const ModuleSummaryIndex &Index,
     const unsigned Threshold, const GVSummaryMapTy &DefinedGVSummaries,
     SmallVectorImpl<EdgeInfo> &Worklist,
-    FunctionImporter::ImportMapTy &ImportList,
+    FunctionImporter::ImportMapTy &ImportList, raw_ostream &DbgOS,
     StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
   for (auto &Edge : Summary.calls()) {
     auto GUID = Edge.first.getGUID();
-    DEBUG(dbgs() << " edge -> " << GUID << " Threshold:" << Threshold << "\n");
+    DEBUG(DbgOS << " edge -> " << GUID << " Threshold:" << Threshold << "\n");
 
     if (DefinedGVSummaries.count(GUID)) {
-      DEBUG(dbgs() << "ignored! Target already in destination module.\n");
+      DEBUG(DbgOS << "ignored! Target already in destination module.\n");
       continue;
     }
 
@@ -222,7 +223,7 @@ static void computeImportForFunction(
     auto *CalleeSummary =
         selectCallee(GUID, NewThreshold, Index, Summary.modulePath());
     if (!CalleeSummary) {
-      DEBUG(dbgs() << "ignored! No qualifying callee with summary found.\n");
+      DEBUG(DbgOS << "ignored! No qualifying callee with summary found.\n");
       continue;
     }
     // "Resolve" the summary, traversing alias,
@@ -257,8 +258,8 @@ static void computeImportForFunction(
     /// a second time with a higher threshold. In this case, it is added back to
     /// the worklist with the new threshold.
     if (ProcessedThreshold && ProcessedThreshold >= AdjThreshold) {
-      DEBUG(dbgs() << "ignored! Target was already seen with Threshold "
-                   << ProcessedThreshold << "\n");
+      DEBUG(DbgOS << "ignored! Target was already seen with Threshold "
+                  << ProcessedThreshold << "\n");
       continue;
     }
     bool PreviouslyImported = ProcessedThreshold != 0;
@@ -294,10 +295,11 @@ static void computeImportForFunction(
 
 /// Given the list of globals defined in a module, compute the list of imports
 /// as well as the list of "exports", i.e. the list of symbols referenced from
-/// another module (that may require promotion).
+/// another module (that may require promotion). Debug output is written to
+/// \p DbgOS.
 static void ComputeImportForModule(
     const GVSummaryMapTy &DefinedGVSummaries, const ModuleSummaryIndex &Index,
-    FunctionImporter::ImportMapTy &ImportList,
+    FunctionImporter::ImportMapTy &ImportList, raw_ostream &DbgOS,
     StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr,
     const DenseSet<GlobalValue::GUID> *DeadSymbols = nullptr) {
   // Worklist contains the list of function imported in this module, for which
@@ -308,7 +310,7 @@ static void ComputeImportForModule(
   // module
   for (auto &GVSummary : DefinedGVSummaries) {
     if (DeadSymbols && DeadSymbols->count(GVSummary.first)) {
-      DEBUG(dbgs() << "Ignores Dead GUID: " << GVSummary.first << "\n");
+      DEBUG(DbgOS << "Ignores Dead GUID: " << GVSummary.first << "\n");
       continue;
     }
     auto *Summary = GVSummary.second;
@@ -318,9 +320,9 @@ static void ComputeImportForModule(
     if (!FuncSummary)
       // Skip import for global variables
       continue;
-    DEBUG(dbgs() << "Initalize import for " << GVSummary.first << "\n");
+    DEBUG(DbgOS << "Initalize import for " << GVSummary.first << "\n");
     computeImportForFunction(*FuncSummary, Index, ImportInstrLimit,
-                             DefinedGVSummaries, Worklist, ImportList,
+                             DefinedGVSummaries, Worklist, ImportList, DbgOS,
                              ExportLists);
   }
 
@@ -339,7 +341,7 @@ static void ComputeImportForModule(
       continue;
 
     computeImportForFunction(*Summary, Index, Threshold, DefinedGVSummaries,
-                             Worklist, ImportList, ExportLists);
+                             Worklist, ImportList, DbgOS, ExportLists);
   }
 }
 
@@ -352,13 +354,35 @@ void llvm::ComputeCrossModuleImport(
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
     StringMap<FunctionImporter::ExportSetTy> &ExportLists,
     const DenseSet<GlobalValue::GUID> *DeadSymbols) {
-  // For each module that has function defined, compute the import/export lists.
+  // Create the import lists up front: each module only updates its own, so
+  // the modules can be processed in parallel.
+  std::vector<const StringMapEntry<GVSummaryMapTy> *> Modules;
+  std::vector<FunctionImporter::ImportMapTy *> ModuleImportLists;
   for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
-    DEBUG(dbgs() << "Computing import for Module '"
-                 << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index, ImportList,
-                           &ExportLists, DeadSymbols);
+    Modules.push_back(&DefinedGVSummaries);
+    ModuleImportLists.push_back(&ImportLists[DefinedGVSummaries.first()]);
+  }
+
+  // For each module that has function defined, compute the import/export lists.
+  // The exports made by each module are recorded separately, and merged in the
+  // order of the modules so that the result does not depend on scheduling.
+  // The debug output of each module is buffered as well, and printed in the
+  // same order.
+  std::vector<StringMap<FunctionImporter::ExportSetTy>> ModuleExportLists(
+      Modules.size());
+  std::vector<std::string> ModuleDebugOutput(Modules.size());
+  parallelFor(size_t(0), Modules.size(), [&](size_t I) {
+    raw_string_ostream DbgOS(ModuleDebugOutput[I]);
+    DEBUG(DbgOS << "Computing import for Module '" << Modules[I]->first()
+                << "'\n");
+    ComputeImportForModule(Modules[I]->second, Index, *ModuleImportLists[I],
+                           DbgOS, &ModuleExportLists[I], DeadSymbols);
+  });
+  DEBUG(for (const std::string &Output : ModuleDebugOutput) dbgs() << Output);
+  for (auto &ModuleExports : ModuleExportLists) {
+    for (auto &ELI : ModuleExports)
+      ExportLists[ELI.first()].insert(ELI.second.begin(), ELI.second.end());
+    ModuleExports.clear();
   }
 
   // When computing imports we added all GUIDs referenced by anything
@@ -366,16 +390,24 @@ void llvm::ComputeCrossModuleImport(
   // of any not defined in that module. This is more efficient than checking
   // while computing imports because some of the summary lists may be long
   // due to linkonce (comdat) copies.
-  for (auto &ELI : ExportLists) {
-    const auto &DefinedGVSummaries =
-        ModuleToDefinedGVSummaries.lookup(ELI.first());
-    for (auto EI = ELI.second.begin(); EI != ELI.second.end();) {
+  std::vector<StringMapEntry<FunctionImporter::ExportSetTy> *> ExportEntries;
+  for (auto &ELI : ExportLists)
+    ExportEntries.push_back(&ELI);
+  parallelFor(size_t(0), ExportEntries.size(), [&](size_t I) {
+    auto &ExportList = ExportEntries[I]->second;
+    auto DefinedIt = ModuleToDefinedGVSummaries.find(ExportEntries[I]->first());
+    if (DefinedIt == ModuleToDefinedGVSummaries.end()) {
+      ExportList.clear();
+      return;
+    }
+    const auto &DefinedGVSummaries = DefinedIt->second;
+    for (auto EI = ExportList.begin(); EI != ExportList.end();) {
       if (!DefinedGVSummaries.count(*EI))
-        EI = ELI.second.erase(EI);
+        EI = ExportList.erase(EI);
       else
         ++EI;
     }
-  }
+  });
 
 #ifndef NDEBUG
   DEBUG(dbgs() << "Import/Export lists for " << ImportLists.size()
@@ -407,7 +439,7 @@ void llvm::ComputeCrossModuleImportForModule(
 
   // Compute the import list for this module.
   DEBUG(dbgs() << "Computing import for Module '" << ModulePath << "'\n");
-  ComputeImportForModule(FunctionSummaryMap, Index, ImportList);
+  ComputeImportForModule(FunctionSummaryMap, Index, ImportList, dbgs());
 
 #ifndef NDEBUG
   DEBUG(dbgs() << "* Module " << ModulePath << " imports from "
@@ -448,40 +480,47 @@ DenseSet<GlobalValue::GUID> llvm::computeDeadSymbols(
     Worklist.push_back(Entry.first);
   }
 
+  // Walk the graph one level at a time. The references of the symbols of a
+  // level are collected in parallel, then marked live in order, so that the
+  // next level does not depend on scheduling.
+  std::vector<SmallVector<GlobalValue::GUID, 8>> Successors;
+  std::vector<char> NotInIndex;
   while (!Worklist.empty()) {
-    auto GUID = Worklist.pop_back_val();
-    auto It = Index.findGlobalValueSummaryList(GUID);
-    if (It == Index.end()) {
-      DEBUG(dbgs() << "Not in index: " << GUID << "\n");
-      continue;
-    }
-
-    // FIXME: we should only make the prevailing copy live here
-    for (auto &Summary : It->second) {
-      for (auto Ref : Summary->refs()) {
-        auto RefGUID = Ref.getGUID();
-        if (LiveSymbols.insert(RefGUID).second) {
-          DEBUG(dbgs() << "Marking live (ref): " << RefGUID << "\n");
-          Worklist.push_back(RefGUID);
-        }
+    Successors.clear();
+    Successors.resize(Worklist.size());
+    NotInIndex.assign(Worklist.size(), false);
+    parallelFor(size_t(0), Worklist.size(), [&](size_t I) {
+      auto GUID = Worklist[I];
+      auto It = Index.findGlobalValueSummaryList(GUID);
+      if (It == Index.end()) {
+        NotInIndex[I] = true;
+        return;
       }
-      if (auto *FS = dyn_cast<FunctionSummary>(Summary.get())) {
-        for (auto Call : FS->calls()) {
-          auto CallGUID = Call.first.getGUID();
-          if (LiveSymbols.insert(CallGUID).second) {
-            DEBUG(dbgs() << "Marking live (call): " << CallGUID << "\n");
-            Worklist.push_back(CallGUID);
-          }
-        }
+
+      // FIXME: we should only make the prevailing copy live here
+      for (auto &Summary : It->second) {
+        for (auto Ref : Summary->refs())
+          Successors[I].push_back(Ref.getGUID());
+        if (auto *FS = dyn_cast<FunctionSummary>(Summary.get()))
+          for (auto Call : FS->calls())
+            Successors[I].push_back(Call.first.getGUID());
+        if (auto *AS = dyn_cast<AliasSummary>(Summary.get()))
+          Successors[I].push_back(AS->getAliasee().getOriginalName());
       }
-      if (auto *AS = dyn_cast<AliasSummary>(Summary.get())) {
-        auto AliaseeGUID = AS->getAliasee().getOriginalName();
-        if (LiveSymbols.insert(AliaseeGUID).second) {
-          DEBUG(dbgs() << "Marking live (alias): " << AliaseeGUID << "\n");
-          Worklist.push_back(AliaseeGUID);
+    });
+
+    DEBUG({
+      for (size_t I = 0, E = Worklist.size(); I != E; ++I)
+        if (NotInIndex[I])
+          dbgs() << "Not in index: " << Worklist[I] << "\n";
+    });
+    Worklist.clear();
+    for (auto &GUIDs : Successors)
+      for (auto GUID : GUIDs)
+        if (LiveSymbols.insert(GUID).second) {
+          DEBUG(dbgs() << "Marking live: " << GUID << "\n");
+          Worklist.push_back(GUID);
         }
-      }
-    }
   }
   DenseSet<GlobalValue::GUID> DeadSymbols;
   DeadSymbols.reserve(
@@ -663,6 +663,12 @@ void PassManagerBuilder::populateModulePassManager(
 }
 
 void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
+  addLTOIPOPasses(PM);
+  if (OptLevel > 1)
+    addLTOFunctionPasses(PM);
+}
+
+void PassManagerBuilder::addLTOIPOPasses(legacy::PassManagerBase &PM) {
   // Remove unused virtual tables to improve the quality of code generated by
   // whole-program devirtualization and bitset lowering.
   PM.add(createGlobalDCEPass());
@@ -742,7 +748,9 @@ void PassManagerBuilder::addLTOOptimizationPasses(legacy::PassManagerBase &PM) {
   // If we didn't decide to inline a function, check to see if we can
   // transform it to pass arguments by value instead of by reference.
   PM.add(createArgumentPromotionPass());
+}
 
+void PassManagerBuilder::addLTOFunctionPasses(legacy::PassManagerBase &PM) {
   // The IPO passes may leave cruft around.  Clean up after them.
   addInstructionCombiningPass(PM);
   addExtensionsToPM(EP_Peephole, PM);
@@ -868,6 +876,55 @@ void PassManagerBuilder::populateLTOPassManager(legacy::PassManagerBase &PM) {
     PM.add(createVerifierPass());
 }
 
+void PassManagerBuilder::populateLTOIPOPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  if (VerifyInput)
+    PM.add(createVerifierPass());
+
+  if (OptLevel != 0)
+    addLTOIPOPasses(PM);
+
+  // The type tests must be lowered on the whole module, so run the CFI passes
+  // before the function passes rather than after them.
+  PM.add(createCrossDSOCFIPass());
+  PM.add(createLowerTypeTestsPass(Summary ? LowerTypeTestsSummaryAction::Export
+                                          : LowerTypeTestsSummaryAction::None,
+                                  Summary));
+
+  if (OptLevel != 0) {
+    // Remove what the inliner left dead now, as SplitModule externalizes the
+    // local functions, which the partitions could not delete anymore.
+    PM.add(createEliminateAvailableExternallyPass());
+    PM.add(createGlobalDCEPass());
+    if (MergeFunctions)
+      PM.add(createMergeFunctionsPass());
+  }
+
+  if (VerifyOutput)
+    PM.add(createVerifierPass());
+}
+
+void PassManagerBuilder::populateLTOPartitionPassManager(
+    legacy::PassManagerBase &PM) {
+  if (LibraryInfo)
+    PM.add(new TargetLibraryInfoWrapperPass(*LibraryInfo));
+
+  if (OptLevel > 1) {
+    addInitialAliasAnalysisPasses(PM);
+    addLTOFunctionPasses(PM);
+  }
+
+  // Delete basic blocks, which optimization passes may have killed.
+  if (OptLevel != 0)
+    PM.add(createCFGSimplificationPass());
+
+  if (VerifyOutput)
+    PM.add(createVerifierPass());
+}
+
 inline PassManagerBuilder *unwrap(LLVMPassManagerBuilderRef P) {
     return reinterpret_cast<PassManagerBuilder*>(P);
 }
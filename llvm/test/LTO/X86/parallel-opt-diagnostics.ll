@@ -0,0 +1,50 @@
+; RUN: llvm-as -o %t.bc %s
+
+; The remarks of the function passes run on each partition reach the
+; diagnostic handler of the code generator.
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar -j2 -parallel-opt \
+; RUN:   -use-diagnostic-handler -pass-remarks-analysis=loop-vectorize \
+; RUN:   -o %t.o %t.bc 2>&1 | FileCheck --check-prefix=REMARK %s
+; REMARK: llvm-lto: remark: {{.*}}interleaving
+; REMARK: llvm-lto: remark: {{.*}}interleaving
+
+; The partitions are not optimized separately when the remarks are written to
+; a file.
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar -j2 -parallel-opt \
+; RUN:   -lto-pass-remarks-output=%t.yaml -save-merged-module -o %t2.o %t.bc \
+; RUN:   2>&1 | FileCheck --check-prefix=WARN %s
+; RUN: llvm-dis -o - %t2.o.merged.bc | FileCheck --check-prefix=MERGED %s
+; WARN: warning: optimizing the partitions in parallel is not supported when writing optimization remarks to a file
+; MERGED: define void @bar
+; MERGED-NOT: call void @foo
+
+; FIXME: Investigate test failures on these architecures.
+; UNSUPPORTED: mips, mipsel, aarch64, powerpc64
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define void @foo(i32* %a, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr i32, i32* %a, i64 %i
+  %v = load i32, i32* %p
+  %i.next = add i64 %i, 1
+  %q = getelementptr i32, i32* %a, i64 %i.next
+  %w = add i32 %v, 1
+  store i32 %w, i32* %q
+  %c = icmp ult i64 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+define void @bar(i32* %a, i64 %n) {
+entry:
+  call void @foo(i32* %a, i64 %n)
+  ret void
+}
@@ -0,0 +1,61 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=baz -j2 -parallel-opt \
+; RUN:   -save-merged-module -o %t.o %t.bc
+; RUN: llvm-dis -o - %t.o.merged.bc | FileCheck --check-prefix=MERGED %s
+; RUN: llvm-objdump -d %t.o.0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-objdump -d %t.o.1 | FileCheck --check-prefix=CHECK1 %s
+
+; With -parallel-opt, only the interprocedural passes run on the merged
+; module: bar is inlined and deleted, but the loops are left to the function
+; passes, which run on each partition.
+
+; FIXME: Investigate test failures on these architecures.
+; UNSUPPORTED: mips, mipsel, aarch64, powerpc64
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; MERGED: define i32 @foo()
+; MERGED: phi
+; MERGED-NOT: define i32 @bar()
+; MERGED: define i32 @baz()
+; MERGED: phi
+
+; CHECK0: foo:
+; CHECK0-NEXT: movl $10, %eax
+; CHECK0-NEXT: retq
+define i32 @foo() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
+
+define i32 @bar() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, 10
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
+
+; CHECK1: baz:
+; CHECK1-NEXT: movl $20, %eax
+; CHECK1-NEXT: retq
+define i32 @baz() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, 20
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
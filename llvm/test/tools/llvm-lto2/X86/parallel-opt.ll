@@ -0,0 +1,52 @@
+; RUN: llvm-as < %s > %t1.bc
+
+; RUN: llvm-lto2 %t1.bc -o %t.o -save-temps -lto-partitions=2 \
+; RUN:   -lto-parallel-opt -r %t1.bc,foo,px -r %t1.bc,bar,p -r %t1.bc,baz,px
+; RUN: llvm-dis < %t.o.0.4.opt.bc | FileCheck %s --check-prefix=OPT0
+; RUN: llvm-dis < %t.o.1.4.opt.bc | FileCheck %s --check-prefix=OPT1
+
+; The post-optimization hook runs on each partition after the function
+; passes.
+; OPT0: define i32 @foo()
+; OPT0-NEXT: bar.exit:
+; OPT0-NEXT: ret i32 10
+; OPT0-NOT: define
+; OPT1: define i32 @baz()
+; OPT1-NEXT: entry:
+; OPT1-NEXT: ret i32 20
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @foo() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
+
+define i32 @bar() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, 10
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
+
+define i32 @baz() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, 20
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
@@ -31,7 +31,7 @@
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/ScopedPrinter.h"
-#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include <functional>
 #include <system_error>
@@ -703,6 +703,11 @@ int CodeCoverageTool::show(int argc, const char **argv,
   cl::alias ShowOutputDirectoryA("o", cl::desc("Alias for --output-dir"),
                                  cl::aliasopt(ShowOutputDirectory));
 
+  cl::opt<unsigned> NumThreads(
+      "num-threads", cl::init(0),
+      cl::desc("Number of threads used to write the reports of the files in "
+               "-output-dir mode (default = one per hardware thread)"));
+
   cl::opt<uint32_t> TabSize(
       "tab-size", cl::init(2),
       cl::desc(
@@ -797,19 +802,18 @@ int CodeCoverageTool::show(int argc, const char **argv,
     }
   }
 
-  // FIXME: Sink the hardware_concurrency() == 1 check into ThreadPool.
-  if (!ViewOpts.hasOutputDirectory() ||
-      std::thread::hardware_concurrency() == 1) {
+  if (!ViewOpts.hasOutputDirectory()) {
     for (const std::string &SourceFile : SourceFiles)
       writeSourceFileView(SourceFile, Coverage.get(), Printer.get(),
                           ShowFilenames);
   } else {
     // In -output-dir mode, it's safe to use multiple threads to print files.
-    ThreadPool Pool;
-    for (const std::string &SourceFile : SourceFiles)
-      Pool.async(&CodeCoverageTool::writeSourceFileView, this, SourceFile,
-                 Coverage.get(), Printer.get(), ShowFilenames);
-    Pool.wait();
+    WorkStealingPool::setDefaultConcurrency(NumThreads);
+    parallelForEach(SourceFiles.begin(), SourceFiles.end(),
+                    [&](const std::string &SourceFile) {
+                      writeSourceFileView(SourceFile, Coverage.get(),
+                                          Printer.get(), ShowFilenames);
+                    });
   }
 
   return 0;
@@ -64,6 +64,22 @@ static cl::opt<bool>
                                        "import files for the "
                                        "distributed backend case"));
 
+static cl::opt<std::string> ThinLTOIndexTable(
+    "thinlto-index-table",
+    cl::desc("Write out a module summary index table for the distributed "
+             "backend case"),
+    cl::value_desc("filename"));
+
+static cl::opt<unsigned>
+    Partitions("lto-partitions", cl::init(1),
+               cl::desc("Number of parallel code generation partitions for "
+                        "the regular LTO module"));
+
+static cl::opt<bool> ParallelOpt(
+    "lto-parallel-opt",
+    cl::desc("Run the function passes of regular LTO on each partition, in "
+             "parallel, instead of on the whole module"));
+
 static cl::opt<int> Threads("thinlto-threads",
                             cl::init(llvm::heavyweight_hardware_concurrency()));
 
@@ -201,13 +217,16 @@ int main(int argc, char **argv) {
 
   Conf.OverrideTriple = OverrideTriple;
   Conf.DefaultTriple = DefaultTriple;
+  Conf.ParallelOpt = ParallelOpt;
 
   ThinBackend Backend;
   if (ThinLTODistributedIndexes)
     Backend = createWriteIndexesThinBackend("", "", true, "");
+  else if (!ThinLTOIndexTable.empty())
+    Backend = createWriteIndexTableThinBackend(ThinLTOIndexTable);
   else
     Backend = createInProcessThinBackend(Threads);
-  LTO Lto(std::move(Conf), std::move(Backend));
+  LTO Lto(std::move(Conf), std::move(Backend), Partitions);
 
   bool HasErrors = false;
   for (std::string F : InputFilenames) {
@@ -0,0 +1,216 @@
+//===- ModuleSummaryIndexTableTest.cpp - Tests for summary index tables ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ModuleSummaryIndexTable.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+const GlobalValue::GUID FooGUID = 1, BarGUID = 2, VarGUID = 3, AliasGUID = 4;
+const CalleeInfo::HotnessType Hot = CalleeInfo::HotnessType::Hot;
+
+std::unique_ptr<GlobalValueSummary>
+makeFunction(StringRef ModulePath, GlobalValue::LinkageTypes Linkage,
+             unsigned NumInsts, std::vector<FunctionSummary::EdgeTy> Calls) {
+  auto S = llvm::make_unique<FunctionSummary>(
+      GlobalValueSummary::GVFlags(Linkage, false, false), NumInsts,
+      std::vector<ValueInfo>{ValueInfo(VarGUID)}, std::move(Calls),
+      std::vector<GlobalValue::GUID>{42});
+  S->setModulePath(ModulePath);
+  return std::move(S);
+}
+
+/// Build a combined index of two modules: a.o defines foo, which calls bar,
+/// and b.o defines bar, a variable and an alias of bar. Both define a local
+/// function with the GUID of foo.
+void buildIndex(ModuleSummaryIndex &Index) {
+  StringRef A = Index.addModulePath("a.o", 0, ModuleHash{{1, 2, 3, 4, 5}})
+                    ->first();
+  StringRef B = Index.addModulePath("b.o", 1)->first();
+
+  Index.addGlobalValueSummary(
+      FooGUID, makeFunction(A, GlobalValue::ExternalLinkage, 10,
+                            {std::make_pair(ValueInfo(BarGUID),
+                                            CalleeInfo(Hot))}));
+  Index.addGlobalValueSummary(
+      FooGUID, makeFunction(B, GlobalValue::InternalLinkage, 3, {}));
+
+  auto Bar = makeFunction(B, GlobalValue::ExternalLinkage, 5, {});
+  GlobalValueSummary *BarSummary = Bar.get();
+  Index.addGlobalValueSummary(BarGUID, std::move(Bar));
+
+  auto Var = llvm::make_unique<GlobalVarSummary>(
+      GlobalValueSummary::GVFlags(GlobalValue::CommonLinkage, true, true),
+      std::vector<ValueInfo>{});
+  Var->setModulePath(B);
+  Var->setOriginalName(7);
+  Index.addGlobalValueSummary(VarGUID, std::move(Var));
+
+  auto Alias = llvm::make_unique<AliasSummary>(
+      GlobalValueSummary::GVFlags(GlobalValue::WeakODRLinkage, false, false),
+      std::vector<ValueInfo>{});
+  Alias->setModulePath(B);
+  Alias->setAliasee(BarSummary);
+  Index.addGlobalValueSummary(AliasGUID, std::move(Alias));
+}
+
+std::string writeTable(const ModuleSummaryIndex &Index) {
+  ModuleSummaryIndexTableBuilder Builder(Index);
+
+  // The backend of a.o imports bar and the alias from b.o.
+  std::map<std::string, GVSummaryMapTy> Summaries;
+  for (GlobalValue::GUID GUID : {FooGUID})
+    Summaries["a.o"][GUID] = Index.findSummaryInModule(GUID, "a.o");
+  for (GlobalValue::GUID GUID : {BarGUID, AliasGUID})
+    Summaries["b.o"][GUID] = Index.findSummaryInModule(GUID, "b.o");
+  Builder.addBackendSummaries("a.o", Summaries);
+
+  std::string Table;
+  raw_string_ostream OS(Table);
+  Builder.write(OS);
+  return OS.str();
+}
+
+TEST(ModuleSummaryIndexTableTest, FindSummaries) {
+  ModuleSummaryIndex Index;
+  buildIndex(Index);
+  std::string Buffer = writeTable(Index);
+  MemoryBufferRef Ref(Buffer, "table");
+  ASSERT_TRUE(ModuleSummaryIndexTable::isModuleSummaryIndexTable(Ref));
+
+  auto TableOrErr = ModuleSummaryIndexTable::create(Ref);
+  ASSERT_TRUE(!!TableOrErr);
+  ModuleSummaryIndexTable &Table = **TableOrErr;
+  EXPECT_EQ(2u, Table.getNumModules());
+  EXPECT_EQ(5u, Table.getNumSummaries());
+  auto BOrErr = Table.findModule("b.o");
+  ASSERT_TRUE(!!BOrErr);
+  auto PathOrErr = Table.getModulePath(*BOrErr);
+  ASSERT_TRUE(!!PathOrErr);
+  EXPECT_EQ("b.o", *PathOrErr);
+  auto ModuleOrErr = Table.findModule("c.o");
+  EXPECT_FALSE(!!ModuleOrErr);
+  consumeError(ModuleOrErr.takeError());
+
+  auto FooOrErr = Table.findSummaries(FooGUID);
+  ASSERT_TRUE(!!FooOrErr);
+  auto FooIndexOrErr = Table.loadSummaries(*FooOrErr);
+  ASSERT_TRUE(!!FooIndexOrErr);
+  ModuleSummaryIndex &FooIndex = **FooIndexOrErr;
+  EXPECT_EQ(2u, FooIndex.modulePaths().size());
+  auto *Foo =
+      cast<FunctionSummary>(FooIndex.findSummaryInModule(FooGUID, "a.o"));
+  EXPECT_EQ(GlobalValue::ExternalLinkage, Foo->linkage());
+  EXPECT_EQ(10u, Foo->instCount());
+  ASSERT_EQ(1u, Foo->refs().size());
+  EXPECT_EQ(VarGUID, Foo->refs()[0].getGUID());
+  ASSERT_EQ(1u, Foo->type_tests().size());
+  EXPECT_EQ(42u, Foo->type_tests()[0]);
+  ASSERT_EQ(1u, Foo->calls().size());
+  EXPECT_EQ(BarGUID, Foo->calls()[0].first.getGUID());
+  EXPECT_EQ(Hot, Foo->calls()[0].second.Hotness);
+  EXPECT_EQ(ModuleHash({{1, 2, 3, 4, 5}}), FooIndex.getModuleHash("a.o"));
+  auto *LocalFoo =
+      cast<FunctionSummary>(FooIndex.findSummaryInModule(FooGUID, "b.o"));
+  EXPECT_EQ(GlobalValue::InternalLinkage, LocalFoo->linkage());
+
+  auto VarOrErr = Table.findSummaries(VarGUID);
+  ASSERT_TRUE(!!VarOrErr);
+  auto VarIndexOrErr = Table.loadSummaries(*VarOrErr);
+  ASSERT_TRUE(!!VarIndexOrErr);
+  GlobalValueSummary *Var =
+      (*VarIndexOrErr)->findSummaryInModule(VarGUID, "b.o");
+  ASSERT_TRUE(Var && isa<GlobalVarSummary>(Var));
+  EXPECT_EQ(GlobalValue::CommonLinkage, Var->linkage());
+  EXPECT_TRUE(Var->notEligibleToImport());
+  EXPECT_TRUE(Var->liveRoot());
+  EXPECT_EQ(7u, Var->getOriginalName());
+
+  auto NoneOrErr = Table.findSummaries(5);
+  ASSERT_TRUE(!!NoneOrErr);
+  EXPECT_TRUE(NoneOrErr->empty());
+}
+
+TEST(ModuleSummaryIndexTableTest, LoadIndexForModule) {
+  ModuleSummaryIndex Index;
+  buildIndex(Index);
+  std::string Buffer = writeTable(Index);
+  auto TableOrErr =
+      ModuleSummaryIndexTable::create(MemoryBufferRef(Buffer, "table"));
+  ASSERT_TRUE(!!TableOrErr);
+
+  auto IndexOrErr = (*TableOrErr)->loadIndexForModule("a.o");
+  ASSERT_TRUE(!!IndexOrErr);
+  ModuleSummaryIndex &AIndex = **IndexOrErr;
+  EXPECT_EQ(2u, AIndex.modulePaths().size());
+  EXPECT_TRUE(AIndex.findSummaryInModule(FooGUID, "a.o"));
+  EXPECT_FALSE(AIndex.findSummaryInModule(FooGUID, "b.o"));
+  EXPECT_FALSE(AIndex.findSummaryInModule(VarGUID, "b.o"));
+  GlobalValueSummary *Bar = AIndex.findSummaryInModule(BarGUID, "b.o");
+  auto *Alias = dyn_cast_or_null<AliasSummary>(
+      AIndex.findSummaryInModule(AliasGUID, "b.o"));
+  ASSERT_TRUE(Bar && Alias);
+  EXPECT_EQ(Bar, &Alias->getAliasee());
+
+  // No summaries were recorded for the backend of b.o, but its module is
+  // still in its index.
+  auto BIndexOrErr = (*TableOrErr)->loadIndexForModule("b.o");
+  ASSERT_TRUE(!!BIndexOrErr);
+  EXPECT_EQ(1u, (*BIndexOrErr)->modulePaths().size());
+  EXPECT_EQ(1u, (*BIndexOrErr)->getModuleId("b.o"));
+}
+
+TEST(ModuleSummaryIndexTableTest, Invalid) {
+  ModuleSummaryIndex Index;
+  buildIndex(Index);
+  std::string Buffer = writeTable(Index);
+
+  // Tables truncated in the header or the records are rejected.
+  for (size_t Size : {size_t(8), sizeof(summary_table::Header),
+                      Buffer.size() - 1}) {
+    auto TableOrErr = ModuleSummaryIndexTable::create(
+        MemoryBufferRef(StringRef(Buffer.data(), Size), "table"));
+    EXPECT_FALSE(!!TableOrErr);
+    consumeError(TableOrErr.takeError());
+  }
+
+  EXPECT_FALSE(ModuleSummaryIndexTable::isModuleSummaryIndexTable(
+      MemoryBufferRef("BC\xC0\xDE", "bitcode")));
+
+  // So are summaries with a module or an aliasee out of bounds, even if the
+  // index is a reserved key of DenseMap.
+  auto *H = reinterpret_cast<const summary_table::Header *>(Buffer.data());
+  for (uint32_t Bad : {~0u, ~0u - 1, 100u}) {
+    for (uint32_t I = 0; I != H->NumSummaries; ++I) {
+      std::string Corrupt = Buffer;
+      auto *R = reinterpret_cast<summary_table::Summary *>(
+          &Corrupt[H->SummariesOffset + I * sizeof(summary_table::Summary)]);
+      if (R->Kind == GlobalValueSummary::AliasKind)
+        R->Aliasee = Bad;
+      else
+        R->Module = Bad;
+
+      auto TableOrErr =
+          ModuleSummaryIndexTable::create(MemoryBufferRef(Corrupt, "table"));
+      ASSERT_TRUE(!!TableOrErr);
+      std::vector<support::ulittle32_t> Indices(H->NumSummaries);
+      for (uint32_t J = 0; J != H->NumSummaries; ++J)
+        Indices[J] = J;
+      auto IndexOrErr = (*TableOrErr)->loadSummaries(Indices);
+      EXPECT_FALSE(!!IndexOrErr);
+      consumeError(IndexOrErr.takeError());
+    }
+  }
+}
+
+} // end anonymous namespace
@@ -72,6 +72,36 @@ TEST(CompressionTest, ZlibCRC32) {
       zlib::crc32(StringRef("The quick brown fox jumps over the lazy dog")));
 }
 
+TEST(CompressionTest, ZlibChunks) {
+  std::string Input;
+  for (int I = 0; I < 1000; ++I)
+    Input += "chunk " + std::to_string(I) + "\n";
+  StringRef First = StringRef(Input).substr(0, 3000);
+  StringRef Second = StringRef(Input).substr(3000);
+
+  // Raw deflate chunks wrapped with a zlib header and a combined checksum
+  // form a single zlib stream.
+  SmallString<32> Compressed;
+  uint16_t Header = zlib::getHeader(zlib::BestSpeedCompression);
+  Compressed.push_back(Header >> 8);
+  Compressed.push_back(Header & 0xff);
+  EXPECT_FALSE(zlib::compressChunk(First, Compressed,
+                                   zlib::BestSpeedCompression, false));
+  EXPECT_FALSE(zlib::compressChunk(Second, Compressed,
+                                   zlib::BestSpeedCompression, true));
+  uint32_t Checksum = zlib::adler32Combine(
+      zlib::adler32(First), zlib::adler32(Second), Second.size());
+  EXPECT_EQ(zlib::adler32(Input), Checksum);
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    Compressed.push_back(Checksum >> Shift);
+
+  SmallString<32> Uncompressed;
+  Error E = zlib::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
 #endif
 
 }
@@ -0,0 +1,102 @@
+//===- unittests/Support/ParallelTest.cpp - Parallel algorithm tests ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <random>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ParallelTest, ParallelFor) {
+  std::vector<unsigned> Values(10000);
+  parallelFor(0u, 10000u, [&](unsigned I) { Values[I] += I; });
+  for (unsigned I = 0; I < 10000; ++I)
+    EXPECT_EQ(I, Values[I]);
+
+  // Empty ranges do nothing.
+  parallelFor(5, 5, [](int) { FAIL(); });
+  parallelFor(5, 0, [](int) { FAIL(); });
+}
+
+TEST(ParallelTest, ParallelForEach) {
+  std::vector<unsigned> Values(3000, 1);
+  std::atomic<unsigned> Sum(0);
+  parallelForEach(Values.begin(), Values.end(), [&](unsigned V) { Sum += V; });
+  EXPECT_EQ(3000u, Sum);
+}
+
+TEST(ParallelTest, ParallelSortIsStable) {
+  std::mt19937 RandEngine;
+  std::uniform_int_distribution<unsigned> Dist(0, 100);
+  std::vector<std::pair<unsigned, unsigned>> Values;
+  for (unsigned I = 0; I < 100000; ++I)
+    Values.push_back(std::make_pair(Dist(RandEngine), I));
+
+  std::vector<std::pair<unsigned, unsigned>> Expected = Values;
+  auto CompareFirst = [](const std::pair<unsigned, unsigned> &A,
+                         const std::pair<unsigned, unsigned> &B) {
+    return A.first < B.first;
+  };
+  std::stable_sort(Expected.begin(), Expected.end(), CompareFirst);
+  parallelSort(Values.begin(), Values.end(), CompareFirst);
+  EXPECT_EQ(Expected, Values);
+}
+
+TEST(ParallelTest, ParallelTransformReduce) {
+  std::vector<std::string> Strings;
+  for (unsigned I = 0; I < 5000; ++I)
+    Strings.push_back(std::to_string(I % 10));
+
+  size_t Length = parallelTransformReduce(
+      Strings.begin(), Strings.end(), size_t(0), std::plus<size_t>(),
+      [](const std::string &S) { return S.size(); });
+  EXPECT_EQ(5000u, Length);
+
+  // Non-commutative reductions see the elements in order.
+  std::string Concatenated = parallelTransformReduce(
+      Strings.begin(), Strings.end(), std::string(),
+      [](std::string A, const std::string &B) { return A + B; },
+      [](const std::string &S) { return S; });
+  std::string Expected;
+  for (const std::string &S : Strings)
+    Expected += S;
+  EXPECT_EQ(Expected, Concatenated);
+}
+
+TEST(ParallelTest, ShardedDenseMap) {
+  std::vector<std::pair<unsigned, unsigned>> Values;
+  for (unsigned I = 0; I < 20000; ++I)
+    Values.push_back(std::make_pair(I % 1000, I));
+
+  ShardedDenseMap<unsigned, unsigned> Map(16);
+  std::atomic<unsigned> KeyCalls(0);
+  Map.insertParallel(
+      Values.begin(), Values.end(),
+      [&](const std::pair<unsigned, unsigned> &P) {
+        ++KeyCalls;
+        return P.first;
+      },
+      [](const std::pair<unsigned, unsigned> &P) { return P.second; });
+  EXPECT_EQ(20000u, KeyCalls);
+  EXPECT_EQ(1000u, Map.size());
+  EXPECT_EQ(16u, Map.shards().size());
+
+  // The first element with a given key wins.
+  for (unsigned I = 0; I < 1000; ++I) {
+    EXPECT_EQ(1u, Map.count(I));
+    EXPECT_EQ(I, Map.lookup(I));
+  }
+  EXPECT_EQ(0u, Map.count(1000));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,89 @@
+//===- unittests/Support/WorkStealingPoolTest.cpp - WorkStealingPool tests ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/WorkStealingPool.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(WorkStealingPoolTest, TaskGroup) {
+  WorkStealingPool Pool(4);
+  std::atomic<unsigned> Count(0);
+  {
+    TaskGroup Group(Pool);
+    for (unsigned I = 0; I < 1000; ++I)
+      Group.spawn([&] { ++Count; });
+    Group.wait();
+    EXPECT_EQ(1000u, Count);
+
+    // A group can be reused after waiting for it.
+    for (unsigned I = 0; I < 10; ++I)
+      Group.spawn([&] { ++Count; });
+  }
+  EXPECT_EQ(1010u, Count);
+}
+
+static unsigned fib(WorkStealingPool &Pool, unsigned N) {
+  if (N < 2)
+    return N;
+  unsigned A, B;
+  TaskGroup Group(Pool);
+  Group.spawn([&] { A = fib(Pool, N - 1); });
+  B = fib(Pool, N - 2);
+  Group.wait();
+  return A + B;
+}
+
+TEST(WorkStealingPoolTest, NestedGroups) {
+  // Tasks waiting for nested groups run queued tasks instead of blocking the
+  // few threads of the pool.
+  WorkStealingPool Pool(2);
+  EXPECT_EQ(6765u, fib(Pool, 20));
+}
+
+TEST(WorkStealingPoolTest, NoThreads) {
+  // Without threads, tasks run on the thread which waits for them.
+  WorkStealingPool Pool(0);
+  EXPECT_EQ(0u, Pool.getThreadCount());
+  EXPECT_EQ(55u, fib(Pool, 10));
+
+  bool Ran = false;
+  Pool.async([&] { Ran = true; });
+  EXPECT_FALSE(Ran);
+  EXPECT_TRUE(Pool.runQueuedTask());
+  EXPECT_TRUE(Ran);
+  EXPECT_FALSE(Pool.runQueuedTask());
+}
+
+TEST(WorkStealingPoolTest, DestructorRunsQueuedTasks) {
+  std::atomic<unsigned> Count(0);
+  {
+    WorkStealingPool Pool(2);
+    for (unsigned I = 0; I < 100; ++I)
+      Pool.async([&] { ++Count; });
+  }
+  EXPECT_EQ(100u, Count);
+
+  // The tasks run by the destructor may still spawn nested tasks.
+  Count = 0;
+  for (unsigned ThreadCount : {0u, 2u}) {
+    WorkStealingPool Pool(ThreadCount);
+    for (unsigned I = 0; I < 10; ++I)
+      Pool.async([&] {
+        TaskGroup Group(Pool);
+        for (unsigned J = 0; J < 10; ++J)
+          Group.spawn([&] { ++Count; });
+      });
+  }
+  EXPECT_EQ(200u, Count);
+}
+
+} // end anonymous namespace
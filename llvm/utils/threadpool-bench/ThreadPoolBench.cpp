@@ -0,0 +1,156 @@
+//===- ThreadPoolBench - Benchmark the thread pools -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program compares ThreadPool and WorkStealingPool on many small tasks
+// submitted from one thread, on tasks submitted from the tasks themselves, and
+// (for WorkStealingPool only, as ThreadPool cannot wait from within a task) on
+// recursively nested tasks, and outputs the run times.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/WorkStealingPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+    Threads("threads", cl::desc("Number of threads in each pool"),
+            cl::init(std::thread::hardware_concurrency()));
+
+static cl::opt<unsigned> NumTasks("tasks", cl::desc("Number of tasks to run"),
+                                  cl::init(100000));
+
+static cl::opt<unsigned>
+    Work("work", cl::desc("Number of loop iterations in each task"),
+         cl::init(100));
+
+static cl::opt<unsigned>
+    FanOut("fan-out",
+           cl::desc("Number of tasks submitted by each task in the fan-out "
+                    "benchmark"),
+           cl::init(100));
+
+static cl::opt<unsigned>
+    FibN("fib", cl::desc("Argument of the nested Fibonacci benchmark"),
+         cl::init(25));
+
+static std::atomic<unsigned> Sink(0);
+
+/// A small task, which should take roughly Work iterations.
+static void work() {
+  unsigned X = 0;
+  for (unsigned I = 0; I != Work; ++I)
+    X = X * 31 + I;
+  Sink += X;
+}
+
+static void benchmarkFlat(TimerGroup &Group) {
+  {
+    ThreadPool Pool(Threads);
+    Timer T("flat.threadpool", "Flat: ThreadPool", Group);
+    T.startTimer();
+    for (unsigned I = 0; I != NumTasks; ++I)
+      Pool.async(work);
+    Pool.wait();
+    T.stopTimer();
+  }
+
+  {
+    WorkStealingPool Pool(Threads);
+    Timer T("flat.workstealing", "Flat: WorkStealingPool", Group);
+    T.startTimer();
+    TaskGroup Tasks(Pool);
+    for (unsigned I = 0; I != NumTasks; ++I)
+      Tasks.spawn(work);
+    Tasks.wait();
+    T.stopTimer();
+  }
+}
+
+static void benchmarkFanOut(TimerGroup &Group) {
+  unsigned NumOuter = std::max(1u, NumTasks / FanOut.getValue());
+  {
+    ThreadPool Pool(Threads);
+    Timer T("fanout.threadpool", "Fan-out: ThreadPool", Group);
+    T.startTimer();
+    for (unsigned I = 0; I != NumOuter; ++I)
+      Pool.async([&] {
+        for (unsigned J = 0; J != FanOut; ++J)
+          Pool.async(work);
+      });
+    Pool.wait();
+    T.stopTimer();
+  }
+
+  {
+    WorkStealingPool Pool(Threads);
+    Timer T("fanout.workstealing", "Fan-out: WorkStealingPool", Group);
+    T.startTimer();
+    TaskGroup Tasks(Pool);
+    for (unsigned I = 0; I != NumOuter; ++I)
+      Tasks.spawn([&] {
+        for (unsigned J = 0; J != FanOut; ++J)
+          Tasks.spawn(work);
+      });
+    Tasks.wait();
+    T.stopTimer();
+  }
+}
+
+static unsigned fib(unsigned N) {
+  if (N < 2) {
+    work();
+    return N;
+  }
+  return fib(N - 1) + fib(N - 2);
+}
+
+static unsigned fib(WorkStealingPool &Pool, unsigned N) {
+  if (N < 2) {
+    work();
+    return N;
+  }
+  unsigned A, B;
+  TaskGroup Tasks(Pool);
+  Tasks.spawn([&] { A = fib(Pool, N - 1); });
+  B = fib(Pool, N - 2);
+  Tasks.wait();
+  return A + B;
+}
+
+static void benchmarkNested(TimerGroup &Group) {
+  {
+    Timer T("nested.serial", "Nested: Serial", Group);
+    T.startTimer();
+    Sink += fib(FibN);
+    T.stopTimer();
+  }
+
+  {
+    WorkStealingPool Pool(Threads);
+    Timer T("nested.workstealing", "Nested: WorkStealingPool", Group);
+    T.startTimer();
+    Sink += fib(Pool, FibN);
+    T.stopTimer();
+  }
+}
+
+int main(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "thread pool benchmark\n");
+
+  TimerGroup Group("threadpool", "Thread pool benchmark");
+  benchmarkFlat(Group);
+  benchmarkFanOut(Group);
+  benchmarkNested(Group);
+  return 0;
+}